@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otlp.h"
+
+#include <cstring>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <jaeger-struct/runtime/TestUtil.hpp>
+#include <otlp.pb.h>
+
+namespace jaeger_struct {
+namespace examples {
+namespace {
+
+namespace otlp = opentelemetry::proto::v1;
+
+using runtime::LogNode;
+using runtime::SpanNode;
+using runtime::SpanRefNode;
+using runtime::TagNode;
+using runtime::appendNode;
+using runtime::assign;
+
+jaegertracing_protobuf_tag& stringTag(jaegertracing_protobuf_tag& tag,
+                                      const std::string& key,
+                                      const std::string& value)
+{
+    assign(tag.key, key);
+    tag.value.type = jaegertracing_protobuf_tag_value_str_value_type;
+    assign(tag.value.value.str_value, value);
+    return tag;
+}
+
+std::string bytes(std::initializer_list<uint8_t> values)
+{
+    return std::string(values.begin(), values.end());
+}
+
+const otlp::AnyValue* attribute(
+    const google::protobuf::RepeatedPtrField<otlp::KeyValue>& attributes,
+    const std::string& key)
+{
+    for (auto&& keyValue : attributes) {
+        if (keyValue.key() == key) {
+            return &keyValue.value();
+        }
+    }
+    return nullptr;
+}
+
+otlp::ExportTraceServiceRequest parse(const jaeger_buffer& buffer)
+{
+    otlp::ExportTraceServiceRequest request;
+    EXPECT_TRUE(request.ParseFromArray(buffer.data, buffer.size));
+    return request;
+}
+
+}  // anonymous namespace
+
+TEST(Otlp, testSpan)
+{
+    jaegertracing_protobuf_batch batch;
+    std::memset(&batch, 0, sizeof(batch));
+    assign(batch.process.service_name, "frontend");
+    stringTag(appendNode<TagNode>(batch.process.tags)->value,
+              "hostname",
+              "host-1");
+
+    auto& span = appendNode<SpanNode>(batch.spans)->value;
+    span.trace_id = { 0x0102030405060708, 0x090a0b0c0d0e0f10 };
+    span.span_id = 0x1112131415161718;
+    assign(span.operation_name, "GET /");
+    span.flags = 1;
+    span.start_time = 1500000000000000;
+    span.duration = 250;
+
+    stringTag(*jaegertracing_protobuf_span_append_tags(&span),
+              "span.kind",
+              "server");
+    auto* error = jaegertracing_protobuf_span_append_tags(&span);
+    assign(error->key, "error");
+    error->value.type = jaegertracing_protobuf_tag_value_bool_value_type;
+    error->value.value.bool_value = true;
+    auto* status = jaegertracing_protobuf_span_append_tags(&span);
+    assign(status->key, "http.status_code");
+    status->value.type = jaegertracing_protobuf_tag_value_long_value_type;
+    status->value.value.long_value = -500;
+    auto* ratio = jaegertracing_protobuf_span_append_tags(&span);
+    assign(ratio->key, "ratio");
+    ratio->value.type = jaegertracing_protobuf_tag_value_double_value_type;
+    ratio->value.value.double_value = 0.25;
+    auto* payload = jaegertracing_protobuf_span_append_tags(&span);
+    assign(payload->key, "payload");
+    payload->value.type = jaegertracing_protobuf_tag_value_binary_value_type;
+    assign(payload->value.value.binary_value, std::string("\0\1", 2));
+
+    auto& log =
+        appendNode<LogNode>(*jaegertracing_protobuf_span_mutable_logs(&span))
+            ->value;
+    log.timestamp = span.start_time + 10;
+    stringTag(appendNode<TagNode>(log.fields)->value, "level", "info");
+    stringTag(appendNode<TagNode>(log.fields)->value, "event", "retry");
+
+    // The first CHILD_OF reference in the trace is the parent.
+    auto* parent = jaegertracing_protobuf_span_append_references(&span);
+    parent->type = jaegertracing_protobuf_span_ref_type_child_of;
+    parent->trace_id = span.trace_id;
+    parent->span_id = 0x2122232425262728;
+    auto* follows = jaegertracing_protobuf_span_append_references(&span);
+    follows->type = jaegertracing_protobuf_span_ref_type_follows_from;
+    follows->trace_id = { 0, 1 };
+    follows->span_id = 2;
+
+    jaeger_buffer buffer;
+    std::memset(&buffer, 0, sizeof(buffer));
+    ASSERT_TRUE(jaeger_otlp_encode_batch(&batch, &buffer));
+    auto request = parse(buffer);
+
+    ASSERT_EQ(1, request.resource_spans_size());
+    const auto& resourceSpans = request.resource_spans(0);
+    const auto& resource = resourceSpans.resource().attributes();
+    ASSERT_EQ(2, resource.size());
+    ASSERT_EQ("frontend", attribute(resource, "service.name")->string_value());
+    ASSERT_EQ("host-1", attribute(resource, "hostname")->string_value());
+
+    ASSERT_EQ(1, resourceSpans.scope_spans_size());
+    ASSERT_EQ(1, resourceSpans.scope_spans(0).spans_size());
+    const auto& otlpSpan = resourceSpans.scope_spans(0).spans(0);
+    ASSERT_EQ(bytes({ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 }),
+              otlpSpan.trace_id());
+    ASSERT_EQ(bytes({ 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18 }),
+              otlpSpan.span_id());
+    ASSERT_EQ(bytes({ 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28 }),
+              otlpSpan.parent_span_id());
+    ASSERT_EQ("GET /", otlpSpan.name());
+    ASSERT_EQ(otlp::Span::SPAN_KIND_SERVER, otlpSpan.kind());
+    ASSERT_EQ(otlp::Status::STATUS_CODE_ERROR, otlpSpan.status().code());
+    ASSERT_EQ(1u, otlpSpan.flags());
+    ASSERT_EQ(1500000000000000000u, otlpSpan.start_time_unix_nano());
+    ASSERT_EQ(1500000000000250000u, otlpSpan.end_time_unix_nano());
+
+    // span.kind and error are not repeated as attributes.
+    const auto& attributes = otlpSpan.attributes();
+    ASSERT_EQ(3, attributes.size());
+    ASSERT_EQ(-500, attribute(attributes, "http.status_code")->int_value());
+    ASSERT_EQ(0.25, attribute(attributes, "ratio")->double_value());
+    ASSERT_EQ(std::string("\0\1", 2),
+              attribute(attributes, "payload")->bytes_value());
+
+    ASSERT_EQ(1, otlpSpan.events_size());
+    const auto& event = otlpSpan.events(0);
+    ASSERT_EQ("retry", event.name());
+    ASSERT_EQ(1500000000000010000u, event.time_unix_nano());
+    ASSERT_EQ(1, event.attributes_size());
+    ASSERT_EQ("info", attribute(event.attributes(), "level")->string_value());
+
+    ASSERT_EQ(1, otlpSpan.links_size());
+    const auto& link = otlpSpan.links(0);
+    ASSERT_EQ(bytes({ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 }),
+              link.trace_id());
+    ASSERT_EQ(bytes({ 0, 0, 0, 0, 0, 0, 0, 2 }), link.span_id());
+    ASSERT_EQ("follows_from",
+              attribute(link.attributes(), "opentracing.ref_type")
+                  ->string_value());
+
+    jaeger_buffer_destroy(&buffer);
+    jaegertracing_protobuf_batch_destroy(&batch);
+}
+
+TEST(Otlp, testLargeBatch)
+{
+    // Enough spans and attributes for lengths longer than their guesses.
+    jaegertracing_protobuf_batch batch;
+    std::memset(&batch, 0, sizeof(batch));
+    assign(batch.process.service_name, std::string(200, 's'));
+    constexpr auto kSpans = 1000;
+    for (auto i = 0; i < kSpans; ++i) {
+        auto& span = appendNode<SpanNode>(batch.spans)->value;
+        span.span_id = i + 1;
+        span.parent_span_id = i;
+        assign(span.operation_name, std::string(i % 300, 'o'));
+        stringTag(*jaegertracing_protobuf_span_append_tags(&span),
+                  "span.kind",
+                  "unknown");
+        stringTag(*jaegertracing_protobuf_span_append_tags(&span),
+                  "error",
+                  "false");
+    }
+
+    jaeger_buffer buffer;
+    std::memset(&buffer, 0, sizeof(buffer));
+    ASSERT_TRUE(jaeger_otlp_encode_batch(&batch, &buffer));
+    // Requests appended to one buffer merge.
+    ASSERT_TRUE(jaeger_otlp_encode_batch(&batch, &buffer));
+    auto request = parse(buffer);
+
+    ASSERT_EQ(2, request.resource_spans_size());
+    for (auto&& resourceSpans : request.resource_spans()) {
+        ASSERT_EQ(std::string(200, 's'),
+                  attribute(resourceSpans.resource().attributes(),
+                            "service.name")
+                      ->string_value());
+        const auto& spans = resourceSpans.scope_spans(0).spans();
+        ASSERT_EQ(kSpans, spans.size());
+        for (auto i = 0; i < kSpans; ++i) {
+            const auto& span = spans.Get(i);
+            ASSERT_EQ(std::string(i % 300, 'o'), span.name());
+            ASSERT_EQ(i == 0, span.parent_span_id().empty());
+            ASSERT_EQ(0u, span.flags());
+            // Unknown kinds and false errors stay attributes.
+            ASSERT_EQ(otlp::Span::SPAN_KIND_UNSPECIFIED, span.kind());
+            ASSERT_FALSE(span.has_status());
+            ASSERT_EQ(2, span.attributes_size());
+        }
+    }
+
+    jaeger_buffer_destroy(&buffer);
+    jaegertracing_protobuf_batch_destroy(&batch);
+}
+
+}  // namespace examples
+}  // namespace jaeger_struct
@@ -0,0 +1,487 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otlp.h"
+
+#include <string.h>
+
+#include <jaeger-struct/runtime/codec.h>
+#include <jaeger-struct/runtime/varint.h>
+
+/* Field numbers of opentelemetry/proto/{collector/trace,trace,common}/v1. */
+enum {
+    REQUEST_RESOURCE_SPANS = 1,
+    RESOURCE_SPANS_RESOURCE = 1,
+    RESOURCE_SPANS_SCOPE_SPANS = 2,
+    RESOURCE_ATTRIBUTES = 1,
+    SCOPE_SPANS_SPANS = 2,
+    SPAN_TRACE_ID = 1,
+    SPAN_SPAN_ID = 2,
+    SPAN_PARENT_SPAN_ID = 4,
+    SPAN_NAME = 5,
+    SPAN_KIND = 6,
+    SPAN_START_TIME = 7,
+    SPAN_END_TIME = 8,
+    SPAN_ATTRIBUTES = 9,
+    SPAN_EVENTS = 11,
+    SPAN_LINKS = 13,
+    SPAN_STATUS = 15,
+    SPAN_FLAGS = 16,
+    EVENT_TIME = 1,
+    EVENT_NAME = 2,
+    EVENT_ATTRIBUTES = 3,
+    LINK_TRACE_ID = 1,
+    LINK_SPAN_ID = 2,
+    LINK_ATTRIBUTES = 4,
+    STATUS_CODE = 3,
+    KEY_VALUE_KEY = 1,
+    KEY_VALUE_VALUE = 2,
+    ANY_VALUE_STRING = 1,
+    ANY_VALUE_BOOL = 2,
+    ANY_VALUE_INT = 3,
+    ANY_VALUE_DOUBLE = 4,
+    ANY_VALUE_BYTES = 7
+};
+
+enum { STATUS_CODE_ERROR = 2 };
+
+/* W3C trace flags, of which Jaeger and OTLP share the sampled bit. */
+enum { TRACE_FLAG_SAMPLED = 1 };
+
+typedef JAEGER_LIST(jaegertracing_protobuf_tag) tag_node;
+typedef JAEGER_LIST(jaegertracing_protobuf_log) log_node;
+typedef JAEGER_LIST(jaegertracing_protobuf_span_ref) span_ref_node;
+typedef JAEGER_LIST(jaegertracing_protobuf_span) span_node;
+
+static bool put_tag(jaeger_buffer* out, uint32_t number, uint8_t wire_type)
+{
+    return jaeger_buffer_append_varint(out,
+                                       ((uint64_t) number << 3) | wire_type);
+}
+
+static bool put_varint(jaeger_buffer* out, uint32_t number, uint64_t value)
+{
+    return put_tag(out, number, JAEGER_WIRE_VARINT) &&
+           jaeger_buffer_append_varint(out, value);
+}
+
+static bool put_fixed(jaeger_buffer* out,
+                      uint32_t number,
+                      uint64_t value,
+                      size_t size)
+{
+    uint8_t bytes[8];
+    size_t i;
+    for (i = 0; i < size; ++i) {
+        bytes[i] = (uint8_t) (value >> (8 * i));
+    }
+    return put_tag(out,
+                   number,
+                   size == 4 ? JAEGER_WIRE_FIXED32 : JAEGER_WIRE_FIXED64) &&
+           jaeger_buffer_append(out, bytes, size);
+}
+
+static bool
+put_bytes(jaeger_buffer* out, uint32_t number, const void* data, size_t len)
+{
+    return put_tag(out, number, JAEGER_WIRE_LENGTH) &&
+           jaeger_buffer_append_varint(out, len) &&
+           jaeger_buffer_append(out, data, len);
+}
+
+static bool
+put_string(jaeger_buffer* out, uint32_t number, const jaeger_string* str)
+{
+    return put_bytes(out, number, str->buffer, str->len);
+}
+
+/* Writes IDs as OTLP does, big-endian, high bits first for trace IDs. */
+static bool put_id(jaeger_buffer* out,
+                   uint32_t number,
+                   const jaegertracing_protobuf_trace_id* trace_id,
+                   uint64_t span_id)
+{
+    uint8_t bytes[16];
+    size_t size = 0;
+    int shift;
+    if (trace_id != NULL) {
+        for (shift = 56; shift >= 0; shift -= 8) {
+            bytes[size++] = (uint8_t) (trace_id->high >> shift);
+        }
+        for (shift = 56; shift >= 0; shift -= 8) {
+            bytes[size++] = (uint8_t) (trace_id->low >> shift);
+        }
+    }
+    else {
+        for (shift = 56; shift >= 0; shift -= 8) {
+            bytes[size++] = (uint8_t) (span_id >> shift);
+        }
+    }
+    return put_bytes(out, number, bytes, size);
+}
+
+/*
+ * Starts a submessage, leaving len_size bytes for its length. The body is
+ * written in place and moved by end_message only if its length needs a
+ * different number of bytes, so guessing well avoids moving large bodies.
+ */
+static bool begin_message(jaeger_buffer* out,
+                          uint32_t number,
+                          size_t len_size,
+                          size_t* body)
+{
+    if (!put_tag(out, number, JAEGER_WIRE_LENGTH) ||
+        !jaeger_buffer_reserve(out, len_size)) {
+        return false;
+    }
+    out->size += len_size;
+    *body = out->size;
+    return true;
+}
+
+static bool end_message(jaeger_buffer* out, size_t body, size_t len_size)
+{
+    const size_t len = out->size - body;
+    const size_t actual_size = jaeger_varint_size(len);
+    if (actual_size > len_size &&
+        !jaeger_buffer_reserve(out, actual_size - len_size)) {
+        return false;
+    }
+    if (actual_size != len_size) {
+        memmove(out->data + body - len_size + actual_size,
+                out->data + body,
+                len);
+        out->size = out->size - len_size + actual_size;
+    }
+    jaeger_varint_write(out->data + body - len_size, len);
+    return true;
+}
+
+static bool
+equals(const jaeger_string* str, const char* literal, size_t literal_len)
+{
+    return str->len == literal_len &&
+           memcmp(str->buffer, literal, literal_len) == 0;
+}
+
+#define EQUALS(str, literal) equals((str), (literal), sizeof(literal) - 1)
+
+static bool put_any_value(jaeger_buffer* out,
+                          const jaegertracing_protobuf_tag_value* value)
+{
+    size_t body;
+    if (!begin_message(out, KEY_VALUE_VALUE, 1, &body)) {
+        return false;
+    }
+    switch (value->type) {
+    case jaegertracing_protobuf_tag_value_str_value_type:
+        if (!put_string(out, ANY_VALUE_STRING, &value->value.str_value)) {
+            return false;
+        }
+        break;
+    case jaegertracing_protobuf_tag_value_double_value_type: {
+        uint64_t bits;
+        memcpy(&bits, &value->value.double_value, sizeof(bits));
+        if (!put_fixed(out, ANY_VALUE_DOUBLE, bits, 8)) {
+            return false;
+        }
+        break;
+    }
+    case jaegertracing_protobuf_tag_value_bool_value_type:
+        if (!put_varint(out, ANY_VALUE_BOOL, value->value.bool_value)) {
+            return false;
+        }
+        break;
+    case jaegertracing_protobuf_tag_value_long_value_type:
+        if (!put_varint(
+                out, ANY_VALUE_INT, (uint64_t) value->value.long_value)) {
+            return false;
+        }
+        break;
+    case jaegertracing_protobuf_tag_value_binary_value_type:
+        if (!put_string(out, ANY_VALUE_BYTES, &value->value.binary_value)) {
+            return false;
+        }
+        break;
+    default:
+        break;
+    }
+    return end_message(out, body, 1);
+}
+
+static bool put_attribute(jaeger_buffer* out,
+                          uint32_t number,
+                          const jaegertracing_protobuf_tag* tag)
+{
+    size_t body;
+    return begin_message(out, number, 1, &body) &&
+           put_string(out, KEY_VALUE_KEY, &tag->key) &&
+           put_any_value(out, &tag->value) && end_message(out, body, 1);
+}
+
+static bool put_string_attribute(jaeger_buffer* out,
+                                 uint32_t number,
+                                 const char* key,
+                                 const jaeger_string* value)
+{
+    size_t body;
+    size_t value_body;
+    return begin_message(out, number, 1, &body) &&
+           put_bytes(out, KEY_VALUE_KEY, key, strlen(key)) &&
+           begin_message(out, KEY_VALUE_VALUE, 1, &value_body) &&
+           put_string(out, ANY_VALUE_STRING, value) &&
+           end_message(out, value_body, 1) && end_message(out, body, 1);
+}
+
+static bool put_attributes(jaeger_buffer* out,
+                           uint32_t number,
+                           const jaeger_list* tags)
+{
+    const jaeger_list* node;
+    JAEGER_LIST_FOR_EACH(tags, node)
+    {
+        if (!put_attribute(out, number, &((const tag_node*) node)->value)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Returns the OTLP SpanKind named by the value of a span.kind tag, or 0. */
+static uint64_t span_kind(const jaegertracing_protobuf_tag_value* value)
+{
+    const jaeger_string* kind = &value->value.str_value;
+    if (value->type != jaegertracing_protobuf_tag_value_str_value_type) {
+        return 0;
+    }
+    if (EQUALS(kind, "internal")) {
+        return 1;
+    }
+    if (EQUALS(kind, "server")) {
+        return 2;
+    }
+    if (EQUALS(kind, "client")) {
+        return 3;
+    }
+    if (EQUALS(kind, "producer")) {
+        return 4;
+    }
+    if (EQUALS(kind, "consumer")) {
+        return 5;
+    }
+    return 0;
+}
+
+static bool is_true(const jaegertracing_protobuf_tag_value* value)
+{
+    switch (value->type) {
+    case jaegertracing_protobuf_tag_value_bool_value_type:
+        return value->value.bool_value;
+    case jaegertracing_protobuf_tag_value_str_value_type:
+        return EQUALS(&value->value.str_value, "true");
+    default:
+        return false;
+    }
+}
+
+static bool put_event(jaeger_buffer* out, const jaegertracing_protobuf_log* log)
+{
+    const jaeger_list* node;
+    bool named = false;
+    size_t body;
+    if (!begin_message(out, SPAN_EVENTS, 1, &body) ||
+        !put_fixed(out, EVENT_TIME, (uint64_t) log->timestamp * 1000, 8)) {
+        return false;
+    }
+    JAEGER_LIST_FOR_EACH(&log->fields, node)
+    {
+        const jaegertracing_protobuf_tag* field =
+            &((const tag_node*) node)->value;
+        if (!named && EQUALS(&field->key, "event") &&
+            field->value.type ==
+                jaegertracing_protobuf_tag_value_str_value_type) {
+            named = true;
+            if (!put_string(out, EVENT_NAME, &field->value.value.str_value)) {
+                return false;
+            }
+        }
+        else if (!put_attribute(out, EVENT_ATTRIBUTES, field)) {
+            return false;
+        }
+    }
+    return end_message(out, body, 1);
+}
+
+static bool put_link(jaeger_buffer* out,
+                     const jaegertracing_protobuf_span_ref* reference)
+{
+    static const jaeger_string child_of = { 8, (char*) "child_of", 0 };
+    static const jaeger_string follows_from = { 12, (char*) "follows_from", 0 };
+    size_t body;
+    return begin_message(out, SPAN_LINKS, 1, &body) &&
+           put_id(out, LINK_TRACE_ID, &reference->trace_id, 0) &&
+           put_id(out, LINK_SPAN_ID, NULL, reference->span_id) &&
+           put_string_attribute(
+               out,
+               LINK_ATTRIBUTES,
+               "opentracing.ref_type",
+               reference->type ==
+                       jaegertracing_protobuf_span_ref_type_follows_from
+                   ? &follows_from
+                   : &child_of) &&
+           end_message(out, body, 1);
+}
+
+bool jaeger_otlp_encode_span(const jaegertracing_protobuf_span* span,
+                             jaeger_buffer* out)
+{
+    const size_t size = out->size;
+    const jaeger_list* references =
+        &jaegertracing_protobuf_span_get_references(span);
+    const jaegertracing_protobuf_span_ref* parent = NULL;
+    uint64_t parent_span_id = span->parent_span_id;
+    uint64_t kind = 0;
+    bool error = false;
+    const jaeger_list* node;
+
+    if (parent_span_id == 0) {
+        JAEGER_LIST_FOR_EACH(references, node)
+        {
+            const jaegertracing_protobuf_span_ref* reference =
+                &((const span_ref_node*) node)->value;
+            if (reference->type ==
+                    jaegertracing_protobuf_span_ref_type_child_of &&
+                reference->trace_id.high == span->trace_id.high &&
+                reference->trace_id.low == span->trace_id.low) {
+                parent = reference;
+                parent_span_id = reference->span_id;
+                break;
+            }
+        }
+    }
+
+    if (!put_id(out, SPAN_TRACE_ID, &span->trace_id, 0) ||
+        !put_id(out, SPAN_SPAN_ID, NULL, span->span_id) ||
+        (parent_span_id != 0 &&
+         !put_id(out, SPAN_PARENT_SPAN_ID, NULL, parent_span_id)) ||
+        !put_string(out, SPAN_NAME, &span->operation_name) ||
+        !put_fixed(
+            out, SPAN_START_TIME, (uint64_t) span->start_time * 1000, 8) ||
+        !put_fixed(out,
+                   SPAN_END_TIME,
+                   (uint64_t) (span->start_time + span->duration) * 1000,
+                   8)) {
+        goto fail;
+    }
+
+    JAEGER_LIST_FOR_EACH(&jaegertracing_protobuf_span_get_tags(span), node)
+    {
+        const jaegertracing_protobuf_tag* tag =
+            &((const tag_node*) node)->value;
+        if (EQUALS(&tag->key, "span.kind") && kind == 0 &&
+            (kind = span_kind(&tag->value)) != 0) {
+            continue;
+        }
+        if (EQUALS(&tag->key, "error") && is_true(&tag->value)) {
+            error = true;
+            continue;
+        }
+        if (!put_attribute(out, SPAN_ATTRIBUTES, tag)) {
+            goto fail;
+        }
+    }
+
+    JAEGER_LIST_FOR_EACH(&jaegertracing_protobuf_span_get_logs(span), node)
+    {
+        if (!put_event(out, &((const log_node*) node)->value)) {
+            goto fail;
+        }
+    }
+
+    JAEGER_LIST_FOR_EACH(references, node)
+    {
+        const jaegertracing_protobuf_span_ref* reference =
+            &((const span_ref_node*) node)->value;
+        if (reference != parent && !put_link(out, reference)) {
+            goto fail;
+        }
+    }
+
+    if (kind != 0 && !put_varint(out, SPAN_KIND, kind)) {
+        goto fail;
+    }
+    if (error) {
+        size_t body;
+        if (!begin_message(out, SPAN_STATUS, 1, &body) ||
+            !put_varint(out, STATUS_CODE, STATUS_CODE_ERROR) ||
+            !end_message(out, body, 1)) {
+            goto fail;
+        }
+    }
+    if ((span->flags & TRACE_FLAG_SAMPLED) != 0 &&
+        !put_fixed(out, SPAN_FLAGS, TRACE_FLAG_SAMPLED, 4)) {
+        goto fail;
+    }
+    return true;
+
+fail:
+    out->size = size;
+    return false;
+}
+
+bool jaeger_otlp_encode_batch(const jaegertracing_protobuf_batch* batch,
+                              jaeger_buffer* out)
+{
+    const size_t size = out->size;
+    const jaeger_list* node;
+    size_t resource_spans;
+    size_t resource;
+    size_t scope_spans;
+    if (!begin_message(out, REQUEST_RESOURCE_SPANS, 3, &resource_spans) ||
+        !begin_message(out, RESOURCE_SPANS_RESOURCE, 2, &resource)) {
+        goto fail;
+    }
+    if (batch->process.service_name.len != 0 &&
+        !put_string_attribute(out,
+                              RESOURCE_ATTRIBUTES,
+                              "service.name",
+                              &batch->process.service_name)) {
+        goto fail;
+    }
+    if (!put_attributes(out, RESOURCE_ATTRIBUTES, &batch->process.tags) ||
+        !end_message(out, resource, 2) ||
+        !begin_message(out, RESOURCE_SPANS_SCOPE_SPANS, 3, &scope_spans)) {
+        goto fail;
+    }
+    JAEGER_LIST_FOR_EACH(&batch->spans, node)
+    {
+        size_t span;
+        if (!begin_message(out, SCOPE_SPANS_SPANS, 2, &span) ||
+            !jaeger_otlp_encode_span(&((const span_node*) node)->value, out) ||
+            !end_message(out, span, 2)) {
+            goto fail;
+        }
+    }
+    if (!end_message(out, scope_spans, 3) ||
+        !end_message(out, resource_spans, 3)) {
+        goto fail;
+    }
+    return true;
+
+fail:
+    out->size = size;
+    return false;
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_EXAMPLES_OTLP_H
+#define JAEGER_STRUCT_EXAMPLES_OTLP_H
+
+#include <jaeger-struct/runtime/buffer.h>
+
+#include "jaeger.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Transcodes Jaeger spans to the OpenTelemetry protocol (OTLP) wire format
+ * in one pass over the structs, without building OTLP messages first. The
+ * mapping follows the OpenTelemetry Jaeger translator:
+ *
+ * - The process becomes the resource, its service name the service.name
+ *   attribute.
+ * - Tags become attributes, their oneof an AnyValue, except span.kind and
+ *   error, which set the span's kind and status.
+ * - Logs become events, named by their event field.
+ * - The parent is parent_span_id or else the first CHILD_OF reference in
+ *   the same trace. Other references become links with an
+ *   opentracing.ref_type attribute.
+ */
+
+/*
+ * Appends an ExportTraceServiceRequest holding the batch's spans as one
+ * ResourceSpans. Requests appended to the same buffer form one request
+ * holding every batch.
+ */
+bool jaeger_otlp_encode_batch(const jaegertracing_protobuf_batch* batch,
+                              jaeger_buffer* out);
+
+/* Appends the fields of an OTLP Span, without a tag or length. */
+bool jaeger_otlp_encode_span(const jaegertracing_protobuf_span* span,
+                             jaeger_buffer* out);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* JAEGER_STRUCT_EXAMPLES_OTLP_H */
@@ -0,0 +1,703 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/compiler/Bindings.h>
+
+#include <algorithm>
+#include <map>
+
+#include <google/protobuf/io/printer.h>
+
+#include <jaeger-struct/compiler/ComplexType.h>
+#include <jaeger-struct/compiler/Enum.h>
+#include <jaeger-struct/compiler/Layout.h>
+#include <jaeger-struct/compiler/Strings.h>
+#include <jaeger-struct/compiler/Union.h>
+
+namespace jaeger_struct {
+namespace compiler {
+namespace {
+
+std::string pythonType(const Type& type)
+{
+    static const std::map<std::string, std::string> fundamentalTypes = {
+        { "bool", "ctypes.c_bool" },
+        { "float", "ctypes.c_float" },
+        { "double", "ctypes.c_double" },
+        { "int32_t", "ctypes.c_int32" },
+        { "int64_t", "ctypes.c_int64" },
+        { "uint32_t", "ctypes.c_uint32" },
+        { "uint64_t", "ctypes.c_uint64" },
+        { "jaeger_string", "JaegerString" }
+    };
+    if (dynamic_cast<const Enum*>(&type)) {
+        return "ctypes.c_int32";
+    }
+    if (dynamic_cast<const ComplexType*>(&type)) {
+        return pascalCase(type.name());
+    }
+    return fundamentalTypes.at(type.name());
+}
+
+std::string pythonType(const Field& field)
+{
+    if (field.indirect()) {
+        return "ctypes.POINTER(" + pythonType(*field.type()) + ")";
+    }
+    return field.repeated() ? "JaegerList" : pythonType(*field.type());
+}
+
+std::string goType(const Type& type)
+{
+    static const std::map<std::string, std::string> fundamentalTypes = {
+        { "bool", "bool" },
+        { "float", "float32" },
+        { "double", "float64" },
+        { "int32_t", "int32" },
+        { "int64_t", "int64" },
+        { "uint32_t", "uint32" },
+        { "uint64_t", "uint64" },
+        { "jaeger_string", "JaegerString" }
+    };
+    if (dynamic_cast<const Enum*>(&type) ||
+        dynamic_cast<const ComplexType*>(&type)) {
+        return pascalCase(type.name());
+    }
+    return fundamentalTypes.at(type.name());
+}
+
+std::string goType(const Field& field)
+{
+    if (field.indirect()) {
+        return "*" + goType(*field.type());
+    }
+    return field.repeated() ? "JaegerList" : goType(*field.type());
+}
+
+std::string padTo(const std::string& str, std::size_t width)
+{
+    return str + std::string(width - str.size() + 1, ' ');
+}
+
+// A member of a mirrored struct, or padding if name is empty.
+struct Member {
+    std::string _name;
+    std::string _type;
+    std::size_t _size;
+};
+
+// Returns the members of type with explicit padding before them and at the
+// end, for bindings that do not align members like C does.
+std::vector<Member> membersOf(const ComplexType& type,
+                              const std::vector<Member>& fields)
+{
+    const auto offsets = Layout::offsets(type);
+    std::vector<Member> members;
+    std::size_t offset = 0;
+    for (auto i = 0u; i < fields.size(); ++i) {
+        if (offsets[i] > offset) {
+            members.push_back(Member{ "", "", offsets[i] - offset });
+        }
+        members.push_back(fields[i]);
+        offset = offsets[i] + fields[i]._size;
+    }
+    const auto size = Layout::of(type).size();
+    if (size > offset) {
+        members.push_back(Member{ "", "", size - offset });
+    }
+    return members;
+}
+
+void writePythonPrelude(google::protobuf::io::Printer& printer)
+{
+    printer.Print(
+        "class JaegerString(ctypes.Structure):\n"
+        "    \"\"\"Mirrors jaeger_string.\"\"\"\n\n"
+        "    _fields_ = [\n"
+        "        (\"len\", ctypes.c_size_t),\n"
+        "        (\"buffer\", ctypes.c_void_p),\n"
+        "        (\"capacity\", ctypes.c_size_t),\n"
+        "    ]\n\n"
+        "    def view(self):\n"
+        "        \"\"\"Returns the bytes in C memory without copying them."
+        "\"\"\"\n"
+        "        if self.len == 0:\n"
+        "            return memoryview(b\"\")\n"
+        "        array_type = ctypes.c_ubyte * self.len\n"
+        "        array = array_type.from_address(self.buffer)\n"
+        "        return memoryview(array).cast(\"B\")\n\n"
+        "    def __bytes__(self):\n"
+        "        return self.view().tobytes()\n\n"
+        "    def __str__(self):\n"
+        "        return bytes(self).decode(\"utf-8\")\n\n\n"
+        "class JaegerList(ctypes.Structure):\n"
+        "    \"\"\"Mirrors jaeger_list.\"\"\"\n\n"
+        "    _fields_ = [\n"
+        "        (\"next\", ctypes.c_void_p),\n"
+        "        (\"prev\", ctypes.c_void_p),\n"
+        "    ]\n\n"
+        "    def values(self, value_type, value_offset):\n"
+        "        \"\"\"Yields the values of the nodes in place.\"\"\"\n"
+        "        node = self.next\n"
+        "        while node:\n"
+        "            yield value_type.from_address(node + value_offset)\n"
+        "            node = ctypes.c_void_p.from_address(node).value\n\n\n"
+        "def _check_layout(cls, size, offsets):\n"
+        "    if ctypes.sizeof(cls) != size or any(\n"
+        "        getattr(cls, name).offset != offset\n"
+        "        for name, offset in offsets.items()\n"
+        "    ):\n"
+        "        raise ImportError(\"Layout of %s differs from C\" % "
+        "cls.__name__)\n");
+}
+
+void writePythonFields(google::protobuf::io::Printer& printer,
+                       const std::vector<Member>& members)
+{
+    printer.Print("    _fields_ = [\n");
+    auto padding = 0;
+    for (auto&& member : members) {
+        if (member._name.empty()) {
+            printer.Print(
+                "        (\"_pad$index$\", ctypes.c_ubyte * $size$),\n",
+                "index",
+                std::to_string(padding++),
+                "size",
+                std::to_string(member._size));
+        }
+        else {
+            printer.Print("        (\"$name$\", $type$),\n",
+                          "name",
+                          member._name,
+                          "type",
+                          member._type);
+        }
+    }
+    printer.Print("    ]\n");
+}
+
+// Writes iterators over the repeated fields behind the indirect field, empty
+// if the pointer is NULL.
+void writePythonColdIterators(google::protobuf::io::Printer& printer,
+                              const Field& field)
+{
+    auto&& coldType = dynamic_cast<const ComplexType&>(*field.type());
+    for (auto&& coldField : coldType.fields()) {
+        if (!coldField.repeated()) {
+            continue;
+        }
+        printer.Print("\n"
+                      "    def iter_$name$(self):\n"
+                      "        if not self.$pointer$:\n"
+                      "            return iter(())\n"
+                      "        return self.$pointer$.contents.iter_$name$()\n",
+                      "name",
+                      coldField.name(),
+                      "pointer",
+                      field.name());
+    }
+}
+
+void writePythonType(google::protobuf::io::Printer& printer,
+                     const ComplexType& type)
+{
+    const auto className = pascalCase(type.name());
+    std::vector<Member> fields;
+    if (auto u = dynamic_cast<const Union*>(&type)) {
+        // Sized to the C union by a byte array member, as the packed
+        // structures of its members are not aligned like in C.
+        const auto size =
+            Layout::of(type).size() - Layout::offsets(type).front();
+        printer.Print("\n\nclass _$class$Value(ctypes.Union):\n"
+                      "    _pack_ = 1\n"
+                      "    _fields_ = [\n",
+                      "class",
+                      className);
+        for (auto&& field : u->fields()) {
+            printer.Print("        (\"$name$\", $type$),\n",
+                          "name",
+                          field.name(),
+                          "type",
+                          pythonType(field));
+        }
+        printer.Print("        (\"_bytes\", ctypes.c_ubyte * $size$),\n"
+                      "    ]\n",
+                      "size",
+                      std::to_string(size));
+        fields.push_back(Member{ "type", "ctypes.c_uint8", 1 });
+        fields.push_back(Member{ "value", "_" + className + "Value", size });
+    }
+    else {
+        for (auto&& field : type.fields()) {
+            fields.push_back(Member{
+                field.name(), pythonType(field), Layout::of(field).size() });
+        }
+    }
+
+    printer.Print("\n\nclass $class$(ctypes.Structure):\n"
+                  "    \"\"\"Mirrors $name$.\"\"\"\n\n"
+                  "    _pack_ = 1\n",
+                  "class",
+                  className,
+                  "name",
+                  type.name());
+    if (dynamic_cast<const Union*>(&type)) {
+        // Padding between the type tag and the value rather than for each
+        // member.
+        const auto offset = Layout::offsets(type).front();
+        std::vector<Member> members{ fields[0] };
+        if (offset > 1) {
+            members.push_back(Member{ "", "", offset - 1 });
+        }
+        members.push_back(fields[1]);
+        writePythonFields(printer, members);
+        printer.Print("\n");
+        auto index = 0;
+        for (auto&& field : type.fields()) {
+            printer.Print("    $name$_TYPE = $index$\n",
+                          "name",
+                          capsCase(field.name()),
+                          "index",
+                          std::to_string(index++));
+        }
+        return;
+    }
+    writePythonFields(printer, membersOf(type, fields));
+    for (auto&& field : type.fields()) {
+        if (field.indirect()) {
+            writePythonColdIterators(printer, field);
+            continue;
+        }
+        if (!field.repeated()) {
+            continue;
+        }
+        printer.Print("\n"
+                      "    def iter_$name$(self):\n"
+                      "        return self.$name$.values($type$, $offset$)\n",
+                      "name",
+                      field.name(),
+                      "type",
+                      pythonType(*field.type()),
+                      "offset",
+                      std::to_string(Layout::nodeValueOffset(field)));
+    }
+}
+
+void writePythonCheck(google::protobuf::io::Printer& printer,
+                      const ComplexType& type)
+{
+    printer.Print("_check_layout($class$, $size$, {\n",
+                  "class",
+                  pascalCase(type.name()),
+                  "size",
+                  std::to_string(Layout::of(type).size()));
+    if (dynamic_cast<const Union*>(&type)) {
+        printer.Print("    \"type\": 0,\n"
+                      "    \"value\": $offset$,\n",
+                      "offset",
+                      std::to_string(Layout::offsets(type).front()));
+    }
+    else {
+        const auto offsets = Layout::offsets(type);
+        for (auto i = 0u; i < offsets.size(); ++i) {
+            printer.Print("    \"$name$\": $offset$,\n",
+                          "name",
+                          type.fields()[i].name(),
+                          "offset",
+                          std::to_string(offsets[i]));
+        }
+    }
+    printer.Print("})\n");
+}
+
+void writeGoPrelude(google::protobuf::io::Printer& printer)
+{
+    printer.Print(
+        "// JaegerString mirrors jaeger_string.\n"
+        "type JaegerString struct {\n"
+        "\tLen      uintptr\n"
+        "\tBuffer   unsafe.Pointer\n"
+        "\tCapacity uintptr\n"
+        "}\n\n"
+        "// Bytes returns the bytes of s in C memory without copying them.\n"
+        "func (s *JaegerString) Bytes() []byte {\n"
+        "\tif s.Len == 0 {\n"
+        "\t\treturn nil\n"
+        "\t}\n"
+        "\treturn unsafe.Slice((*byte)(s.Buffer), s.Len)\n"
+        "}\n\n"
+        "// String returns a copy of s.\n"
+        "func (s *JaegerString) String() string {\n"
+        "\treturn string(s.Bytes())\n"
+        "}\n\n"
+        "// JaegerList mirrors jaeger_list.\n"
+        "type JaegerList struct {\n"
+        "\tNext unsafe.Pointer\n"
+        "\tPrev unsafe.Pointer\n"
+        "}\n\n"
+        "// each calls f with the value at valueOffset in each node of l until "
+        "f\n"
+        "// returns false.\n"
+        "func (l *JaegerList) each(valueOffset uintptr, "
+        "f func(unsafe.Pointer) bool) {\n"
+        "\tfor node := l.Next; node != nil; node = (*JaegerList)(node).Next "
+        "{\n"
+        "\t\tif !f(unsafe.Add(node, valueOffset)) {\n"
+        "\t\t\treturn\n"
+        "\t\t}\n"
+        "\t}\n"
+        "}\n");
+}
+
+void writeGoEnum(google::protobuf::io::Printer& printer, const Enum& e)
+{
+    const auto typeName = pascalCase(e.name());
+    printer.Print("\n// $type$ mirrors $name$.\n"
+                  "type $type$ int32\n\n"
+                  "const (\n",
+                  "type",
+                  typeName,
+                  "name",
+                  e.name());
+    std::size_t width = 0;
+    for (auto&& value : e.values()) {
+        width = std::max(width, pascalCase(value.name()).size());
+    }
+    for (auto&& value : e.values()) {
+        printer.Print("\t$name$$type$ = $value$\n",
+                      "name",
+                      padTo(pascalCase(value.name()), width),
+                      "type",
+                      typeName,
+                      "value",
+                      std::to_string(value.value()));
+    }
+    printer.Print(")\n");
+}
+
+void writeGoFields(google::protobuf::io::Printer& printer,
+                   const std::vector<Member>& members)
+{
+    std::size_t width = 1;
+    for (auto&& member : members) {
+        width = std::max(width, member._name.size());
+    }
+    for (auto&& member : members) {
+        if (member._name.empty()) {
+            printer.Print("\t$name$[$size$]byte\n",
+                          "name",
+                          padTo("_", width),
+                          "size",
+                          std::to_string(member._size));
+        }
+        else {
+            printer.Print("\t$name$$type$\n",
+                          "name",
+                          padTo(member._name, width),
+                          "type",
+                          member._type);
+        }
+    }
+}
+
+void writeGoUnion(google::protobuf::io::Printer& printer, const Union& type)
+{
+    const auto typeName = pascalCase(type.name());
+    const auto layout = Layout::of(type);
+    const auto offset = Layout::offsets(type).front();
+    printer.Print("\n// $type$ mirrors $name$.\n"
+                  "// Access the member selected by Type through its method.\n"
+                  "type $type$ struct {\n",
+                  "type",
+                  typeName,
+                  "name",
+                  type.name());
+    std::vector<Member> fields{ Member{ "Type", "uint8", 1 } };
+    if (offset > 1) {
+        fields.push_back(Member{ "", "", offset - 1 });
+    }
+    fields.push_back(Member{ "value",
+                             "[" + std::to_string(layout.size() - offset) +
+                                 "]byte",
+                             layout.size() - offset });
+    if (layout.alignment() > 1) {
+        // Aligns the struct like the C union, as value is only bytes.
+        const std::string alignType =
+            "[0]uint" + std::to_string(layout.alignment() * 8);
+        fields.insert(std::begin(fields), Member{ "_", alignType, 0 });
+    }
+    writeGoFields(printer, fields);
+    printer.Print("}\n\nconst (\n");
+    std::vector<std::string> tags;
+    std::size_t width = 0;
+    for (auto&& field : type.fields()) {
+        tags.push_back(pascalCase(type.name() + "_" + field.name() + "_type"));
+        width = std::max(width, tags.back().size());
+    }
+    for (auto i = 0u; i < tags.size(); ++i) {
+        printer.Print("\t$name$= $index$\n",
+                      "name",
+                      padTo(tags[i], width),
+                      "index",
+                      std::to_string(i));
+    }
+    printer.Print(")\n");
+    for (auto&& field : type.fields()) {
+        std::map<std::string, std::string> vars;
+        vars["type"] = typeName;
+        vars["method"] = pascalCase(field.name());
+        vars["name"] = field.name();
+        vars["member"] = goType(field);
+        vars["tag"] = pascalCase(type.name() + "_" + field.name() + "_type");
+        printer.Print(vars,
+                      "\n// $method$ returns the $name$ member, valid if Type "
+                      "is\n// $tag$.\n"
+                      "func (u *$type$) $method$() *$member$ {\n"
+                      "\treturn (*$member$)(unsafe.Pointer(&u.value))\n"
+                      "}\n");
+    }
+}
+
+// Writes iterators over the repeated fields behind the indirect field, which
+// call nothing if the pointer is nil.
+void writeGoColdIterators(google::protobuf::io::Printer& printer,
+                          const std::string& typeName,
+                          const Field& field)
+{
+    auto&& coldType = dynamic_cast<const ComplexType&>(*field.type());
+    for (auto&& coldField : coldType.fields()) {
+        if (!coldField.repeated()) {
+            continue;
+        }
+        std::map<std::string, std::string> vars;
+        vars["type"] = typeName;
+        vars["field"] = pascalCase(coldField.name());
+        vars["element"] = goType(*coldField.type());
+        vars["pointer"] = pascalCase(field.name());
+        printer.Print(
+            vars,
+            "\n// Each$field$ calls f with each element of $field$ until f "
+            "returns false.\n"
+            "func (m *$type$) Each$field$(f func(*$element$) bool) {\n"
+            "\tif m.$pointer$ != nil {\n"
+            "\t\tm.$pointer$.Each$field$(f)\n"
+            "\t}\n"
+            "}\n");
+    }
+}
+
+void writeGoStruct(google::protobuf::io::Printer& printer,
+                   const ComplexType& type)
+{
+    const auto typeName = pascalCase(type.name());
+    std::vector<Member> fields;
+    for (auto&& field : type.fields()) {
+        fields.push_back(Member{ pascalCase(field.name()),
+                                 goType(field),
+                                 Layout::of(field).size() });
+    }
+    printer.Print("\n// $type$ mirrors $name$.\n"
+                  "type $type$ struct {\n",
+                  "type",
+                  typeName,
+                  "name",
+                  type.name());
+    writeGoFields(printer, membersOf(type, fields));
+    printer.Print("}\n");
+    for (auto&& field : type.fields()) {
+        if (field.indirect()) {
+            writeGoColdIterators(printer, typeName, field);
+            continue;
+        }
+        if (!field.repeated()) {
+            continue;
+        }
+        std::map<std::string, std::string> vars;
+        vars["type"] = typeName;
+        vars["field"] = pascalCase(field.name());
+        vars["element"] = goType(*field.type());
+        vars["offset"] = std::to_string(Layout::nodeValueOffset(field));
+        printer.Print(
+            vars,
+            "\n// Each$field$ calls f with each element of $field$ until f "
+            "returns false.\n"
+            "func (m *$type$) Each$field$(f func(*$element$) bool) {\n"
+            "\tm.$field$.each($offset$, func(value unsafe.Pointer) bool {\n"
+            "\t\treturn f((*$element$)(value))\n"
+            "\t})\n"
+            "}\n");
+    }
+}
+
+}  // anonymous namespace
+
+void Bindings::writeLayoutAssertions(
+    google::protobuf::io::Printer& printer) const
+{
+    printer.Print("\n/* Layout mirrored by the bindings for other languages. "
+                  "*/\n"
+                  "#if SIZE_MAX == UINT64_MAX\n");
+    for (auto&& type : _types) {
+        printer.Print("_Static_assert(sizeof($name$) == $size$, \"$name$\");\n",
+                      "name",
+                      type->name(),
+                      "size",
+                      std::to_string(Layout::of(*type).size()));
+        const auto offsets = Layout::offsets(*type);
+        const auto isUnion = dynamic_cast<const Union*>(type.get()) != nullptr;
+        for (auto i = 0u; i < offsets.size(); ++i) {
+            auto&& field = type->fields()[i];
+            printer.Print("_Static_assert(offsetof($name$, $member$) == "
+                          "$offset$,\n"
+                          "               \"$name$.$field$\");\n",
+                          "name",
+                          type->name(),
+                          "member",
+                          (isUnion ? "value." : "") + field.name(),
+                          "field",
+                          field.name(),
+                          "offset",
+                          std::to_string(offsets[i]));
+        }
+    }
+    printer.Print("#endif /* SIZE_MAX == UINT64_MAX */\n");
+}
+
+void Bindings::writePython(google::protobuf::io::Printer& printer) const
+{
+    printer.Print(
+        "# Generated by protoc-gen-jaeger_struct from $file$. DO NOT EDIT.\n"
+        "\"\"\"ctypes mirrors of the structs generated from $file$.\n\n"
+        "Structures have the layout of the C structs on 64-bit platforms, "
+        "checked on\nimport, so that C structs in shared memory can be read "
+        "in place with\nfrom_address. Strings and lists point into C memory, "
+        "which must outlive\nanything read from it.\n"
+        "\"\"\"\n\n"
+        "import ctypes\n\n\n",
+        "file",
+        _protoFileName);
+    writePythonPrelude(printer);
+    for (auto&& e : _enums) {
+        printer.Print("\n\n");
+        for (auto&& value : e->values()) {
+            printer.Print("$name$ = $value$\n",
+                          "name",
+                          capsCase(value.name()),
+                          "value",
+                          std::to_string(value.value()));
+        }
+    }
+    for (auto&& type : _types) {
+        writePythonType(printer, *type);
+    }
+    printer.Print("\n\n");
+    for (auto&& type : _types) {
+        writePythonCheck(printer, *type);
+    }
+}
+
+void Bindings::writeGo(google::protobuf::io::Printer& printer,
+                       const std::string& package) const
+{
+    printer.Print(
+        "// Code generated by protoc-gen-jaeger_struct from $file$. DO NOT "
+        "EDIT.\n\n"
+        "// Package $package$ mirrors the structs generated from $file$ "
+        "with the\n"
+        "// same layout on 64-bit platforms, so that C structs in shared "
+        "memory can be\n"
+        "// read in place through unsafe pointers without cgo. Strings and "
+        "lists point\n"
+        "// into C memory, which must outlive anything read from it.\n"
+        "package $package$\n\n"
+        "import \"unsafe\"\n\n",
+        "file",
+        _protoFileName,
+        "package",
+        package);
+    writeGoPrelude(printer);
+    for (auto&& e : _enums) {
+        writeGoEnum(printer, *e);
+    }
+    for (auto&& type : _types) {
+        if (auto u = std::dynamic_pointer_cast<const Union>(type)) {
+            writeGoUnion(printer, *u);
+        }
+        else {
+            writeGoStruct(printer, *type);
+        }
+    }
+}
+
+void Bindings::writeGoTest(google::protobuf::io::Printer& printer,
+                           const std::string& package) const
+{
+    printer.Print(
+        "// Code generated by protoc-gen-jaeger_struct from $file$. DO NOT "
+        "EDIT.\n\n"
+        "package $package$\n\n"
+        "import (\n"
+        "\t\"testing\"\n"
+        "\t\"unsafe\"\n"
+        ")\n\n"
+        "func checkLayout(t *testing.T, name string, got, want uintptr) {\n"
+        "\tt.Helper()\n"
+        "\tif got != want {\n"
+        "\t\tt.Errorf(\"%s: got %d, want %d\", name, got, want)\n"
+        "\t}\n"
+        "}\n",
+        "file",
+        _protoFileName,
+        "package",
+        package);
+    for (auto&& type : _types) {
+        const auto typeName = pascalCase(type->name());
+        printer.Print("\nfunc Test$type$Layout(t *testing.T) {\n"
+                      "\tvar v $type$\n"
+                      "\tcheckLayout(t, \"sizeof($name$)\", "
+                      "unsafe.Sizeof(v), $size$)\n",
+                      "type",
+                      typeName,
+                      "name",
+                      type->name(),
+                      "size",
+                      std::to_string(Layout::of(*type).size()));
+        if (dynamic_cast<const Union*>(type.get())) {
+            printer.Print("\tcheckLayout(t, \"value\", "
+                          "unsafe.Offsetof(v.value), $offset$)\n",
+                          "offset",
+                          std::to_string(Layout::offsets(*type).front()));
+        }
+        else {
+            const auto offsets = Layout::offsets(*type);
+            for (auto i = 0u; i < offsets.size(); ++i) {
+                auto&& field = type->fields()[i];
+                printer.Print("\tcheckLayout(t, \"$name$\", "
+                              "unsafe.Offsetof(v.$member$), $offset$)\n",
+                              "name",
+                              field.name(),
+                              "member",
+                              pascalCase(field.name()),
+                              "offset",
+                              std::to_string(offsets[i]));
+            }
+        }
+        printer.Print("}\n");
+    }
+}
+
+}  // namespace compiler
+}  // namespace jaeger_struct
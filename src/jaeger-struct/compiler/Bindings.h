@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_COMPILER_BINDINGS_H
+#define JAEGER_STRUCT_COMPILER_BINDINGS_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace protobuf {
+namespace io {
+
+class Printer;
+
+}  // namespace io
+}  // namespace protobuf
+}  // namespace google
+
+namespace jaeger_struct {
+namespace compiler {
+
+class ComplexType;
+class Enum;
+
+// Bindings reading the generated C structs in place from other languages.
+// They mirror the offsets and sizes computed by Layout, which the generated
+// C file checks against the compiler with writeLayoutAssertions.
+class Bindings {
+  public:
+    Bindings(const std::string& protoFileName,
+             const std::vector<std::shared_ptr<const Enum>>& enums,
+             const std::vector<std::shared_ptr<const ComplexType>>& types)
+        : _protoFileName(protoFileName)
+        , _enums(enums)
+        , _types(types)
+    {
+    }
+
+    // Writes static assertions of the layout of every struct for the C file.
+    void writeLayoutAssertions(google::protobuf::io::Printer& printer) const;
+
+    // Writes a Python module of ctypes structures.
+    void writePython(google::protobuf::io::Printer& printer) const;
+
+    // Writes a Go file of structs declared with the same layout, using
+    // unsafe instead of cgo.
+    void writeGo(google::protobuf::io::Printer& printer,
+                 const std::string& package) const;
+
+    // Writes a Go test checking the layout of the Go structs.
+    void writeGoTest(google::protobuf::io::Printer& printer,
+                     const std::string& package) const;
+
+  private:
+    std::string _protoFileName;
+    std::vector<std::shared_ptr<const Enum>> _enums;
+    std::vector<std::shared_ptr<const ComplexType>> _types;
+};
+
+}  // namespace compiler
+}  // namespace jaeger_struct
+
+#endif  // JAEGER_STRUCT_COMPILER_BINDINGS_H
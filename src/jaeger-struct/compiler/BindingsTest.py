@@ -0,0 +1,152 @@
+# Copyright (c) 2018 Uber Technologies, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Reads structs decoded by the C codec in place through the Python bindings.
+
+Usage: BindingsTest.py <example module> <directory of jaeger.py>
+"""
+
+import ctypes
+import struct
+import sys
+import unittest
+
+
+def varint(value):
+    result = bytearray()
+    while value >= 0x80:
+        result.append(value & 0x7F | 0x80)
+        value >>= 7
+    result.append(value)
+    return bytes(result)
+
+
+def uint(number, value):
+    return varint(number << 3) + varint(value)
+
+
+def double(number, value):
+    return varint(number << 3 | 1) + struct.pack("<d", value)
+
+
+def message(number, *fields):
+    body = b"".join(fields)
+    return varint(number << 3 | 2) + varint(len(body)) + body
+
+
+def string(number, value):
+    return message(number, value.encode("utf-8"))
+
+
+PAYLOAD = "x" * 5000
+
+
+def make_batch():
+    spans = []
+    for i in range(3):
+        spans.append(
+            message(
+                2,
+                message(1, uint(1, 7), uint(2, 100 + i)),
+                uint(2, i + 1),
+                string(4, "span%d" % i),
+                message(5, uint(1, 1), message(2, uint(2, 99)), uint(3, 42)),
+                uint(8, 1000 * i),
+                message(9, string(1, "ratio"), double(3, i / 2)),
+                message(
+                    10,
+                    uint(1, 5),
+                    message(2, string(1, "event"), string(2, PAYLOAD)),
+                ),
+            )
+        )
+    process = message(
+        1,
+        string(1, "frontend"),
+        message(2, string(1, "host"), string(2, "a")),
+    )
+    return process + b"".join(spans)
+
+
+class BindingsTest(unittest.TestCase):
+    def setUp(self):
+        self.batch = jaeger.JaegertracingProtobufBatch()
+        data = make_batch()
+        self.assertTrue(
+            library.jaegertracing_protobuf_batch_decode(
+                ctypes.byref(self.batch), data, len(data)
+            )
+        )
+
+    def tearDown(self):
+        library.jaegertracing_protobuf_batch_destroy(ctypes.byref(self.batch))
+
+    def test_process(self):
+        process = self.batch.process
+        self.assertEqual("frontend", str(process.service_name))
+        (tag,) = process.iter_tags()
+        self.assertEqual("host", str(tag.key))
+        self.assertEqual(
+            jaeger.JaegertracingProtobufTagValue.STR_VALUE_TYPE, tag.value.type
+        )
+        self.assertEqual("a", str(tag.value.value.str_value))
+
+    def test_spans(self):
+        spans = list(self.batch.iter_spans())
+        self.assertEqual([1, 2, 3], [span.span_id for span in spans])
+        for i, span in enumerate(spans):
+            self.assertEqual("span%d" % i, str(span.operation_name))
+            self.assertEqual(7, span.trace_id.high)
+            self.assertEqual(100 + i, span.trace_id.low)
+            self.assertEqual(1000 * i, span.duration)
+            (reference,) = span.iter_references()
+            self.assertEqual(
+                jaeger.JAEGERTRACING_PROTOBUF_SPAN_REF_TYPE_FOLLOWS_FROM,
+                reference.type,
+            )
+            self.assertEqual(99, reference.trace_id.low)
+            self.assertEqual(42, reference.span_id)
+            (tag,) = span.iter_tags()
+            self.assertEqual(
+                jaeger.JaegertracingProtobufTagValue.DOUBLE_VALUE_TYPE,
+                tag.value.type,
+            )
+            self.assertEqual(i / 2, tag.value.value.double_value)
+
+    def test_zero_copy(self):
+        span = next(self.batch.iter_spans())
+        (log,) = span.iter_logs()
+        self.assertEqual(5, log.timestamp)
+        (field,) = log.iter_fields()
+        payload = field.value.value.str_value
+        view = payload.view()
+        self.assertEqual(PAYLOAD.encode("utf-8"), view.tobytes())
+        self.assertEqual(
+            payload.buffer, ctypes.addressof(ctypes.c_char.from_buffer(view))
+        )
+
+
+if __name__ == "__main__":
+    library = ctypes.CDLL(sys.argv[1])
+    library.jaegertracing_protobuf_batch_decode.argtypes = [
+        ctypes.c_void_p,
+        ctypes.c_char_p,
+        ctypes.c_size_t,
+    ]
+    library.jaegertracing_protobuf_batch_decode.restype = ctypes.c_bool
+    library.jaegertracing_protobuf_batch_destroy.argtypes = [ctypes.c_void_p]
+    sys.path.insert(0, sys.argv[2])
+    import jaeger
+
+    unittest.main(argv=sys.argv[:1])
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+#include <jaeger-struct/runtime/stats.h>
+#include <jaeger.h>
+
+namespace jaeger_struct {
+namespace compiler {
+namespace {
+
+typedef JAEGER_LIST(jaegertracing_protobuf_tag) TagNode;
+
+void assign(jaeger_string& str, const char* value)
+{
+    ASSERT_TRUE(jaeger_string_assign(&str, value, std::strlen(value)));
+}
+
+void appendTag(jaegertracing_protobuf_span& span,
+               const char* key,
+               const char* value)
+{
+    auto* node = reinterpret_cast<TagNode*>(
+        jaegertracing_protobuf_tag_node_pool_acquire());
+    ASSERT_NE(nullptr, node);
+    assign(node->value.key, key);
+    node->value.value.type = jaegertracing_protobuf_tag_value_str_value_type;
+    assign(node->value.value.value.str_value, value);
+    auto* tags = jaegertracing_protobuf_span_mutable_tags(&span);
+    ASSERT_NE(nullptr, tags);
+    jaeger_list_append(tags, &node->base);
+}
+
+}  // anonymous namespace
+
+TEST(Clear, testClear)
+{
+    jaegertracing_protobuf_span span;
+    std::memset(&span, 0, sizeof(span));
+    span.span_id = 1;
+    assign(span.operation_name, "operation");
+    appendTag(span, "key", "value");
+    auto* operationName = span.operation_name.buffer;
+
+    jaegertracing_protobuf_span_clear(&span);
+    ASSERT_EQ(0u, span.span_id);
+    ASSERT_EQ(0u, span.operation_name.len);
+    ASSERT_EQ(operationName, span.operation_name.buffer);
+    // The cold fields stay allocated for reuse.
+    ASSERT_NE(nullptr, span.cold);
+    ASSERT_TRUE(jaeger_list_empty(&span.cold->tags));
+    ASSERT_EQ(nullptr, span.cold->tags.prev);
+
+    // Shorter values reuse the buffer.
+    assign(span.operation_name, "op");
+    ASSERT_EQ(operationName, span.operation_name.buffer);
+    ASSERT_EQ(std::strlen("operation"), span.operation_name.capacity);
+    jaegertracing_protobuf_span_destroy(&span);
+}
+
+TEST(Clear, testClearUnion)
+{
+    jaegertracing_protobuf_tag tag;
+    std::memset(&tag, 0, sizeof(tag));
+    tag.value.type = jaegertracing_protobuf_tag_value_str_value_type;
+    assign(tag.value.value.str_value, "value");
+    auto* value = tag.value.value.str_value.buffer;
+    jaegertracing_protobuf_tag_clear(&tag);
+    ASSERT_EQ(0u, tag.value.value.str_value.len);
+    ASSERT_EQ(value, tag.value.value.str_value.buffer);
+
+    // Other members are released, leaving a zeroed union.
+    jaegertracing_protobuf_tag_destroy(&tag);
+    tag.value.type = jaegertracing_protobuf_tag_value_binary_value_type;
+    assign(tag.value.value.binary_value, "bytes");
+    jaegertracing_protobuf_tag_clear(&tag);
+    ASSERT_EQ(jaegertracing_protobuf_tag_value_str_value_type, tag.value.type);
+    ASSERT_EQ(nullptr, tag.value.value.str_value.buffer);
+    jaegertracing_protobuf_tag_destroy(&tag);
+}
+
+TEST(Clear, testShrink)
+{
+    jaegertracing_protobuf_span span;
+    std::memset(&span, 0, sizeof(span));
+    assign(span.operation_name, "operation");
+    appendTag(span, "key", "value");
+    jaegertracing_protobuf_span_clear(&span);
+    appendTag(span, "key", "value");
+    auto* tag = &reinterpret_cast<TagNode*>(
+                     jaegertracing_protobuf_span_get_tags(&span).next)
+                     ->value;
+    assign(tag->key, "k");
+
+    jaegertracing_protobuf_span_shrink(&span);
+    ASSERT_EQ(nullptr, span.operation_name.buffer);
+    ASSERT_EQ(0u, span.operation_name.capacity);
+    ASSERT_EQ(1u, tag->key.capacity);
+    ASSERT_EQ('k', tag->key.buffer[0]);
+    jaegertracing_protobuf_span_destroy(&span);
+}
+
+#ifdef JAEGER_ENABLE_STATS
+
+namespace {
+
+void recordSpan()
+{
+    auto* span = jaegertracing_protobuf_span_pool_acquire();
+    ASSERT_NE(nullptr, span);
+    span->span_id = 1;
+    assign(span->operation_name, "operation");
+    appendTag(*span, "component", "test");
+    appendTag(*span, "http.method", "GET");
+    appendTag(*span, "http.url", "/");
+    jaegertracing_protobuf_span_pool_release(span);
+}
+
+}  // anonymous namespace
+
+TEST(Clear, testSteadyState)
+{
+    // Pools hand out nodes in LIFO order, so buffers settle at their largest
+    // size after a few spans.
+    for (auto i = 0; i < 3; ++i) {
+        recordSpan();
+    }
+    jaeger_struct_runtime_stats_snapshot before;
+    std::memset(&before, 0, sizeof(before));
+    ASSERT_TRUE(jaeger_stats_snapshot(&before));
+    for (auto i = 0; i < 100; ++i) {
+        recordSpan();
+    }
+    jaeger_struct_runtime_stats_snapshot after;
+    std::memset(&after, 0, sizeof(after));
+    ASSERT_TRUE(jaeger_stats_snapshot(&after));
+    // The first snapshot allocated its histogram buckets.
+    ASSERT_EQ(before.allocations +
+                  jaeger_list_size(&before.encode_time.buckets) +
+                  jaeger_list_size(&before.decode_time.buckets),
+              after.allocations);
+    jaeger_struct_runtime_stats_snapshot_destroy(&before);
+    jaeger_struct_runtime_stats_snapshot_destroy(&after);
+}
+
+#endif  // JAEGER_ENABLE_STATS
+
+}  // namespace compiler
+}  // namespace jaeger_struct
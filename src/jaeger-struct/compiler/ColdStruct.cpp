@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/compiler/ColdStruct.h>
+
+#include <google/protobuf/io/printer.h>
+
+namespace jaeger_struct {
+namespace compiler {
+
+void ColdStruct::writeDefinition(google::protobuf::io::Printer& printer) const
+{
+    printer.Print("typedef struct $name$ ", "name", name());
+    writeBracedDefinition(printer);
+    printer.Print(" $name$;", "name", name());
+}
+
+void ColdStruct::writeFunctionDefinitions(
+    google::protobuf::io::Printer& printer) const
+{
+    writeReleaseFunctions(printer, _pooled);
+    writeAppendFunctions(printer, _pooled);
+}
+
+}  // namespace compiler
+}  // namespace jaeger_struct
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_COMPILER_COLD_STRUCT_H
+#define JAEGER_STRUCT_COMPILER_COLD_STRUCT_H
+
+#include <vector>
+
+#include <jaeger-struct/compiler/ComplexType.h>
+
+namespace jaeger_struct {
+namespace compiler {
+
+// Companion of a Struct holding its fields marked cold. The struct points to
+// it from its cold member, allocated on first write, so that it only keeps
+// the fields accessed frequently.
+class ColdStruct : public ComplexType {
+  public:
+    ColdStruct(const std::string& ownerName,
+               const std::vector<Field>& fields,
+               bool pooled)
+        : ComplexType(ownerName + "_cold", fields)
+        , _ownerName(ownerName)
+        , _pooled(pooled)
+    {
+    }
+
+    const std::string& ownerName() const { return _ownerName; }
+
+    void writeDefinition(google::protobuf::io::Printer& printer) const override;
+
+    void writeFunctionDefinitions(
+        google::protobuf::io::Printer& printer) const override;
+
+  private:
+    std::string _ownerName;
+    bool _pooled;
+};
+
+}  // namespace compiler
+}  // namespace jaeger_struct
+
+#endif  // JAEGER_STRUCT_COMPILER_COLD_STRUCT_H
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <jaeger.h>
+
+namespace jaeger_struct {
+namespace compiler {
+namespace {
+
+typedef JAEGER_LIST(jaegertracing_protobuf_span) SpanNode;
+typedef JAEGER_LIST(jaegertracing_protobuf_tag) TagNode;
+
+void assign(jaeger_string& str, const char* value)
+{
+    ASSERT_TRUE(jaeger_string_assign(&str, value, std::strlen(value)));
+}
+
+void appendTag(jaegertracing_protobuf_span& span, const char* key)
+{
+    auto* node = static_cast<TagNode*>(jaeger_malloc(sizeof(TagNode)));
+    ASSERT_NE(nullptr, node);
+    std::memset(node, 0, sizeof(*node));
+    assign(node->value.key, key);
+    auto* tags = jaegertracing_protobuf_span_mutable_tags(&span);
+    ASSERT_NE(nullptr, tags);
+    jaeger_list_append(tags, &node->base);
+}
+
+std::string encode(const jaegertracing_protobuf_span& span)
+{
+    jaeger_buffer buffer;
+    std::memset(&buffer, 0, sizeof(buffer));
+    std::string result;
+    if (jaegertracing_protobuf_span_encode(&span, &buffer)) {
+        result.assign(reinterpret_cast<const char*>(buffer.data), buffer.size);
+    }
+    jaeger_buffer_destroy(&buffer);
+    return result;
+}
+
+}  // anonymous namespace
+
+TEST(Cold, testDefaults)
+{
+    jaegertracing_protobuf_span span;
+    std::memset(&span, 0, sizeof(span));
+    ASSERT_TRUE(
+        jaeger_list_empty(&jaegertracing_protobuf_span_get_tags(&span)));
+    ASSERT_TRUE(
+        jaeger_list_empty(&jaegertracing_protobuf_span_get_logs(&span)));
+    ASSERT_EQ(nullptr, span.cold);
+
+    // Spans without cold fields encode exactly as before.
+    span.span_id = 1;
+    ASSERT_EQ(std::string("\x10\x01", 2), encode(span));
+    jaegertracing_protobuf_span_destroy(&span);
+}
+
+TEST(Cold, testDecode)
+{
+    jaegertracing_protobuf_span span;
+    std::memset(&span, 0, sizeof(span));
+    span.span_id = 1;
+    auto hot = encode(span);
+    appendTag(span, "error");
+    auto cold = encode(span);
+    // Cold fields follow the others.
+    ASSERT_EQ(hot, cold.substr(0, hot.size()));
+    jaegertracing_protobuf_span_destroy(&span);
+    ASSERT_EQ(nullptr, span.cold);
+
+    jaegertracing_protobuf_span copy;
+    std::memset(&copy, 0, sizeof(copy));
+    ASSERT_TRUE(
+        jaegertracing_protobuf_span_decode(&copy, hot.data(), hot.size()));
+    ASSERT_EQ(1u, copy.span_id);
+    ASSERT_EQ(nullptr, copy.cold);
+
+    ASSERT_TRUE(
+        jaegertracing_protobuf_span_decode(&copy, cold.data(), cold.size()));
+    ASSERT_NE(nullptr, copy.cold);
+    ASSERT_EQ(1u, jaeger_list_size(&copy.cold->tags));
+    auto& tag = reinterpret_cast<const TagNode*>(copy.cold->tags.next)->value;
+    ASSERT_EQ(std::string("error"),
+              std::string(tag.key.buffer, tag.key.len));
+    jaegertracing_protobuf_span_destroy(&copy);
+    ASSERT_EQ(nullptr, copy.cold);
+}
+
+TEST(Cold, testColumns)
+{
+    jaeger_list spans;
+    std::memset(&spans, 0, sizeof(spans));
+    for (auto i = 0; i < 2; ++i) {
+        auto* node = static_cast<SpanNode*>(jaeger_malloc(sizeof(SpanNode)));
+        ASSERT_NE(nullptr, node);
+        std::memset(node, 0, sizeof(*node));
+        node->value.span_id = i + 1;
+        if (i == 1) {
+            appendTag(node->value, "error");
+        }
+        jaeger_list_append(&spans, &node->base);
+    }
+
+    jaegertracing_protobuf_span_columns columns;
+    std::memset(&columns, 0, sizeof(columns));
+    ASSERT_TRUE(
+        jaegertracing_protobuf_span_columns_append_list(&columns, &spans));
+    ASSERT_EQ(1u, columns.tags.size);
+
+    jaeger_list copies;
+    std::memset(&copies, 0, sizeof(copies));
+    ASSERT_TRUE(jaegertracing_protobuf_span_columns_to_list(&columns, &copies));
+    ASSERT_EQ(2u, jaeger_list_size(&copies));
+    auto& first = reinterpret_cast<const SpanNode*>(copies.next)->value;
+    auto& second = reinterpret_cast<const SpanNode*>(copies.next->next)->value;
+    // Rows without cold values leave the companion unallocated.
+    ASSERT_EQ(nullptr, first.cold);
+    ASSERT_NE(nullptr, second.cold);
+    ASSERT_EQ(1u, jaeger_list_size(&second.cold->tags));
+
+    jaegertracing_protobuf_span_columns_destroy(&columns);
+    for (auto* list : { &spans, &copies }) {
+        while (list->next != nullptr) {
+            auto* node = list->next;
+            list->next = node->next;
+            jaegertracing_protobuf_span_destroy(
+                &reinterpret_cast<SpanNode*>(node)->value);
+            jaeger_free(node);
+        }
+    }
+}
+
+}  // namespace compiler
+}  // namespace jaeger_struct
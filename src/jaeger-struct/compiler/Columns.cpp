@@ -0,0 +1,985 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/compiler/Columns.h>
+
+#include <map>
+
+#include <google/protobuf/io/printer.h>
+
+#include <jaeger-struct/compiler/Enum.h>
+#include <jaeger-struct/compiler/Struct.h>
+#include <jaeger-struct/compiler/Union.h>
+
+namespace jaeger_struct {
+namespace compiler {
+namespace {
+
+using Guards = std::vector<std::pair<std::string, std::string>>;
+using ColdOwners = std::vector<std::pair<std::string, std::string>>;
+
+// Returns the expression of member in the struct that pointer points to.
+std::string memberOf(const std::string& pointer, const std::string& member)
+{
+    if (pointer.front() == '&') {
+        return pointer.substr(1) + "." + member;
+    }
+    return pointer + "->" + member;
+}
+
+void addStructColumns(const Struct& type,
+                      const std::string& pointer,
+                      const std::string& mutablePointer,
+                      const std::string& prefix,
+                      const Guards& guards,
+                      const ColdOwners& coldOwners,
+                      std::vector<Columns::Column>& columns);
+
+void addColumns(const Field& field,
+                const std::string& path,
+                const std::string& mutablePath,
+                const std::string& name,
+                const Guards& guards,
+                const ColdOwners& coldOwners,
+                std::vector<Columns::Column>& columns)
+{
+    auto&& type = field.type();
+    const auto isString = (type->name() == "jaeger_string");
+    const auto isSigned = type->name() == "int32_t" ||
+                          type->name() == "int64_t" ||
+                          std::dynamic_pointer_cast<const Enum>(type);
+    const auto isFloatingPoint =
+        type->name() == "float" || type->name() == "double";
+    Columns::Column column{ Columns::Column::kScalar,
+                            name,
+                            path,
+                            mutablePath,
+                            type->name(),
+                            guards,
+                            coldOwners,
+                            isSigned,
+                            isFloatingPoint,
+                            field.inlineCapacity() };
+
+    if (field.repeated()) {
+        if (std::dynamic_pointer_cast<const Struct>(type)) {
+            column._kind = Columns::Column::kRepeatedMessage;
+        }
+        else if (isString) {
+            column._kind = Columns::Column::kRepeatedString;
+        }
+        else {
+            column._kind = Columns::Column::kRepeatedScalar;
+        }
+        columns.emplace_back(std::move(column));
+        return;
+    }
+
+    if (auto structType = std::dynamic_pointer_cast<const Struct>(type)) {
+        addStructColumns(*structType,
+                         "&" + path,
+                         "&" + mutablePath,
+                         name + "_",
+                         guards,
+                         coldOwners,
+                         columns);
+        return;
+    }
+
+    if (auto unionType = std::dynamic_pointer_cast<const Union>(type)) {
+        columns.emplace_back(Columns::Column{ Columns::Column::kScalar,
+                                              name + "_type",
+                                              path + ".type",
+                                              mutablePath + ".type",
+                                              "uint8_t",
+                                              guards,
+                                              coldOwners,
+                                              false,
+                                              false,
+                                              0 });
+        for (auto&& member : unionType->fields()) {
+            auto memberGuards = guards;
+            memberGuards.emplace_back(path + ".type",
+                                      unionType->name() + "_" +
+                                          member.name() + "_type");
+            addColumns(member,
+                       path + ".value." + member.name(),
+                       mutablePath + ".value." + member.name(),
+                       name + "_" + member.name(),
+                       memberGuards,
+                       coldOwners,
+                       columns);
+        }
+        return;
+    }
+
+    if (isString) {
+        column._kind = Columns::Column::kString;
+    }
+    columns.emplace_back(std::move(column));
+}
+
+// Adds the columns of the fields of the struct that pointer points to, read
+// through pointer and assigned through mutablePointer. Cold fields are read
+// through their accessor macros, and their columns are named like the other
+// fields.
+void addStructColumns(const Struct& type,
+                      const std::string& pointer,
+                      const std::string& mutablePointer,
+                      const std::string& prefix,
+                      const Guards& guards,
+                      const ColdOwners& coldOwners,
+                      std::vector<Columns::Column>& columns)
+{
+    for (auto&& field : type.fields()) {
+        if (!field.indirect()) {
+            addColumns(field,
+                       memberOf(pointer, field.name()),
+                       memberOf(mutablePointer, field.name()),
+                       prefix + field.name(),
+                       guards,
+                       coldOwners,
+                       columns);
+            continue;
+        }
+        auto fieldOwners = coldOwners;
+        fieldOwners.emplace_back(type.name(), mutablePointer);
+        for (auto&& coldField : type.cold()->fields()) {
+            addColumns(coldField,
+                       type.name() + "_get_" + coldField.name() + "(" +
+                           pointer + ")",
+                       memberOf(mutablePointer, field.name()) + "->" +
+                           coldField.name(),
+                       prefix + coldField.name(),
+                       guards,
+                       fieldOwners,
+                       columns);
+        }
+    }
+}
+
+// Adds the statements making the frozen encodings of the struct that pointer
+// points to and of the cached structs it stores by value stale.
+void addTouches(const Struct& type,
+                const std::string& pointer,
+                std::vector<std::string>& touches)
+{
+    if (type.cached()) {
+        touches.emplace_back(type.name() + "_touch(" + pointer + ");\n");
+    }
+    for (auto&& field : type.fields()) {
+        auto structType = std::dynamic_pointer_cast<const Struct>(field.type());
+        if (structType && !field.repeated() && !field.indirect()) {
+            addTouches(
+                *structType, "&" + memberOf(pointer, field.name()), touches);
+        }
+    }
+}
+
+std::string guardExpression(const Guards& guards)
+{
+    std::string result;
+    for (auto&& guard : guards) {
+        if (!result.empty()) {
+            result += " && ";
+        }
+        result += guard.first + " == " + guard.second;
+    }
+    return result;
+}
+
+std::map<std::string, std::string> columnVariables(const Columns::Column& column)
+{
+    return { { "name", column._name },
+             { "path", column._path },
+             { "mutable", column._mutablePath },
+             { "type", column._typeName },
+             { "guard", guardExpression(column._guards) },
+             { "signed", column._signed ? "true" : "false" } };
+}
+
+// Writes the statement storing count elements of the scalar array values
+// in the block.
+void writePutScalars(google::protobuf::io::Printer& printer,
+                     const Columns::Column& column,
+                     const std::string& values,
+                     const std::string& count)
+{
+    auto vars = columnVariables(column);
+    vars["values"] = values;
+    vars["count"] = count;
+    if (column._floatingPoint) {
+        printer.Print(vars,
+                      "if (!jaeger_block_put_raw(\n"
+                      "        block, $values$, sizeof(*$values$) * $count$)) {\n"
+                      "  return false;\n"
+                      "}\n");
+    }
+    else {
+        printer.Print(vars,
+                      "if (!jaeger_block_put_ints(\n"
+                      "        block, $values$, sizeof(*$values$), $signed$, "
+                      "$count$)) {\n"
+                      "  return false;\n"
+                      "}\n");
+    }
+}
+
+void writeGetScalars(google::protobuf::io::Printer& printer,
+                     const Columns::Column& column,
+                     const std::string& values,
+                     const std::string& count)
+{
+    auto vars = columnVariables(column);
+    vars["values"] = values;
+    vars["count"] = count;
+    if (column._floatingPoint) {
+        printer.Print(vars,
+                      "if (!jaeger_block_get_raw(\n"
+                      "        reader, $values$, sizeof(*$values$) * $count$)) {\n"
+                      "  return false;\n"
+                      "}\n");
+    }
+    else {
+        printer.Print(vars,
+                      "if (!jaeger_block_get_ints(\n"
+                      "        reader, $values$, sizeof(*$values$), $signed$, "
+                      "$count$)) {\n"
+                      "  return false;\n"
+                      "}\n");
+    }
+}
+
+// Opens a block guarded by the column's union tags, if any. An unguarded block
+// is opened anyway if scoped is true.
+bool openGuard(google::protobuf::io::Printer& printer,
+               const Columns::Column& column,
+               bool scoped = false)
+{
+    if (!column._guards.empty()) {
+        printer.Print("if ($guard$) {\n",
+                      "guard",
+                      guardExpression(column._guards));
+    }
+    else if (scoped) {
+        printer.Print("{\n");
+    }
+    else {
+        return false;
+    }
+    printer.Indent();
+    return true;
+}
+
+void closeGuard(google::protobuf::io::Printer& printer, bool guarded)
+{
+    if (guarded) {
+        printer.Outdent();
+        printer.Print("}\n");
+    }
+}
+
+// Writes the statements allocating the cold fields holding the column in
+// the row, only if the row has elements for repeated columns.
+void writeAllocateCold(google::protobuf::io::Printer& printer,
+                       const Columns::Column& column)
+{
+    for (auto&& owner : column._coldOwners) {
+        std::map<std::string, std::string> vars;
+        vars["name"] = column._name;
+        vars["type"] = owner.first;
+        vars["pointer"] = owner.second;
+        if (column._kind == Columns::Column::kScalar ||
+            column._kind == Columns::Column::kString) {
+            printer.Print(vars,
+                          "if ($type$_mutable_cold($pointer$) == NULL) {\n");
+        }
+        else {
+            printer.Print(vars,
+                          "if (columns->$name$_offsets[row] <\n"
+                          "        columns->$name$_offsets[row + 1] &&\n"
+                          "    $type$_mutable_cold($pointer$) == NULL) {\n");
+        }
+        printer.Print("  return false;\n"
+                      "}\n");
+    }
+}
+
+}  // anonymous namespace
+
+Columns::Columns(const Struct& type)
+    : _name(type.name() + "_columns")
+    , _rowName(type.name())
+    , _columns()
+    , _touches()
+{
+    addStructColumns(
+        type, "value", "value", "", Guards(), ColdOwners(), _columns);
+    addTouches(type, "value", _touches);
+}
+
+void Columns::writeDefinition(google::protobuf::io::Printer& printer) const
+{
+    printer.Print("typedef struct $name$ {\n", "name", _name);
+    printer.Indent();
+    printer.Print("size_t size;\n"
+                  "size_t capacity;");
+    for (auto&& column : _columns) {
+        const auto vars = columnVariables(column);
+        printer.Print("\n");
+        switch (column._kind) {
+        case Column::kScalar:
+            printer.Print(vars, "$type$* $name$;");
+            break;
+        case Column::kString:
+            printer.Print(vars, "jaeger_string_column $name$;");
+            break;
+        case Column::kRepeatedScalar:
+            printer.Print(vars,
+                          "size_t* $name$_offsets;\n"
+                          "$type$* $name$;\n"
+                          "size_t $name$_size;\n"
+                          "size_t $name$_capacity;");
+            break;
+        case Column::kRepeatedString:
+            printer.Print(vars,
+                          "size_t* $name$_offsets;\n"
+                          "jaeger_string_column $name$;\n"
+                          "size_t $name$_size;\n"
+                          "size_t $name$_capacity;");
+            break;
+        default:
+            assert(column._kind == Column::kRepeatedMessage);
+            printer.Print(vars,
+                          "size_t* $name$_offsets;\n"
+                          "$type$_columns $name$;");
+            break;
+        }
+    }
+    printer.Outdent();
+    printer.Print("\n} $name$;", "name", _name);
+}
+
+void Columns::writeFunctionDeclarations(
+    google::protobuf::io::Printer& printer) const
+{
+    const std::map<std::string, std::string> vars = { { "name", _name },
+                                                      { "row", _rowName } };
+    printer.Print(
+        vars,
+        "/* Makes room for capacity rows. */\n"
+        "bool $name$_reserve($name$* columns, size_t capacity);\n"
+        "/*\n"
+        " * Appends a copy of value as the last row. On failure, columns is\n"
+        " * left in an unspecified state that can still be destroyed.\n"
+        " */\n"
+        "bool $name$_append($name$* columns, const $row$* value);\n"
+        "/* Copies row into value, which must be zero-initialized. */\n"
+        "bool $name$_get(const $name$* columns, size_t row, $row$* value);\n"
+        "/* Appends every $row$ held in list. */\n"
+        "bool $name$_append_list($name$* columns, const jaeger_list* list);\n"
+        "/* Appends every row to list as a $row$. */\n"
+        "bool $name$_to_list(const $name$* columns, jaeger_list* list);\n"
+        "void $name$_destroy($name$* columns);\n"
+        "/* Appends the columns to an uncompressed block. */\n"
+        "bool $name$_write(const $name$* columns, jaeger_buffer* block);\n"
+        "/* Reads columns written by $name$_write into empty columns. */\n"
+        "bool $name$_read($name$* columns, jaeger_block_reader* reader);\n"
+        "/* Appends the compressed columns to out. */\n"
+        "bool $name$_compress(const $name$* columns, jaeger_buffer* out);\n"
+        "/* Decompresses columns written by $name$_compress into empty "
+        "columns. */\n"
+        "bool $name$_decompress($name$* columns, const void* data, size_t "
+        "size);\n");
+}
+
+void Columns::writeFunctionDefinitions(
+    google::protobuf::io::Printer& printer) const
+{
+    writeReserve(printer);
+    printer.Print("\n");
+    writeAppend(printer);
+    printer.Print("\n");
+    writeGet(printer);
+    printer.Print("\n");
+    writeListFunctions(printer);
+    printer.Print("\n");
+    writeDestroy(printer);
+    printer.Print("\n");
+    writeBlockWrite(printer);
+    printer.Print("\n");
+    writeBlockRead(printer);
+    printer.Print("\n");
+    writeCompression(printer);
+}
+
+void Columns::writeReserve(google::protobuf::io::Printer& printer) const
+{
+    printer.Print("bool $name$_reserve($name$* columns, size_t capacity)\n"
+                  "{\n",
+                  "name",
+                  _name);
+    printer.Indent();
+    printer.Print("if (capacity <= columns->capacity) {\n"
+                  "  return true;\n"
+                  "}\n");
+    for (auto&& column : _columns) {
+        const auto vars = columnVariables(column);
+        switch (column._kind) {
+        case Column::kScalar:
+            printer.Print(vars,
+                          "{\n"
+                          "  $type$* data = jaeger_column_resize(\n"
+                          "      columns->$name$, sizeof(*data), capacity);\n"
+                          "  if (data == NULL) {\n"
+                          "    return false;\n"
+                          "  }\n"
+                          "  columns->$name$ = data;\n"
+                          "}\n");
+            break;
+        case Column::kString:
+            printer.Print(vars,
+                          "if (!jaeger_string_column_reserve(&columns->$name$, "
+                          "capacity)) {\n"
+                          "  return false;\n"
+                          "}\n");
+            break;
+        default:
+            printer.Print(vars,
+                          "{\n"
+                          "  size_t* offsets = jaeger_column_resize(\n"
+                          "      columns->$name$_offsets, sizeof(*offsets), "
+                          "capacity + 1);\n"
+                          "  if (offsets == NULL) {\n"
+                          "    return false;\n"
+                          "  }\n"
+                          "  if (columns->capacity == 0) {\n"
+                          "    offsets[0] = 0;\n"
+                          "  }\n"
+                          "  columns->$name$_offsets = offsets;\n"
+                          "}\n");
+            break;
+        }
+    }
+    printer.Print("columns->capacity = capacity;\n"
+                  "return true;\n");
+    printer.Outdent();
+    printer.Print("}\n");
+}
+
+void Columns::writeAppend(google::protobuf::io::Printer& printer) const
+{
+    printer.Print(
+        "bool $name$_append($name$* columns, const $row$* value)\n"
+        "{\n",
+        "name",
+        _name,
+        "row",
+        _rowName);
+    printer.Indent();
+    printer.Print("const size_t row = columns->size;\n"
+                  "if (row == columns->capacity &&\n"
+                  "    !$name$_reserve(columns, "
+                  "jaeger_column_grow(columns->capacity))) {\n"
+                  "  return false;\n"
+                  "}\n",
+                  "name",
+                  _name);
+    for (auto&& column : _columns) {
+        const auto vars = columnVariables(column);
+        switch (column._kind) {
+        case Column::kScalar:
+            if (column._guards.empty()) {
+                printer.Print(vars, "columns->$name$[row] = $path$;\n");
+            }
+            else {
+                printer.Print(
+                    vars,
+                    "columns->$name$[row] = ($guard$) ? $path$ : 0;\n");
+            }
+            break;
+        case Column::kString: {
+            const auto guarded = openGuard(printer, column);
+            printer.Print(vars,
+                          "if (!jaeger_string_column_append(\n"
+                          "        &columns->$name$, row, &$path$)) {\n"
+                          "  return false;\n"
+                          "}\n");
+            if (guarded) {
+                printer.Outdent();
+                printer.Print(vars,
+                              "}\n"
+                              "else {\n"
+                              "  columns->$name$.offsets[row + 1] =\n"
+                              "      columns->$name$.offsets[row];\n"
+                              "}\n");
+            }
+        } break;
+        default: {
+            const auto guarded = openGuard(printer, column, true);
+            printer.Print(vars,
+                          "const jaeger_list* node;\n"
+                          "JAEGER_LIST_FOR_EACH(&$path$, node) {\n");
+            printer.Indent();
+            if (column._kind == Column::kRepeatedMessage) {
+                printer.Print(vars,
+                              "if (!$type$_columns_append(\n"
+                              "        &columns->$name$,\n"
+                              "        JAEGER_LIST_NODE_VALUE(const $type$, "
+                              "node))) {\n"
+                              "  return false;\n"
+                              "}\n");
+            }
+            else if (column._kind == Column::kRepeatedString) {
+                printer.Print(
+                    vars,
+                    "if (columns->$name$_size == columns->$name$_capacity) {\n"
+                    "  const size_t capacity =\n"
+                    "      jaeger_column_grow(columns->$name$_capacity);\n"
+                    "  if (!jaeger_string_column_reserve(&columns->$name$, "
+                    "capacity)) {\n"
+                    "    return false;\n"
+                    "  }\n"
+                    "  columns->$name$_capacity = capacity;\n"
+                    "}\n"
+                    "if (!jaeger_string_column_append(\n"
+                    "        &columns->$name$,\n"
+                    "        columns->$name$_size,\n"
+                    "        JAEGER_LIST_NODE_VALUE(const jaeger_string, "
+                    "node))) {\n"
+                    "  return false;\n"
+                    "}\n"
+                    "++columns->$name$_size;\n");
+            }
+            else {
+                printer.Print(
+                    vars,
+                    "if (columns->$name$_size == columns->$name$_capacity) {\n"
+                    "  const size_t capacity =\n"
+                    "      jaeger_column_grow(columns->$name$_capacity);\n"
+                    "  $type$* data = jaeger_column_resize(\n"
+                    "      columns->$name$, sizeof(*data), capacity);\n"
+                    "  if (data == NULL) {\n"
+                    "    return false;\n"
+                    "  }\n"
+                    "  columns->$name$ = data;\n"
+                    "  columns->$name$_capacity = capacity;\n"
+                    "}\n"
+                    "columns->$name$[columns->$name$_size++] =\n"
+                    "    *JAEGER_LIST_NODE_VALUE(const $type$, node);\n");
+            }
+            printer.Outdent();
+            printer.Print("}\n");
+            closeGuard(printer, guarded);
+            if (column._kind == Column::kRepeatedMessage) {
+                printer.Print(
+                    vars,
+                    "columns->$name$_offsets[row + 1] = columns->$name$.size;\n");
+            }
+            else {
+                printer.Print(
+                    vars,
+                    "columns->$name$_offsets[row + 1] = columns->$name$_size;\n");
+            }
+        } break;
+        }
+    }
+    printer.Print("columns->size = row + 1;\n"
+                  "return true;\n");
+    printer.Outdent();
+    printer.Print("}\n");
+}
+
+void Columns::writeGet(google::protobuf::io::Printer& printer) const
+{
+    printer.Print(
+        "bool $name$_get(const $name$* columns, size_t row, $row$* value)\n"
+        "{\n",
+        "name",
+        _name,
+        "row",
+        _rowName);
+    printer.Indent();
+    for (auto&& touch : _touches) {
+        printer.Print(touch.c_str());
+    }
+    for (auto&& column : _columns) {
+        const auto vars = columnVariables(column);
+        const auto guarded = openGuard(
+            printer,
+            column,
+            column._kind != Column::kScalar && column._kind != Column::kString);
+        switch (column._kind) {
+        case Column::kScalar:
+            writeAllocateCold(printer, column);
+            printer.Print(vars, "$mutable$ = columns->$name$[row];\n");
+            break;
+        case Column::kString:
+            writeAllocateCold(printer, column);
+            printer.Print(vars,
+                          "if (!jaeger_string_column_copy(\n"
+                          "        &columns->$name$, row, &$mutable$)) {\n"
+                          "  return false;\n"
+                          "}\n");
+            break;
+        default: {
+            const auto elementType =
+                column._kind == Column::kRepeatedString ? std::string("jaeger_string")
+                                                        : column._typeName;
+            printer.Print("size_t i;\n");
+            writeAllocateCold(printer, column);
+            printer.Print(vars,
+                          "for (i = columns->$name$_offsets[row];\n"
+                          "     i < columns->$name$_offsets[row + 1];\n"
+                          "     ++i) {\n");
+            printer.Indent();
+            if (column._inlineCapacity == 0) {
+                printer.Print("JAEGER_LIST($type$)* node = "
+                              "jaeger_malloc(sizeof(*node));\n"
+                              "if (node == NULL) {\n"
+                              "  return false;\n"
+                              "}\n"
+                              "memset(node, 0, sizeof(*node));\n",
+                              "type",
+                              elementType);
+            }
+            else {
+                // Inline nodes first, keeping the buffers of their values.
+                auto inlineVars = vars;
+                inlineVars["type"] = elementType;
+                inlineVars["capacity"] =
+                    std::to_string(column._inlineCapacity);
+                printer.Print(inlineVars,
+                              "JAEGER_LIST($type$)* node = (void*) "
+                              "jaeger_list_inline_take(\n"
+                              "    &$mutable$_inline, sizeof(*node), "
+                              "$capacity$);\n"
+                              "if (node == NULL) {\n"
+                              "  node = jaeger_malloc(sizeof(*node));\n"
+                              "  if (node == NULL) {\n"
+                              "    return false;\n"
+                              "  }\n"
+                              "  memset(node, 0, sizeof(*node));\n"
+                              "}\n");
+            }
+            printer.Print(vars,
+                          "jaeger_list_append(&$mutable$, &node->base);\n");
+            if (column._kind == Column::kRepeatedMessage) {
+                printer.Print(
+                    vars,
+                    "if (!$type$_columns_get(&columns->$name$, i, "
+                    "&node->value)) {\n"
+                    "  return false;\n"
+                    "}\n");
+            }
+            else if (column._kind == Column::kRepeatedString) {
+                printer.Print(vars,
+                              "if (!jaeger_string_column_copy(\n"
+                              "        &columns->$name$, i, &node->value)) {\n"
+                              "  return false;\n"
+                              "}\n");
+            }
+            else {
+                printer.Print(vars, "node->value = columns->$name$[i];\n");
+            }
+            printer.Outdent();
+            printer.Print("}\n");
+        } break;
+        }
+        closeGuard(printer, guarded);
+    }
+    printer.Print("return true;\n");
+    printer.Outdent();
+    printer.Print("}\n");
+}
+
+void Columns::writeListFunctions(google::protobuf::io::Printer& printer) const
+{
+    const std::map<std::string, std::string> vars = { { "name", _name },
+                                                      { "row", _rowName } };
+    printer.Print(
+        vars,
+        "bool $name$_append_list($name$* columns, const jaeger_list* list)\n"
+        "{\n"
+        "  const jaeger_list* node;\n"
+        "  JAEGER_LIST_FOR_EACH(list, node) {\n"
+        "    if (!$name$_append(columns, "
+        "JAEGER_LIST_NODE_VALUE(const $row$, node))) {\n"
+        "      return false;\n"
+        "    }\n"
+        "  }\n"
+        "  return true;\n"
+        "}\n"
+        "\n"
+        "bool $name$_to_list(const $name$* columns, jaeger_list* list)\n"
+        "{\n"
+        "  size_t row;\n"
+        "  for (row = 0; row < columns->size; ++row) {\n"
+        "    JAEGER_LIST($row$)* node = jaeger_malloc(sizeof(*node));\n"
+        "    if (node == NULL) {\n"
+        "      return false;\n"
+        "    }\n"
+        "    memset(node, 0, sizeof(*node));\n"
+        "    jaeger_list_append(list, &node->base);\n"
+        "    if (!$name$_get(columns, row, &node->value)) {\n"
+        "      return false;\n"
+        "    }\n"
+        "  }\n"
+        "  return true;\n"
+        "}\n");
+}
+
+void Columns::writeDestroy(google::protobuf::io::Printer& printer) const
+{
+    printer.Print("void $name$_destroy($name$* columns)\n"
+                  "{\n",
+                  "name",
+                  _name);
+    printer.Indent();
+    for (auto&& column : _columns) {
+        const auto vars = columnVariables(column);
+        switch (column._kind) {
+        case Column::kScalar:
+            printer.Print(vars, "jaeger_free(columns->$name$);\n");
+            break;
+        case Column::kString:
+            printer.Print(vars,
+                          "jaeger_string_column_destroy(&columns->$name$);\n");
+            break;
+        case Column::kRepeatedScalar:
+            printer.Print(vars,
+                          "jaeger_free(columns->$name$_offsets);\n"
+                          "jaeger_free(columns->$name$);\n");
+            break;
+        case Column::kRepeatedString:
+            printer.Print(vars,
+                          "jaeger_free(columns->$name$_offsets);\n"
+                          "jaeger_string_column_destroy(&columns->$name$);\n");
+            break;
+        default:
+            printer.Print(vars,
+                          "jaeger_free(columns->$name$_offsets);\n"
+                          "$type$_columns_destroy(&columns->$name$);\n");
+            break;
+        }
+    }
+    printer.Print("memset(columns, 0, sizeof(*columns));\n");
+    printer.Outdent();
+    printer.Print("}\n");
+}
+
+void Columns::writeBlockWrite(google::protobuf::io::Printer& printer) const
+{
+    printer.Print(
+        "bool $name$_write(const $name$* columns, jaeger_buffer* block)\n"
+        "{\n",
+        "name",
+        _name);
+    printer.Indent();
+    printer.Print("if (!jaeger_block_put_size(block, columns->size)) {\n"
+                  "  return false;\n"
+                  "}\n"
+                  "if (columns->size == 0) {\n"
+                  "  return true;\n"
+                  "}\n");
+    for (auto&& column : _columns) {
+        const auto vars = columnVariables(column);
+        switch (column._kind) {
+        case Column::kScalar:
+            writePutScalars(
+                printer, column, "columns->" + column._name, "columns->size");
+            break;
+        case Column::kString:
+            printer.Print(vars,
+                          "if (!jaeger_block_put_strings(\n"
+                          "        block, &columns->$name$, columns->size)) {\n"
+                          "  return false;\n"
+                          "}\n");
+            break;
+        default:
+            printer.Print(vars,
+                          "if (!jaeger_block_put_ints(block,\n"
+                          "                           columns->$name$_offsets "
+                          "+ 1,\n"
+                          "                           sizeof(size_t),\n"
+                          "                           false,\n"
+                          "                           columns->size)) {\n"
+                          "  return false;\n"
+                          "}\n");
+            if (column._kind == Column::kRepeatedMessage) {
+                printer.Print(vars,
+                              "if (!$type$_columns_write(&columns->$name$, "
+                              "block)) {\n"
+                              "  return false;\n"
+                              "}\n");
+            }
+            else if (column._kind == Column::kRepeatedString) {
+                printer.Print(vars,
+                              "if (!jaeger_block_put_strings(\n"
+                              "        block, &columns->$name$, "
+                              "columns->$name$_size)) {\n"
+                              "  return false;\n"
+                              "}\n");
+            }
+            else {
+                writePutScalars(printer,
+                                column,
+                                "columns->" + column._name,
+                                "columns->" + column._name + "_size");
+            }
+            break;
+        }
+    }
+    printer.Print("return true;\n");
+    printer.Outdent();
+    printer.Print("}\n");
+}
+
+void Columns::writeBlockRead(google::protobuf::io::Printer& printer) const
+{
+    printer.Print(
+        "bool $name$_read($name$* columns, jaeger_block_reader* reader)\n"
+        "{\n",
+        "name",
+        _name);
+    printer.Indent();
+    printer.Print("size_t size;\n"
+                  "if (!jaeger_block_get_size(reader, &size) ||\n"
+                  "    size > (size_t)(reader->end - reader->pos)) {\n"
+                  "  return false;\n"
+                  "}\n"
+                  "if (size == 0) {\n"
+                  "  return true;\n"
+                  "}\n"
+                  "if (!$name$_reserve(columns, size)) {\n"
+                  "  return false;\n"
+                  "}\n",
+                  "name",
+                  _name);
+    for (auto&& column : _columns) {
+        const auto vars = columnVariables(column);
+        switch (column._kind) {
+        case Column::kScalar:
+            writeGetScalars(printer, column, "columns->" + column._name, "size");
+            break;
+        case Column::kString:
+            printer.Print(vars,
+                          "if (!jaeger_block_get_strings(reader, "
+                          "&columns->$name$, size)) {\n"
+                          "  return false;\n"
+                          "}\n");
+            break;
+        default:
+            printer.Print(vars,
+                          "if (!jaeger_block_get_ints(reader,\n"
+                          "                           columns->$name$_offsets "
+                          "+ 1,\n"
+                          "                           sizeof(size_t),\n"
+                          "                           false,\n"
+                          "                           size) ||\n"
+                          "    !jaeger_block_check_offsets(columns->$name$_offsets, "
+                          "size)) {\n"
+                          "  return false;\n"
+                          "}\n");
+            if (column._kind == Column::kRepeatedMessage) {
+                printer.Print(
+                    vars,
+                    "if (!$type$_columns_read(&columns->$name$, reader) ||\n"
+                    "    columns->$name$.size != "
+                    "columns->$name$_offsets[size]) {\n"
+                    "  return false;\n"
+                    "}\n");
+                break;
+            }
+            printer.Print(vars,
+                          "{\n"
+                          "  const size_t count = columns->$name$_offsets[size];\n"
+                          "  if (count > (size_t)(reader->end - reader->pos)) {\n"
+                          "    return false;\n"
+                          "  }\n");
+            printer.Indent();
+            if (column._kind == Column::kRepeatedString) {
+                printer.Print(vars,
+                              "if (!jaeger_string_column_reserve(&columns->$name$, "
+                              "count) ||\n"
+                              "    !jaeger_block_get_strings(reader, "
+                              "&columns->$name$, count)) {\n"
+                              "  return false;\n"
+                              "}\n");
+            }
+            else {
+                printer.Print(vars,
+                              "$type$* data = jaeger_column_resize(\n"
+                              "    columns->$name$, sizeof(*data), count);\n"
+                              "if (data == NULL) {\n"
+                              "  return false;\n"
+                              "}\n"
+                              "columns->$name$ = data;\n");
+            }
+            printer.Print(vars,
+                          "columns->$name$_size = count;\n"
+                          "columns->$name$_capacity = count;\n");
+            if (column._kind == Column::kRepeatedScalar) {
+                writeGetScalars(
+                    printer, column, "columns->" + column._name, "count");
+            }
+            printer.Outdent();
+            printer.Print("}\n");
+            break;
+        }
+    }
+    printer.Print("columns->size = size;\n"
+                  "return true;\n");
+    printer.Outdent();
+    printer.Print("}\n");
+}
+
+void Columns::writeCompression(google::protobuf::io::Printer& printer) const
+{
+    printer.Print(
+        "bool $name$_compress(const $name$* columns, jaeger_buffer* out)\n"
+        "{\n"
+        "  jaeger_buffer block;\n"
+        "  bool result;\n"
+        "  memset(&block, 0, sizeof(block));\n"
+        "  result = $name$_write(columns, &block) &&\n"
+        "           jaeger_block_compress(&block, out);\n"
+        "  jaeger_buffer_destroy(&block);\n"
+        "  return result;\n"
+        "}\n"
+        "\n"
+        "bool $name$_decompress($name$* columns, const void* data, size_t "
+        "size)\n"
+        "{\n"
+        "  jaeger_buffer block;\n"
+        "  jaeger_block_reader reader;\n"
+        "  bool result = false;\n"
+        "  memset(&block, 0, sizeof(block));\n"
+        "  if (jaeger_block_decompress(data, size, &block)) {\n"
+        "    reader.pos = block.data;\n"
+        "    reader.end = block.data + block.size;\n"
+        "    result = $name$_read(columns, &reader) && reader.pos == "
+        "reader.end;\n"
+        "  }\n"
+        "  jaeger_buffer_destroy(&block);\n"
+        "  return result;\n"
+        "}\n",
+        "name",
+        _name);
+}
+
+}  // namespace compiler
+}  // namespace jaeger_struct
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_COMPILER_COLUMNS_H
+#define JAEGER_STRUCT_COMPILER_COLUMNS_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <jaeger-struct/compiler/Type.h>
+
+namespace google {
+namespace protobuf {
+namespace io {
+
+class Printer;
+
+}  // namespace io
+}  // namespace protobuf
+}  // namespace google
+
+namespace jaeger_struct {
+namespace compiler {
+
+class Struct;
+
+// Columnar (struct-of-arrays) companion of a Struct. Nested messages and
+// oneofs are flattened into one column per leaf field, strings are stored as
+// offsets into a shared blob and repeated fields as offsets into a child
+// column table.
+class Columns : public Type {
+  public:
+    struct Column {
+        enum Kind {
+            kScalar,
+            kString,
+            kRepeatedScalar,
+            kRepeatedString,
+            kRepeatedMessage
+        };
+
+        Kind _kind;
+        // Member name in the columns struct.
+        std::string _name;
+        // Expression reading the value from the row struct pointed to by
+        // value.
+        std::string _path;
+        // Expression assigning the value, once the cold fields of every
+        // struct in _coldOwners are allocated.
+        std::string _mutablePath;
+        // Element type for scalar and repeated columns.
+        std::string _typeName;
+        // Union tags (path, enumerator) that must match for the column to
+        // hold the row's value.
+        std::vector<std::pair<std::string, std::string>> _guards;
+        // Structs (type, pointer expression) holding the value among their
+        // cold fields.
+        std::vector<std::pair<std::string, std::string>> _coldOwners;
+        // Encoding of scalar elements in compressed blocks.
+        bool _signed;
+        bool _floatingPoint;
+        // Inline nodes of the list of a repeated column, zero if none.
+        std::uint32_t _inlineCapacity;
+    };
+
+    explicit Columns(const Struct& type);
+
+    std::string name() const override { return _name; }
+
+    void writeDefinition(google::protobuf::io::Printer& printer) const;
+
+    void writeFunctionDeclarations(google::protobuf::io::Printer& printer) const;
+
+    void writeFunctionDefinitions(google::protobuf::io::Printer& printer) const;
+
+  private:
+    void writeReserve(google::protobuf::io::Printer& printer) const;
+
+    void writeAppend(google::protobuf::io::Printer& printer) const;
+
+    void writeGet(google::protobuf::io::Printer& printer) const;
+
+    void writeListFunctions(google::protobuf::io::Printer& printer) const;
+
+    void writeDestroy(google::protobuf::io::Printer& printer) const;
+
+    void writeBlockWrite(google::protobuf::io::Printer& printer) const;
+
+    void writeBlockRead(google::protobuf::io::Printer& printer) const;
+
+    void writeCompression(google::protobuf::io::Printer& printer) const;
+
+    std::string _name;
+    std::string _rowName;
+    std::vector<Column> _columns;
+    // Statements making the frozen encodings of the row stale, run by get.
+    std::vector<std::string> _touches;
+};
+
+}  // namespace compiler
+}  // namespace jaeger_struct
+
+#endif  // JAEGER_STRUCT_COMPILER_COLUMNS_H
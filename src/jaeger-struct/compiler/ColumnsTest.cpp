@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+#include <jaeger.h>
+
+namespace jaeger_struct {
+namespace compiler {
+namespace {
+
+typedef JAEGER_LIST(jaegertracing_protobuf_span) SpanNode;
+typedef JAEGER_LIST(jaegertracing_protobuf_tag) TagNode;
+
+void assign(jaeger_string& str, const char* value)
+{
+    ASSERT_TRUE(jaeger_string_assign(&str, value, std::strlen(value)));
+}
+
+std::string toString(const jaeger_string& str)
+{
+    return std::string(str.buffer, str.len);
+}
+
+void appendTag(jaeger_list& list, const char* key, const char* value)
+{
+    auto* node = static_cast<TagNode*>(jaeger_malloc(sizeof(TagNode)));
+    ASSERT_NE(nullptr, node);
+    std::memset(node, 0, sizeof(*node));
+    assign(node->value.key, key);
+    node->value.value.type = jaegertracing_protobuf_tag_value_str_value_type;
+    assign(node->value.value.value.str_value, value);
+    jaeger_list_append(&list, &node->base);
+}
+
+void appendTag(jaeger_list& list, const char* key, int64_t value)
+{
+    auto* node = static_cast<TagNode*>(jaeger_malloc(sizeof(TagNode)));
+    ASSERT_NE(nullptr, node);
+    std::memset(node, 0, sizeof(*node));
+    assign(node->value.key, key);
+    node->value.value.type = jaegertracing_protobuf_tag_value_long_value_type;
+    node->value.value.value.long_value = value;
+    jaeger_list_append(&list, &node->base);
+}
+
+}  // anonymous namespace
+
+TEST(Columns, testRoundTrip)
+{
+    jaegertracing_protobuf_batch batch;
+    std::memset(&batch, 0, sizeof(batch));
+    for (auto i = 0; i < 100; ++i) {
+        auto* node = static_cast<SpanNode*>(jaeger_malloc(sizeof(SpanNode)));
+        ASSERT_NE(nullptr, node);
+        std::memset(node, 0, sizeof(*node));
+        auto& span = node->value;
+        span.trace_id.high = 1;
+        span.trace_id.low = i;
+        span.span_id = i + 1;
+        span.start_time = 1000 + i;
+        span.duration = 10 * i;
+        assign(span.operation_name, (i % 2 == 0) ? "get" : "post");
+        auto* tags = jaegertracing_protobuf_span_mutable_tags(&span);
+        ASSERT_NE(nullptr, tags);
+        appendTag(*tags, "http.status_code", 200 + i);
+        if (i % 3 == 0) {
+            appendTag(*tags, "error.message", "timeout");
+        }
+        jaeger_list_append(&batch.spans, &node->base);
+    }
+
+    jaegertracing_protobuf_span_columns columns;
+    std::memset(&columns, 0, sizeof(columns));
+    ASSERT_TRUE(
+        jaegertracing_protobuf_span_columns_append_list(&columns, &batch.spans));
+    ASSERT_EQ(100u, columns.size);
+    ASSERT_EQ(134u, columns.tags.size);
+    int64_t totalDuration = 0;
+    for (size_t i = 0; i < columns.size; ++i) {
+        totalDuration += columns.duration[i];
+    }
+    ASSERT_EQ(49500, totalDuration);
+    ASSERT_EQ(2u, columns.tags_offsets[1]);
+    ASSERT_EQ(
+        "post",
+        toString(jaeger_string_column_get(&columns.operation_name, 1)));
+    ASSERT_EQ(jaegertracing_protobuf_tag_value_str_value_type,
+              columns.tags.value_type[1]);
+    ASSERT_EQ("timeout",
+              toString(jaeger_string_column_get(&columns.tags.value_str_value,
+                                                1)));
+    ASSERT_EQ(
+        0u, jaeger_string_column_get(&columns.tags.value_str_value, 0).len);
+
+    jaeger_list spans;
+    std::memset(&spans, 0, sizeof(spans));
+    ASSERT_TRUE(jaegertracing_protobuf_span_columns_to_list(&columns, &spans));
+    ASSERT_EQ(100u, jaeger_list_size(&spans));
+    const jaeger_list* expected = batch.spans.next;
+    for (const jaeger_list* node = spans.next; node != nullptr;
+         node = node->next, expected = expected->next) {
+        auto& lhs = reinterpret_cast<const SpanNode*>(expected)->value;
+        auto& rhs = reinterpret_cast<const SpanNode*>(node)->value;
+        ASSERT_EQ(lhs.trace_id.low, rhs.trace_id.low);
+        ASSERT_EQ(lhs.start_time, rhs.start_time);
+        ASSERT_EQ(toString(lhs.operation_name), toString(rhs.operation_name));
+        auto& lhsTags = jaegertracing_protobuf_span_get_tags(&lhs);
+        auto& rhsTags = jaegertracing_protobuf_span_get_tags(&rhs);
+        ASSERT_EQ(jaeger_list_size(&lhsTags), jaeger_list_size(&rhsTags));
+        const jaeger_list* lhsTag = lhsTags.next;
+        for (const jaeger_list* rhsTag = rhsTags.next; rhsTag != nullptr;
+             rhsTag = rhsTag->next, lhsTag = lhsTag->next) {
+            auto& lhsValue = reinterpret_cast<const TagNode*>(lhsTag)->value;
+            auto& rhsValue = reinterpret_cast<const TagNode*>(rhsTag)->value;
+            ASSERT_EQ(toString(lhsValue.key), toString(rhsValue.key));
+            ASSERT_EQ(lhsValue.value.type, rhsValue.value.type);
+        }
+    }
+
+    jaegertracing_protobuf_span_columns_destroy(&columns);
+    while (spans.next != nullptr) {
+        auto* node = spans.next;
+        spans.next = node->next;
+        jaegertracing_protobuf_span_destroy(
+            &reinterpret_cast<SpanNode*>(node)->value);
+        jaeger_free(node);
+    }
+    jaegertracing_protobuf_batch_destroy(&batch);
+}
+
+}  // namespace compiler
+}  // namespace jaeger_struct
@@ -17,11 +17,169 @@
 #include <jaeger-struct/compiler/ComplexType.h>
 
 #include <algorithm>
+#include <cctype>
+#include <map>
+#include <memory>
+#include <string>
 
+#include <google/protobuf/descriptor.h>
 #include <google/protobuf/io/printer.h>
 
 namespace jaeger_struct {
 namespace compiler {
+namespace {
+
+std::string wireType(const Field& field)
+{
+    if (field.packed()) {
+        return "JAEGER_WIRE_LENGTH";
+    }
+    switch (field.protoType()) {
+    case google::protobuf::FieldDescriptor::TYPE_DOUBLE:
+    case google::protobuf::FieldDescriptor::TYPE_FIXED64:
+    case google::protobuf::FieldDescriptor::TYPE_SFIXED64:
+        return "JAEGER_WIRE_FIXED64";
+    case google::protobuf::FieldDescriptor::TYPE_FLOAT:
+    case google::protobuf::FieldDescriptor::TYPE_FIXED32:
+    case google::protobuf::FieldDescriptor::TYPE_SFIXED32:
+        return "JAEGER_WIRE_FIXED32";
+    case google::protobuf::FieldDescriptor::TYPE_STRING:
+    case google::protobuf::FieldDescriptor::TYPE_BYTES:
+    case google::protobuf::FieldDescriptor::TYPE_MESSAGE:
+        return "JAEGER_WIRE_LENGTH";
+    case google::protobuf::FieldDescriptor::TYPE_GROUP:
+        return "JAEGER_WIRE_START_GROUP";
+    default:
+        return "JAEGER_WIRE_VARINT";
+    }
+}
+
+std::string tableType(const Field& field)
+{
+    if (field.indirect()) {
+        return "JAEGER_TYPE_COLD";
+    }
+    if (field.protoType() == 0) {
+        return "JAEGER_TYPE_ONEOF";
+    }
+    std::string result = "JAEGER_TYPE_";
+    for (auto&& ch : std::string(google::protobuf::FieldDescriptor::TypeName(
+             static_cast<google::protobuf::FieldDescriptor::Type>(
+                 field.protoType())))) {
+        result += static_cast<char>(std::toupper(ch));
+    }
+    return result;
+}
+
+std::string subTable(const Field& field)
+{
+    switch (field.protoType()) {
+    case 0:
+    case google::protobuf::FieldDescriptor::TYPE_ENUM:
+    case google::protobuf::FieldDescriptor::TYPE_MESSAGE:
+        return "&" + field.type()->name() + "_table";
+    default:
+        return "NULL";
+    }
+}
+
+void writeViewAccessor(google::protobuf::io::Printer& printer,
+                       const Field& field,
+                       std::string expression)
+{
+    const auto& typeName = field.type()->name();
+    std::string returnType;
+    if (field.repeated()) {
+        returnType = "ListView<" + typeName + ">";
+        expression = returnType + "(" + expression + ")";
+    }
+    else if (std::dynamic_pointer_cast<const ComplexType>(field.type())) {
+        returnType = "View<" + typeName + ">";
+        expression = returnType + "(" + expression + ")";
+    }
+    else if (typeName == "jaeger_string") {
+        returnType = "StringView";
+        expression = "toStringView(" + expression + ")";
+    }
+    else {
+        returnType = typeName;
+    }
+    printer.Print("\n"
+                  "$type$ $name$() const noexcept\n"
+                  "{\n"
+                  "  return $expression$;\n"
+                  "}\n",
+                  "type",
+                  returnType,
+                  "name",
+                  field.name(),
+                  "expression",
+                  expression);
+}
+
+// Writes a loop applying the destroy, clear or shrink function named by
+// operation to the values of the inline nodes of field, accessed as value,
+// from first up to but excluding last. Scalars need none.
+void writeInlineValues(google::protobuf::io::Printer& printer,
+                       const Field& field,
+                       const std::string& value,
+                       const std::string& operation,
+                       const std::string& first,
+                       const std::string& last)
+{
+    std::string function;
+    if (std::dynamic_pointer_cast<const ComplexType>(field.type())) {
+        function = field.type()->name() + "_" + operation;
+    }
+    else if (field.type()->name() == "jaeger_string") {
+        function = "jaeger_string_" + operation;
+    }
+    if (field.inlineCapacity() == 0 || function.empty()) {
+        return;
+    }
+    printer.Print("{\n"
+                  "  size_t i;\n"
+                  "  for (i = $first$; i < $last$; ++i) {\n"
+                  "    $function$(&$list$_inline.nodes[i].value);\n"
+                  "  }\n"
+                  "}\n",
+                  "first",
+                  first,
+                  "last",
+                  last,
+                  "function",
+                  function,
+                  "list",
+                  value);
+}
+
+}  // anonymous namespace
+
+bool ComplexType::relocatable() const
+{
+    return std::all_of(
+        std::begin(_fields), std::end(_fields), [](const Field& field) {
+            if (field.inlineCapacity() != 0) {
+                return false;
+            }
+            const auto complexType =
+                std::dynamic_pointer_cast<const ComplexType>(field.type());
+            return !complexType || field.repeated() || field.indirect() ||
+                   complexType->relocatable();
+        });
+}
+
+std::vector<std::shared_ptr<const Type>> ComplexType::valueTypes() const
+{
+    std::vector<std::shared_ptr<const Type>> types;
+    for (auto&& field : _fields) {
+        if ((!field.repeated() && !field.indirect()) ||
+            field.inlineCapacity() != 0) {
+            types.emplace_back(field.type());
+        }
+    }
+    return types;
+}
 
 void ComplexType::writeBracedDefinition(
     google::protobuf::io::Printer& printer) const
@@ -33,9 +191,640 @@ void ComplexType::writeBracedDefinition(
             printer.Print("\n");
             field.writeDefinition(printer);
         });
+    if (cached()) {
+        printer.Print("\n/* Private: the encoding frozen by $name$_freeze. */\n"
+                      "jaeger_encoded_cache* encoded;",
+                      "name",
+                      _name);
+    }
     printer.Outdent();
     printer.Print("\n}");
 }
 
+void ComplexType::writeReleaseFunctions(
+    google::protobuf::io::Printer& printer,
+    bool pooled) const
+{
+    printer.Print("void $name$_destroy($name$* value)\n"
+                  "{\n",
+                  "name",
+                  name());
+    printer.Indent();
+    auto owned = false;
+    for (auto&& field : fields()) {
+        owned =
+            writeDestroy(printer, field, "value->" + field.name(), pooled) ||
+            owned;
+    }
+    if (cached()) {
+        printer.Print("jaeger_encoded_cache_destroy(&value->encoded);\n");
+        owned = true;
+    }
+    if (!owned) {
+        printer.Print("(void) value;\n");
+    }
+    printer.Outdent();
+    printer.Print("}\n");
+
+    printer.Print("\n"
+                  "void $name$_clear($name$* value)\n"
+                  "{\n",
+                  "name",
+                  name());
+    printer.Indent();
+    auto cleared = false;
+    for (auto&& field : fields()) {
+        cleared =
+            writeClear(printer, field, "value->" + field.name(), pooled) ||
+            cleared;
+    }
+    if (cached()) {
+        printer.Print("$name$_touch(value);\n", "name", name());
+        cleared = true;
+    }
+    if (!cleared) {
+        printer.Print("(void) value;\n");
+    }
+    printer.Outdent();
+    printer.Print("}\n");
+
+    printer.Print("\n"
+                  "void $name$_shrink($name$* value)\n"
+                  "{\n",
+                  "name",
+                  name());
+    printer.Indent();
+    auto shrunk = false;
+    for (auto&& field : fields()) {
+        shrunk =
+            writeShrink(printer, field, "value->" + field.name()) || shrunk;
+    }
+    if (!shrunk) {
+        printer.Print("(void) value;\n");
+    }
+    printer.Outdent();
+    printer.Print("}\n");
+
+    printer.Print("\n"
+                  "size_t $name$_memory_usage(const $name$* value)\n"
+                  "{\n"
+                  "  size_t size = 0;\n",
+                  "name",
+                  name());
+    printer.Indent();
+    auto counted = false;
+    for (auto&& field : fields()) {
+        counted = writeMemoryUsage(printer, field, "value->" + field.name()) ||
+                  counted;
+    }
+    if (cached()) {
+        printer.Print(
+            "size += jaeger_encoded_cache_memory_usage(value->encoded);\n");
+        counted = true;
+    }
+    if (!counted) {
+        printer.Print("(void) value;\n");
+    }
+    printer.Outdent();
+    printer.Print("  return size;\n"
+                  "}\n");
+}
+
+void ComplexType::writeAppendFunctions(google::protobuf::io::Printer& printer,
+                                       bool pooled) const
+{
+    for (auto&& field : _fields) {
+        if (field.inlineCapacity() == 0) {
+            continue;
+        }
+        std::map<std::string, std::string> vars{
+            { "name", _name },
+            { "field", field.name() },
+            { "type", field.type()->name() },
+            { "capacity", std::to_string(field.inlineCapacity()) }
+        };
+        printer.Print(vars,
+                      "\n"
+                      "$type$* $name$_append_$field$($name$* value)\n"
+                      "{\n"
+                      "  jaeger_list* node = jaeger_list_inline_take(\n"
+                      "      &value->$field$_inline,\n"
+                      "      sizeof(value->$field$_inline.nodes[0]),\n"
+                      "      $capacity$);\n"
+                      "  if (node == NULL) {\n");
+        printer.Indent();
+        printer.Indent();
+        if (pooled && std::dynamic_pointer_cast<const ComplexType>(
+                          field.type())) {
+            printer.Print(vars,
+                          "node = $type$_node_pool_acquire();\n"
+                          "if (node == NULL) {\n"
+                          "  return NULL;\n"
+                          "}\n");
+        }
+        else {
+            printer.Print(vars,
+                          "node = (jaeger_list*) jaeger_malloc(\n"
+                          "    sizeof(value->$field$_inline.nodes[0]));\n"
+                          "if (node == NULL) {\n"
+                          "  return NULL;\n"
+                          "}\n"
+                          "memset(node, 0, "
+                          "sizeof(value->$field$_inline.nodes[0]));\n");
+        }
+        printer.Outdent();
+        printer.Outdent();
+        printer.Print("  }\n");
+        if (cached()) {
+            printer.Print(vars, "  $name$_touch(value);\n");
+        }
+        printer.Print(vars,
+                      "  jaeger_list_append(&value->$field$, node);\n"
+                      "  return JAEGER_LIST_NODE_VALUE($type$, node);\n"
+                      "}\n");
+    }
+}
+
+void ComplexType::writeFunctionDeclarations(
+    google::protobuf::io::Printer& printer) const
+{
+    printer.Print("void $name$_destroy($name$* value);\n"
+                  "void $name$_clear($name$* value);\n"
+                  "void $name$_shrink($name$* value);\n"
+                  "/* Bytes allocated for value beyond sizeof(*value). */\n"
+                  "size_t $name$_memory_usage(const $name$* value);\n",
+                  "name",
+                  _name);
+    for (auto&& field : _fields) {
+        if (field.inlineCapacity() == 0) {
+            continue;
+        }
+        printer.Print("/*\n"
+                      " * Appends an element to $field$, stored inline while "
+                      "fewer than $capacity$ are\n"
+                      " * in use. Returns NULL if allocation fails.\n"
+                      " */\n"
+                      "$type$* $name$_append_$field$($name$* value);\n",
+                      "name",
+                      _name,
+                      "field",
+                      field.name(),
+                      "type",
+                      field.type()->name(),
+                      "capacity",
+                      std::to_string(field.inlineCapacity()));
+    }
+}
+
+void ComplexType::writeTableDeclarations(
+    google::protobuf::io::Printer& printer) const
+{
+    printer.Print("extern const jaeger_message_table $name$_table;\n",
+                  "name",
+                  _name);
+}
+
+void ComplexType::writeTableDefinitions(
+    google::protobuf::io::Printer& printer) const
+{
+    auto fieldsName = std::string("NULL");
+    if (!_fields.empty()) {
+        fieldsName = _name + "_fields";
+        printer.Print("static const jaeger_field_table $fields$[] = {",
+                      "fields",
+                      fieldsName);
+        printer.Indent();
+        for (auto&& field : _fields) {
+            std::string nodeSize("0");
+            std::string nodeOffset("0");
+            std::string inlineOffset("0");
+            if (field.repeated()) {
+                const auto node = "JAEGER_LIST(" + field.type()->name() + ")";
+                nodeSize = "sizeof(" + node + ")";
+                nodeOffset = "offsetof(" + node + ", value)";
+            }
+            if (field.inlineCapacity() != 0) {
+                inlineOffset =
+                    "offsetof(" + _name + ", " + memberPath(field) + "_inline)";
+            }
+            const std::map<std::string, std::string> vars{
+                { "comma", &field == &_fields.front() ? "" : "," },
+                { "number", std::to_string(field.number()) },
+                { "name", _name },
+                { "path", memberPath(field) },
+                { "nodeSize", nodeSize },
+                { "nodeOffset", nodeOffset },
+                { "inlineOffset", inlineOffset },
+                { "inlineCapacity", std::to_string(field.inlineCapacity()) },
+                { "wireType", field.protoType() == 0 ? "0" : wireType(field) },
+                { "type", tableType(field) },
+                { "repeated", field.repeated() ? "true" : "false" },
+                { "table", subTable(field) }
+            };
+            printer.Print(vars,
+                          "$comma$\n"
+                          "{ $number$, offsetof($name$, $path$), $nodeSize$, "
+                          "$nodeOffset$, $inlineOffset$, $inlineCapacity$, "
+                          "$wireType$, $type$, $repeated$, $table$ }");
+        }
+        printer.Outdent();
+        printer.Print("\n};\n\n");
+    }
+    printer.Print("const jaeger_message_table $name$_table = {\n"
+                  "  \"$name$\", sizeof($name$), $fields$, $count$, $encoded$\n"
+                  "};\n",
+                  "name",
+                  _name,
+                  "fields",
+                  fieldsName,
+                  "count",
+                  std::to_string(_fields.size()),
+                  "encoded",
+                  cached() ? "offsetof(" + _name + ", encoded)" : "0");
+}
+
+void ComplexType::writeCppDefinition(
+    google::protobuf::io::Printer& printer) const
+{
+    printer.Print("template <>\n"
+                  "struct Traits<$name$> {\n",
+                  "name",
+                  _name);
+    printer.Indent();
+    printer.Print("static constexpr const char* name()\n"
+                  "{\n"
+                  "  return \"$name$\";\n"
+                  "}\n\n"
+                  "static constexpr std::array<FieldInfo, $size$> fields()\n"
+                  "{\n"
+                  "  return {{",
+                  "name",
+                  _name,
+                  "size",
+                  std::to_string(_fields.size()));
+    printer.Indent();
+    printer.Indent();
+    for (auto&& field : _fields) {
+        printer.Print("\n"
+                      "{ \"$field$\", offsetof($name$, $path$), $repeated$ },",
+                      "field",
+                      field.name(),
+                      "name",
+                      _name,
+                      "path",
+                      memberPath(field),
+                      "repeated",
+                      field.repeated() ? "true" : "false");
+    }
+    printer.Outdent();
+    printer.Outdent();
+    printer.Print("\n  }};\n"
+                  "}\n\n"
+                  "static constexpr bool relocatable()\n"
+                  "{\n"
+                  "  return $relocatable$;\n"
+                  "}\n\n"
+                  "static void destroy($name$* value) noexcept\n"
+                  "{\n"
+                  "  $name$_destroy(value);\n"
+                  "}\n",
+                  "name",
+                  _name,
+                  "relocatable",
+                  relocatable() ? "true" : "false");
+    printer.Outdent();
+    printer.Print("};\n\n");
+
+    printer.Print("template <>\n"
+                  "class View<$name$> {\n"
+                  "public:\n",
+                  "name",
+                  _name);
+    printer.Indent();
+    printer.Print("constexpr explicit View(const $name$& value) noexcept\n"
+                  "  : _value(&value)\n"
+                  "{\n"
+                  "}\n\n"
+                  "constexpr const $name$& get() const noexcept\n"
+                  "{\n"
+                  "  return *_value;\n"
+                  "}\n",
+                  "name",
+                  _name);
+    writeViewAccessors(printer);
+    printer.Outdent();
+    printer.Print("\n"
+                  "private:\n"
+                  "  const $name$* _value;\n"
+                  "};\n",
+                  "name",
+                  _name);
+}
+
+void ComplexType::writeViewAccessors(
+    google::protobuf::io::Printer& printer) const
+{
+    for (auto&& field : _fields) {
+        if (!field.indirect()) {
+            writeViewAccessor(printer, field, "_value->" + memberPath(field));
+            continue;
+        }
+        // Cold fields read through the accessor macros of the C struct.
+        const auto coldType =
+            std::dynamic_pointer_cast<const ComplexType>(field.type());
+        for (auto&& coldField : coldType->fields()) {
+            writeViewAccessor(printer,
+                              coldField,
+                              _name + "_get_" + coldField.name() + "(_value)");
+        }
+    }
+}
+
+void ComplexType::writeNodesRelease(google::protobuf::io::Printer& printer,
+                                    const Field& field,
+                                    const std::string& value,
+                                    bool pooled)
+{
+    const auto complexType =
+        std::dynamic_pointer_cast<const ComplexType>(field.type());
+    printer.Print("while ($list$.next != NULL) {\n", "list", value);
+    printer.Indent();
+    printer.Print("jaeger_list* node = $list$.next;\n"
+                  "$list$.next = node->next;\n",
+                  "list",
+                  value);
+    if (field.inlineCapacity() != 0) {
+        printer.Print("if (jaeger_list_inline_owns(\n"
+                      "        &$list$_inline, "
+                      "sizeof($list$_inline.nodes[0]), $capacity$, "
+                      "node)) {\n"
+                      "  continue;\n"
+                      "}\n",
+                      "list",
+                      value,
+                      "capacity",
+                      std::to_string(field.inlineCapacity()));
+    }
+    if (complexType && pooled) {
+        printer.Print("$type$_node_pool_release(node);\n",
+                      "type",
+                      complexType->name());
+    }
+    else {
+        if (complexType) {
+            printer.Print(
+                "$type$_destroy(JAEGER_LIST_NODE_VALUE($type$, node));\n",
+                "type",
+                complexType->name());
+        }
+        else if (field.type()->name() == "jaeger_string") {
+            printer.Print(
+                "jaeger_string_destroy("
+                "JAEGER_LIST_NODE_VALUE(jaeger_string, node));\n");
+        }
+        printer.Print("jaeger_free(node);\n");
+    }
+    printer.Outdent();
+    printer.Print("}\n"
+                  "$list$.prev = NULL;\n",
+                  "list",
+                  value);
+}
+
+bool ComplexType::writeDestroy(google::protobuf::io::Printer& printer,
+                               const Field& field,
+                               const std::string& value,
+                               bool pooled)
+{
+    const auto complexType =
+        std::dynamic_pointer_cast<const ComplexType>(field.type());
+    if (field.indirect()) {
+        printer.Print("if ($value$ != NULL) {\n"
+                      "  $type$_destroy($value$);\n"
+                      "  jaeger_free($value$);\n"
+                      "  $value$ = NULL;\n"
+                      "}\n",
+                      "type",
+                      complexType->name(),
+                      "value",
+                      value);
+        return true;
+    }
+    if (field.repeated()) {
+        writeNodesRelease(printer, field, value, pooled);
+        if (field.inlineCapacity() != 0) {
+            // Unused inline nodes may still hold buffers from earlier uses.
+            writeInlineValues(printer,
+                              field,
+                              value,
+                              "destroy",
+                              "0",
+                              std::to_string(field.inlineCapacity()));
+            printer.Print("$list$_inline.size = 0;\n", "list", value);
+        }
+        return true;
+    }
+    if (complexType) {
+        printer.Print("$type$_destroy(&$value$);\n",
+                      "type",
+                      complexType->name(),
+                      "value",
+                      value);
+        return true;
+    }
+    if (field.type()->name() == "jaeger_string") {
+        printer.Print("jaeger_string_destroy(&$value$);\n", "value", value);
+        return true;
+    }
+    return false;
+}
+
+bool ComplexType::writeClear(google::protobuf::io::Printer& printer,
+                             const Field& field,
+                             const std::string& value,
+                             bool pooled)
+{
+    if (field.indirect()) {
+        // Keeps the cold fields allocated for reuse like other buffers.
+        printer.Print("if ($value$ != NULL) {\n"
+                      "  $type$_clear($value$);\n"
+                      "}\n",
+                      "type",
+                      field.type()->name(),
+                      "value",
+                      value);
+        return true;
+    }
+    if (field.repeated()) {
+        writeNodesRelease(printer, field, value, pooled);
+        if (field.inlineCapacity() != 0) {
+            // Inline nodes keep their buffers for the next appends.
+            writeInlineValues(
+                printer, field, value, "clear", "0", value + "_inline.size");
+            printer.Print("$list$_inline.size = 0;\n", "list", value);
+        }
+        return true;
+    }
+    if (const auto complexType =
+            std::dynamic_pointer_cast<const ComplexType>(field.type())) {
+        printer.Print("$type$_clear(&$value$);\n",
+                      "type",
+                      complexType->name(),
+                      "value",
+                      value);
+    }
+    else if (field.type()->name() == "jaeger_string") {
+        printer.Print("jaeger_string_clear(&$value$);\n", "value", value);
+    }
+    else {
+        printer.Print("$value$ = 0;\n", "value", value);
+    }
+    return true;
+}
+
+bool ComplexType::writeShrink(google::protobuf::io::Printer& printer,
+                              const Field& field,
+                              const std::string& value)
+{
+    const auto complexType =
+        std::dynamic_pointer_cast<const ComplexType>(field.type());
+    const auto isString = (field.type()->name() == "jaeger_string");
+    if (!complexType && !isString) {
+        return false;
+    }
+    if (field.indirect()) {
+        printer.Print("if ($value$ != NULL) {\n"
+                      "  $type$_shrink($value$);\n"
+                      "}\n",
+                      "type",
+                      complexType->name(),
+                      "value",
+                      value);
+        return true;
+    }
+    if (field.repeated()) {
+        printer.Print("{\n"
+                      "  jaeger_list* node;\n"
+                      "  JAEGER_LIST_FOR_EACH(&$list$, node) {\n",
+                      "list",
+                      value);
+        if (complexType) {
+            printer.Print(
+                "    $type$_shrink(JAEGER_LIST_NODE_VALUE($type$, node));\n",
+                "type",
+                complexType->name());
+        }
+        else {
+            printer.Print("    jaeger_string_shrink("
+                          "JAEGER_LIST_NODE_VALUE(jaeger_string, node));\n");
+        }
+        printer.Print("  }\n"
+                      "}\n");
+        writeInlineValues(printer,
+                          field,
+                          value,
+                          "shrink",
+                          value + "_inline.size",
+                          std::to_string(field.inlineCapacity()));
+        return true;
+    }
+    if (complexType) {
+        printer.Print("$type$_shrink(&$value$);\n",
+                      "type",
+                      complexType->name(),
+                      "value",
+                      value);
+    }
+    else {
+        printer.Print("jaeger_string_shrink(&$value$);\n", "value", value);
+    }
+    return true;
+}
+
+bool ComplexType::writeMemoryUsage(google::protobuf::io::Printer& printer,
+                                   const Field& field,
+                                   const std::string& value)
+{
+    const auto complexType =
+        std::dynamic_pointer_cast<const ComplexType>(field.type());
+    const auto isString = (field.type()->name() == "jaeger_string");
+    const std::map<std::string, std::string> vars{
+        { "type", field.type()->name() },
+        { "value", value },
+        { "capacity", std::to_string(field.inlineCapacity()) }
+    };
+    if (field.indirect()) {
+        printer.Print(vars,
+                      "if ($value$ != NULL) {\n"
+                      "  size += sizeof(*$value$) + "
+                      "$type$_memory_usage($value$);\n"
+                      "}\n");
+        return true;
+    }
+    if (field.repeated()) {
+        printer.Print(vars,
+                      "{\n"
+                      "  const jaeger_list* node;\n"
+                      "  JAEGER_LIST_FOR_EACH(&$value$, node) {\n");
+        printer.Indent();
+        printer.Indent();
+        if (field.inlineCapacity() != 0) {
+            printer.Print(vars,
+                          "if (!jaeger_list_inline_owns(\n"
+                          "        &$value$_inline, "
+                          "sizeof($value$_inline.nodes[0]), $capacity$, "
+                          "node)) {\n"
+                          "  size += sizeof($value$_inline.nodes[0]);\n"
+                          "}\n");
+        }
+        else {
+            printer.Print(vars, "size += sizeof(JAEGER_LIST($type$));\n");
+        }
+        if (complexType) {
+            printer.Print(vars,
+                          "size += $type$_memory_usage("
+                          "JAEGER_LIST_NODE_VALUE($type$, node));\n");
+        }
+        else if (isString) {
+            printer.Print("size += jaeger_string_memory_usage("
+                          "JAEGER_LIST_NODE_VALUE(jaeger_string, node));\n");
+        }
+        printer.Outdent();
+        printer.Outdent();
+        printer.Print("  }\n"
+                      "}\n");
+        if (field.inlineCapacity() != 0 && (complexType || isString)) {
+            // Unused inline nodes keep the buffers of earlier uses.
+            printer.Print(vars,
+                          "{\n"
+                          "  size_t i;\n"
+                          "  for (i = $value$_inline.size; i < $capacity$; "
+                          "++i) {\n");
+            if (complexType) {
+                printer.Print(vars,
+                              "    size += $type$_memory_usage("
+                              "&$value$_inline.nodes[i].value);\n");
+            }
+            else {
+                printer.Print(vars,
+                              "    size += jaeger_string_memory_usage("
+                              "&$value$_inline.nodes[i].value);\n");
+            }
+            printer.Print("  }\n"
+                          "}\n");
+        }
+        return true;
+    }
+    if (complexType) {
+        printer.Print(vars, "size += $type$_memory_usage(&$value$);\n");
+        return true;
+    }
+    if (isString) {
+        printer.Print(vars, "size += jaeger_string_memory_usage(&$value$);\n");
+        return true;
+    }
+    return false;
+}
+
 }  // namespace compiler
 }  // namespace jaeger_struct
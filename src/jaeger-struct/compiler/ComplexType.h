@@ -17,6 +17,7 @@
 #ifndef JAEGER_STRUCT_COMPILER_COMPLEX_TYPE_H
 #define JAEGER_STRUCT_COMPILER_COMPLEX_TYPE_H
 
+#include <memory>
 #include <vector>
 
 #include <jaeger-struct/compiler/Field.h>
@@ -49,15 +50,101 @@ class ComplexType : public Type {
 
     const std::vector<Field>& fields() const { return _fields; }
 
+    // Whether values can be moved with memcpy, which they cannot if they
+    // hold inline list nodes that their lists point to.
+    bool relocatable() const;
+
+    // Whether the struct ends with a member encoded pointing to its
+    // jaeger_encoded_cache (runtime/codec.h), which the functions writing
+    // the struct make stale.
+    virtual bool cached() const { return false; }
+
+    // Types of the fields stored by value, which must be defined before this
+    // type. Lists only need their element types for inline nodes.
+    std::vector<std::shared_ptr<const Type>> valueTypes() const;
+
     virtual void
     writeDefinition(google::protobuf::io::Printer& printer) const = 0;
 
+    virtual void
+    writeFunctionDeclarations(google::protobuf::io::Printer& printer) const;
+
+    virtual void
+    writeFunctionDefinitions(google::protobuf::io::Printer& printer) const = 0;
+
+    // Writes the declarations of the table describing this type to the
+    // table-driven codec (runtime/codec.h).
+    virtual void
+    writeTableDeclarations(google::protobuf::io::Printer& printer) const;
+
+    virtual void
+    writeTableDefinitions(google::protobuf::io::Printer& printer) const;
+
+    // Writes the jaeger_struct::View and jaeger_struct::Traits
+    // specializations used by the C++ wrappers.
+    void writeCppDefinition(google::protobuf::io::Printer& printer) const;
+
   protected:
+    // Returns the member expression for field relative to the struct.
+    virtual std::string memberPath(const Field& field) const
+    {
+        return field.name();
+    }
+
+    virtual void
+    writeViewAccessors(google::protobuf::io::Printer& printer) const;
+
     void writeBracedDefinition(google::protobuf::io::Printer& printer) const;
 
+    // Writes the destroy, clear, shrink and memory_usage functions of a
+    // struct of fields().
+    void writeReleaseFunctions(google::protobuf::io::Printer& printer,
+                               bool pooled) const;
+
+    // Writes the append functions of the fields with inline capacity, which
+    // take inline nodes first. If pooled, list nodes of messages spill to
+    // their node pools.
+    void writeAppendFunctions(google::protobuf::io::Printer& printer,
+                              bool pooled) const;
+
+    // Writes the statements releasing the memory owned by field, accessed as
+    // value. Returns false if the field owns no memory. If pooled, list nodes
+    // of messages go back to their node pools. Indirect fields are freed and
+    // reset to NULL.
+    static bool writeDestroy(google::protobuf::io::Printer& printer,
+                             const Field& field,
+                             const std::string& value,
+                             bool pooled = false);
+
+    // Writes the statements emptying field while keeping its buffers, except
+    // for list nodes, which are destroyed unless pooled.
+    static bool writeClear(google::protobuf::io::Printer& printer,
+                           const Field& field,
+                           const std::string& value,
+                           bool pooled);
+
+    // Writes the statements releasing the unused capacity of field. Returns
+    // false if field has no capacity.
+    static bool writeShrink(google::protobuf::io::Printer& printer,
+                            const Field& field,
+                            const std::string& value);
+
+    // Writes the statements adding the bytes allocated for field, accessed
+    // as value, to size. Returns false if the field allocates nothing.
+    static bool writeMemoryUsage(google::protobuf::io::Printer& printer,
+                                 const Field& field,
+                                 const std::string& value);
+
     std::vector<Field>& fields() { return _fields; }
 
   private:
+    // Writes the loop unlinking the list nodes of field, which destroys or
+    // pools them like writeDestroy, except for inline nodes.
+    static void writeNodesRelease(google::protobuf::io::Printer& printer,
+                                  const Field& field,
+                                  const std::string& value,
+                                  bool pooled);
+
     std::string _name;
     std::vector<Field> _fields;
 };
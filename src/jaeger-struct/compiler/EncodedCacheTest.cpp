@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <jaeger.h>
+
+namespace jaeger_struct {
+namespace compiler {
+namespace {
+
+typedef JAEGER_LIST(jaegertracing_protobuf_span) SpanNode;
+typedef JAEGER_LIST(jaegertracing_protobuf_tag) TagNode;
+
+void assign(jaeger_string& str, const char* value)
+{
+    ASSERT_TRUE(jaeger_string_assign(&str, value, std::strlen(value)));
+}
+
+void appendTag(jaeger_list& tags, const char* key, const char* value)
+{
+    auto* node = static_cast<TagNode*>(jaeger_malloc(sizeof(TagNode)));
+    ASSERT_NE(nullptr, node);
+    std::memset(node, 0, sizeof(*node));
+    assign(node->value.key, key);
+    node->value.value.type = jaegertracing_protobuf_tag_value_str_value_type;
+    assign(node->value.value.value.str_value, value);
+    jaeger_list_append(&tags, &node->base);
+}
+
+void appendSpan(jaegertracing_protobuf_batch& batch, std::uint64_t spanID)
+{
+    auto* node = static_cast<SpanNode*>(jaeger_malloc(sizeof(SpanNode)));
+    ASSERT_NE(nullptr, node);
+    std::memset(node, 0, sizeof(*node));
+    node->value.span_id = spanID;
+    assign(node->value.operation_name, "get");
+    jaeger_list_append(&batch.spans, &node->base);
+}
+
+void setProcess(jaegertracing_protobuf_process& process, const char* name)
+{
+    ASSERT_TRUE(jaegertracing_protobuf_process_set_service_name(
+        &process, name, std::strlen(name)));
+    auto* tags = jaegertracing_protobuf_process_mutable_tags(&process);
+    appendTag(*tags, "hostname", "host-1");
+    appendTag(*tags, "ip", "10.0.0.1");
+}
+
+std::string encode(const jaegertracing_protobuf_batch& batch)
+{
+    jaeger_buffer buffer;
+    std::memset(&buffer, 0, sizeof(buffer));
+    std::string result;
+    if (jaegertracing_protobuf_batch_encode(&batch, &buffer)) {
+        result.assign(reinterpret_cast<const char*>(buffer.data), buffer.size);
+    }
+    jaeger_buffer_destroy(&buffer);
+    return result;
+}
+
+std::string encodeIov(const jaegertracing_protobuf_batch& batch)
+{
+    jaeger_iov_buffer buffer;
+    jaeger_iov_buffer_init(&buffer, 8);
+    std::string result;
+    if (jaegertracing_protobuf_batch_encode_iov(&batch, &buffer)) {
+        for (auto i = 0u; i < buffer.count; ++i) {
+            result.append(static_cast<const char*>(buffer.iov[i].iov_base),
+                          buffer.iov[i].iov_len);
+        }
+    }
+    jaeger_iov_buffer_destroy(&buffer);
+    return result;
+}
+
+// Encodes batch with its process's frozen encoding set aside.
+std::string encodeFresh(jaegertracing_protobuf_batch& batch)
+{
+    auto* cache = batch.process.encoded;
+    batch.process.encoded = nullptr;
+    const auto result = encode(batch);
+    batch.process.encoded = cache;
+    return result;
+}
+
+}  // anonymous namespace
+
+TEST(EncodedCache, testSplice)
+{
+    jaegertracing_protobuf_batch batch;
+    std::memset(&batch, 0, sizeof(batch));
+    setProcess(batch.process, "frontend");
+    for (auto i = 1; i <= 3; ++i) {
+        appendSpan(batch, i);
+    }
+    const auto expected = encode(batch);
+    ASSERT_FALSE(expected.empty());
+
+    ASSERT_TRUE(jaegertracing_protobuf_process_freeze(&batch.process));
+    ASSERT_NE(nullptr, batch.process.encoded);
+    ASSERT_EQ(expected, encode(batch));
+    ASSERT_EQ(expected, encodeIov(batch));
+    ASSERT_EQ(expected.size(),
+              jaegertracing_protobuf_batch_encoded_size(&batch));
+
+    // Writing a member directly goes unnoticed until touched: the frozen
+    // bytes are spliced in.
+    batch.process.service_name.buffer[0] = 'F';
+    ASSERT_EQ(expected, encode(batch));
+    jaegertracing_protobuf_process_touch(&batch.process);
+    ASSERT_NE(expected, encode(batch));
+    ASSERT_EQ(encodeFresh(batch), encode(batch));
+    ASSERT_EQ(encodeFresh(batch), encodeIov(batch));
+
+    const auto usage = jaegertracing_protobuf_process_memory_usage(
+        &batch.process);
+    jaeger_encoded_cache_destroy(&batch.process.encoded);
+    ASSERT_GT(usage,
+              jaegertracing_protobuf_process_memory_usage(&batch.process));
+    jaegertracing_protobuf_batch_destroy(&batch);
+}
+
+TEST(EncodedCache, testStale)
+{
+    jaegertracing_protobuf_batch batch;
+    std::memset(&batch, 0, sizeof(batch));
+    setProcess(batch.process, "frontend");
+    appendSpan(batch, 1);
+
+    ASSERT_TRUE(jaegertracing_protobuf_process_freeze(&batch.process));
+    ASSERT_TRUE(jaegertracing_protobuf_process_set_service_name(
+        &batch.process, "backend", 7));
+    ASSERT_EQ(encodeFresh(batch), encode(batch));
+
+    ASSERT_TRUE(jaegertracing_protobuf_process_freeze(&batch.process));
+    appendTag(*jaegertracing_protobuf_process_mutable_tags(&batch.process),
+              "zone",
+              "a");
+    ASSERT_EQ(encodeFresh(batch), encode(batch));
+
+    // Freezing again brings the encoding up to date.
+    ASSERT_TRUE(jaegertracing_protobuf_process_freeze(&batch.process));
+    const auto expected = encodeFresh(batch);
+    ASSERT_EQ(expected, encode(batch));
+
+    // Decoding into the process writes it too.
+    jaegertracing_protobuf_process other;
+    std::memset(&other, 0, sizeof(other));
+    setProcess(other, "database");
+    jaeger_buffer buffer;
+    std::memset(&buffer, 0, sizeof(buffer));
+    ASSERT_TRUE(jaegertracing_protobuf_process_encode(&other, &buffer));
+    jaegertracing_protobuf_process_clear(&batch.process);
+    ASSERT_TRUE(jaegertracing_protobuf_process_freeze(&batch.process));
+    ASSERT_TRUE(jaegertracing_protobuf_process_decode(
+        &batch.process, buffer.data, buffer.size));
+    ASSERT_EQ(encodeFresh(batch), encode(batch));
+    ASSERT_NE(expected, encode(batch));
+
+    jaegertracing_protobuf_process_clear(&batch.process);
+    ASSERT_EQ(encodeFresh(batch), encode(batch));
+
+    jaeger_buffer_destroy(&buffer);
+    jaegertracing_protobuf_process_destroy(&other);
+    jaegertracing_protobuf_batch_destroy(&batch);
+}
+
+TEST(EncodedCache, testSplitParts)
+{
+    jaegertracing_protobuf_batch batch;
+    std::memset(&batch, 0, sizeof(batch));
+    setProcess(batch.process, "frontend");
+    for (auto i = 1; i <= 10; ++i) {
+        appendSpan(batch, i);
+    }
+    ASSERT_TRUE(jaegertracing_protobuf_process_freeze(&batch.process));
+
+    // Parts share the process, and so its frozen encoding.
+    jaegertracing_protobuf_batch part;
+    ASSERT_EQ(10u,
+              jaegertracing_protobuf_batch_split_spans(&batch, 1024, &part));
+    ASSERT_EQ(batch.process.encoded, part.process.encoded);
+    ASSERT_EQ(encodeFresh(part), encode(part));
+    jaegertracing_protobuf_batch_split_spans_release(&part);
+    jaegertracing_protobuf_batch_destroy(&batch);
+}
+
+TEST(EncodedCache, testSplitCached)
+{
+    jaegertracing_protobuf_process process;
+    std::memset(&process, 0, sizeof(process));
+    setProcess(process, "frontend");
+    auto* tags = jaegertracing_protobuf_process_mutable_tags(&process);
+    for (auto i = 0; i < 8; ++i) {
+        appendTag(*tags, "key", "value");
+    }
+    ASSERT_TRUE(jaegertracing_protobuf_process_freeze(&process));
+    const auto frozenSize =
+        jaegertracing_protobuf_process_encoded_size(&process);
+
+    // Splitting the cached message itself leaves neither side its encoding.
+    jaegertracing_protobuf_process part;
+    ASSERT_EQ(1u,
+              jaegertracing_protobuf_process_split_tags(&process, 40, &part));
+    ASSERT_EQ(nullptr, part.encoded);
+    ASSERT_GE(40u, jaegertracing_protobuf_process_encoded_size(&part));
+    ASSERT_GT(frozenSize,
+              jaegertracing_protobuf_process_encoded_size(&process));
+    jaeger_buffer buffer;
+    std::memset(&buffer, 0, sizeof(buffer));
+    ASSERT_TRUE(jaegertracing_protobuf_process_encode(&process, &buffer));
+    ASSERT_EQ(jaegertracing_protobuf_process_encoded_size(&process),
+              buffer.size);
+    jaeger_buffer_destroy(&buffer);
+    jaegertracing_protobuf_process_split_tags_release(&part);
+    jaegertracing_protobuf_process_destroy(&process);
+}
+
+}  // namespace compiler
+}  // namespace jaeger_struct
@@ -64,5 +64,31 @@ void Enum::writeDefinition(google::protobuf::io::Printer& printer) const
     printer.Print("\n} $name$;", "name", _name);
 }
 
+void Enum::writeTableDeclaration(google::protobuf::io::Printer& printer) const
+{
+    printer.Print("extern const jaeger_enum_table $name$_table;\n",
+                  "name",
+                  _name);
+}
+
+void Enum::writeTableDefinition(google::protobuf::io::Printer& printer) const
+{
+    printer.Print("static const int32_t $name$_values[] = { ", "name", _name);
+    for (auto itr = std::begin(_values); itr != std::end(_values); ++itr) {
+        if (itr != std::begin(_values)) {
+            printer.Print(", ");
+        }
+        printer.Print("$value$", "value", std::to_string(itr->value()));
+    }
+    printer.Print(" };\n\n"
+                  "const jaeger_enum_table $name$_table = {\n"
+                  "  \"$name$\", $name$_values, $count$\n"
+                  "};\n",
+                  "name",
+                  _name,
+                  "count",
+                  std::to_string(_values.size()));
+}
+
 }  // namespace compiler
 }  // namespace jaeger_struct
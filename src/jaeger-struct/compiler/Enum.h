@@ -66,8 +66,15 @@ class Enum : public Type {
 
     std::string name() const override { return _name; }
 
+    const std::set<Value>& values() const { return _values; }
+
     void writeDefinition(google::protobuf::io::Printer& printer) const;
 
+    // Writes the jaeger_enum_table for the table-driven codec.
+    void writeTableDeclaration(google::protobuf::io::Printer& printer) const;
+
+    void writeTableDefinition(google::protobuf::io::Printer& printer) const;
+
   private:
     std::string _name;
     std::set<Value> _values;
@@ -16,11 +16,14 @@
 
 #include <jaeger-struct/compiler/Field.h>
 
+#include <cstdint>
 #include <sstream>
 #include <stdexcept>
 
 #include <google/protobuf/descriptor.h>
+#include <google/protobuf/descriptor.pb.h>
 #include <google/protobuf/io/printer.h>
+#include <google/protobuf/unknown_field_set.h>
 
 #include <jaeger-struct/compiler/Strings.h>
 #include <jaeger-struct/compiler/TypeRegistry.h>
@@ -59,14 +62,49 @@ determineType(const google::protobuf::FieldDescriptor& field,
 #undef TYPE_MAPPING
 }
 
+// Numbers of the extensions in jaeger-struct/options.proto.
+constexpr int kColdOption = 50300;
+constexpr int kInlineCapacityOption = 50301;
+
 }  // anonymous namespace
 
+std::uint64_t varintOption(const google::protobuf::Message& options,
+                           int number)
+{
+    auto&& unknownFields =
+        options.GetReflection()->GetUnknownFields(options);
+    for (auto i = unknownFields.field_count() - 1; i >= 0; --i) {
+        auto&& unknownField = unknownFields.field(i);
+        if (unknownField.number() == number &&
+            unknownField.type() ==
+                google::protobuf::UnknownField::TYPE_VARINT) {
+            return unknownField.varint();
+        }
+    }
+    return 0;
+}
+
 Field::Field(const google::protobuf::FieldDescriptor& descriptor,
              const TypeRegistry& registry)
     : _type(determineType(descriptor, registry))
     , _repetition(descriptor.label())
     , _name(snakeCase(descriptor.name()))
+    , _number(descriptor.number())
+    , _protoType(descriptor.type())
+    , _packed(descriptor.is_packed())
+    , _cold(varintOption(descriptor.options(), kColdOption) != 0)
+    , _inlineCapacity(0)
+    , _indirect(false)
 {
+    if (descriptor.is_repeated()) {
+        _inlineCapacity = static_cast<std::uint32_t>(
+            varintOption(descriptor.options(), kInlineCapacityOption));
+    }
+}
+
+bool Field::repeated() const
+{
+    return _repetition == google::protobuf::FieldDescriptor::LABEL_REPEATED;
 }
 
 void Field::writeDefinition(google::protobuf::io::Printer& printer) const
@@ -84,8 +122,21 @@ void Field::writeDefinition(google::protobuf::io::Printer& printer) const
         typeStr = "jaeger_list";
         break;
     }
+    if (_indirect) {
+        typeStr += "*";
+    }
 
     printer.Print("$type$ $name$;", "type", typeStr, "name", _name);
+    if (_inlineCapacity != 0) {
+        printer.Print("\nJAEGER_LIST_INLINE($type$, $capacity$) "
+                      "$name$_inline;",
+                      "type",
+                      _type->name(),
+                      "capacity",
+                      std::to_string(_inlineCapacity),
+                      "name",
+                      _name);
+    }
 }
 
 }  // namespace compiler
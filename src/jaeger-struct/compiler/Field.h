@@ -17,6 +17,7 @@
 #ifndef JAEGER_STRUCT_COMPILER_FIELD_H
 #define JAEGER_STRUCT_COMPILER_FIELD_H
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -31,6 +32,7 @@ class Printer;
 }  // namespace io
 
 class FieldDescriptor;
+class Message;
 
 }  // namespace protobuf
 }  // namespace google
@@ -45,25 +47,70 @@ class Field {
     Field(const google::protobuf::FieldDescriptor& descriptor,
           const TypeRegistry& registry);
 
+    // A field without a protobuf counterpart, such as a oneof. If indirect,
+    // the member is a pointer to type.
     Field(const std::shared_ptr<const Type>& type,
           int repetition,
-          const std::string& name)
+          const std::string& name,
+          bool indirect = false)
         : _type(type)
         , _repetition(repetition)
         , _name(name)
+        , _number(0)
+        , _protoType(0)
+        , _packed(false)
+        , _cold(false)
+        , _inlineCapacity(0)
+        , _indirect(indirect)
     {
     }
 
     const std::string& name() const { return _name; }
 
+    // Field number, or zero for fields without one such as oneofs.
+    int number() const { return _number; }
+
+    // google::protobuf::FieldDescriptor::Type, or zero if there is no
+    // corresponding protobuf field.
+    int protoType() const { return _protoType; }
+
+    bool packed() const { return _packed; }
+
+    // Marked with the (jaeger_struct.cold) option of
+    // jaeger-struct/options.proto.
+    bool cold() const { return _cold; }
+
+    // Number of list nodes stored in the struct, from the
+    // (jaeger_struct.inline_capacity) option of a repeated field, or zero.
+    std::uint32_t inlineCapacity() const { return _inlineCapacity; }
+
+    bool indirect() const { return _indirect; }
+
+    const std::shared_ptr<const Type>& type() const { return _type; }
+
+    bool repeated() const;
+
     void writeDefinition(google::protobuf::io::Printer& printer) const;
 
   private:
     std::shared_ptr<const Type> _type;
     int _repetition;
     std::string _name;
+    int _number;
+    int _protoType;
+    bool _packed;
+    bool _cold;
+    std::uint32_t _inlineCapacity;
+    bool _indirect;
 };
 
+// Returns the value of the varint extension numbered number of options,
+// such as a descriptor's FieldOptions, or zero if unset. The plugin does not
+// link the code generated for options.proto, so the extensions arrive as
+// unknown fields.
+std::uint64_t varintOption(const google::protobuf::Message& options,
+                           int number);
+
 }  // namespace compiler
 }  // namespace jaeger_struct
 
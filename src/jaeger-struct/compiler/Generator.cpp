@@ -16,15 +16,21 @@
 
 #include <jaeger-struct/compiler/Generator.h>
 
+#include <algorithm>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <unordered_set>
+#include <vector>
 
 #include <google/protobuf/compiler/plugin.h>
 #include <google/protobuf/descriptor.h>
+#include <google/protobuf/descriptor.pb.h>
 #include <google/protobuf/io/printer.h>
 #include <google/protobuf/io/zero_copy_stream.h>
 
+#include <jaeger-struct/compiler/Bindings.h>
+#include <jaeger-struct/compiler/Columns.h>
 #include <jaeger-struct/compiler/Enum.h>
 #include <jaeger-struct/compiler/Strings.h>
 #include <jaeger-struct/compiler/Struct.h>
@@ -35,6 +41,70 @@ namespace jaeger_struct {
 namespace compiler {
 namespace {
 
+struct Options {
+    Options()
+        : _columns(false)
+        , _cpp(false)
+        , _tableCodec(false)
+        , _pool(false)
+        , _python(false)
+        , _go(false)
+        , _goPackage()
+        , _split(false)
+    {
+    }
+
+    bool _columns;
+    bool _cpp;
+    bool _tableCodec;
+    bool _pool;
+    bool _python;
+    bool _go;
+    std::string _goPackage;
+    bool _split;
+};
+
+bool parseOptions(const std::string& parameter,
+                  Options& options,
+                  std::string& error)
+{
+    std::vector<std::pair<std::string, std::string>> pairs;
+    google::protobuf::compiler::ParseGeneratorParameter(parameter, &pairs);
+    for (auto&& pair : pairs) {
+        if (pair.first == "columns") {
+            options._columns = true;
+        }
+        else if (pair.first == "cpp") {
+            options._cpp = true;
+        }
+        else if (pair.first == "codec") {
+            if (pair.second != "table") {
+                error = "Unknown codec: " + pair.second;
+                return false;
+            }
+            options._tableCodec = true;
+        }
+        else if (pair.first == "pool") {
+            options._pool = true;
+        }
+        else if (pair.first == "python") {
+            options._python = true;
+        }
+        else if (pair.first == "go") {
+            options._go = true;
+            options._goPackage = pair.second;
+        }
+        else if (pair.first == "split") {
+            options._split = true;
+        }
+        else {
+            error = "Unknown generator option: " + pair.first;
+            return false;
+        }
+    }
+    return true;
+}
+
 struct Context {
     Context(google::protobuf::compiler::GeneratorContext& context,
             std::string& error)
@@ -77,13 +147,42 @@ std::string stripProto(const std::string& str)
     return str;
 }
 
+std::string baseName(const std::string& str)
+{
+    const auto pos = str.rfind('/');
+    if (pos == std::string::npos) {
+        return str;
+    }
+    return str.substr(pos + 1);
+}
+
 void writeProlog(google::protobuf::io::Printer& printer,
-                 const std::string& guard)
+                 const std::string& guard,
+                 const Options& options,
+                 const std::vector<std::string>& headers =
+                     std::vector<std::string>())
 {
     printer.Print("#ifndef $guard$_H\n", "guard", guard);
     printer.Print("#define $guard$_H\n\n", "guard", guard);
+    if (options._columns) {
+        printer.Print("#include <jaeger-struct/runtime/column.h>\n");
+        printer.Print("#include <jaeger-struct/runtime/compress.h>\n");
+    }
+    if (options._tableCodec) {
+        printer.Print("#include <jaeger-struct/runtime/codec.h>\n");
+        printer.Print("#include <jaeger-struct/runtime/split.h>\n");
+    }
+    if (options._pool) {
+        printer.Print("#include <jaeger-struct/runtime/pool.h>\n");
+    }
     printer.Print("#include <jaeger-struct/runtime/list.h>\n");
     printer.Print("#include <jaeger-struct/runtime/string.h>\n\n");
+    for (auto&& header : headers) {
+        printer.Print("#include \"$header$\"\n", "header", header);
+    }
+    if (!headers.empty()) {
+        printer.Print("\n");
+    }
     printer.Print("#ifdef __cplusplus\n");
     printer.Print("extern \"C\" {\n");
     printer.Print("#endif /* __cplusplus */\n\n");
@@ -98,49 +197,340 @@ void writeEpilog(google::protobuf::io::Printer& printer,
     printer.Print("#endif /* $guard$_H */\n", "guard", guard);
 }
 
-void generateTypes(const google::protobuf::FileDescriptor& file,
-                   google::protobuf::io::Printer& printer,
-                   TypeRegistry& registry)
+// Types defined together: a top-level message with its nested enums, its
+// oneofs and its cold fields, or the enums at file level, which have no
+// owner. Split headers define each message's unit in a header of its own.
+struct Unit {
+    std::string _owner;
+    std::vector<std::shared_ptr<const Enum>> _enums;
+    std::vector<std::shared_ptr<const ComplexType>> _complexTypes;
+    std::vector<Columns> _columns;
+};
+
+std::vector<Unit> generateTypes(const google::protobuf::FileDescriptor& file,
+                                TypeRegistry& registry,
+                                bool pooled,
+                                bool tableCodec)
 {
+    std::vector<Unit> units(1);
+
     for (auto i = 0, len = file.enum_type_count(); i < len; ++i) {
         auto&& enumDescriptor = *file.enum_type(i);
         auto e = std::make_shared<const Enum>(enumDescriptor);
-        printer.Print("\n");
-        e->writeDefinition(printer);
-        printer.Print("\n");
         registry.registerType(std::static_pointer_cast<const Type>(e));
+        units.front()._enums.emplace_back(e);
     }
 
     for (auto i = 0, len = file.message_type_count(); i < len; ++i) {
         auto&& message = *file.message_type(i);
+        units.emplace_back();
+        auto& unit = units.back();
+        unit._owner = snakeCase(message.name());
 
         for (auto j = 0, len = message.enum_type_count(); j < len; ++j) {
             auto&& enumDescriptor = *message.enum_type(j);
             auto e = std::make_shared<const Enum>(enumDescriptor);
-            printer.Print("\n");
-            e->writeDefinition(printer);
-            printer.Print("\n");
-            registry.registerType(std::static_pointer_cast<const Type>(e));
+            registry.registerType(std::static_pointer_cast<const Type>(e),
+                                  unit._owner);
+            unit._enums.emplace_back(e);
         }
 
         for (auto j = 0, oneOfLen = message.oneof_decl_count(); j < oneOfLen;
              ++j) {
             auto&& oneOf = *message.oneof_decl(j);
             auto u = std::make_shared<const Union>(oneOf, registry);
+            registry.registerType(std::static_pointer_cast<const Type>(u),
+                                  unit._owner);
+            unit._complexTypes.emplace_back(u);
+        }
+
+        auto s = std::make_shared<const Struct>(
+            message, registry, pooled, tableCodec);
+        if (auto cold = s->cold()) {
+            unit._complexTypes.emplace_back(cold);
+        }
+        registry.registerType(std::static_pointer_cast<const Type>(s),
+                              unit._owner);
+        unit._complexTypes.emplace_back(s);
+    }
+
+    return units;
+}
+
+void generateColumns(std::vector<Unit>& units)
+{
+    for (auto&& unit : units) {
+        for (auto&& complexType : unit._complexTypes) {
+            if (auto s = std::dynamic_pointer_cast<const Struct>(complexType)) {
+                unit._columns.emplace_back(*s);
+            }
+        }
+    }
+}
+
+// Owners of the other units whose types the definitions of unit store by
+// value. Columns also store the child columns of repeated messages, so with
+// columns every message referenced counts.
+std::vector<std::string> dependencies(const Unit& unit,
+                                      const TypeRegistry& registry,
+                                      bool columns)
+{
+    std::vector<std::string> owners;
+    for (auto&& complexType : unit._complexTypes) {
+        auto types = complexType->valueTypes();
+        if (columns) {
+            for (auto&& field : complexType->fields()) {
+                types.emplace_back(field.type());
+            }
+        }
+        for (auto&& type : types) {
+            const auto owner = registry.ownerOf(type->name());
+            if (!owner.empty() && owner != unit._owner &&
+                std::find(std::begin(owners), std::end(owners), owner) ==
+                    std::end(owners)) {
+                owners.emplace_back(owner);
+            }
+        }
+    }
+    return owners;
+}
+
+void writeDefinitions(const Unit& unit, google::protobuf::io::Printer& printer)
+{
+    for (auto&& e : unit._enums) {
+        printer.Print("\n");
+        e->writeDefinition(printer);
+        printer.Print("\n");
+    }
+    for (auto&& complexType : unit._complexTypes) {
+        printer.Print("\n");
+        complexType->writeDefinition(printer);
+        printer.Print("\n");
+    }
+}
+
+// Writes the definitions and declarations of units, in the order of the
+// single header: every definition comes before any function.
+void writeHeaderBody(const std::vector<const Unit*>& units,
+                     const Options& options,
+                     google::protobuf::io::Printer& printer)
+{
+    for (auto&& unit : units) {
+        writeDefinitions(*unit, printer);
+    }
+    for (auto&& unit : units) {
+        for (auto&& column : unit->_columns) {
+            printer.Print("\n");
+            column.writeDefinition(printer);
+            printer.Print("\n");
+        }
+    }
+    for (auto&& unit : units) {
+        for (auto&& complexType : unit->_complexTypes) {
             printer.Print("\n");
-            u->writeDefinition(printer);
+            complexType->writeFunctionDeclarations(printer);
+        }
+    }
+    for (auto&& unit : units) {
+        for (auto&& column : unit->_columns) {
+            printer.Print("\n");
+            column.writeFunctionDeclarations(printer);
+        }
+    }
+    if (options._tableCodec) {
+        for (auto&& unit : units) {
+            for (auto&& e : unit->_enums) {
+                printer.Print("\n");
+                e->writeTableDeclaration(printer);
+            }
+        }
+        for (auto&& unit : units) {
+            for (auto&& complexType : unit->_complexTypes) {
+                printer.Print("\n");
+                complexType->writeTableDeclarations(printer);
+            }
+        }
+    }
+    if (options._pool) {
+        for (auto&& unit : units) {
+            for (auto&& complexType : unit->_complexTypes) {
+                if (auto s =
+                        std::dynamic_pointer_cast<const Struct>(complexType)) {
+                    printer.Print("\n");
+                    s->writePoolDeclarations(printer);
+                }
+            }
+        }
+    }
+}
+
+// Writes the file level enums, which cannot be declared without their
+// values, and a typedef for every struct.
+void writeForwardDeclarations(const std::string& guard,
+                              const std::vector<Unit>& units,
+                              google::protobuf::io::Printer& printer)
+{
+    printer.Print("#ifndef $guard$_H\n", "guard", guard);
+    printer.Print("#define $guard$_H\n", "guard", guard);
+    writeDefinitions(units.front(), printer);
+    printer.Print("\n");
+    for (auto&& unit : units) {
+        for (auto&& complexType : unit._complexTypes) {
+            printer.Print("typedef struct $name$ $name$;\n",
+                          "name",
+                          complexType->name());
+        }
+        for (auto&& column : unit._columns) {
+            printer.Print(
+                "typedef struct $name$ $name$;\n", "name", column.name());
+        }
+    }
+    printer.Print("\n#endif /* $guard$_H */\n", "guard", guard);
+}
+
+// Writes a header per message, including the forward declarations and the
+// headers of the messages it stores by value, and the file's header, which
+// includes them all.
+void writeSplitHeaders(const std::string& fileName,
+                       const std::vector<Unit>& units,
+                       const TypeRegistry& registry,
+                       const Options& options,
+                       Context& context)
+{
+    const auto prefix = stripProto(fileName);
+    const auto fwdFileName = prefix + "_fwd.h";
+    context.openFile(fwdFileName);
+    writeForwardDeclarations(
+        capsCase(fwdFileName), units, *context._printer);
+
+    std::vector<std::string> headers{ baseName(fwdFileName) };
+    for (auto itr = std::next(std::begin(units)); itr != std::end(units);
+         ++itr) {
+        std::vector<std::string> includes{ baseName(fwdFileName) };
+        for (auto&& owner :
+             dependencies(*itr, registry, options._columns)) {
+            includes.emplace_back(baseName(prefix) + "_" + owner + ".h");
+        }
+        const auto unitFileName = prefix + "_" + itr->_owner + ".h";
+        context.openFile(unitFileName);
+        const auto guard = capsCase(unitFileName);
+        writeProlog(*context._printer, guard, options, includes);
+        writeHeaderBody({ &*itr }, options, *context._printer);
+        writeEpilog(*context._printer, guard);
+        headers.emplace_back(baseName(unitFileName));
+    }
+
+    const auto headerFileName = prefix + ".h";
+    context.openFile(headerFileName);
+    auto& printer = *context._printer;
+    const auto guard = capsCase(headerFileName);
+    printer.Print("#ifndef $guard$_H\n", "guard", guard);
+    printer.Print("#define $guard$_H\n\n", "guard", guard);
+    for (auto&& header : headers) {
+        printer.Print("#include \"$header$\"\n", "header", header);
+    }
+    const auto& enums = units.front()._enums;
+    if (options._tableCodec && !enums.empty()) {
+        printer.Print("\n#include <jaeger-struct/runtime/codec.h>\n\n");
+        printer.Print("#ifdef __cplusplus\n");
+        printer.Print("extern \"C\" {\n");
+        printer.Print("#endif /* __cplusplus */\n");
+        for (auto&& e : enums) {
             printer.Print("\n");
-            registry.registerType(std::static_pointer_cast<const Type>(u));
+            e->writeTableDeclaration(printer);
         }
+        printer.Print("\n#ifdef __cplusplus\n");
+        printer.Print("}\n");
+        printer.Print("#endif /* __cplusplus */\n");
+    }
+    printer.Print("\n#endif /* $guard$_H */\n", "guard", guard);
+}
 
-        auto s = std::make_shared<const Struct>(message, registry);
+void writeTableDefinitions(
+    const std::vector<std::shared_ptr<const Enum>>& enums,
+    const std::vector<std::shared_ptr<const ComplexType>>& complexTypes,
+    google::protobuf::io::Printer& printer)
+{
+    for (auto&& e : enums) {
         printer.Print("\n");
-        s->writeDefinition(printer);
+        e->writeTableDefinition(printer);
+    }
+    for (auto&& complexType : complexTypes) {
         printer.Print("\n");
-        registry.registerType(std::static_pointer_cast<const Type>(s));
+        complexType->writeTableDefinitions(printer);
     }
 }
 
+void writePoolDefinitions(
+    const std::vector<std::shared_ptr<const ComplexType>>& complexTypes,
+    google::protobuf::io::Printer& printer)
+{
+    for (auto&& complexType : complexTypes) {
+        if (auto s = std::dynamic_pointer_cast<const Struct>(complexType)) {
+            printer.Print("\n");
+            s->writePoolDefinitions(printer);
+        }
+    }
+}
+
+void writeFunctionDefinitions(
+    const std::string& header,
+    const std::vector<std::shared_ptr<const ComplexType>>& complexTypes,
+    const std::vector<Columns>& columns,
+    google::protobuf::io::Printer& printer)
+{
+    printer.Print("#include \"$header$\"\n\n", "header", header);
+    printer.Print("#include <string.h>\n");
+    for (auto&& complexType : complexTypes) {
+        printer.Print("\n");
+        complexType->writeFunctionDefinitions(printer);
+    }
+    for (auto&& column : columns) {
+        printer.Print("\n");
+        column.writeFunctionDefinitions(printer);
+    }
+}
+
+void writeCppWrappers(
+    const std::string& header,
+    const std::string& guard,
+    const std::vector<std::shared_ptr<const ComplexType>>& complexTypes,
+    google::protobuf::io::Printer& printer)
+{
+    printer.Print("#ifndef $guard$\n", "guard", guard);
+    printer.Print("#define $guard$\n\n", "guard", guard);
+    printer.Print("#include <array>\n"
+                  "#include <cstddef>\n\n"
+                  "#include <jaeger-struct/runtime/view.hpp>\n\n");
+    printer.Print("#include \"$header$\"\n\n", "header", header);
+    printer.Print("namespace jaeger_struct {\n");
+    for (auto&& complexType : complexTypes) {
+        printer.Print("\n");
+        complexType->writeCppDefinition(printer);
+    }
+    printer.Print("\n}  // namespace jaeger_struct\n\n");
+    printer.Print("#endif  // $guard$\n", "guard", guard);
+}
+
+// Package named by the go_package option, else by the last component of the
+// proto package, else by the file.
+std::string goPackage(const google::protobuf::FileDescriptor& file)
+{
+    auto package = file.options().go_package();
+    const auto semicolon = package.find(';');
+    if (semicolon != std::string::npos) {
+        package = package.substr(semicolon + 1);
+    }
+    if (package.empty()) {
+        package = file.package();
+        package = package.substr(package.rfind('.') + 1);
+    }
+    if (package.empty()) {
+        package = stripProto(baseName(file.name()));
+    }
+    return snakeCase(makeIdentifier(baseName(package)));
+}
+
 }  // anonymous namespace
 
 bool Generator::Generate(const google::protobuf::FileDescriptor* file,
@@ -148,14 +538,81 @@ bool Generator::Generate(const google::protobuf::FileDescriptor* file,
                          google::protobuf::compiler::GeneratorContext* arg,
                          std::string* error) const
 {
+    Options options;
+    if (!parseOptions(parameter, options, *error)) {
+        return false;
+    }
+
     Context context(*arg, *error);
     const auto fileName = stripProto(file->name()) + ".h";
-    context.openFile(fileName);
-    const auto guard = capsCase(fileName);
-    writeProlog(*context._printer, guard);
     TypeRegistry registry;
-    generateTypes(*file, *context._printer, registry);
-    writeEpilog(*context._printer, guard);
+    auto units =
+        generateTypes(*file, registry, options._pool, options._tableCodec);
+    if (options._columns) {
+        generateColumns(units);
+    }
+    std::vector<std::shared_ptr<const Enum>> enums;
+    std::vector<std::shared_ptr<const ComplexType>> complexTypes;
+    std::vector<Columns> columns;
+    std::vector<const Unit*> unitPointers;
+    for (auto&& unit : units) {
+        enums.insert(
+            std::end(enums), std::begin(unit._enums), std::end(unit._enums));
+        complexTypes.insert(std::end(complexTypes),
+                            std::begin(unit._complexTypes),
+                            std::end(unit._complexTypes));
+        columns.insert(std::end(columns),
+                       std::begin(unit._columns),
+                       std::end(unit._columns));
+        unitPointers.emplace_back(&unit);
+    }
+
+    if (options._split) {
+        writeSplitHeaders(file->name(), units, registry, options, context);
+    }
+    else {
+        context.openFile(fileName);
+        const auto guard = capsCase(fileName);
+        writeProlog(*context._printer, guard, options);
+        writeHeaderBody(unitPointers, options, *context._printer);
+        writeEpilog(*context._printer, guard);
+    }
+
+    context.openFile(stripProto(file->name()) + ".c");
+    writeFunctionDefinitions(
+        baseName(fileName), complexTypes, columns, *context._printer);
+    if (options._tableCodec) {
+        writeTableDefinitions(enums, complexTypes, *context._printer);
+    }
+    if (options._pool) {
+        writePoolDefinitions(complexTypes, *context._printer);
+    }
+    const Bindings bindings(baseName(file->name()), enums, complexTypes);
+    if (options._python || options._go) {
+        bindings.writeLayoutAssertions(*context._printer);
+    }
+
+    if (options._cpp) {
+        const auto cppFileName = stripProto(file->name()) + ".hpp";
+        context.openFile(cppFileName);
+        writeCppWrappers(baseName(fileName),
+                         capsCase(cppFileName),
+                         complexTypes,
+                         *context._printer);
+    }
+    if (options._python) {
+        context.openFile(stripProto(file->name()) + ".py");
+        bindings.writePython(*context._printer);
+    }
+    if (options._go) {
+        const auto package = options._goPackage.empty()
+                                 ? goPackage(*file)
+                                 : options._goPackage;
+        context.openFile(stripProto(file->name()) + ".go");
+        bindings.writeGo(*context._printer, package);
+        context.openFile(stripProto(file->name()) + "_layout_test.go");
+        bindings.writeGoTest(*context._printer, package);
+    }
     return true;
 }
 
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <jaeger.h>
+
+namespace jaeger_struct {
+namespace compiler {
+namespace {
+
+typedef JAEGER_LIST(jaegertracing_protobuf_span) SpanNode;
+typedef JAEGER_LIST(jaegertracing_protobuf_tag) TagNode;
+
+constexpr auto kCapacity = 8u;
+
+void appendTag(jaegertracing_protobuf_span& span, const std::string& key)
+{
+    auto* tag = jaegertracing_protobuf_span_append_tags(&span);
+    ASSERT_NE(nullptr, tag);
+    ASSERT_TRUE(jaeger_string_assign(&tag->key, key.data(), key.size()));
+}
+
+bool isInline(const jaegertracing_protobuf_span& span, const jaeger_list* node)
+{
+    return jaeger_list_inline_owns(&span.cold->tags_inline,
+                                   sizeof(span.cold->tags_inline.nodes[0]),
+                                   kCapacity,
+                                   node);
+}
+
+std::string key(const jaeger_list* node)
+{
+    auto& tag = reinterpret_cast<const TagNode*>(node)->value;
+    return std::string(tag.key.buffer, tag.key.len);
+}
+
+}  // anonymous namespace
+
+TEST(Inline, testAppend)
+{
+    jaegertracing_protobuf_span span;
+    std::memset(&span, 0, sizeof(span));
+    for (auto i = 0u; i <= kCapacity; ++i) {
+        appendTag(span, "key" + std::to_string(i));
+    }
+    ASSERT_EQ(kCapacity, span.cold->tags_inline.size);
+
+    // Iteration is unchanged, spilling past the capacity.
+    auto i = 0u;
+    const jaeger_list* node;
+    JAEGER_LIST_FOR_EACH(&span.cold->tags, node) {
+        ASSERT_EQ("key" + std::to_string(i), key(node));
+        ASSERT_EQ(i < kCapacity, isInline(span, node));
+        ++i;
+    }
+    ASSERT_EQ(kCapacity + 1, i);
+    jaegertracing_protobuf_span_destroy(&span);
+}
+
+TEST(Inline, testClear)
+{
+    jaegertracing_protobuf_span span;
+    std::memset(&span, 0, sizeof(span));
+    appendTag(span, "key");
+    auto* buffer = span.cold->tags_inline.nodes[0].value.key.buffer;
+
+    jaegertracing_protobuf_span_clear(&span);
+    ASSERT_TRUE(jaeger_list_empty(&span.cold->tags));
+    ASSERT_EQ(0u, span.cold->tags_inline.size);
+
+    // The inline node is reused along with the buffer of its value.
+    appendTag(span, "k");
+    ASSERT_EQ(buffer, span.cold->tags_inline.nodes[0].value.key.buffer);
+    ASSERT_EQ("k", key(span.cold->tags.next));
+
+    // Shrinking releases the buffers of unused inline nodes only.
+    appendTag(span, "key");
+    jaegertracing_protobuf_span_clear(&span);
+    appendTag(span, "k");
+    jaegertracing_protobuf_span_shrink(&span);
+    ASSERT_EQ(1u, span.cold->tags_inline.nodes[0].value.key.capacity);
+    ASSERT_EQ(nullptr, span.cold->tags_inline.nodes[1].value.key.buffer);
+    jaegertracing_protobuf_span_destroy(&span);
+    ASSERT_EQ(nullptr, span.cold);
+}
+
+TEST(Inline, testDecode)
+{
+    jaegertracing_protobuf_span span;
+    std::memset(&span, 0, sizeof(span));
+    for (auto i = 0; i < 3; ++i) {
+        appendTag(span, "key" + std::to_string(i));
+    }
+    jaeger_buffer buffer;
+    std::memset(&buffer, 0, sizeof(buffer));
+    ASSERT_TRUE(jaegertracing_protobuf_span_encode(&span, &buffer));
+    jaegertracing_protobuf_span_destroy(&span);
+
+    jaegertracing_protobuf_span copy;
+    std::memset(&copy, 0, sizeof(copy));
+    ASSERT_TRUE(
+        jaegertracing_protobuf_span_decode(&copy, buffer.data, buffer.size));
+    ASSERT_EQ(3u, copy.cold->tags_inline.size);
+    auto i = 0;
+    const jaeger_list* node;
+    JAEGER_LIST_FOR_EACH(&copy.cold->tags, node) {
+        ASSERT_TRUE(isInline(copy, node));
+        ASSERT_EQ("key" + std::to_string(i++), key(node));
+    }
+    ASSERT_EQ(3, i);
+    jaegertracing_protobuf_span_destroy(&copy);
+    jaeger_buffer_destroy(&buffer);
+}
+
+TEST(Inline, testColumns)
+{
+    jaeger_list spans;
+    std::memset(&spans, 0, sizeof(spans));
+    auto* node = static_cast<SpanNode*>(jaeger_malloc(sizeof(SpanNode)));
+    ASSERT_NE(nullptr, node);
+    std::memset(node, 0, sizeof(*node));
+    jaeger_list_append(&spans, &node->base);
+    for (auto i = 0u; i <= kCapacity; ++i) {
+        appendTag(node->value, "key" + std::to_string(i));
+    }
+
+    jaegertracing_protobuf_span_columns columns;
+    std::memset(&columns, 0, sizeof(columns));
+    ASSERT_TRUE(
+        jaegertracing_protobuf_span_columns_append_list(&columns, &spans));
+    jaegertracing_protobuf_span copy;
+    std::memset(&copy, 0, sizeof(copy));
+    ASSERT_TRUE(jaegertracing_protobuf_span_columns_get(&columns, 0, &copy));
+    ASSERT_EQ(kCapacity, copy.cold->tags_inline.size);
+    ASSERT_EQ(kCapacity + 1, jaeger_list_size(&copy.cold->tags));
+    ASSERT_EQ("key0", key(copy.cold->tags.next));
+    ASSERT_EQ("key8", key(copy.cold->tags.prev));
+
+    jaegertracing_protobuf_span_destroy(&copy);
+    jaegertracing_protobuf_span_columns_destroy(&columns);
+    jaegertracing_protobuf_span_destroy(&node->value);
+    jaeger_free(node);
+}
+
+}  // namespace compiler
+}  // namespace jaeger_struct
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/compiler/Layout.h>
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+#include <jaeger-struct/compiler/ComplexType.h>
+#include <jaeger-struct/compiler/Enum.h>
+#include <jaeger-struct/compiler/Field.h>
+#include <jaeger-struct/compiler/Union.h>
+
+namespace jaeger_struct {
+namespace compiler {
+namespace {
+
+// jaeger_list is two pointers, jaeger_string two size_t and a pointer.
+const Layout kListLayout(16, 8);
+const Layout kPointerLayout(8, 8);
+
+const std::map<std::string, Layout>& fundamentalLayouts()
+{
+    static const std::map<std::string, Layout> layouts = {
+        { "bool", Layout(1, 1) },
+        { "float", Layout(4, 4) },
+        { "double", Layout(8, 8) },
+        { "int32_t", Layout(4, 4) },
+        { "int64_t", Layout(8, 8) },
+        { "uint32_t", Layout(4, 4) },
+        { "uint64_t", Layout(8, 8) },
+        { "jaeger_string", Layout(24, 8) }
+    };
+    return layouts;
+}
+
+// Offset of the value union after the uint8_t type tag.
+std::size_t unionValueOffset(const Union& type, Layout& value)
+{
+    std::size_t size = 0;
+    std::size_t alignment = 1;
+    for (auto&& field : type.fields()) {
+        const auto layout = Layout::of(field);
+        size = std::max(size, layout.size());
+        alignment = std::max(alignment, layout.alignment());
+    }
+    value = Layout(Layout::alignUp(size, alignment), alignment);
+    return Layout::alignUp(1, alignment);
+}
+
+}  // anonymous namespace
+
+Layout Layout::of(const Type& type)
+{
+    if (dynamic_cast<const Enum*>(&type)) {
+        return Layout(4, 4);
+    }
+    if (auto u = dynamic_cast<const Union*>(&type)) {
+        Layout value(0, 1);
+        const auto offset = unionValueOffset(*u, value);
+        return Layout(alignUp(offset + value.size(), value.alignment()),
+                      value.alignment());
+    }
+    if (auto complexType = dynamic_cast<const ComplexType*>(&type)) {
+        const auto offsets = Layout::offsets(*complexType);
+        std::size_t end = 0;
+        std::size_t alignment = 1;
+        for (auto i = 0u; i < offsets.size(); ++i) {
+            auto&& field = complexType->fields()[i];
+            const auto layout = of(field);
+            end = offsets[i] + layout.size();
+            alignment = std::max(alignment, layout.alignment());
+            const auto storage = inlineStorage(field);
+            if (storage.size() != 0) {
+                end = alignUp(end, storage.alignment()) + storage.size();
+                alignment = std::max(alignment, storage.alignment());
+            }
+        }
+        if (complexType->cached()) {
+            end = alignUp(end, kPointerLayout.alignment()) +
+                  kPointerLayout.size();
+            alignment = std::max(alignment, kPointerLayout.alignment());
+        }
+        // Structs without fields have size zero, as in GNU C.
+        return Layout(alignUp(end, alignment), alignment);
+    }
+    const auto itr = fundamentalLayouts().find(type.name());
+    if (itr == std::end(fundamentalLayouts())) {
+        throw std::logic_error("No layout for type " + type.name());
+    }
+    return itr->second;
+}
+
+Layout Layout::of(const Field& field)
+{
+    if (field.indirect()) {
+        return kPointerLayout;
+    }
+    if (field.repeated()) {
+        return kListLayout;
+    }
+    return of(*field.type());
+}
+
+std::vector<std::size_t> Layout::offsets(const ComplexType& type)
+{
+    if (auto u = dynamic_cast<const Union*>(&type)) {
+        Layout value(0, 1);
+        return std::vector<std::size_t>(type.fields().size(),
+                                        unionValueOffset(*u, value));
+    }
+    std::vector<std::size_t> offsets;
+    offsets.reserve(type.fields().size());
+    std::size_t offset = 0;
+    for (auto&& field : type.fields()) {
+        const auto layout = of(field);
+        offset = alignUp(offset, layout.alignment());
+        offsets.push_back(offset);
+        offset += layout.size();
+        const auto storage = inlineStorage(field);
+        if (storage.size() != 0) {
+            offset = alignUp(offset, storage.alignment()) + storage.size();
+        }
+    }
+    return offsets;
+}
+
+std::size_t Layout::nodeValueOffset(const Field& field)
+{
+    return alignUp(kListLayout.size(), of(*field.type()).alignment());
+}
+
+Layout Layout::inlineStorage(const Field& field)
+{
+    if (field.inlineCapacity() == 0) {
+        return Layout(0, 1);
+    }
+    // The nodes, then the size_t counting those in use.
+    const auto value = of(*field.type());
+    const auto alignment = std::max(kListLayout.alignment(), value.alignment());
+    const auto nodeSize =
+        alignUp(nodeValueOffset(field) + value.size(), alignment);
+    return Layout(alignUp(nodeSize * field.inlineCapacity() + 8, alignment),
+                  alignment);
+}
+
+}  // namespace compiler
+}  // namespace jaeger_struct
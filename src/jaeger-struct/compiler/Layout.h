@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_COMPILER_LAYOUT_H
+#define JAEGER_STRUCT_COMPILER_LAYOUT_H
+
+#include <cstddef>
+#include <vector>
+
+namespace jaeger_struct {
+namespace compiler {
+
+class ComplexType;
+class Field;
+class Type;
+
+// Size and alignment of a generated C type under the LP64 data model, as
+// laid out by the C compiler. Bindings for other languages mirror the C
+// structs from these, and the generated C file asserts that they hold.
+class Layout {
+  public:
+    Layout(std::size_t size, std::size_t alignment)
+        : _size(size)
+        , _alignment(alignment)
+    {
+    }
+
+    static Layout of(const Type& type);
+
+    // jaeger_list for repeated fields, a pointer for indirect ones.
+    static Layout of(const Field& field);
+
+    // Offsets of the fields of type in its struct. All members of a union
+    // share the offset of its value.
+    static std::vector<std::size_t> offsets(const ComplexType& type);
+
+    // Offset of the value in a JAEGER_LIST node of field.
+    static std::size_t nodeValueOffset(const Field& field);
+
+    // JAEGER_LIST_INLINE storage following the list of field, empty if it
+    // has no inline capacity.
+    static Layout inlineStorage(const Field& field);
+
+    static std::size_t alignUp(std::size_t offset, std::size_t alignment)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    std::size_t size() const { return _size; }
+
+    std::size_t alignment() const { return _alignment; }
+
+  private:
+    std::size_t _size;
+    std::size_t _alignment;
+};
+
+}  // namespace compiler
+}  // namespace jaeger_struct
+
+#endif  // JAEGER_STRUCT_COMPILER_LAYOUT_H
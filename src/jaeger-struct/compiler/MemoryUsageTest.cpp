@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <jaeger-struct/runtime/budget.h>
+#include <jaeger.h>
+
+namespace jaeger_struct {
+namespace compiler {
+namespace {
+
+typedef JAEGER_LIST(jaegertracing_protobuf_log) LogNode;
+typedef JAEGER_LIST(jaegertracing_protobuf_span) SpanNode;
+typedef JAEGER_LIST(jaegertracing_protobuf_tag) TagNode;
+
+void assign(jaeger_string& str, const std::string& value)
+{
+    ASSERT_TRUE(jaeger_string_assign(&str, value.data(), value.size()));
+}
+
+size_t appendTag(jaegertracing_protobuf_span& span, const std::string& value)
+{
+    auto* tag = jaegertracing_protobuf_span_append_tags(&span);
+    EXPECT_NE(nullptr, tag);
+    assign(tag->key, "key");
+    tag->value.type = jaegertracing_protobuf_tag_value_str_value_type;
+    assign(tag->value.value.str_value, value);
+    return tag->key.capacity + tag->value.value.str_value.capacity;
+}
+
+void appendLog(jaegertracing_protobuf_span& span, const std::string& message)
+{
+    auto* node = static_cast<LogNode*>(jaeger_malloc(sizeof(LogNode)));
+    std::memset(node, 0, sizeof(*node));
+    auto* field = static_cast<TagNode*>(jaeger_malloc(sizeof(TagNode)));
+    std::memset(field, 0, sizeof(*field));
+    assign(field->value.key, "message");
+    assign(field->value.value.value.str_value, message);
+    jaeger_list_append(&node->value.fields, &field->base);
+    jaeger_list_append(jaegertracing_protobuf_span_mutable_logs(&span),
+                       &node->base);
+}
+
+}  // anonymous namespace
+
+TEST(MemoryUsage, testSpan)
+{
+    jaegertracing_protobuf_span span;
+    std::memset(&span, 0, sizeof(span));
+    ASSERT_EQ(0u, jaegertracing_protobuf_span_memory_usage(&span));
+
+    assign(span.operation_name, "operation");
+    auto expected = span.operation_name.capacity;
+    ASSERT_EQ(expected, jaegertracing_protobuf_span_memory_usage(&span));
+
+    // The first tags live in the cold fields, the next in their own nodes.
+    expected += sizeof(*span.cold);
+    auto inlineTags = 0u;
+    for (auto i = 0u; i < 8; ++i) {
+        inlineTags += appendTag(span, "value" + std::to_string(i));
+    }
+    expected += inlineTags;
+    ASSERT_EQ(expected, jaegertracing_protobuf_span_memory_usage(&span));
+    expected += sizeof(TagNode) + appendTag(span, "spilled");
+    ASSERT_EQ(expected, jaegertracing_protobuf_span_memory_usage(&span));
+
+    const std::string message(1000, 'm');
+    appendLog(span, message);
+    const auto& log =
+        reinterpret_cast<const LogNode*>(span.cold->logs.next)->value;
+    const auto* field =
+        &reinterpret_cast<const TagNode*>(log.fields.next)->value;
+    expected += sizeof(LogNode) + sizeof(TagNode) + field->key.capacity +
+                field->value.value.str_value.capacity;
+    ASSERT_LE(message.size(), field->value.value.str_value.capacity);
+    ASSERT_EQ(expected, jaegertracing_protobuf_span_memory_usage(&span));
+
+    // Cleared spans keep their cold fields and the buffers of inline tags.
+    jaegertracing_protobuf_span_clear(&span);
+    ASSERT_EQ(span.operation_name.capacity + sizeof(*span.cold) + inlineTags,
+              jaegertracing_protobuf_span_memory_usage(&span));
+    jaegertracing_protobuf_span_destroy(&span);
+    ASSERT_EQ(0u, jaegertracing_protobuf_span_memory_usage(&span));
+}
+
+TEST(MemoryUsage, testHandFilled)
+{
+    // Strings filled in by hand own buffers of unknown size, counted as
+    // their length.
+    const std::string payload(4096, 'p');
+    jaegertracing_protobuf_span span;
+    std::memset(&span, 0, sizeof(span));
+    auto* tag = jaegertracing_protobuf_span_append_tags(&span);
+    ASSERT_NE(nullptr, tag);
+    tag->value.type = jaegertracing_protobuf_tag_value_str_value_type;
+    auto& value = tag->value.value.str_value;
+    value.buffer = static_cast<char*>(jaeger_malloc(payload.size()));
+    ASSERT_NE(nullptr, value.buffer);
+    std::memcpy(value.buffer, payload.data(), payload.size());
+    value.len = payload.size();
+    ASSERT_EQ(0u, value.capacity);
+    ASSERT_EQ(payload.size(), jaegertracing_protobuf_tag_memory_usage(tag));
+    ASSERT_EQ(sizeof(*span.cold) + payload.size(),
+              jaegertracing_protobuf_span_memory_usage(&span));
+    jaegertracing_protobuf_span_destroy(&span);
+}
+
+TEST(MemoryUsage, testBudget)
+{
+    // Buffering spans in a batch under a byte limit rather than a count.
+    jaeger_budget budget = JAEGER_BUDGET_INIT(4096);
+    jaegertracing_protobuf_batch batch;
+    std::memset(&batch, 0, sizeof(batch));
+    auto buffer = [&budget, &batch](const std::string& message) {
+        auto* node = static_cast<SpanNode*>(jaeger_malloc(sizeof(SpanNode)));
+        std::memset(node, 0, sizeof(*node));
+        assign(node->value.operation_name, "operation");
+        appendLog(node->value, message);
+        const auto size = sizeof(*node) +
+                          jaegertracing_protobuf_span_memory_usage(&node->value);
+        if (!jaeger_budget_charge(&budget, size)) {
+            jaegertracing_protobuf_span_destroy(&node->value);
+            jaeger_free(node);
+            return false;
+        }
+        jaeger_list_append(&batch.spans, &node->base);
+        return true;
+    };
+
+    ASSERT_TRUE(buffer("small"));
+    ASSERT_TRUE(buffer("small"));
+    ASSERT_FALSE(buffer(std::string(4096, 'l')));
+    ASSERT_TRUE(buffer("small"));
+    ASSERT_EQ(3u, jaeger_list_size(&batch.spans));
+    ASSERT_EQ(jaegertracing_protobuf_batch_memory_usage(&batch),
+              jaeger_budget_used(&budget));
+
+    // Sending the batch gives its bytes back.
+    jaeger_budget_release(&budget,
+                          jaegertracing_protobuf_batch_memory_usage(&batch));
+    ASSERT_EQ(0u, jaeger_budget_used(&budget));
+    jaegertracing_protobuf_batch_destroy(&batch);
+}
+
+TEST(MemoryUsage, testConcurrentCharges)
+{
+    constexpr auto kLimit = 10000u;
+    jaeger_budget budget = JAEGER_BUDGET_INIT(kLimit);
+    std::atomic<size_t> charged(0);
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < 4; ++i) {
+        threads.emplace_back([&budget, &charged]() {
+            for (auto j = 0; j < 10000; ++j) {
+                if (jaeger_budget_charge(&budget, 3)) {
+                    charged += 3;
+                }
+            }
+        });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+    ASSERT_LE(charged.load(), kLimit);
+    ASSERT_GT(charged.load(), kLimit - 3 * 4);
+    ASSERT_EQ(charged.load(), jaeger_budget_used(&budget));
+}
+
+}  // namespace compiler
+}  // namespace jaeger_struct
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+#include <split/jaeger_trace_id.h>
+
+// Only the messages stored by value come along.
+#ifdef JAEGER_SPAN_H
+#error "The header of TraceID includes the header of Span"
+#endif
+
+namespace jaeger_struct {
+namespace compiler {
+
+TEST(SplitHeaders, testTraceID)
+{
+    // Other messages are declared, for pointers to them.
+    jaegertracing_protobuf_span* span = nullptr;
+    ASSERT_EQ(nullptr, span);
+
+    jaegertracing_protobuf_trace_id traceID;
+    std::memset(&traceID, 0, sizeof(traceID));
+    traceID.high = 1;
+    traceID.low = 2;
+    jaeger_buffer buffer;
+    std::memset(&buffer, 0, sizeof(buffer));
+    ASSERT_TRUE(jaegertracing_protobuf_trace_id_encode(&traceID, &buffer));
+
+    jaegertracing_protobuf_trace_id copy;
+    std::memset(&copy, 0, sizeof(copy));
+    ASSERT_TRUE(jaegertracing_protobuf_trace_id_decode(
+        &copy, buffer.data, buffer.size));
+    ASSERT_EQ(1u, copy.high);
+    ASSERT_EQ(2u, copy.low);
+    jaegertracing_protobuf_trace_id_destroy(&copy);
+    jaeger_buffer_destroy(&buffer);
+}
+
+}  // namespace compiler
+}  // namespace jaeger_struct
@@ -72,6 +72,23 @@ inline std::string snakeCase(const std::string& str)
     return result;
 }
 
+inline std::string pascalCase(const std::string& str)
+{
+    auto&& input = capsCase(str);
+    std::string result;
+    result.reserve(input.size());
+    auto wordStart = true;
+    for (auto&& ch : input) {
+        if (ch == '_') {
+            wordStart = true;
+            continue;
+        }
+        result += wordStart ? ch : static_cast<char>(std::tolower(ch));
+        wordStart = false;
+    }
+    return result;
+}
+
 }  // namespace compiler
 }  // namespace jaeger_struct
 
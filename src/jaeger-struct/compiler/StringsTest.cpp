@@ -35,5 +35,14 @@ TEST(Strings, testCapsCase)
     }
 }
 
+TEST(Strings, testPascalCase)
+{
+    ASSERT_EQ("PascalCase", pascalCase("pascal_case"));
+    ASSERT_EQ("TraceId", pascalCase("traceID"));
+    ASSERT_EQ("JaegertracingProtobufSpan",
+              pascalCase("jaegertracing_protobuf_span"));
+    ASSERT_EQ("Int64", pascalCase("int64"));
+}
+
 }  // namespace compiler
 }  // namespace jaeger_struct
@@ -16,9 +16,14 @@
 
 #include <jaeger-struct/compiler/Struct.h>
 
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <string>
 #include <unordered_set>
 
 #include <google/protobuf/descriptor.h>
+#include <google/protobuf/descriptor.pb.h>
 #include <google/protobuf/io/printer.h>
 
 #include <jaeger-struct/compiler/Strings.h>
@@ -82,13 +87,50 @@ determineFields(const google::protobuf::Descriptor& descriptor,
     return result;
 }
 
+// Number of the MessageOptions extension in jaeger-struct/options.proto.
+constexpr int kCachedOption = 50302;
+
+// Only repeated message fields can be split, as splicing moves list nodes
+// of whole messages, which inline nodes cannot leave.
+bool isSplittable(const Field& field)
+{
+    return field.repeated() && field.inlineCapacity() == 0 &&
+           std::dynamic_pointer_cast<const Struct>(field.type());
+}
+
 }  // anonymous namespace
 
 Struct::Struct(const google::protobuf::Descriptor& descriptor,
-               const TypeRegistry& registry)
+               const TypeRegistry& registry,
+               bool pooled,
+               bool tableCodec)
     : ComplexType(snakeCase(descriptor.full_name()),
                   determineFields(descriptor, registry))
+    , _pooled(pooled)
+    , _cached(tableCodec && descriptor.field_count() != 0 &&
+              varintOption(descriptor.options(), kCachedOption) != 0)
+    , _cold()
 {
+    auto& members = fields();
+    std::vector<Field> coldFields;
+    std::copy_if(std::begin(members),
+                 std::end(members),
+                 std::back_inserter(coldFields),
+                 [](const Field& field) { return field.cold(); });
+    if (coldFields.empty()) {
+        return;
+    }
+    members.erase(std::remove_if(std::begin(members),
+                                 std::end(members),
+                                 [](const Field& field) {
+                                     return field.cold();
+                                 }),
+                  std::end(members));
+    _cold = std::make_shared<const ColdStruct>(name(), coldFields, pooled);
+    members.emplace_back(_cold,
+                         google::protobuf::FieldDescriptor::LABEL_OPTIONAL,
+                         "cold",
+                         true);
 }
 
 void Struct::writeDefinition(google::protobuf::io::Printer& printer) const
@@ -98,5 +140,319 @@ void Struct::writeDefinition(google::protobuf::io::Printer& printer) const
     printer.Print(" $name$;", "name", name());
 }
 
+void Struct::writeFunctionDeclarations(
+    google::protobuf::io::Printer& printer) const
+{
+    ComplexType::writeFunctionDeclarations(printer);
+    if (_cached) {
+        printer.Print("/* Setters and mutable accessors, which make the "
+                      "frozen encoding stale. */\n");
+        for (auto&& field : fields()) {
+            if (!field.indirect()) {
+                writeSetter(printer, field, false);
+            }
+        }
+    }
+    if (!_cold) {
+        return;
+    }
+    printer.Print("/* Zeroed cold fields, read through a NULL cold pointer. "
+                  "*/\n"
+                  "extern const $cold$ $cold$_default;\n"
+                  "/*\n"
+                  " * Returns the cold fields of value, allocating them on "
+                  "first use, or NULL if\n"
+                  " * allocation fails.\n"
+                  " */\n"
+                  "$cold$* $name$_mutable_cold($name$* value);\n",
+                  "name",
+                  name(),
+                  "cold",
+                  _cold->name());
+    for (auto&& field : _cold->fields()) {
+        printer.Print("#define $name$_get_$field$(value) (((value)->cold != "
+                      "NULL ? (value)->cold : &$cold$_default)->$field$)\n"
+                      "#define $name$_mutable_$field$(value) "
+                      "($name$_mutable_cold(value) != NULL ? "
+                      "&(value)->cold->$field$ : NULL)\n",
+                      "name",
+                      name(),
+                      "cold",
+                      _cold->name(),
+                      "field",
+                      field.name());
+        if (field.inlineCapacity() != 0) {
+            printer.Print("#define $name$_append_$field$(value) "
+                          "($name$_mutable_cold(value) != NULL ? "
+                          "$cold$_append_$field$((value)->cold) : NULL)\n",
+                          "name",
+                          name(),
+                          "cold",
+                          _cold->name(),
+                          "field",
+                          field.name());
+        }
+    }
+}
+
+void Struct::writeFunctionDefinitions(
+    google::protobuf::io::Printer& printer) const
+{
+    writeReleaseFunctions(printer, _pooled);
+    writeAppendFunctions(printer, _pooled);
+    if (_cached) {
+        for (auto&& field : fields()) {
+            if (!field.indirect()) {
+                printer.Print("\n");
+                writeSetter(printer, field, true);
+            }
+        }
+    }
+    if (!_cold) {
+        return;
+    }
+    printer.Print("\n"
+                  "const $cold$ $cold$_default;\n\n"
+                  "$cold$* $name$_mutable_cold($name$* value)\n"
+                  "{\n"
+                  "$touch$"
+                  "  if (value->cold == NULL) {\n"
+                  "    value->cold =\n"
+                  "        ($cold$*) jaeger_malloc(sizeof(*value->cold));\n"
+                  "    if (value->cold != NULL) {\n"
+                  "      memset(value->cold, 0, sizeof(*value->cold));\n"
+                  "    }\n"
+                  "  }\n"
+                  "  return value->cold;\n"
+                  "}\n",
+                  "name",
+                  name(),
+                  "cold",
+                  _cold->name(),
+                  "touch",
+                  _cached ? "  " + name() + "_touch(value);\n" : "");
+}
+
+void Struct::writeTableDeclarations(
+    google::protobuf::io::Printer& printer) const
+{
+    ComplexType::writeTableDeclarations(printer);
+    printer.Print("bool $name$_encode(const $name$* value, "
+                  "jaeger_buffer* out);\n"
+                  "bool $name$_encode_iov(const $name$* value, "
+                  "jaeger_iov_buffer* out);\n"
+                  "bool $name$_decode($name$* value, const void* data, "
+                  "size_t size);\n"
+                  "/* Skip UTF-8 validation of string fields. */\n"
+                  "bool $name$_encode_trusted(const $name$* value, "
+                  "jaeger_buffer* out);\n"
+                  "bool $name$_encode_iov_trusted(const $name$* value, "
+                  "jaeger_iov_buffer* out);\n"
+                  "bool $name$_decode_trusted($name$* value, "
+                  "const void* data, size_t size);\n"
+                  "size_t $name$_encoded_size(const $name$* value);\n",
+                  "name",
+                  name());
+    if (_cached) {
+        printer.Print("/*\n"
+                      " * Freezes the encoding of value into its encoded "
+                      "member. Encoding value, alone\n"
+                      " * or inside another message, then copies it until "
+                      "value is written again.\n"
+                      " */\n"
+                      "bool $name$_freeze($name$* value);\n"
+                      "/* Makes the frozen encoding stale after writing a "
+                      "member directly. */\n"
+                      "void $name$_touch($name$* value);\n",
+                      "name",
+                      name());
+    }
+    for (auto&& field : fields()) {
+        if (!isSplittable(field)) {
+            continue;
+        }
+        printer.Print("size_t $name$_split_$field$($name$* value, "
+                      "size_t max_size, $name$* part);\n"
+                      "void $name$_split_$field$_release($name$* part);\n",
+                      "name",
+                      name(),
+                      "field",
+                      field.name());
+    }
+}
+
+void Struct::writeTableDefinitions(
+    google::protobuf::io::Printer& printer) const
+{
+    ComplexType::writeTableDefinitions(printer);
+    printer.Print("\n"
+                  "bool $name$_encode(const $name$* value, "
+                  "jaeger_buffer* out)\n"
+                  "{\n"
+                  "  return jaeger_encode(&$name$_table, value, out);\n"
+                  "}\n\n"
+                  "bool $name$_encode_iov(const $name$* value, "
+                  "jaeger_iov_buffer* out)\n"
+                  "{\n"
+                  "  return jaeger_encode_iov(&$name$_table, value, out);\n"
+                  "}\n\n"
+                  "bool $name$_decode($name$* value, const void* data, "
+                  "size_t size)\n"
+                  "{\n"
+                  "  return jaeger_decode(&$name$_table, value, data, size);\n"
+                  "}\n\n"
+                  "bool $name$_encode_trusted(const $name$* value, "
+                  "jaeger_buffer* out)\n"
+                  "{\n"
+                  "  return jaeger_encode_trusted(&$name$_table, value, out);\n"
+                  "}\n\n"
+                  "bool $name$_encode_iov_trusted(const $name$* value, "
+                  "jaeger_iov_buffer* out)\n"
+                  "{\n"
+                  "  return jaeger_encode_iov_trusted(&$name$_table, value, "
+                  "out);\n"
+                  "}\n\n"
+                  "bool $name$_decode_trusted($name$* value, "
+                  "const void* data, size_t size)\n"
+                  "{\n"
+                  "  return jaeger_decode_trusted(&$name$_table, value, data, "
+                  "size);\n"
+                  "}\n\n"
+                  "size_t $name$_encoded_size(const $name$* value)\n"
+                  "{\n"
+                  "  return jaeger_encoded_size(&$name$_table, value);\n"
+                  "}\n",
+                  "name",
+                  name());
+    if (_cached) {
+        printer.Print("\n"
+                      "bool $name$_freeze($name$* value)\n"
+                      "{\n"
+                      "  return jaeger_freeze(&$name$_table, value);\n"
+                      "}\n\n"
+                      "void $name$_touch($name$* value)\n"
+                      "{\n"
+                      "  jaeger_encoded_cache_touch(value->encoded);\n"
+                      "}\n",
+                      "name",
+                      name());
+    }
+    for (auto&& field : fields()) {
+        if (!isSplittable(field)) {
+            continue;
+        }
+        std::map<std::string, std::string> vars;
+        vars["name"] = name();
+        vars["field"] = field.name();
+        vars["number"] = std::to_string(field.number());
+        printer.Print(vars,
+                      "\n"
+                      "size_t $name$_split_$field$($name$* value, "
+                      "size_t max_size, $name$* part)\n"
+                      "{\n"
+                      "  return jaeger_split(\n"
+                      "      &$name$_table, value, $number$, max_size, "
+                      "part);\n"
+                      "}\n\n"
+                      "void $name$_split_$field$_release($name$* part)\n"
+                      "{\n");
+        printer.Indent();
+        writeDestroy(printer, field, "part->" + field.name(), _pooled);
+        printer.Print("memset(part, 0, sizeof(*part));\n");
+        printer.Outdent();
+        printer.Print("}\n");
+    }
+}
+
+void Struct::writeSetter(google::protobuf::io::Printer& printer,
+                         const Field& field,
+                         bool definition) const
+{
+    std::map<std::string, std::string> vars{ { "name", name() },
+                                             { "field", field.name() },
+                                             { "type", field.type()->name() } };
+    std::string signature;
+    std::string body;
+    if (field.repeated()) {
+        signature = "jaeger_list* $name$_mutable_$field$($name$* value)";
+        body = "  return &value->$field$;\n";
+    }
+    else if (std::dynamic_pointer_cast<const ComplexType>(field.type())) {
+        signature = "$type$* $name$_mutable_$field$($name$* value)";
+        body = "  return &value->$field$;\n";
+    }
+    else if (field.type()->name() == "jaeger_string") {
+        signature = "bool $name$_set_$field$($name$* value, "
+                    "const char* buffer, size_t len)";
+        body = "  return jaeger_string_assign(&value->$field$, buffer, len);\n";
+    }
+    else {
+        signature =
+            "void $name$_set_$field$($name$* value, $type$ new_value)";
+        body = "  value->$field$ = new_value;\n";
+    }
+    if (!definition) {
+        printer.Print(vars, (signature + ";\n").c_str());
+        return;
+    }
+    printer.Print(vars,
+                  (signature + "\n{\n  $name$_touch(value);\n" + body + "}\n")
+                      .c_str());
+}
+
+void Struct::writePoolDeclarations(
+    google::protobuf::io::Printer& printer) const
+{
+    printer.Print("$name$* $name$_pool_acquire(void);\n"
+                  "void $name$_pool_release($name$* value);\n"
+                  "jaeger_list* $name$_node_pool_acquire(void);\n"
+                  "void $name$_node_pool_release(jaeger_list* node);\n",
+                  "name",
+                  name());
+}
+
+void Struct::writePoolDefinitions(
+    google::protobuf::io::Printer& printer) const
+{
+    printer.Print(
+        "static void $name$_pool_destroy(void* value)\n"
+        "{\n"
+        "  $name$_destroy(($name$*) value);\n"
+        "}\n\n"
+        "static void $name$_node_pool_destroy(void* node)\n"
+        "{\n"
+        "  $name$_destroy(JAEGER_LIST_NODE_VALUE($name$, node));\n"
+        "}\n\n"
+        "static jaeger_pool $name$_pool =\n"
+        "    JAEGER_POOL_INIT(sizeof($name$), $name$_pool_destroy);\n"
+        "static jaeger_pool $name$_node_pool =\n"
+        "    JAEGER_POOL_INIT(sizeof(JAEGER_LIST($name$)),\n"
+        "                     $name$_node_pool_destroy);\n\n"
+        "$name$* $name$_pool_acquire(void)\n"
+        "{\n"
+        "  return ($name$*) jaeger_pool_acquire(&$name$_pool);\n"
+        "}\n\n"
+        "void $name$_pool_release($name$* value)\n"
+        "{\n"
+        "  if (value != NULL) {\n"
+        "    $name$_clear(value);\n"
+        "    jaeger_pool_release(&$name$_pool, value);\n"
+        "  }\n"
+        "}\n\n"
+        "jaeger_list* $name$_node_pool_acquire(void)\n"
+        "{\n"
+        "  return (jaeger_list*) jaeger_pool_acquire(&$name$_node_pool);\n"
+        "}\n\n"
+        "void $name$_node_pool_release(jaeger_list* node)\n"
+        "{\n"
+        "  if (node != NULL) {\n"
+        "    $name$_clear(JAEGER_LIST_NODE_VALUE($name$, node));\n"
+        "    jaeger_pool_release(&$name$_node_pool, node);\n"
+        "  }\n"
+        "}\n",
+        "name",
+        name());
+}
+
 }  // namespace compiler
 }  // namespace jaeger_struct
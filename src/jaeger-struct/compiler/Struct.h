@@ -17,8 +17,10 @@
 #ifndef JAEGER_STRUCT_COMPILER_STRUCT_H
 #define JAEGER_STRUCT_COMPILER_STRUCT_H
 
+#include <memory>
 #include <vector>
 
+#include <jaeger-struct/compiler/ColdStruct.h>
 #include <jaeger-struct/compiler/ComplexType.h>
 
 namespace google {
@@ -36,10 +38,55 @@ class TypeRegistry;
 
 class Struct : public ComplexType {
   public:
+    // If pooled, destroy and clear return the list nodes of message fields to
+    // their node pools, which writePoolDefinitions defines for every struct.
+    // If tableCodec, a message marked (jaeger_struct.cached) is cached().
     Struct(const google::protobuf::Descriptor& descriptor,
-           const TypeRegistry& registry);
+           const TypeRegistry& registry,
+           bool pooled = false,
+           bool tableCodec = false);
+
+    // Companion holding the fields marked cold, which the struct points to
+    // from its last field, an indirect field named cold. NULL if no field
+    // is cold.
+    const std::shared_ptr<const ColdStruct>& cold() const { return _cold; }
+
+    bool cached() const override { return _cached; }
 
     void writeDefinition(google::protobuf::io::Printer& printer) const override;
+
+    // Also declares the accessors of the cold fields and, if cached, the
+    // setters of the other fields.
+    void writeFunctionDeclarations(
+        google::protobuf::io::Printer& printer) const override;
+
+    void writeFunctionDefinitions(
+        google::protobuf::io::Printer& printer) const override;
+
+    // Also writes the encode and decode functions using the table, and the
+    // freeze and touch functions if cached.
+    void writeTableDeclarations(
+        google::protobuf::io::Printer& printer) const override;
+
+    void writeTableDefinitions(
+        google::protobuf::io::Printer& printer) const override;
+
+    // Writes the pool functions for this type and its list nodes
+    // (runtime/pool.h).
+    void writePoolDeclarations(google::protobuf::io::Printer& printer) const;
+
+    void writePoolDefinitions(google::protobuf::io::Printer& printer) const;
+
+  private:
+    // Writes the declaration or the definition of the function writing
+    // field: a setter for strings and scalars, else a mutable accessor.
+    void writeSetter(google::protobuf::io::Printer& printer,
+                     const Field& field,
+                     bool definition) const;
+
+    bool _pooled;
+    bool _cached;
+    std::shared_ptr<const ColdStruct> _cold;
 };
 
 }  // namespace compiler
@@ -19,7 +19,9 @@
 
 #include <iostream>
 #include <memory>
+#include <string>
 #include <unordered_map>
+#include <utility>
 
 #include <google/protobuf/descriptor.h>
 
@@ -37,6 +39,26 @@ class TypeRegistry {
         _registry.emplace(type->name(), type);
     }
 
+    // Registers a type belonging to the top-level message named owner, in
+    // whose header it is defined when headers are split.
+    void registerType(std::shared_ptr<const Type>&& type,
+                      const std::string& owner)
+    {
+        _owners.emplace(type->name(), owner);
+        registerType(std::move(type));
+    }
+
+    // Returns the owner of the type named name, or an empty string for
+    // fundamental types and enums at file level.
+    std::string ownerOf(const std::string& name) const
+    {
+        const auto itr = _owners.find(name);
+        if (itr == std::end(_owners)) {
+            return std::string();
+        }
+        return itr->second;
+    }
+
     std::shared_ptr<const Type> findType(const std::string& name) const
     {
         const auto itr = _registry.find(name);
@@ -51,6 +73,7 @@ class TypeRegistry {
 
   private:
     std::unordered_map<std::string, std::shared_ptr<const Type>> _registry;
+    std::unordered_map<std::string, std::string> _owners;
 };
 
 }  // namespace compiler
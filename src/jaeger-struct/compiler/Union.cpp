@@ -89,5 +89,103 @@ void Union::writeDefinition(google::protobuf::io::Printer& printer) const
     printer.Print("} $name$;", "name", name());
 }
 
+void Union::writeFunctionDefinitions(
+    google::protobuf::io::Printer& printer) const
+{
+    printer.Print("void $name$_destroy($name$* value)\n"
+                  "{\n",
+                  "name",
+                  name());
+    printer.Indent();
+    printer.Print("switch (value->type) {\n");
+    for (auto&& field : fields()) {
+        printer.Print(
+            "case $name$_type:\n", "name", name() + "_" + field.name());
+        printer.Indent();
+        writeDestroy(printer, field, "value->value." + field.name());
+        printer.Print("break;\n");
+        printer.Outdent();
+    }
+    printer.Print("default:\n"
+                  "  break;\n"
+                  "}\n");
+    printer.Outdent();
+    printer.Print("}\n");
+
+    // Only the first member keeps its buffers, so that cleared unions have a
+    // zero type like zeroed ones.
+    const auto& first = fields().front();
+    printer.Print("\n"
+                  "void $name$_clear($name$* value)\n"
+                  "{\n"
+                  "  if (value->type != $first$_type) {\n"
+                  "    $name$_destroy(value);\n"
+                  "    memset(value, 0, sizeof(*value));\n"
+                  "    return;\n"
+                  "  }\n",
+                  "name",
+                  name(),
+                  "first",
+                  name() + "_" + first.name());
+    printer.Indent();
+    writeClear(printer, first, "value->value." + first.name(), false);
+    printer.Outdent();
+    printer.Print("}\n");
+
+    printer.Print("\n"
+                  "void $name$_shrink($name$* value)\n"
+                  "{\n",
+                  "name",
+                  name());
+    printer.Indent();
+    printer.Print("switch (value->type) {\n");
+    for (auto&& field : fields()) {
+        printer.Print(
+            "case $name$_type:\n", "name", name() + "_" + field.name());
+        printer.Indent();
+        writeShrink(printer, field, "value->value." + field.name());
+        printer.Print("break;\n");
+        printer.Outdent();
+    }
+    printer.Print("default:\n"
+                  "  break;\n"
+                  "}\n");
+    printer.Outdent();
+    printer.Print("}\n");
+
+    printer.Print("\n"
+                  "size_t $name$_memory_usage(const $name$* value)\n"
+                  "{\n"
+                  "  size_t size = 0;\n",
+                  "name",
+                  name());
+    printer.Indent();
+    printer.Print("switch (value->type) {\n");
+    for (auto&& field : fields()) {
+        printer.Print(
+            "case $name$_type:\n", "name", name() + "_" + field.name());
+        printer.Indent();
+        writeMemoryUsage(printer, field, "value->value." + field.name());
+        printer.Print("break;\n");
+        printer.Outdent();
+    }
+    printer.Print("default:\n"
+                  "  break;\n"
+                  "}\n"
+                  "return size;\n");
+    printer.Outdent();
+    printer.Print("}\n");
+}
+
+void Union::writeViewAccessors(google::protobuf::io::Printer& printer) const
+{
+    printer.Print("\n"
+                  "uint8_t type() const noexcept\n"
+                  "{\n"
+                  "  return _value->type;\n"
+                  "}\n");
+    ComplexType::writeViewAccessors(printer);
+}
+
 }  // namespace compiler
 }  // namespace jaeger_struct
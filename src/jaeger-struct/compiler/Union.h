@@ -38,6 +38,18 @@ class Union : public ComplexType {
                    const TypeRegistry& registry);
 
     void writeDefinition(google::protobuf::io::Printer& printer) const override;
+
+    void writeFunctionDefinitions(
+        google::protobuf::io::Printer& printer) const override;
+
+  protected:
+    std::string memberPath(const Field& field) const override
+    {
+        return "value." + field.name();
+    }
+
+    void writeViewAccessors(
+        google::protobuf::io::Printer& printer) const override;
 };
 
 }  // namespace compiler
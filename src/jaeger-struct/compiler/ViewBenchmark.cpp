@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+
+#include <benchmark/benchmark.h>
+
+#include <jaeger.hpp>
+
+namespace jaeger_struct {
+namespace compiler {
+namespace {
+
+constexpr auto kSpans = 10000;
+constexpr auto kTags = 4;
+
+typedef JAEGER_LIST(jaegertracing_protobuf_span) SpanNode;
+typedef JAEGER_LIST(jaegertracing_protobuf_tag) TagNode;
+
+struct Fixture {
+    Fixture()
+    {
+        for (auto i = 0; i < kSpans; ++i) {
+            auto* node =
+                static_cast<SpanNode*>(jaeger_malloc(sizeof(SpanNode)));
+            std::memset(node, 0, sizeof(*node));
+            node->value.start_time = i;
+            jaeger_string_assign(&node->value.operation_name, "get", 3);
+            for (auto j = 0; j < kTags; ++j) {
+                auto* tag =
+                    static_cast<TagNode*>(jaeger_malloc(sizeof(TagNode)));
+                std::memset(tag, 0, sizeof(*tag));
+                jaeger_string_assign(&tag->value.key, "key", 3 - j % 2);
+                tag->value.value.type =
+                    jaegertracing_protobuf_tag_value_long_value_type;
+                tag->value.value.value.long_value = j;
+                jaeger_list_append(
+                    jaegertracing_protobuf_span_mutable_tags(&node->value),
+                    &tag->base);
+            }
+            jaeger_list_append(&batch->spans, &node->base);
+        }
+    }
+
+    Owner<jaegertracing_protobuf_batch> batch;
+};
+
+const Fixture& fixture()
+{
+    static const Fixture instance;
+    return instance;
+}
+
+// Both benchmarks read the same fields; views should cost nothing extra.
+void BM_DirectAccess(benchmark::State& state)
+{
+    const auto& batch = *fixture().batch.get();
+    for (auto _ : state) {
+        int64_t sum = 0;
+        const jaeger_list* spanNode;
+        JAEGER_LIST_FOR_EACH(&batch.spans, spanNode)
+        {
+            const auto& span =
+                reinterpret_cast<const SpanNode*>(spanNode)->value;
+            sum += span.start_time + span.operation_name.len;
+            const jaeger_list* tagNode;
+            JAEGER_LIST_FOR_EACH(&jaegertracing_protobuf_span_get_tags(&span),
+                                 tagNode)
+            {
+                const auto& tag =
+                    reinterpret_cast<const TagNode*>(tagNode)->value;
+                sum += tag.key.len;
+                if (tag.value.type ==
+                    jaegertracing_protobuf_tag_value_long_value_type) {
+                    sum += tag.value.value.long_value;
+                }
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * kSpans);
+}
+BENCHMARK(BM_DirectAccess);
+
+void BM_ViewAccess(benchmark::State& state)
+{
+    const auto batch = fixture().batch.view();
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (auto&& span : batch.spans()) {
+            sum += span.start_time() + span.operation_name().size();
+            for (auto&& tag : span.tags()) {
+                sum += tag.key().size();
+                if (tag.value().type() ==
+                    jaegertracing_protobuf_tag_value_long_value_type) {
+                    sum += tag.value().long_value();
+                }
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * kSpans);
+}
+BENCHMARK(BM_ViewAccess);
+
+}  // anonymous namespace
+}  // namespace compiler
+}  // namespace jaeger_struct
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <jaeger.hpp>
+
+namespace jaeger_struct {
+namespace compiler {
+namespace {
+
+typedef JAEGER_LIST(jaegertracing_protobuf_span) SpanNode;
+typedef JAEGER_LIST(jaegertracing_protobuf_tag) TagNode;
+
+static_assert(sizeof(View<jaegertracing_protobuf_span>) == sizeof(void*),
+              "views hold a single pointer");
+static_assert(!std::is_copy_constructible<
+                  Owner<jaegertracing_protobuf_span>>::value,
+              "owners are move-only");
+static_assert(Traits<jaegertracing_protobuf_span>::fields().size() == 8,
+              "span has seven hot fields and its cold pointer");
+
+void assign(jaeger_string& str, const char* value)
+{
+    ASSERT_TRUE(jaeger_string_assign(&str, value, std::strlen(value)));
+}
+
+void appendTag(jaeger_list& list, const char* key, int64_t value)
+{
+    auto* node = static_cast<TagNode*>(jaeger_malloc(sizeof(TagNode)));
+    ASSERT_NE(nullptr, node);
+    std::memset(node, 0, sizeof(*node));
+    assign(node->value.key, key);
+    node->value.value.type = jaegertracing_protobuf_tag_value_long_value_type;
+    node->value.value.value.long_value = value;
+    jaeger_list_append(&list, &node->base);
+}
+
+}  // anonymous namespace
+
+TEST(View, testAccessors)
+{
+    Owner<jaegertracing_protobuf_batch> batch;
+    assign(batch->process.service_name, "frontend");
+    for (auto i = 0; i < 3; ++i) {
+        auto* node = static_cast<SpanNode*>(jaeger_malloc(sizeof(SpanNode)));
+        ASSERT_NE(nullptr, node);
+        std::memset(node, 0, sizeof(*node));
+        node->value.trace_id.low = i;
+        assign(node->value.operation_name, "get");
+        auto* tags = jaegertracing_protobuf_span_mutable_tags(&node->value);
+        ASSERT_NE(nullptr, tags);
+        appendTag(*tags, "retry", i);
+        appendTag(*tags, "size", 10 * i);
+        jaeger_list_append(&batch->spans, &node->base);
+    }
+
+    const auto fields = Traits<jaegertracing_protobuf_batch>::fields();
+    ASSERT_STREQ("spans", fields[1]._name);
+    ASSERT_EQ(offsetof(jaegertracing_protobuf_batch, spans), fields[1]._offset);
+    ASSERT_TRUE(fields[1]._repeated);
+
+    const auto view = batch.view();
+    ASSERT_EQ("frontend", view.process().service_name());
+    ASSERT_EQ(3u, view.spans().size());
+    uint64_t i = 0;
+    for (auto&& span : view.spans()) {
+        ASSERT_EQ(i, span.trace_id().low());
+        ASSERT_EQ("get", span.operation_name());
+        std::vector<std::string> keys;
+        int64_t sum = 0;
+        for (auto&& tag : span.tags()) {
+            keys.emplace_back(std::string(tag.key()));
+            ASSERT_EQ(jaegertracing_protobuf_tag_value_long_value_type,
+                      tag.value().type());
+            sum += tag.value().long_value();
+        }
+        ASSERT_EQ((std::vector<std::string>{ "retry", "size" }), keys);
+        ASSERT_EQ(static_cast<int64_t>(11 * i), sum);
+        ++i;
+    }
+
+    auto moved = std::move(batch);
+    ASSERT_TRUE(jaeger_list_empty(&batch->spans));
+    ASSERT_EQ(3u, jaeger_list_size(&moved->spans));
+    moved.reset();
+    ASSERT_TRUE(jaeger_list_empty(&moved->spans));
+}
+
+}  // namespace compiler
+}  // namespace jaeger_struct
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <ctime>
+
+#include <benchmark/benchmark.h>
+
+#include <jaeger-struct/runtime/clock.h>
+
+#include <jaeger.h>
+
+namespace jaeger_struct {
+namespace runtime {
+namespace {
+
+// Timing a span the usual way, with a clock_gettime at either end.
+void BM_SpanClockGettime(benchmark::State& state)
+{
+    jaegertracing_protobuf_span span;
+    std::memset(&span, 0, sizeof(span));
+    for (auto _ : state) {
+        timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        span.start_time =
+            static_cast<int64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        const auto start =
+            static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        span.duration =
+            (static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec -
+             start) /
+            1000;
+        benchmark::DoNotOptimize(span);
+    }
+}
+BENCHMARK(BM_SpanClockGettime);
+
+void BM_SpanClock(benchmark::State& state)
+{
+    jaeger_clock clock;
+    if (!jaeger_clock_init(&clock,
+                           static_cast<jaeger_clock_source>(state.range(0)))) {
+        state.SkipWithError("no reliable cycle counter");
+        return;
+    }
+    jaegertracing_protobuf_span span;
+    std::memset(&span, 0, sizeof(span));
+    for (auto _ : state) {
+        JAEGER_CLOCK_START_SPAN(&clock, &span);
+        JAEGER_CLOCK_FINISH_SPAN(&clock, &span);
+        benchmark::DoNotOptimize(span);
+    }
+}
+BENCHMARK(BM_SpanClock)
+    ->Arg(JAEGER_CLOCK_COUNTER)
+    ->Arg(JAEGER_CLOCK_MONOTONIC);
+
+}  // anonymous namespace
+}  // namespace runtime
+}  // namespace jaeger_struct
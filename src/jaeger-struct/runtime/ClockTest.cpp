@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/clock.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <jaeger.h>
+
+namespace jaeger_struct {
+namespace runtime {
+namespace {
+
+int64_t readClock(clockid_t id)
+{
+    timespec now;
+    clock_gettime(id, &now);
+    return static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+// Checks the clock against the wall clock read just before and after it, so
+// that being preempted between the reads widens the window instead of
+// failing.
+void assertNearRealtime(const jaeger_clock& clock, int64_t margin)
+{
+    const auto before = readClock(CLOCK_REALTIME) / 1000;
+    const auto now = jaeger_clock_now_us(&clock);
+    const auto after = readClock(CLOCK_REALTIME) / 1000;
+    ASSERT_GE(now, before - margin);
+    ASSERT_LE(now, after + margin);
+}
+
+std::vector<jaeger_clock_source> sources()
+{
+    std::vector<jaeger_clock_source> result{ JAEGER_CLOCK_MONOTONIC };
+    jaeger_clock clock;
+    if (jaeger_clock_init(&clock, JAEGER_CLOCK_COUNTER)) {
+        result.push_back(JAEGER_CLOCK_COUNTER);
+    }
+    return result;
+}
+
+}  // anonymous namespace
+
+TEST(Clock, testSources)
+{
+    jaeger_clock clock;
+    ASSERT_TRUE(jaeger_clock_init(&clock, JAEGER_CLOCK_MONOTONIC));
+    ASSERT_FALSE(clock.counter);
+    ASSERT_TRUE(jaeger_clock_init(&clock, JAEGER_CLOCK_AUTO));
+    if (jaeger_clock_init(&clock, JAEGER_CLOCK_COUNTER)) {
+        ASSERT_TRUE(clock.counter);
+    }
+}
+
+TEST(Clock, testDrift)
+{
+    for (auto&& source : sources()) {
+        jaeger_clock clock;
+        ASSERT_TRUE(jaeger_clock_init(&clock, source));
+        for (auto i = 0; i < 4; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+            // A millisecond of calibration keeps the error within tens of
+            // parts per million, and each calibration measures longer.
+            ASSERT_NO_FATAL_FAILURE(assertNearRealtime(clock, 1000));
+            jaeger_clock_calibrate(&clock);
+            ASSERT_NO_FATAL_FAILURE(assertNearRealtime(clock, 200));
+
+            const auto start = readClock(CLOCK_MONOTONIC);
+            const auto ticks = jaeger_clock_ticks(&clock);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            const auto elapsed =
+                jaeger_clock_elapsed(&clock, ticks, jaeger_clock_ticks(&clock));
+            const auto expected = readClock(CLOCK_MONOTONIC) - start;
+            ASSERT_GE(elapsed, 10000000 - 10000);
+            ASSERT_LE(elapsed, expected + 10000);
+        }
+    }
+}
+
+TEST(Clock, testSpan)
+{
+    for (auto&& source : sources()) {
+        jaeger_clock clock;
+        ASSERT_TRUE(jaeger_clock_init(&clock, source));
+        jaegertracing_protobuf_span span;
+        std::memset(&span, 0, sizeof(span));
+        const auto before = readClock(CLOCK_REALTIME) / 1000;
+        JAEGER_CLOCK_START_SPAN(&clock, &span);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        // Recalibrating while the span runs leaves its duration sensible.
+        jaeger_clock_calibrate(&clock);
+        JAEGER_CLOCK_FINISH_SPAN(&clock, &span);
+        const auto after = readClock(CLOCK_REALTIME) / 1000;
+        ASSERT_GE(span.start_time, before - 100);
+        ASSERT_LE(span.start_time, after + 100);
+        ASSERT_GE(span.duration, 2000 - 10);
+        ASSERT_LE(span.duration, after - before + 100);
+    }
+}
+
+}  // namespace runtime
+}  // namespace jaeger_struct
@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include <jaeger-struct/runtime/encoder.h>
+#include <jaeger-struct/runtime/iov.h>
+#include <jaeger.h>
+#include <jaeger.pb.h>
+
+namespace jaeger_struct {
+namespace runtime {
+namespace {
+
+constexpr auto kSpans = 1000;
+
+// The same batch as a libprotobuf message and as a struct decoded from its
+// serialization by the table-driven codec.
+struct Fixture {
+    Fixture()
+    {
+        std::mt19937_64 random(1);
+        message.mutable_process()->set_service_name("frontend");
+        for (auto i = 0; i < kSpans; ++i) {
+            auto& span = *message.add_spans();
+            span.mutable_trace_id()->set_high(random());
+            span.mutable_trace_id()->set_low(random());
+            span.set_span_id(random());
+            span.set_operation_name("GET /api/users");
+            span.set_start_time(1500000000000000 + i * 1000);
+            span.set_duration(random() % 100000);
+            for (auto j = 0; j < 4; ++j) {
+                auto& tag = *span.add_tags();
+                tag.set_key("http.status_code");
+                tag.set_long_value(200 + j);
+            }
+        }
+        message.SerializeToString(&encoded);
+
+        std::memset(&batch, 0, sizeof(batch));
+        if (!jaegertracing_protobuf_batch_decode(
+                &batch, encoded.data(), encoded.size())) {
+            throw std::runtime_error("Cannot decode batch");
+        }
+    }
+
+    ~Fixture() { jaegertracing_protobuf_batch_destroy(&batch); }
+
+    jaegertracing::protobuf::Batch message;
+    std::string encoded;
+    jaegertracing_protobuf_batch batch;
+};
+
+Fixture& fixture()
+{
+    static Fixture instance;
+    return instance;
+}
+
+// Spans dominated by kilobyte log payloads.
+struct LogFixture {
+    LogFixture()
+    {
+        jaegertracing::protobuf::Batch message;
+        message.mutable_process()->set_service_name("frontend");
+        for (auto i = 0; i < kSpans / 10; ++i) {
+            auto& span = *message.add_spans();
+            span.set_span_id(i + 1);
+            span.set_operation_name("GET /api/users");
+            for (auto j = 0; j < 2; ++j) {
+                auto& log = *span.add_logs();
+                log.set_timestamp(1500000000000000 + i * 1000 + j);
+                auto& field = *log.add_fields();
+                field.set_key("payload");
+                field.set_str_value(std::string(4096, 'a' + j));
+            }
+        }
+        message.SerializeToString(&encoded);
+
+        std::memset(&batch, 0, sizeof(batch));
+        if (!jaegertracing_protobuf_batch_decode(
+                &batch, encoded.data(), encoded.size())) {
+            throw std::runtime_error("Cannot decode batch");
+        }
+    }
+
+    ~LogFixture() { jaegertracing_protobuf_batch_destroy(&batch); }
+
+    std::string encoded;
+    jaegertracing_protobuf_batch batch;
+};
+
+LogFixture& logFixture()
+{
+    static LogFixture instance;
+    return instance;
+}
+
+void BM_ProtobufSerialize(benchmark::State& state)
+{
+    auto& data = fixture();
+    std::string output;
+    for (auto _ : state) {
+        output.clear();
+        data.message.SerializeToString(&output);
+        benchmark::DoNotOptimize(output.data());
+    }
+    state.SetBytesProcessed(state.iterations() * data.encoded.size());
+}
+BENCHMARK(BM_ProtobufSerialize);
+
+void BM_TableEncode(benchmark::State& state)
+{
+    auto& data = fixture();
+    jaeger_buffer output;
+    std::memset(&output, 0, sizeof(output));
+    for (auto _ : state) {
+        output.size = 0;
+        jaegertracing_protobuf_batch_encode(&data.batch, &output);
+        benchmark::DoNotOptimize(output.data);
+    }
+    state.SetBytesProcessed(state.iterations() * data.encoded.size());
+    if (std::string(reinterpret_cast<const char*>(output.data), output.size) !=
+        data.encoded) {
+        state.SkipWithError("Encoding differs from libprotobuf");
+    }
+    jaeger_buffer_destroy(&output);
+}
+BENCHMARK(BM_TableEncode);
+
+void BM_ParallelEncode(benchmark::State& state)
+{
+    auto& data = fixture();
+    jaeger_encoder encoder;
+    if (!jaeger_encoder_init(&encoder, state.range(0))) {
+        state.SkipWithError("Cannot start encoder");
+        return;
+    }
+    jaeger_buffer output;
+    std::memset(&output, 0, sizeof(output));
+    for (auto _ : state) {
+        output.size = 0;
+        jaeger_encoder_encode(&encoder,
+                              &jaegertracing_protobuf_batch_table,
+                              &data.batch,
+                              2,
+                              &output);
+        benchmark::DoNotOptimize(output.data);
+    }
+    state.SetBytesProcessed(state.iterations() * data.encoded.size());
+    if (std::string(reinterpret_cast<const char*>(output.data), output.size) !=
+        data.encoded) {
+        state.SkipWithError("Encoding differs from libprotobuf");
+    }
+    jaeger_buffer_destroy(&output);
+    jaeger_encoder_destroy(&encoder);
+}
+BENCHMARK(BM_ParallelEncode)->RangeMultiplier(2)->Range(1, 16)->UseRealTime();
+
+void BM_TableEncodeLogs(benchmark::State& state)
+{
+    auto& data = logFixture();
+    jaeger_buffer output;
+    std::memset(&output, 0, sizeof(output));
+    for (auto _ : state) {
+        output.size = 0;
+        jaegertracing_protobuf_batch_encode(&data.batch, &output);
+        benchmark::DoNotOptimize(output.data);
+    }
+    state.SetBytesProcessed(state.iterations() * data.encoded.size());
+    jaeger_buffer_destroy(&output);
+}
+BENCHMARK(BM_TableEncodeLogs);
+
+void BM_IovEncodeLogs(benchmark::State& state)
+{
+    auto& data = logFixture();
+    jaeger_iov_buffer output;
+    jaeger_iov_buffer_init(&output, JAEGER_IOV_DEFAULT_THRESHOLD);
+    for (auto _ : state) {
+        jaeger_iov_buffer_reset(&output);
+        jaegertracing_protobuf_batch_encode_iov(&data.batch, &output);
+        benchmark::DoNotOptimize(output.iov);
+    }
+    state.SetBytesProcessed(state.iterations() * data.encoded.size());
+    if (output.size != data.encoded.size()) {
+        state.SkipWithError("Encoding differs from libprotobuf");
+    }
+    jaeger_iov_buffer_destroy(&output);
+}
+BENCHMARK(BM_IovEncodeLogs);
+
+void BM_ProtobufParse(benchmark::State& state)
+{
+    auto& data = fixture();
+    for (auto _ : state) {
+        jaegertracing::protobuf::Batch message;
+        message.ParseFromString(data.encoded);
+        benchmark::DoNotOptimize(&message);
+    }
+    state.SetBytesProcessed(state.iterations() * data.encoded.size());
+}
+BENCHMARK(BM_ProtobufParse);
+
+void BM_TableDecode(benchmark::State& state)
+{
+    auto& data = fixture();
+    for (auto _ : state) {
+        jaegertracing_protobuf_batch batch;
+        std::memset(&batch, 0, sizeof(batch));
+        jaegertracing_protobuf_batch_decode(
+            &batch, data.encoded.data(), data.encoded.size());
+        jaegertracing_protobuf_batch_destroy(&batch);
+    }
+    state.SetBytesProcessed(state.iterations() * data.encoded.size());
+}
+BENCHMARK(BM_TableDecode);
+
+}  // anonymous namespace
+}  // namespace runtime
+}  // namespace jaeger_struct
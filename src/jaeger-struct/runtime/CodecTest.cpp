@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/codec.h>
+
+#include <cstring>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <jaeger-struct/runtime/TestUtil.hpp>
+#include <jaeger.h>
+
+namespace jaeger_struct {
+namespace runtime {
+
+TEST(Codec, testWireFormat)
+{
+    jaegertracing_protobuf_trace_id traceID{ 1, 300 };
+    jaeger_buffer buffer;
+    std::memset(&buffer, 0, sizeof(buffer));
+    ASSERT_TRUE(jaegertracing_protobuf_trace_id_encode(&traceID, &buffer));
+    ASSERT_EQ(std::string("\x08\x01\x10\xac\x02", 5), toString(buffer));
+
+    buffer.size = 0;
+    jaegertracing_protobuf_span span;
+    std::memset(&span, 0, sizeof(span));
+    span.flags = -1;
+    ASSERT_TRUE(jaegertracing_protobuf_span_encode(&span, &buffer));
+    // Negative int32 values are sign extended to ten bytes.
+    ASSERT_EQ(std::string("\x30\xff\xff\xff\xff\xff\xff\xff\xff\xff\x01", 11),
+              toString(buffer));
+
+    buffer.size = 0;
+    jaegertracing_protobuf_tag tag;
+    std::memset(&tag, 0, sizeof(tag));
+    tag.value.type = jaegertracing_protobuf_tag_value_bool_value_type;
+    ASSERT_TRUE(jaegertracing_protobuf_tag_encode(&tag, &buffer));
+    // Oneof members are written even if zero.
+    ASSERT_EQ(std::string("\x20\x00", 2), toString(buffer));
+    jaeger_buffer_destroy(&buffer);
+}
+
+TEST(Codec, testRoundTrip)
+{
+    jaegertracing_protobuf_batch batch;
+    std::memset(&batch, 0, sizeof(batch));
+    assign(batch.process.service_name, "frontend");
+    for (auto i = 0; i < 20; ++i) {
+        auto& span = appendNode<SpanNode>(batch.spans)->value;
+        span.trace_id.high = i;
+        span.trace_id.low = ~uint64_t(i);
+        span.span_id = i + 1;
+        span.start_time = 1500000000000000 + i;
+        span.duration = -i;
+        assign(span.operation_name, std::string(i * 10, 'x'));
+        auto& ref = appendNode<SpanRefNode>(
+                        *jaegertracing_protobuf_span_mutable_references(&span))
+                        ->value;
+        ref.type = jaegertracing_protobuf_span_ref_type_follows_from;
+        ref.span_id = i;
+        auto& tag =
+            appendNode<TagNode>(*jaegertracing_protobuf_span_mutable_tags(&span))
+                ->value;
+        assign(tag.key, "error");
+        if (i % 2 == 0) {
+            tag.value.type = jaegertracing_protobuf_tag_value_str_value_type;
+            assign(tag.value.value.str_value, "timeout");
+        }
+        else {
+            tag.value.type = jaegertracing_protobuf_tag_value_double_value_type;
+            tag.value.value.double_value = i / 4.0;
+        }
+    }
+
+    jaeger_buffer buffer;
+    std::memset(&buffer, 0, sizeof(buffer));
+    ASSERT_TRUE(jaegertracing_protobuf_batch_encode(&batch, &buffer));
+
+    jaegertracing_protobuf_batch copy;
+    std::memset(&copy, 0, sizeof(copy));
+    ASSERT_TRUE(
+        jaegertracing_protobuf_batch_decode(&copy, buffer.data, buffer.size));
+    ASSERT_EQ("frontend", toString(copy.process.service_name));
+    ASSERT_EQ(20u, jaeger_list_size(&copy.spans));
+    const jaeger_list* expected = batch.spans.next;
+    for (const jaeger_list* node = copy.spans.next; node != nullptr;
+         node = node->next, expected = expected->next) {
+        auto& lhs = reinterpret_cast<const SpanNode*>(expected)->value;
+        auto& rhs = reinterpret_cast<const SpanNode*>(node)->value;
+        ASSERT_EQ(lhs.trace_id.high, rhs.trace_id.high);
+        ASSERT_EQ(lhs.trace_id.low, rhs.trace_id.low);
+        ASSERT_EQ(lhs.span_id, rhs.span_id);
+        ASSERT_EQ(lhs.start_time, rhs.start_time);
+        ASSERT_EQ(lhs.duration, rhs.duration);
+        ASSERT_EQ(toString(lhs.operation_name), toString(rhs.operation_name));
+        auto& ref = reinterpret_cast<const SpanRefNode*>(
+                        jaegertracing_protobuf_span_get_references(&rhs).next)
+                        ->value;
+        ASSERT_EQ(jaegertracing_protobuf_span_ref_type_follows_from, ref.type);
+        ASSERT_EQ(lhs.span_id - 1, ref.span_id);
+        auto& lhsTag = reinterpret_cast<const TagNode*>(
+                           jaegertracing_protobuf_span_get_tags(&lhs).next)
+                           ->value;
+        auto& rhsTag = reinterpret_cast<const TagNode*>(
+                           jaegertracing_protobuf_span_get_tags(&rhs).next)
+                           ->value;
+        ASSERT_EQ(lhsTag.value.type, rhsTag.value.type);
+        if (rhsTag.value.type ==
+            jaegertracing_protobuf_tag_value_str_value_type) {
+            ASSERT_EQ("timeout", toString(rhsTag.value.value.str_value));
+        }
+        else {
+            ASSERT_EQ(lhsTag.value.value.double_value,
+                      rhsTag.value.value.double_value);
+        }
+    }
+
+    jaeger_buffer reencoded;
+    std::memset(&reencoded, 0, sizeof(reencoded));
+    ASSERT_TRUE(jaegertracing_protobuf_batch_encode(&copy, &reencoded));
+    ASSERT_EQ(toString(buffer), toString(reencoded));
+    jaegertracing_protobuf_batch_destroy(&copy);
+
+    // Truncated input may end on a field boundary, so only the last byte is
+    // certain to be detected.
+    for (size_t size = 0; size < buffer.size; ++size) {
+        std::memset(&copy, 0, sizeof(copy));
+        const auto decoded =
+            jaegertracing_protobuf_batch_decode(&copy, buffer.data, size);
+        jaegertracing_protobuf_batch_destroy(&copy);
+        if (size == buffer.size - 1) {
+            ASSERT_FALSE(decoded);
+        }
+    }
+
+    jaeger_buffer_destroy(&reencoded);
+    jaeger_buffer_destroy(&buffer);
+    jaegertracing_protobuf_batch_destroy(&batch);
+}
+
+TEST(Codec, testDecodeMerge)
+{
+    // Unknown field 15, then str_value replaced by long_value in the oneof.
+    const std::string input("\x78\x05"
+                            "\x0a\x01k"
+                            "\x12\x03str"
+                            "\x28\x2a",
+                            12);
+    jaegertracing_protobuf_tag tag;
+    std::memset(&tag, 0, sizeof(tag));
+    ASSERT_TRUE(jaegertracing_protobuf_tag_decode(
+        &tag, input.data(), input.size()));
+    ASSERT_EQ("k", toString(tag.key));
+    ASSERT_EQ(jaegertracing_protobuf_tag_value_long_value_type, tag.value.type);
+    ASSERT_EQ(42, tag.value.value.long_value);
+    jaegertracing_protobuf_tag_destroy(&tag);
+
+    ASSERT_TRUE(jaeger_enum_table_contains(
+        &jaegertracing_protobuf_span_ref_type_table,
+        jaegertracing_protobuf_span_ref_type_follows_from));
+    ASSERT_FALSE(jaeger_enum_table_contains(
+        &jaegertracing_protobuf_span_ref_type_table, 2));
+}
+
+TEST(Codec, testUtf8)
+{
+    // key "k\xff", then binary_value "\xff", which bytes fields allow.
+    const std::string input("\x0a\x02k\xff"
+                            "\x32\x01\xff",
+                            7);
+    jaegertracing_protobuf_tag tag;
+    std::memset(&tag, 0, sizeof(tag));
+    ASSERT_FALSE(jaegertracing_protobuf_tag_decode(
+        &tag, input.data(), input.size()));
+    jaegertracing_protobuf_tag_destroy(&tag);
+    std::memset(&tag, 0, sizeof(tag));
+    ASSERT_TRUE(jaegertracing_protobuf_tag_decode(
+        &tag, input.data() + 4, input.size() - 4));
+    ASSERT_EQ(jaegertracing_protobuf_tag_value_binary_value_type,
+              tag.value.type);
+    ASSERT_TRUE(jaegertracing_protobuf_tag_decode_trusted(
+        &tag, input.data(), input.size()));
+    ASSERT_EQ("k\xff", toString(tag.key));
+
+    jaeger_buffer buffer;
+    std::memset(&buffer, 0, sizeof(buffer));
+    ASSERT_FALSE(jaegertracing_protobuf_tag_encode(&tag, &buffer));
+    ASSERT_EQ(0u, buffer.size);
+    jaeger_iov_buffer iov;
+    jaeger_iov_buffer_init(&iov, JAEGER_IOV_DEFAULT_THRESHOLD);
+    ASSERT_FALSE(jaegertracing_protobuf_tag_encode_iov(&tag, &iov));
+    ASSERT_TRUE(jaegertracing_protobuf_tag_encode_iov_trusted(&tag, &iov));
+    ASSERT_EQ(input.size(), iov.size);
+    ASSERT_TRUE(jaegertracing_protobuf_tag_encode_trusted(&tag, &buffer));
+    ASSERT_EQ(input, toString(buffer));
+
+    assign(tag.key, "k\xc3\xa9");
+    buffer.size = 0;
+    ASSERT_TRUE(jaegertracing_protobuf_tag_encode(&tag, &buffer));
+    jaeger_iov_buffer_destroy(&iov);
+    jaeger_buffer_destroy(&buffer);
+    jaegertracing_protobuf_tag_destroy(&tag);
+}
+
+}  // namespace runtime
+}  // namespace jaeger_struct
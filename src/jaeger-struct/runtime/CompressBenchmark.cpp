@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <random>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include <jaeger-struct/runtime/lz.h>
+
+#include <jaeger.h>
+#include <jaeger.pb.h>
+
+namespace jaeger_struct {
+namespace runtime {
+namespace {
+
+constexpr auto kSpans = 10000;
+
+const char* const kOperations[] = {
+    "GET /api/users", "POST /api/orders", "GET /health", "db.query"
+};
+const char* const kTagKeys[] = { "http.method", "http.status_code", "component" };
+
+// Spans as a tracer would emit them: increasing start times, a handful of
+// operation names and repeated tag keys.
+struct Fixture {
+    Fixture()
+    {
+        std::memset(&columns, 0, sizeof(columns));
+        std::mt19937_64 random(1);
+        auto startTime = int64_t(1500000000000000);
+        for (auto i = 0; i < kSpans; ++i) {
+            auto& span = *message.add_spans();
+            span.mutable_trace_id()->set_high(random());
+            span.mutable_trace_id()->set_low(random());
+            span.set_span_id(random());
+            span.set_parent_span_id(random() % 4 == 0 ? 0 : random());
+            span.set_operation_name(kOperations[random() % 4]);
+            startTime += random() % 2000;
+            span.set_start_time(startTime);
+            span.set_duration(random() % 100000);
+            for (auto&& key : kTagKeys) {
+                auto& tag = *span.add_tags();
+                tag.set_key(key);
+                tag.set_long_value(random() % 8);
+            }
+        }
+        message.SerializeToString(&encoded);
+
+        for (auto&& span : message.spans()) {
+            jaegertracing_protobuf_span row;
+            std::memset(&row, 0, sizeof(row));
+            row.trace_id.high = span.trace_id().high();
+            row.trace_id.low = span.trace_id().low();
+            row.span_id = span.span_id();
+            row.parent_span_id = span.parent_span_id();
+            row.operation_name.buffer =
+                const_cast<char*>(span.operation_name().data());
+            row.operation_name.len = span.operation_name().size();
+            row.start_time = span.start_time();
+            row.duration = span.duration();
+            jaegertracing_protobuf_span_columns_append(&columns, &row);
+            for (auto&& tag : span.tags()) {
+                jaegertracing_protobuf_tag value;
+                std::memset(&value, 0, sizeof(value));
+                value.key.buffer = const_cast<char*>(tag.key().data());
+                value.key.len = tag.key().size();
+                value.value.type =
+                    jaegertracing_protobuf_tag_value_long_value_type;
+                value.value.value.long_value = tag.long_value();
+                jaegertracing_protobuf_tag_columns_append(&columns.tags,
+                                                          &value);
+            }
+            columns.tags_offsets[columns.size] = columns.tags.size;
+        }
+    }
+
+    ~Fixture() { jaegertracing_protobuf_span_columns_destroy(&columns); }
+
+    jaegertracing::protobuf::Batch message;
+    std::string encoded;
+    jaegertracing_protobuf_span_columns columns;
+};
+
+Fixture& fixture()
+{
+    static Fixture instance;
+    return instance;
+}
+
+void BM_ProtobufEncode(benchmark::State& state)
+{
+    auto& data = fixture();
+    std::string output;
+    for (auto _ : state) {
+        output.clear();
+        data.message.SerializeToString(&output);
+        benchmark::DoNotOptimize(output.data());
+    }
+    state.SetBytesProcessed(state.iterations() * data.encoded.size());
+    state.counters["ratio"] = 1;
+}
+BENCHMARK(BM_ProtobufEncode);
+
+void BM_ColumnsCompress(benchmark::State& state)
+{
+    auto& data = fixture();
+    jaeger_buffer output;
+    std::memset(&output, 0, sizeof(output));
+    for (auto _ : state) {
+        output.size = 0;
+        jaegertracing_protobuf_span_columns_compress(&data.columns, &output);
+        benchmark::DoNotOptimize(output.data);
+    }
+    state.SetBytesProcessed(state.iterations() * data.encoded.size());
+    state.counters["ratio"] =
+        static_cast<double>(data.encoded.size()) / output.size;
+    jaeger_buffer_destroy(&output);
+}
+BENCHMARK(BM_ColumnsCompress);
+
+void BM_ColumnsDecompress(benchmark::State& state)
+{
+    auto& data = fixture();
+    jaeger_buffer compressed;
+    std::memset(&compressed, 0, sizeof(compressed));
+    jaegertracing_protobuf_span_columns_compress(&data.columns, &compressed);
+    for (auto _ : state) {
+        jaegertracing_protobuf_span_columns columns;
+        std::memset(&columns, 0, sizeof(columns));
+        jaegertracing_protobuf_span_columns_decompress(
+            &columns, compressed.data, compressed.size);
+        jaegertracing_protobuf_span_columns_destroy(&columns);
+    }
+    state.SetBytesProcessed(state.iterations() * data.encoded.size());
+    jaeger_buffer_destroy(&compressed);
+}
+BENCHMARK(BM_ColumnsDecompress);
+
+void BM_LZCompressProtobuf(benchmark::State& state)
+{
+    auto& data = fixture();
+    std::string output(jaeger_lz_bound(data.encoded.size()), '\0');
+    size_t size = 0;
+    for (auto _ : state) {
+        size = jaeger_lz_compress(
+            data.encoded.data(), data.encoded.size(), &output[0], output.size());
+        benchmark::DoNotOptimize(size);
+    }
+    state.SetBytesProcessed(state.iterations() * data.encoded.size());
+    state.counters["ratio"] = static_cast<double>(data.encoded.size()) / size;
+}
+BENCHMARK(BM_LZCompressProtobuf);
+
+}  // anonymous namespace
+}  // namespace runtime
+}  // namespace jaeger_struct
+
+BENCHMARK_MAIN();
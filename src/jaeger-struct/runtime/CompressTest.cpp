@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/compress.h>
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <jaeger-struct/runtime/lz.h>
+
+#include <jaeger.h>
+
+namespace jaeger_struct {
+namespace runtime {
+namespace {
+
+std::string lzRoundTrip(const std::string& input)
+{
+    std::vector<uint8_t> compressed(jaeger_lz_bound(input.size()));
+    const auto size = jaeger_lz_compress(
+        input.data(), input.size(), compressed.data(), compressed.size());
+    EXPECT_NE(0u, size);
+    std::string output(input.size(), '\0');
+    EXPECT_TRUE(jaeger_lz_decompress(
+        compressed.data(), size, &output[0], output.size()));
+    return output;
+}
+
+jaegertracing_protobuf_span_columns makeColumns(size_t size)
+{
+    const char* operations[] = { "GET /users", "POST /orders", "GET /health" };
+    jaegertracing_protobuf_span_columns columns;
+    std::memset(&columns, 0, sizeof(columns));
+    std::mt19937_64 random(42);
+    for (size_t i = 0; i < size; ++i) {
+        jaegertracing_protobuf_span span;
+        std::memset(&span, 0, sizeof(span));
+        span.trace_id.high = random();
+        span.trace_id.low = random();
+        span.span_id = random();
+        span.start_time = 1500000000000000 + i * 1000 + random() % 10;
+        span.duration = random() % 100000;
+        const auto* operation = operations[random() % 3];
+        span.operation_name.buffer = const_cast<char*>(operation);
+        span.operation_name.len = std::strlen(operation);
+        EXPECT_TRUE(jaegertracing_protobuf_span_columns_append(&columns, &span));
+    }
+    return columns;
+}
+
+}  // anonymous namespace
+
+TEST(Compress, testLZRoundTrip)
+{
+    std::mt19937 random(7);
+    for (size_t size = 0; size < 64; ++size) {
+        std::string input(size, 'a');
+        for (auto&& ch : input) {
+            ch = 'a' + random() % 3;
+        }
+        ASSERT_EQ(input, lzRoundTrip(input));
+    }
+
+    std::string text;
+    for (auto i = 0; i < 1000; ++i) {
+        text += "span operation_name=GET /users/" + std::to_string(i % 17) +
+                " service=frontend\n";
+    }
+    ASSERT_EQ(text, lzRoundTrip(text));
+    std::vector<uint8_t> compressed(jaeger_lz_bound(text.size()));
+    ASSERT_LT(jaeger_lz_compress(
+                  text.data(), text.size(), compressed.data(), compressed.size()),
+              text.size() / 10);
+
+    std::string noise(100000, '\0');
+    for (auto&& ch : noise) {
+        ch = static_cast<char>(random());
+    }
+    ASSERT_EQ(noise, lzRoundTrip(noise));
+}
+
+TEST(Compress, testInts)
+{
+    std::vector<int64_t> timestamps;
+    for (auto i = 0; i < 1000; ++i) {
+        timestamps.push_back(1500000000000000 + i * 1000);
+    }
+    jaeger_buffer block;
+    std::memset(&block, 0, sizeof(block));
+    ASSERT_TRUE(jaeger_block_put_ints(&block,
+                                      timestamps.data(),
+                                      sizeof(int64_t),
+                                      true,
+                                      timestamps.size()));
+    // Delta-of-delta reduces a fixed-interval series to one byte per value.
+    ASSERT_LE(block.size, timestamps.size() + 16);
+
+    std::vector<int32_t> small{ -1, 0, 1, -2147483647 - 1, 2147483647 };
+    std::vector<uint8_t> bytes{ 0, 1, 255, 3 };
+    ASSERT_TRUE(jaeger_block_put_ints(
+        &block, small.data(), sizeof(int32_t), true, small.size()));
+    ASSERT_TRUE(jaeger_block_put_ints(
+        &block, bytes.data(), sizeof(uint8_t), false, bytes.size()));
+
+    jaeger_block_reader reader{ block.data, block.data + block.size };
+    std::vector<int64_t> timestampsCopy(timestamps.size());
+    std::vector<int32_t> smallCopy(small.size());
+    std::vector<uint8_t> bytesCopy(bytes.size());
+    ASSERT_TRUE(jaeger_block_get_ints(&reader,
+                                      timestampsCopy.data(),
+                                      sizeof(int64_t),
+                                      true,
+                                      timestampsCopy.size()));
+    ASSERT_TRUE(jaeger_block_get_ints(
+        &reader, smallCopy.data(), sizeof(int32_t), true, smallCopy.size()));
+    ASSERT_TRUE(jaeger_block_get_ints(
+        &reader, bytesCopy.data(), sizeof(uint8_t), false, bytesCopy.size()));
+    ASSERT_EQ(reader.end, reader.pos);
+    ASSERT_EQ(timestamps, timestampsCopy);
+    ASSERT_EQ(small, smallCopy);
+    ASSERT_EQ(bytes, bytesCopy);
+    jaeger_buffer_destroy(&block);
+}
+
+TEST(Compress, testColumnsRoundTrip)
+{
+    auto columns = makeColumns(1000);
+    jaeger_buffer compressed;
+    std::memset(&compressed, 0, sizeof(compressed));
+    ASSERT_TRUE(
+        jaegertracing_protobuf_span_columns_compress(&columns, &compressed));
+
+    jaegertracing_protobuf_span_columns copy;
+    std::memset(&copy, 0, sizeof(copy));
+    ASSERT_TRUE(jaegertracing_protobuf_span_columns_decompress(
+        &copy, compressed.data, compressed.size));
+    ASSERT_EQ(columns.size, copy.size);
+    for (size_t i = 0; i < columns.size; ++i) {
+        ASSERT_EQ(columns.trace_id_high[i], copy.trace_id_high[i]);
+        ASSERT_EQ(columns.span_id[i], copy.span_id[i]);
+        ASSERT_EQ(columns.start_time[i], copy.start_time[i]);
+        ASSERT_EQ(columns.duration[i], copy.duration[i]);
+        const auto lhs = jaeger_string_column_get(&columns.operation_name, i);
+        const auto rhs = jaeger_string_column_get(&copy.operation_name, i);
+        ASSERT_EQ(std::string(lhs.buffer, lhs.len),
+                  std::string(rhs.buffer, rhs.len));
+        ASSERT_EQ(0u, copy.tags_offsets[i + 1]);
+    }
+    jaegertracing_protobuf_span_columns_destroy(&copy);
+
+    for (size_t size = 0; size < compressed.size; size += 7) {
+        std::memset(&copy, 0, sizeof(copy));
+        ASSERT_FALSE(jaegertracing_protobuf_span_columns_decompress(
+            &copy, compressed.data, size));
+        jaegertracing_protobuf_span_columns_destroy(&copy);
+    }
+
+    jaeger_buffer_destroy(&compressed);
+    jaegertracing_protobuf_span_columns_destroy(&columns);
+}
+
+}  // namespace runtime
+}  // namespace jaeger_struct
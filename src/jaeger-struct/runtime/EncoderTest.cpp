@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/encoder.h>
+
+#include <cstring>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <jaeger-struct/runtime/TestUtil.hpp>
+#include <jaeger.h>
+
+namespace jaeger_struct {
+namespace runtime {
+namespace {
+
+// Spans of very different sizes, so that workers finish unevenly.
+void makeBatch(jaegertracing_protobuf_batch& batch, int numSpans)
+{
+    fillBatch(batch, numSpans, [](jaegertracing_protobuf_span& span, int i) {
+        span.trace_id.low = i;
+        assign(span.operation_name, "GET");
+        for (auto j = 0; j < (i % 7) * (i % 5); ++j) {
+            auto& tag = appendTag(span, "key");
+            tag.value.type = jaegertracing_protobuf_tag_value_long_value_type;
+            tag.value.value.long_value = j;
+        }
+    });
+}
+
+}  // anonymous namespace
+
+TEST(Encoder, testEncode)
+{
+    jaeger_encoder encoder;
+    ASSERT_TRUE(jaeger_encoder_init(&encoder, 4));
+    jaeger_buffer buffer;
+    std::memset(&buffer, 0, sizeof(buffer));
+    for (auto numSpans : { 0, 10, 1000, 3 * 1000 + 7 }) {
+        jaegertracing_protobuf_batch batch;
+        makeBatch(batch, numSpans);
+        buffer.size = 0;
+        ASSERT_TRUE(jaeger_encoder_encode(
+            &encoder, &jaegertracing_protobuf_batch_table, &batch, 2, &buffer));
+        ASSERT_EQ(encode(batch), toString(buffer));
+        jaegertracing_protobuf_batch_destroy(&batch);
+    }
+    jaeger_buffer_destroy(&buffer);
+    jaeger_encoder_destroy(&encoder);
+}
+
+TEST(Encoder, testInvalidField)
+{
+    jaeger_encoder encoder;
+    ASSERT_FALSE(jaeger_encoder_init(&encoder, 0));
+    ASSERT_TRUE(jaeger_encoder_init(&encoder, 2));
+    jaegertracing_protobuf_batch batch;
+    makeBatch(batch, 1);
+    jaeger_buffer buffer;
+    std::memset(&buffer, 0, sizeof(buffer));
+    // Process is not repeated, and there is no field 3.
+    ASSERT_FALSE(jaeger_encoder_encode(
+        &encoder, &jaegertracing_protobuf_batch_table, &batch, 1, &buffer));
+    ASSERT_FALSE(jaeger_encoder_encode(
+        &encoder, &jaegertracing_protobuf_batch_table, &batch, 3, &buffer));
+    ASSERT_EQ(0u, buffer.size);
+    jaegertracing_protobuf_batch_destroy(&batch);
+    jaeger_encoder_destroy(&encoder);
+}
+
+}  // namespace runtime
+}  // namespace jaeger_struct
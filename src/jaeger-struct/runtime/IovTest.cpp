@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/iov.h>
+
+#include <cstring>
+#include <string>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <jaeger-struct/runtime/TestUtil.hpp>
+#include <jaeger.h>
+
+namespace jaeger_struct {
+namespace runtime {
+namespace {
+
+constexpr auto kThreshold = 256u;
+
+// Log payloads alternate between below and above the threshold.
+void makeBatch(jaegertracing_protobuf_batch& batch, int numSpans)
+{
+    fillBatch(batch, numSpans, [](jaegertracing_protobuf_span& span, int i) {
+        span.duration = 1000 * i;
+        assign(span.operation_name, "GET");
+        auto* logs = jaegertracing_protobuf_span_mutable_logs(&span);
+        ASSERT_NE(nullptr, logs);
+        for (auto j = 0; j < 3; ++j) {
+            auto& log = appendNode<LogNode>(*logs)->value;
+            log.timestamp = i * 3 + j;
+            auto& tag = appendNode<TagNode>(log.fields)->value;
+            assign(tag.key, "event");
+            tag.value.type = jaegertracing_protobuf_tag_value_str_value_type;
+            assign(tag.value.value.str_value,
+                   std::string((i + j) % 2 ? 4000 : 100, 'a' + j));
+        }
+    });
+}
+
+std::string flatten(const jaeger_iov_buffer& buffer)
+{
+    std::string result;
+    for (auto i = 0u; i < buffer.count; ++i) {
+        result.append(static_cast<const char*>(buffer.iov[i].iov_base),
+                      buffer.iov[i].iov_len);
+    }
+    return result;
+}
+
+bool isReferenced(const jaeger_iov_buffer& buffer, const void* data)
+{
+    for (auto i = 0u; i < buffer.count; ++i) {
+        if (buffer.iov[i].iov_base == data) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // anonymous namespace
+
+TEST(Iov, testAppend)
+{
+    jaeger_iov_buffer buffer;
+    jaeger_iov_buffer_init(&buffer, 8);
+    const std::string large(10, 'x');
+    ASSERT_TRUE(jaeger_iov_buffer_append(&buffer, "ab", 2));
+    ASSERT_TRUE(jaeger_iov_buffer_append_varint(&buffer, 300));
+    ASSERT_EQ(1u, buffer.count);
+    ASSERT_TRUE(jaeger_iov_buffer_append(&buffer, large.data(), large.size()));
+    ASSERT_TRUE(jaeger_iov_buffer_append(&buffer, "cd", 2));
+    ASSERT_EQ(3u, buffer.count);
+    ASSERT_EQ(large.data(), buffer.iov[1].iov_base);
+    ASSERT_EQ(std::string("ab\xac\x02") + large + "cd", flatten(buffer));
+    ASSERT_EQ(16u, buffer.size);
+
+    jaeger_iov_buffer_truncate(&buffer, 1, 3);
+    ASSERT_EQ("ab\xac", flatten(buffer));
+    ASSERT_TRUE(jaeger_iov_buffer_append(&buffer, "ef", 2));
+    ASSERT_EQ("ab\xac" "ef", flatten(buffer));
+    ASSERT_EQ(5u, buffer.size);
+
+    jaeger_iov_buffer_reset(&buffer);
+    ASSERT_EQ(0u, buffer.count);
+    // Copies larger than a chunk get a chunk of their own.
+    const std::string huge(10000, 'y');
+    ASSERT_TRUE(jaeger_iov_buffer_copy(&buffer, huge.data(), huge.size()));
+    ASSERT_EQ(huge, flatten(buffer));
+    jaeger_iov_buffer_destroy(&buffer);
+}
+
+TEST(Iov, testEncode)
+{
+    jaeger_iov_buffer buffer;
+    jaeger_iov_buffer_init(&buffer, kThreshold);
+    for (auto numSpans : { 0, 1, 100 }) {
+        jaegertracing_protobuf_batch batch;
+        makeBatch(batch, numSpans);
+        jaeger_iov_buffer_reset(&buffer);
+        ASSERT_TRUE(jaegertracing_protobuf_batch_encode_iov(&batch, &buffer));
+        const auto expected = encode(batch);
+        ASSERT_EQ(expected.size(), buffer.size);
+        ASSERT_EQ(expected, flatten(buffer));
+        // Every large payload is referenced, with the small pieces between
+        // them coalesced, except across the 4 KiB scratch chunks.
+        auto numLarge = 0u;
+        auto largeSize = 0u;
+        const jaeger_list* spanNode;
+        JAEGER_LIST_FOR_EACH(&batch.spans, spanNode)
+        {
+            const auto& span =
+                reinterpret_cast<const SpanNode*>(spanNode)->value;
+            const jaeger_list* logNode;
+            JAEGER_LIST_FOR_EACH(&jaegertracing_protobuf_span_get_logs(&span),
+                                 logNode)
+            {
+                const auto& log =
+                    reinterpret_cast<const LogNode*>(logNode)->value;
+                const auto& value = reinterpret_cast<const TagNode*>(
+                                        log.fields.next)->value.value;
+                if (value.value.str_value.len >= kThreshold) {
+                    ++numLarge;
+                    largeSize += value.value.str_value.len;
+                    ASSERT_TRUE(
+                        isReferenced(buffer, value.value.str_value.buffer));
+                }
+            }
+        }
+        const auto numChunks = (buffer.size - largeSize) / 4000 + 1;
+        ASSERT_LE(buffer.count, 2 * numLarge + numChunks);
+        jaegertracing_protobuf_batch_destroy(&batch);
+    }
+    jaeger_iov_buffer_destroy(&buffer);
+}
+
+TEST(Iov, testWrite)
+{
+    jaegertracing_protobuf_batch batch;
+    makeBatch(batch, 3);
+    jaeger_iov_buffer buffer;
+    jaeger_iov_buffer_init(&buffer, kThreshold);
+    ASSERT_TRUE(jaegertracing_protobuf_batch_encode_iov(&batch, &buffer));
+    const auto expected = encode(batch);
+
+    int fds[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    ASSERT_TRUE(jaeger_iov_buffer_write(&buffer, fds[0]));
+    std::string received(expected.size(), '\0');
+    auto offset = 0u;
+    while (offset < received.size()) {
+        const auto result =
+            read(fds[1], &received[offset], received.size() - offset);
+        ASSERT_LT(0, result);
+        offset += result;
+    }
+    ASSERT_EQ(expected, received);
+    close(fds[0]);
+    close(fds[1]);
+
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_DGRAM, 0, fds));
+    ASSERT_TRUE(jaeger_iov_buffer_send(&buffer, fds[0], 0));
+    received.assign(expected.size() + 1, '\0');
+    ASSERT_EQ(static_cast<ssize_t>(expected.size()),
+              recv(fds[1], &received[0], received.size(), 0));
+    received.resize(expected.size());
+    ASSERT_EQ(expected, received);
+    close(fds[0]);
+    close(fds[1]);
+
+    jaeger_iov_buffer_destroy(&buffer);
+    jaegertracing_protobuf_batch_destroy(&batch);
+}
+
+}  // namespace runtime
+}  // namespace jaeger_struct
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/pool.h>
+
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <jaeger.h>
+
+namespace jaeger_struct {
+namespace runtime {
+namespace {
+
+typedef JAEGER_LIST(jaegertracing_protobuf_tag) TagNode;
+
+int destroyed = 0;
+
+void destroyObject(void* object)
+{
+    ASSERT_EQ(nullptr, *static_cast<void**>(object));
+    ++destroyed;
+}
+
+jaeger_pool smallPool = JAEGER_POOL_INIT(1, NULL);
+jaeger_pool batchPool = JAEGER_POOL_INIT(48, NULL);
+jaeger_pool retainingPool = JAEGER_POOL_INIT(16, destroyObject);
+
+}  // anonymous namespace
+
+TEST(Pool, testReuse)
+{
+    ASSERT_EQ(sizeof(void*), smallPool.object_size);
+    auto* object = static_cast<char*>(jaeger_pool_acquire(&smallPool));
+    ASSERT_NE(nullptr, object);
+    std::memset(object, 0xff, smallPool.object_size);
+    jaeger_pool_release(&smallPool, object);
+    auto* reused = static_cast<char*>(jaeger_pool_acquire(&smallPool));
+    ASSERT_EQ(object, reused);
+    for (auto i = 0u; i < smallPool.object_size; ++i) {
+        ASSERT_EQ(0, reused[i]);
+    }
+    jaeger_pool_release(&smallPool, reused);
+    jaeger_pool_release(&smallPool, nullptr);
+}
+
+TEST(Pool, testBatches)
+{
+    constexpr auto count = 4 * JAEGER_POOL_BATCH;
+    std::set<void*> objects;
+    std::thread producer([&objects]() {
+        std::vector<void*> acquired;
+        for (auto i = 0; i < count; ++i) {
+            acquired.push_back(jaeger_pool_acquire(&batchPool));
+        }
+        objects.insert(std::begin(acquired), std::end(acquired));
+        for (auto* object : acquired) {
+            jaeger_pool_release(&batchPool, object);
+        }
+    });
+    producer.join();
+    ASSERT_EQ(static_cast<size_t>(count), objects.size());
+
+    // The producer handed every object back in batches, partly while
+    // releasing and the rest on exit, so a new thread finds them all.
+    std::vector<void*> reused;
+    std::thread consumer([&reused]() {
+        for (auto i = 0; i < count; ++i) {
+            reused.push_back(jaeger_pool_acquire(&batchPool));
+        }
+        for (auto* object : reused) {
+            jaeger_pool_release(&batchPool, object);
+        }
+    });
+    consumer.join();
+    for (auto* object : reused) {
+        ASSERT_EQ(1u, objects.count(object));
+    }
+}
+
+TEST(Pool, testRetain)
+{
+    auto* object = static_cast<char*>(jaeger_pool_acquire(&retainingPool));
+    ASSERT_NE(nullptr, object);
+    std::memset(object + sizeof(void*), 0xff, sizeof(void*));
+    jaeger_pool_release(&retainingPool, object);
+    ASSERT_EQ(object, jaeger_pool_acquire(&retainingPool));
+    ASSERT_EQ(nullptr, *reinterpret_cast<void**>(object));
+    ASSERT_EQ('\xff', object[sizeof(void*)]);
+    jaeger_pool_release(&retainingPool, object);
+
+    // Objects cached by exited threads beyond the depot are destroyed.
+    std::thread([]() {
+        std::vector<void*> objects;
+        for (auto i = 0; i < JAEGER_POOL_BATCH + 1; ++i) {
+            objects.push_back(jaeger_pool_acquire(&retainingPool));
+        }
+        for (auto* object : objects) {
+            jaeger_pool_release(&retainingPool, object);
+        }
+    }).join();
+    ASSERT_EQ(1, destroyed);
+}
+
+TEST(Pool, testGenerated)
+{
+    auto* span = jaegertracing_protobuf_span_pool_acquire();
+    ASSERT_NE(nullptr, span);
+    auto* node = jaegertracing_protobuf_tag_node_pool_acquire();
+    ASSERT_NE(nullptr, node);
+    auto* tag = &reinterpret_cast<TagNode*>(node)->value;
+    ASSERT_TRUE(jaeger_string_assign(&tag->key, "key", 3));
+    jaeger_list_append(jaegertracing_protobuf_span_mutable_tags(span), node);
+    ASSERT_TRUE(jaeger_string_assign(&span->operation_name, "op", 2));
+
+    // Releasing the span clears it and pools its tag nodes, keeping their
+    // string buffers.
+    auto* key = tag->key.buffer;
+    auto* operationName = span->operation_name.buffer;
+    jaegertracing_protobuf_span_pool_release(span);
+    ASSERT_EQ(node, jaegertracing_protobuf_tag_node_pool_acquire());
+    ASSERT_EQ(0u, tag->key.len);
+    ASSERT_EQ(key, tag->key.buffer);
+    ASSERT_EQ(span, jaegertracing_protobuf_span_pool_acquire());
+    ASSERT_EQ(0u, span->operation_name.len);
+    ASSERT_EQ(operationName, span->operation_name.buffer);
+    ASSERT_EQ(nullptr, jaegertracing_protobuf_span_get_tags(span).next);
+    jaegertracing_protobuf_tag_node_pool_release(node);
+    jaegertracing_protobuf_span_pool_release(span);
+}
+
+}  // namespace runtime
+}  // namespace jaeger_struct
@@ -0,0 +1,71 @@
+# Copyright (c) 2018 Uber Technologies, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Checks the USDT probes in the ELF notes of the runtime library.
+
+Usage: ProbesTest.py <readelf> <runtime library> present|absent
+"""
+
+import subprocess
+import sys
+import unittest
+
+# Probe names and their numbers of arguments.
+PROBES = {
+    "sample": 2,
+    "encode_start": 2,
+    "encode_end": 2,
+    "flush": 2,
+    "drop": 1,
+    "pool_miss": 1,
+}
+
+
+def read_probes(readelf, library):
+    """Returns the probes of provider jaeger_struct as (name, arguments)."""
+    output = subprocess.run([readelf, "--notes", "--wide", library],
+                            check=True,
+                            stdout=subprocess.PIPE,
+                            universal_newlines=True).stdout
+    probes = []
+    provider = None
+    name = None
+    for line in output.splitlines():
+        # Wide output puts the provider on the line of the note's owner.
+        _, found, value = line.partition("Provider: ")
+        if found:
+            provider = value.strip()
+            continue
+        key, _, value = line.strip().partition(": ")
+        if key == "Name":
+            name = value
+        elif key == "Arguments" and provider == "jaeger_struct":
+            probes.append((name, value.split()))
+    return probes
+
+
+class ProbesTest(unittest.TestCase):
+    def test_probes(self):
+        probes = read_probes(READELF, LIBRARY)
+        if EXPECTED == "absent":
+            self.assertEqual([], probes)
+            return
+        self.assertEqual(set(PROBES), {name for name, _ in probes})
+        for name, arguments in probes:
+            self.assertEqual(PROBES[name], len(arguments), name)
+
+
+if __name__ == "__main__":
+    READELF, LIBRARY, EXPECTED = sys.argv[1:4]
+    unittest.main(argv=sys.argv[:1])
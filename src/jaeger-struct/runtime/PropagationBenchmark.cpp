@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/propagation.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+namespace jaeger_struct {
+namespace runtime {
+namespace {
+
+const char kUberTraceId[] = "4bf92f3577b34da6a3ce929d0e0e4736:"
+                            "00f067aa0ba902b7:0000000000000000:1";
+const char kTraceparent[] =
+    "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01";
+
+jaeger_trace_context makeContext()
+{
+    jaeger_trace_context context;
+    jaeger_uber_trace_id_parse(
+        &context, kUberTraceId, sizeof(kUberTraceId) - 1);
+    return context;
+}
+
+void BM_UberTraceIdParse(benchmark::State& state)
+{
+    jaeger_trace_context context;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(jaeger_uber_trace_id_parse(
+            &context, kUberTraceId, sizeof(kUberTraceId) - 1));
+        benchmark::DoNotOptimize(context);
+    }
+}
+BENCHMARK(BM_UberTraceIdParse);
+
+// Splitting and strtoull, as most clients parse.
+void BM_UberTraceIdParseStrtoull(benchmark::State& state)
+{
+    const std::string value(kUberTraceId);
+    jaeger_trace_context context;
+    for (auto _ : state) {
+        char fields[4][33];
+        auto start = 0u;
+        for (auto i = 0; i < 4; ++i) {
+            auto end = value.find(':', start);
+            if (end == std::string::npos) {
+                end = value.size();
+            }
+            std::memcpy(fields[i], value.data() + start, end - start);
+            fields[i][end - start] = '\0';
+            start = end + 1;
+        }
+        const auto traceIDLen = std::strlen(fields[0]);
+        context.trace_id_low =
+            std::strtoull(fields[0] + traceIDLen - 16, nullptr, 16);
+        fields[0][traceIDLen - 16] = '\0';
+        context.trace_id_high = std::strtoull(fields[0], nullptr, 16);
+        context.span_id = std::strtoull(fields[1], nullptr, 16);
+        context.parent_span_id = std::strtoull(fields[2], nullptr, 16);
+        context.flags =
+            static_cast<std::uint8_t>(std::strtoul(fields[3], nullptr, 16));
+        benchmark::DoNotOptimize(context);
+    }
+}
+BENCHMARK(BM_UberTraceIdParseStrtoull);
+
+void BM_UberTraceIdFormat(benchmark::State& state)
+{
+    const auto context = makeContext();
+    char out[JAEGER_UBER_TRACE_ID_MAX_LEN];
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(jaeger_uber_trace_id_format(&context, out));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_UberTraceIdFormat);
+
+void BM_UberTraceIdFormatSnprintf(benchmark::State& state)
+{
+    const auto context = makeContext();
+    char out[JAEGER_UBER_TRACE_ID_MAX_LEN + 1];
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::snprintf(out,
+                                               sizeof(out),
+                                               "%016" PRIx64 "%016" PRIx64
+                                               ":%016" PRIx64 ":%016" PRIx64
+                                               ":%x",
+                                               context.trace_id_high,
+                                               context.trace_id_low,
+                                               context.span_id,
+                                               context.parent_span_id,
+                                               context.flags));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_UberTraceIdFormatSnprintf);
+
+void BM_TraceparentParse(benchmark::State& state)
+{
+    jaeger_trace_context context;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(jaeger_traceparent_parse(
+            &context, kTraceparent, sizeof(kTraceparent) - 1));
+        benchmark::DoNotOptimize(context);
+    }
+}
+BENCHMARK(BM_TraceparentParse);
+
+void BM_TraceparentFormat(benchmark::State& state)
+{
+    const auto context = makeContext();
+    char out[JAEGER_TRACEPARENT_LEN];
+    for (auto _ : state) {
+        jaeger_traceparent_format(&context, out);
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_TraceparentFormat);
+
+}  // anonymous namespace
+}  // namespace runtime
+}  // namespace jaeger_struct
@@ -0,0 +1,335 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/propagation.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <jaeger.h>
+
+namespace jaeger_struct {
+namespace runtime {
+namespace {
+
+bool parseUber(jaeger_trace_context& context, const std::string& value)
+{
+    return jaeger_uber_trace_id_parse(&context, value.data(), value.size());
+}
+
+bool parseTraceparent(jaeger_trace_context& context, const std::string& value)
+{
+    return jaeger_traceparent_parse(&context, value.data(), value.size());
+}
+
+std::string formatUber(const jaeger_trace_context& context)
+{
+    char out[JAEGER_UBER_TRACE_ID_MAX_LEN];
+    return std::string(out, jaeger_uber_trace_id_format(&context, out));
+}
+
+std::string formatTraceparent(const jaeger_trace_context& context)
+{
+    char out[JAEGER_TRACEPARENT_LEN];
+    jaeger_traceparent_format(&context, out);
+    return std::string(out, sizeof(out));
+}
+
+bool isHex(const std::string& str, bool lowercaseOnly)
+{
+    for (auto c : str) {
+        if (!(c >= '0' && c <= '9') && !(c >= 'a' && c <= 'f') &&
+            (lowercaseOnly || !(c >= 'A' && c <= 'F'))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::uint64_t toValue(const std::string& digits)
+{
+    return digits.empty() ? 0 : std::strtoull(digits.c_str(), nullptr, 16);
+}
+
+// Parses uber-trace-id values by splitting and strtoull, as the clients do.
+bool referenceParseUber(jaeger_trace_context& context,
+                        const std::string& value)
+{
+    std::vector<std::string> fields(1);
+    for (auto c : value) {
+        if (c == ':') {
+            fields.emplace_back();
+        }
+        else {
+            fields.back() += c;
+        }
+    }
+    const std::size_t maxLens[] = { 32, 16, 16, 2 };
+    if (fields.size() != 4) {
+        return false;
+    }
+    for (auto i = 0; i < 4; ++i) {
+        if (fields[i].empty() || fields[i].size() > maxLens[i] ||
+            !isHex(fields[i], false)) {
+            return false;
+        }
+    }
+    const auto& traceID = fields[0];
+    const auto split = traceID.size() > 16 ? traceID.size() - 16 : 0;
+    context.trace_id_high = toValue(traceID.substr(0, split));
+    context.trace_id_low = toValue(traceID.substr(split));
+    context.span_id = toValue(fields[1]);
+    context.parent_span_id = toValue(fields[2]);
+    context.flags = static_cast<std::uint8_t>(toValue(fields[3]));
+    return context.trace_id_high != 0 || context.trace_id_low != 0;
+}
+
+bool referenceParseTraceparent(jaeger_trace_context& context,
+                               const std::string& value)
+{
+    if (value.size() < JAEGER_TRACEPARENT_LEN || value[2] != '-' ||
+        value[35] != '-' || value[52] != '-') {
+        return false;
+    }
+    const auto version = value.substr(0, 2);
+    const auto flags = value.substr(53, 2);
+    if (!isHex(version, true) || !isHex(value.substr(3, 32), true) ||
+        !isHex(value.substr(36, 16), true) || !isHex(flags, true) ||
+        version == "ff") {
+        return false;
+    }
+    if (version == "00" ? value.size() != JAEGER_TRACEPARENT_LEN
+                        : value.size() > JAEGER_TRACEPARENT_LEN &&
+                              value[JAEGER_TRACEPARENT_LEN] != '-') {
+        return false;
+    }
+    context.trace_id_high = toValue(value.substr(3, 16));
+    context.trace_id_low = toValue(value.substr(19, 16));
+    context.span_id = toValue(value.substr(36, 16));
+    context.parent_span_id = 0;
+    context.flags = toValue(flags) & JAEGER_TRACE_FLAG_SAMPLED;
+    return (context.trace_id_high != 0 || context.trace_id_low != 0) &&
+           context.span_id != 0;
+}
+
+void assertEqual(const jaeger_trace_context& expected,
+                 const jaeger_trace_context& actual)
+{
+    ASSERT_EQ(expected.trace_id_high, actual.trace_id_high);
+    ASSERT_EQ(expected.trace_id_low, actual.trace_id_low);
+    ASSERT_EQ(expected.span_id, actual.span_id);
+    ASSERT_EQ(expected.parent_span_id, actual.parent_span_id);
+    ASSERT_EQ(expected.flags, actual.flags);
+}
+
+// Replaces, inserts or deletes a character, mostly of the header alphabets.
+void mutate(std::mt19937_64& random, std::string& value)
+{
+    const std::string alphabet("0123456789abcdefABCDEF:-g \xff");
+    const auto position = random() % (value.size() + 1);
+    const auto c = random() % 8 == 0
+                       ? static_cast<char>(random())
+                       : alphabet[random() % alphabet.size()];
+    switch (random() % 3) {
+    case 0:
+        if (position < value.size()) {
+            value[position] = c;
+        }
+        break;
+    case 1:
+        value.insert(position, 1, c);
+        break;
+    default:
+        if (position < value.size()) {
+            value.erase(position, 1);
+        }
+        break;
+    }
+}
+
+}  // anonymous namespace
+
+TEST(Propagation, testUberTraceId)
+{
+    jaeger_trace_context context;
+    ASSERT_TRUE(parseUber(context, "3a1f:1a2B3c:0:1"));
+    ASSERT_EQ(0u, context.trace_id_high);
+    ASSERT_EQ(0x3a1fu, context.trace_id_low);
+    ASSERT_EQ(0x1a2b3cu, context.span_id);
+    ASSERT_EQ(0u, context.parent_span_id);
+    ASSERT_EQ(JAEGER_TRACE_FLAG_SAMPLED, context.flags);
+    ASSERT_EQ("0000000000003a1f:00000000001a2b3c:0000000000000000:1",
+              formatUber(context));
+
+    const std::string full("0123456789abcdeffedcba9876543210:"
+                           "00f067aa0ba902b7:0000000000000005:3");
+    ASSERT_TRUE(parseUber(context, full));
+    ASSERT_EQ(UINT64_C(0x0123456789abcdef), context.trace_id_high);
+    ASSERT_EQ(UINT64_C(0xfedcba9876543210), context.trace_id_low);
+    ASSERT_EQ(UINT64_C(0x00f067aa0ba902b7), context.span_id);
+    ASSERT_EQ(5u, context.parent_span_id);
+    ASSERT_EQ(3, context.flags);
+    ASSERT_EQ(full, formatUber(context));
+    ASSERT_TRUE(parseUber(context, "1ffffffffffffffff:1:0:ff"));
+    ASSERT_EQ(1u, context.trace_id_high);
+    ASSERT_EQ(UINT64_MAX, context.trace_id_low);
+    ASSERT_EQ("0000000000000001ffffffffffffffff:0000000000000001:"
+              "0000000000000000:ff",
+              formatUber(context));
+
+    const char* invalid[] = { "",
+                              ":::",
+                              "1:1:0",
+                              "1:1:0:1:",
+                              "1::0:1",
+                              "1:1:0:",
+                              "0:1:0:1",
+                              "0000:1:0:1",
+                              "1:1:0:100",
+                              "1:1:0:1 ",
+                              "1:1:0x0:1",
+                              "1:g:0:1",
+                              "1:11111111111111111:0:1",
+                              "111111111111111111111111111111111:1:0:1" };
+    for (auto&& value : invalid) {
+        ASSERT_FALSE(parseUber(context, value)) << value;
+    }
+}
+
+TEST(Propagation, testTraceparent)
+{
+    const std::string value(
+        "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01");
+    jaeger_trace_context context;
+    ASSERT_TRUE(parseTraceparent(context, value));
+    ASSERT_EQ(UINT64_C(0x4bf92f3577b34da6), context.trace_id_high);
+    ASSERT_EQ(UINT64_C(0xa3ce929d0e0e4736), context.trace_id_low);
+    ASSERT_EQ(UINT64_C(0x00f067aa0ba902b7), context.span_id);
+    ASSERT_EQ(0u, context.parent_span_id);
+    ASSERT_EQ(JAEGER_TRACE_FLAG_SAMPLED, context.flags);
+    ASSERT_EQ(value, formatTraceparent(context));
+    context.flags = JAEGER_TRACE_FLAG_DEBUG;
+    ASSERT_EQ("00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-00",
+              formatTraceparent(context));
+
+    ASSERT_TRUE(parseTraceparent(
+        context, "cc-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-03"));
+    ASSERT_EQ(JAEGER_TRACE_FLAG_SAMPLED, context.flags);
+    ASSERT_TRUE(parseTraceparent(
+        context,
+        "cc-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01-later"));
+
+    const char* invalid[] = {
+        "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-0",
+        "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01-",
+        "00-4BF92F3577B34DA6A3CE929D0E0E4736-00f067aa0ba902b7-01",
+        "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-0A",
+        "ff-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01",
+        "0g-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01",
+        "00-00000000000000000000000000000000-00f067aa0ba902b7-01",
+        "00-4bf92f3577b34da6a3ce929d0e0e4736-0000000000000000-01",
+        "00_4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01",
+        "00-4bf92f3577b34da6a3ce929d0e0e4736_00f067aa0ba902b7-01",
+        "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7_01",
+        "cc-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01x"
+    };
+    for (auto&& value : invalid) {
+        ASSERT_FALSE(parseTraceparent(context, value)) << value;
+    }
+}
+
+TEST(Propagation, testRandom)
+{
+    std::mt19937_64 random(42);
+    for (auto i = 0; i < 100000; ++i) {
+        jaeger_trace_context context;
+        context.trace_id_high = random() % 2 == 0 ? 0 : random();
+        context.trace_id_low = random() >> (random() % 64);
+        context.span_id = random() >> (random() % 64);
+        context.parent_span_id = random() % 2 == 0 ? 0 : random();
+        context.flags = static_cast<std::uint8_t>(random());
+        if (context.trace_id_low == 0 || context.span_id == 0) {
+            continue;
+        }
+
+        auto value = formatUber(context);
+        jaeger_trace_context parsed;
+        ASSERT_TRUE(parseUber(parsed, value)) << value;
+        assertEqual(context, parsed);
+        for (auto j = random() % 4; j > 0; --j) {
+            mutate(random, value);
+        }
+        jaeger_trace_context expected;
+        const auto valid = referenceParseUber(expected, value);
+        ASSERT_EQ(valid, parseUber(parsed, value)) << value;
+        if (valid) {
+            assertEqual(expected, parsed);
+        }
+
+        value = formatTraceparent(context);
+        ASSERT_TRUE(parseTraceparent(parsed, value)) << value;
+        ASSERT_EQ(context.trace_id_low, parsed.trace_id_low);
+        ASSERT_EQ(context.flags & JAEGER_TRACE_FLAG_SAMPLED, parsed.flags);
+        if (random() % 2 == 0) {
+            value[0] = "0123456789abcdef"[random() % 16];
+            value[1] = "0123456789abcdef"[random() % 16];
+        }
+        for (auto j = random() % 3; j > 0; --j) {
+            mutate(random, value);
+        }
+        ASSERT_EQ(referenceParseTraceparent(expected, value),
+                  parseTraceparent(parsed, value))
+            << value;
+    }
+}
+
+TEST(Propagation, testGeneratedStructs)
+{
+    jaegertracing_protobuf_span span;
+    std::memset(&span, 0, sizeof(span));
+    span.trace_id.high = 1;
+    span.trace_id.low = 2;
+    span.span_id = 3;
+    span.parent_span_id = 4;
+    span.flags = JAEGER_TRACE_FLAG_SAMPLED;
+    jaeger_trace_context context;
+    JAEGER_TRACE_CONTEXT_FROM_SPAN(&context, &span);
+    ASSERT_EQ("00000000000000010000000000000002:0000000000000003:"
+              "0000000000000004:1",
+              formatUber(context));
+
+    jaegertracing_protobuf_span child;
+    std::memset(&child, 0, sizeof(child));
+    JAEGER_TRACE_CONTEXT_TO_CHILD(&context, &child);
+    ASSERT_EQ(1u, child.trace_id.high);
+    ASSERT_EQ(2u, child.trace_id.low);
+    ASSERT_EQ(3u, child.parent_span_id);
+    ASSERT_EQ(JAEGER_TRACE_FLAG_SAMPLED, child.flags);
+    jaegertracing_protobuf_span_ref ref;
+    std::memset(&ref, 0, sizeof(ref));
+    JAEGER_TRACE_CONTEXT_TO_REF(&context, &ref);
+    ASSERT_EQ(1u, ref.trace_id.high);
+    ASSERT_EQ(2u, ref.trace_id.low);
+    ASSERT_EQ(3u, ref.span_id);
+}
+
+}  // namespace runtime
+}  // namespace jaeger_struct
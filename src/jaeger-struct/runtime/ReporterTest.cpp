@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/reporter.h>
+
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+namespace jaeger_struct {
+namespace runtime {
+namespace {
+
+class Receiver {
+  public:
+    Receiver()
+        : _fd(::socket(AF_INET, SOCK_DGRAM, 0))
+    {
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        EXPECT_EQ(0,
+                  ::bind(_fd,
+                         reinterpret_cast<sockaddr*>(&address),
+                         sizeof(address)));
+        socklen_t size = sizeof(address);
+        EXPECT_EQ(0,
+                  ::getsockname(
+                      _fd, reinterpret_cast<sockaddr*>(&address), &size));
+        _port = std::to_string(ntohs(address.sin_port));
+    }
+
+    ~Receiver() { ::close(_fd); }
+
+    const std::string& port() const { return _port; }
+
+    std::vector<std::string> receive()
+    {
+        std::vector<std::string> packets;
+        std::string packet(65536, '\0');
+        for (;;) {
+            const auto size =
+                ::recv(_fd, &packet[0], packet.size(), MSG_DONTWAIT);
+            if (size < 0) {
+                break;
+            }
+            packets.emplace_back(packet.data(), size);
+        }
+        return packets;
+    }
+
+  private:
+    int _fd;
+    std::string _port;
+};
+
+}  // anonymous namespace
+
+TEST(Reporter, testPacking)
+{
+    Receiver receiver;
+    const std::string header("HDR");
+    jaeger_udp_reporter reporter;
+    ASSERT_TRUE(jaeger_udp_reporter_open(&reporter,
+                                         "127.0.0.1",
+                                         receiver.port().c_str(),
+                                         503,
+                                         header.data(),
+                                         header.size()));
+
+    // Five 100 byte spans fill each datagram exactly.
+    std::string expected;
+    for (auto i = 0; i < 100; ++i) {
+        const std::string span(100, 'a' + i % 26);
+        expected += span;
+        ASSERT_TRUE(jaeger_udp_reporter_append(
+            &reporter, span.data(), span.size()));
+    }
+    const std::string oversized(501, 'x');
+    ASSERT_FALSE(jaeger_udp_reporter_append(
+        &reporter, oversized.data(), oversized.size()));
+    ASSERT_TRUE(jaeger_udp_reporter_flush(&reporter));
+
+    const auto packets = receiver.receive();
+    ASSERT_EQ(20u, packets.size());
+    std::string actual;
+    for (auto&& packet : packets) {
+        ASSERT_EQ(503u, packet.size());
+        ASSERT_EQ(header, packet.substr(0, header.size()));
+        actual += packet.substr(header.size());
+    }
+    ASSERT_EQ(expected, actual);
+    ASSERT_EQ(20u, reporter.stats.packets);
+    ASSERT_EQ(20u * 503, reporter.stats.bytes);
+    ASSERT_EQ(1u, reporter.stats.drops);
+
+    ASSERT_TRUE(jaeger_udp_reporter_flush(&reporter));
+    ASSERT_EQ(20u, reporter.stats.packets);
+    jaeger_udp_reporter_close(&reporter);
+}
+
+TEST(Reporter, testBudget)
+{
+    Receiver receiver;
+    jaeger_udp_reporter reporter;
+    ASSERT_TRUE(jaeger_udp_reporter_open(
+        &reporter, "127.0.0.1", receiver.port().c_str(), 500, nullptr, 0));
+    jaeger_budget budget = JAEGER_BUDGET_INIT(250);
+    reporter.budget = &budget;
+
+    // Spans are charged while pending, and one over budget flushes them.
+    const std::string span(100, 's');
+    ASSERT_TRUE(
+        jaeger_udp_reporter_append(&reporter, span.data(), span.size()));
+    ASSERT_TRUE(
+        jaeger_udp_reporter_append(&reporter, span.data(), span.size()));
+    ASSERT_EQ(200u, jaeger_budget_used(&budget));
+    ASSERT_TRUE(
+        jaeger_udp_reporter_append(&reporter, span.data(), span.size()));
+    ASSERT_EQ(1u, reporter.stats.packets);
+    ASSERT_EQ(100u, jaeger_budget_used(&budget));
+
+    ASSERT_TRUE(jaeger_udp_reporter_flush(&reporter));
+    ASSERT_EQ(0u, jaeger_budget_used(&budget));
+
+    // Other producers' charges count too.
+    ASSERT_TRUE(jaeger_budget_charge(&budget, 200));
+    ASSERT_FALSE(
+        jaeger_udp_reporter_append(&reporter, span.data(), span.size()));
+    ASSERT_EQ(1u, reporter.stats.drops);
+    ASSERT_EQ(200u, jaeger_budget_used(&budget));
+    jaeger_budget_release(&budget, 200);
+
+    ASSERT_TRUE(
+        jaeger_udp_reporter_append(&reporter, span.data(), span.size()));
+    ASSERT_EQ(100u, jaeger_budget_used(&budget));
+    jaeger_udp_reporter_close(&reporter);
+    ASSERT_EQ(0u, jaeger_budget_used(&budget));
+    ASSERT_EQ(2u, receiver.receive().size());
+}
+
+}  // namespace runtime
+}  // namespace jaeger_struct
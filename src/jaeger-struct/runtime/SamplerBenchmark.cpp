@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <cstring>
+
+#include <benchmark/benchmark.h>
+
+#include <jaeger-struct/runtime/sampler.h>
+
+namespace jaeger_struct {
+namespace runtime {
+namespace {
+
+jaeger_adaptive_sampler* sampler()
+{
+    static jaeger_adaptive_sampler* sampler = []() {
+        static jaeger_adaptive_sampler sampler;
+        jaeger_adaptive_sampler_init(&sampler, 256, 64, 0.001, 1);
+        return &sampler;
+    }();
+    return sampler;
+}
+
+// Decisions for one operation from every thread, as on a busy endpoint.
+void BM_AdaptiveSample(benchmark::State& state)
+{
+    char name[] = "GET /api/users";
+    jaeger_string operationName;
+    std::memset(&operationName, 0, sizeof(operationName));
+    operationName.buffer = name;
+    operationName.len = sizeof(name) - 1;
+    auto traceID = UINT64_C(0x9e3779b97f4a7c15);
+    auto now = UINT64_C(0);
+    for (auto _ : state) {
+        traceID = traceID * UINT64_C(6364136223846793005) + 1;
+        now += 100;
+        benchmark::DoNotOptimize(jaeger_adaptive_sampler_sample(
+            sampler(), &operationName, traceID, now));
+    }
+}
+BENCHMARK(BM_AdaptiveSample)->ThreadRange(1, 8);
+
+void BM_RateLimiterCheck(benchmark::State& state)
+{
+    static jaeger_rate_limiter limiter = []() {
+        jaeger_rate_limiter limiter;
+        std::memset(&limiter, 0, sizeof(limiter));
+        jaeger_rate_limiter_set_rate(&limiter, 1000, 10);
+        return limiter;
+    }();
+    auto now = UINT64_C(0);
+    for (auto _ : state) {
+        now += 100;
+        benchmark::DoNotOptimize(jaeger_rate_limiter_check(&limiter, now));
+    }
+}
+BENCHMARK(BM_RateLimiterCheck)->ThreadRange(1, 8);
+
+}  // anonymous namespace
+}  // namespace runtime
+}  // namespace jaeger_struct
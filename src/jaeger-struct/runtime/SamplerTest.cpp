@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/sampler.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace jaeger_struct {
+namespace runtime {
+namespace {
+
+constexpr auto kSecond = UINT64_C(1000000000);
+
+jaeger_string makeString(const std::string& str)
+{
+    jaeger_string result;
+    std::memset(&result, 0, sizeof(result));
+    result.buffer = const_cast<char*>(str.data());
+    result.len = str.size();
+    return result;
+}
+
+}  // anonymous namespace
+
+TEST(Sampler, testProbabilistic)
+{
+    jaeger_probabilistic_sampler sampler;
+    jaeger_probabilistic_sampler_set_rate(&sampler, 0);
+    ASSERT_FALSE(jaeger_probabilistic_sampler_sample(&sampler, 0));
+    jaeger_probabilistic_sampler_set_rate(
+        &sampler, std::numeric_limits<double>::quiet_NaN());
+    ASSERT_FALSE(jaeger_probabilistic_sampler_sample(&sampler, 0));
+
+    jaeger_probabilistic_sampler_set_rate(&sampler, 2);
+    ASSERT_TRUE(jaeger_probabilistic_sampler_sample(&sampler, UINT64_MAX));
+
+    // Only the low 63 bits count, as in the Jaeger clients.
+    jaeger_probabilistic_sampler_set_rate(&sampler, 0.5);
+    ASSERT_TRUE(jaeger_probabilistic_sampler_sample(&sampler, 0));
+    ASSERT_TRUE(
+        jaeger_probabilistic_sampler_sample(&sampler, (UINT64_C(1) << 62) - 1));
+    ASSERT_FALSE(
+        jaeger_probabilistic_sampler_sample(&sampler, UINT64_C(1) << 62));
+    ASSERT_TRUE(
+        jaeger_probabilistic_sampler_sample(&sampler, UINT64_C(1) << 63));
+}
+
+TEST(Sampler, testRateLimiter)
+{
+    jaeger_rate_limiter limiter;
+    std::memset(&limiter, 0, sizeof(limiter));
+    ASSERT_FALSE(jaeger_rate_limiter_check(&limiter, kSecond));
+
+    // Starts with a full bucket of three credits, then refills two a second.
+    jaeger_rate_limiter_set_rate(&limiter, 2, 3);
+    auto now = 10 * kSecond;
+    for (auto i = 0; i < 3; ++i) {
+        ASSERT_TRUE(jaeger_rate_limiter_check(&limiter, now));
+    }
+    ASSERT_FALSE(jaeger_rate_limiter_check(&limiter, now));
+    now += kSecond / 4;
+    ASSERT_FALSE(jaeger_rate_limiter_check(&limiter, now));
+    now += kSecond / 4;
+    ASSERT_TRUE(jaeger_rate_limiter_check(&limiter, now));
+    ASSERT_FALSE(jaeger_rate_limiter_check(&limiter, now));
+
+    // The balance never exceeds its maximum.
+    now += 100 * kSecond;
+    for (auto i = 0; i < 3; ++i) {
+        ASSERT_TRUE(jaeger_rate_limiter_check(&limiter, now));
+    }
+    ASSERT_FALSE(jaeger_rate_limiter_check(&limiter, now));
+}
+
+TEST(Sampler, testRateLimiterContention)
+{
+    constexpr auto kBalance = 100;
+    jaeger_rate_limiter limiter;
+    std::memset(&limiter, 0, sizeof(limiter));
+    jaeger_rate_limiter_set_rate(&limiter, 1, kBalance);
+
+    // With time standing still, exactly the balance is admitted.
+    std::atomic<int> admitted(0);
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < 8; ++i) {
+        threads.emplace_back([&limiter, &admitted]() {
+            for (auto j = 0; j < 1000; ++j) {
+                if (jaeger_rate_limiter_check(&limiter, kSecond)) {
+                    ++admitted;
+                }
+            }
+        });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(kBalance, admitted.load());
+}
+
+TEST(Sampler, testAdaptive)
+{
+    jaeger_adaptive_sampler sampler;
+    ASSERT_TRUE(jaeger_adaptive_sampler_init(&sampler, 2, 8, 0, 1));
+
+    const std::string name("get");
+    auto* operation =
+        jaeger_adaptive_sampler_operation(&sampler, name.data(), name.size());
+    ASSERT_NE(nullptr, operation);
+    ASSERT_NE(name.data(), operation->name);
+    ASSERT_EQ(name, std::string(operation->name, operation->name_len));
+    ASSERT_EQ(operation,
+              jaeger_adaptive_sampler_operation(&sampler, "get", 3));
+
+    // The lower bound samples one trace a second despite a zero rate.
+    auto operationName = makeString(name);
+    ASSERT_TRUE(
+        jaeger_adaptive_sampler_sample(&sampler, &operationName, 0, kSecond));
+    ASSERT_FALSE(
+        jaeger_adaptive_sampler_sample(&sampler, &operationName, 0, kSecond));
+    ASSERT_TRUE(jaeger_adaptive_sampler_sample(
+        &sampler, &operationName, 0, 2 * kSecond));
+
+    jaeger_probabilistic_sampler_set_rate(&operation->probabilistic, 1);
+    ASSERT_TRUE(
+        jaeger_adaptive_sampler_sample(&sampler, &operationName, 0, kSecond));
+
+    // Operations past the maximums use the default sampler.
+    ASSERT_EQ(nullptr,
+              jaeger_adaptive_sampler_operation(&sampler, "get-items", 9));
+    ASSERT_NE(nullptr, jaeger_adaptive_sampler_operation(&sampler, "put", 3));
+    ASSERT_EQ(nullptr, jaeger_adaptive_sampler_operation(&sampler, "del", 3));
+    const std::string otherName("del");
+    auto other = makeString(otherName);
+    ASSERT_FALSE(jaeger_adaptive_sampler_sample(&sampler, &other, 0, kSecond));
+    jaeger_probabilistic_sampler_set_rate(&sampler.default_sampler, 1);
+    ASSERT_TRUE(jaeger_adaptive_sampler_sample(&sampler, &other, 0, kSecond));
+    jaeger_adaptive_sampler_destroy(&sampler);
+}
+
+TEST(Sampler, testAdaptiveContention)
+{
+    constexpr auto kOperations = 64;
+    constexpr auto kThreads = 4;
+    jaeger_adaptive_sampler sampler;
+    ASSERT_TRUE(jaeger_adaptive_sampler_init(
+        &sampler, kThreads * kOperations, 16, 1, 0));
+
+    // Threads racing to add the same names agree on one sampler per name,
+    // though losers may use up operations.
+    std::vector<std::vector<jaeger_operation_sampler*>> found(kThreads);
+    std::vector<std::thread> threads;
+    for (auto&& operations : found) {
+        threads.emplace_back([&sampler, &operations]() {
+            for (auto i = 0; i < kOperations; ++i) {
+                const auto name = "operation" + std::to_string(i);
+                operations.push_back(jaeger_adaptive_sampler_operation(
+                    &sampler, name.data(), name.size()));
+            }
+        });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+    for (auto i = 0; i < kOperations; ++i) {
+        ASSERT_NE(nullptr, found[0][i]);
+        for (auto&& operations : found) {
+            ASSERT_EQ(found[0][i], operations[i]);
+        }
+    }
+    ASSERT_LE(static_cast<size_t>(kOperations), sampler.operation_count);
+    ASSERT_GE(static_cast<size_t>(kThreads * kOperations),
+              sampler.operation_count);
+    jaeger_adaptive_sampler_destroy(&sampler);
+}
+
+}  // namespace runtime
+}  // namespace jaeger_struct
@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/segment.h>
+
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <jaeger-struct/runtime/crc32c.h>
+
+namespace jaeger_struct {
+namespace runtime {
+namespace {
+
+std::string tempPath()
+{
+    char path[] = "/tmp/jaeger-segment-XXXXXX";
+    const auto fd = ::mkstemp(path);
+    EXPECT_GE(fd, 0);
+    ::close(fd);
+    return path;
+}
+
+std::vector<std::string> readAll(const jaeger_segment_reader& reader)
+{
+    std::vector<std::string> records;
+    uint64_t offset = JAEGER_SEGMENT_HEADER_SIZE;
+    jaeger_segment_record record;
+    while (jaeger_segment_reader_read(&reader, &offset, &record)) {
+        records.emplace_back(static_cast<const char*>(record.data),
+                             record.size);
+    }
+    return records;
+}
+
+}  // anonymous namespace
+
+TEST(Segment, testCRC32C)
+{
+    const std::string input("123456789");
+    ASSERT_EQ(0xe3069283u, jaeger_crc32c(0, input.data(), input.size()));
+    ASSERT_EQ(0xe3069283u,
+              jaeger_crc32c(jaeger_crc32c(0, input.data(), 4),
+                            input.data() + 4,
+                            input.size() - 4));
+    const std::string zeros(32, '\0');
+    ASSERT_EQ(0x8a9136aau, jaeger_crc32c(0, zeros.data(), zeros.size()));
+}
+
+TEST(Segment, testWriteAndRead)
+{
+    const auto path = tempPath();
+    const auto indexPath = path + ".idx";
+    constexpr auto kNumRecords = 100;
+
+    jaeger_segment_writer writer;
+    ASSERT_TRUE(jaeger_segment_writer_open(&writer, path.c_str()));
+    std::vector<std::string> expected;
+    for (auto i = 0; i < kNumRecords; ++i) {
+        expected.emplace_back(std::string(i, 'a' + i % 26));
+        const jaeger_segment_trace_id traceIDs[] = {
+            { 0, static_cast<uint64_t>(i % 10) }, { 1, 1 }
+        };
+        ASSERT_TRUE(jaeger_segment_writer_append(&writer,
+                                                 expected.back().data(),
+                                                 expected.back().size(),
+                                                 traceIDs,
+                                                 2));
+    }
+    ASSERT_TRUE(jaeger_segment_writer_sync(&writer));
+    jaeger_segment_writer_close(&writer);
+
+    jaeger_segment_reader reader;
+    ASSERT_TRUE(jaeger_segment_reader_open(&reader, path.c_str()));
+    ASSERT_EQ(expected, readAll(reader));
+
+    const jaeger_segment_index_entry* entries;
+    const jaeger_segment_trace_id traceID = { 0, 3 };
+    ASSERT_EQ(10u, jaeger_segment_reader_find(&reader, &traceID, &entries));
+    for (auto i = 0; i < 10; ++i) {
+        auto offset = entries[i].offset;
+        jaeger_segment_record record;
+        ASSERT_TRUE(jaeger_segment_reader_read(&reader, &offset, &record));
+        ASSERT_EQ(expected[i * 10 + 3],
+                  std::string(static_cast<const char*>(record.data),
+                              record.size));
+    }
+    const jaeger_segment_trace_id shared = { 1, 1 };
+    ASSERT_EQ(static_cast<size_t>(kNumRecords),
+              jaeger_segment_reader_find(&reader, &shared, &entries));
+    const jaeger_segment_trace_id missing = { 2, 0 };
+    ASSERT_EQ(0u, jaeger_segment_reader_find(&reader, &missing, &entries));
+    const auto size = reader.size;
+    jaeger_segment_reader_close(&reader);
+
+    // A torn final record ends iteration without losing earlier ones.
+    ASSERT_EQ(0, ::truncate(path.c_str(), size - 1));
+    ASSERT_TRUE(jaeger_segment_reader_open(&reader, path.c_str()));
+    expected.pop_back();
+    ASSERT_EQ(expected, readAll(reader));
+    ASSERT_EQ(static_cast<size_t>(kNumRecords - 1),
+              jaeger_segment_reader_find(&reader, &shared, &entries));
+    jaeger_segment_reader_close(&reader);
+
+    std::remove(path.c_str());
+    std::remove(indexPath.c_str());
+}
+
+TEST(Segment, testFailedAppend)
+{
+    const auto path = tempPath();
+    const auto indexPath = path + ".idx";
+    std::vector<jaeger_segment_trace_id> traceIDs(100);
+    for (auto i = 0u; i < traceIDs.size(); ++i) {
+        traceIDs[i] = { 0, i };
+    }
+    const jaeger_segment_trace_id shared = { 1, 1 };
+    const std::string records[] = { "first", "second", "third" };
+
+    jaeger_segment_writer writer;
+    ASSERT_TRUE(jaeger_segment_writer_open(&writer, path.c_str()));
+    ASSERT_TRUE(jaeger_segment_writer_append(
+        &writer, records[0].data(), records[0].size(), &shared, 1));
+    ASSERT_TRUE(jaeger_segment_writer_append(&writer,
+                                             records[0].data(),
+                                             0,
+                                             traceIDs.data(),
+                                             traceIDs.size()));
+    struct stat st;
+    ASSERT_EQ(0, ::stat(indexPath.c_str(), &st));
+
+    // A file size limit part way into an index entry tears the index write,
+    // after the record itself was written.
+    rlimit original;
+    ASSERT_EQ(0, ::getrlimit(RLIMIT_FSIZE, &original));
+    auto limited = original;
+    limited.rlim_cur = st.st_size + 30;
+    const auto handler = std::signal(SIGXFSZ, SIG_IGN);
+    ASSERT_EQ(0, ::setrlimit(RLIMIT_FSIZE, &limited));
+    const auto appended = jaeger_segment_writer_append(&writer,
+                                                       records[1].data(),
+                                                       records[1].size(),
+                                                       traceIDs.data(),
+                                                       traceIDs.size());
+    ASSERT_EQ(0, ::setrlimit(RLIMIT_FSIZE, &original));
+    std::signal(SIGXFSZ, handler);
+    ASSERT_FALSE(appended);
+    ASSERT_EQ(0, ::stat(indexPath.c_str(), &st));
+    ASSERT_EQ(101 * 24, st.st_size);
+
+    ASSERT_TRUE(jaeger_segment_writer_append(
+        &writer, records[2].data(), records[2].size(), &shared, 1));
+    jaeger_segment_writer_close(&writer);
+
+    jaeger_segment_reader reader;
+    ASSERT_TRUE(jaeger_segment_reader_open(&reader, path.c_str()));
+    const std::vector<std::string> expected = {
+        records[0], std::string(), records[1], records[2]
+    };
+    ASSERT_EQ(expected, readAll(reader));
+    const jaeger_segment_index_entry* entries;
+    ASSERT_EQ(2u, jaeger_segment_reader_find(&reader, &shared, &entries));
+    for (auto i = 0; i < 2; ++i) {
+        auto offset = entries[i].offset;
+        jaeger_segment_record record;
+        ASSERT_TRUE(jaeger_segment_reader_read(&reader, &offset, &record));
+        ASSERT_EQ(records[i * 2],
+                  std::string(static_cast<const char*>(record.data),
+                              record.size));
+    }
+    ASSERT_EQ(1u, jaeger_segment_reader_find(&reader, &traceIDs[3], &entries));
+    jaeger_segment_reader_close(&reader);
+
+    std::remove(path.c_str());
+    std::remove(indexPath.c_str());
+}
+
+}  // namespace runtime
+}  // namespace jaeger_struct
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/sort.h>
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <jaeger.h>
+
+namespace jaeger_struct {
+namespace runtime {
+namespace {
+
+typedef JAEGER_LIST(jaegertracing_protobuf_span) SpanNode;
+
+const jaeger_sort_key kSpanKeys[] = {
+    { offsetof(SpanNode, value.trace_id.high), false },
+    { offsetof(SpanNode, value.trace_id.low), false },
+    { offsetof(SpanNode, value.start_time), true }
+};
+
+// Spans of a hundred concurrent traces in completion order.
+std::vector<SpanNode> makeSpans(size_t count)
+{
+    std::mt19937_64 random(42);
+    std::vector<SpanNode> nodes(count);
+    std::memset(nodes.data(), 0, count * sizeof(SpanNode));
+    for (auto i = 0u; i < count; ++i) {
+        nodes[i].value.trace_id.low = random() % 100 + 1;
+        nodes[i].value.start_time = INT64_C(1500000000000000) + i * 10 -
+                                    static_cast<int64_t>(random() % 1000);
+    }
+    return nodes;
+}
+
+void link(std::vector<SpanNode>& nodes, jaeger_list& list)
+{
+    std::memset(&list, 0, sizeof(list));
+    for (auto&& node : nodes) {
+        jaeger_list_append(&list, &node.base);
+    }
+}
+
+void BM_RadixSort(benchmark::State& state)
+{
+    auto nodes = makeSpans(state.range(0));
+    jaeger_list_sorter sorter;
+    std::memset(&sorter, 0, sizeof(sorter));
+    jaeger_list list;
+    for (auto _ : state) {
+        state.PauseTiming();
+        link(nodes, list);
+        state.ResumeTiming();
+        jaeger_list_sort(&sorter, &list, kSpanKeys, 3);
+        benchmark::DoNotOptimize(list.next);
+    }
+    jaeger_list_sorter_destroy(&sorter);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RadixSort)->Range(64, 16384);
+
+int compareSpans(const void* lhs, const void* rhs)
+{
+    const auto& left =
+        reinterpret_cast<const SpanNode*>(*static_cast<jaeger_list* const*>(
+                                              lhs))
+            ->value;
+    const auto& right =
+        reinterpret_cast<const SpanNode*>(*static_cast<jaeger_list* const*>(
+                                              rhs))
+            ->value;
+    if (left.trace_id.high != right.trace_id.high) {
+        return left.trace_id.high < right.trace_id.high ? -1 : 1;
+    }
+    if (left.trace_id.low != right.trace_id.low) {
+        return left.trace_id.low < right.trace_id.low ? -1 : 1;
+    }
+    if (left.start_time != right.start_time) {
+        return left.start_time < right.start_time ? -1 : 1;
+    }
+    return 0;
+}
+
+// qsort of node pointers, then relinking.
+void BM_Qsort(benchmark::State& state)
+{
+    auto nodes = makeSpans(state.range(0));
+    std::vector<jaeger_list*> pointers;
+    jaeger_list list;
+    for (auto _ : state) {
+        state.PauseTiming();
+        link(nodes, list);
+        state.ResumeTiming();
+        pointers.clear();
+        const jaeger_list* node;
+        JAEGER_LIST_FOR_EACH(&list, node) {
+            pointers.push_back(const_cast<jaeger_list*>(node));
+        }
+        std::qsort(pointers.data(),
+                   pointers.size(),
+                   sizeof(pointers[0]),
+                   compareSpans);
+        std::memset(&list, 0, sizeof(list));
+        for (auto* pointer : pointers) {
+            jaeger_list_append(&list, pointer);
+        }
+        benchmark::DoNotOptimize(list.next);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Qsort)->Range(64, 16384);
+
+}  // anonymous namespace
+}  // namespace runtime
+}  // namespace jaeger_struct
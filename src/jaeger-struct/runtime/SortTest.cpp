@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/sort.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <jaeger.h>
+
+namespace jaeger_struct {
+namespace runtime {
+namespace {
+
+typedef JAEGER_LIST(jaegertracing_protobuf_span) SpanNode;
+
+// Trace ID, then start time.
+const jaeger_sort_key kSpanKeys[] = {
+    { offsetof(SpanNode, value.trace_id.high), false },
+    { offsetof(SpanNode, value.trace_id.low), false },
+    { offsetof(SpanNode, value.start_time), true }
+};
+
+typedef std::tuple<uint64_t, uint64_t, int64_t> SpanKey;
+
+SpanKey key(const jaegertracing_protobuf_span& span)
+{
+    return SpanKey(span.trace_id.high, span.trace_id.low, span.start_time);
+}
+
+void appendSpan(jaeger_list& list,
+                uint64_t high,
+                uint64_t low,
+                int64_t startTime,
+                uint64_t spanID)
+{
+    auto* node = static_cast<SpanNode*>(jaeger_malloc(sizeof(SpanNode)));
+    std::memset(node, 0, sizeof(*node));
+    node->value.trace_id = { high, low };
+    node->value.start_time = startTime;
+    node->value.span_id = spanID;
+    jaeger_list_append(&list, &node->base);
+}
+
+std::vector<const jaegertracing_protobuf_span*> spans(const jaeger_list& list)
+{
+    std::vector<const jaegertracing_protobuf_span*> result;
+    auto* prev = static_cast<const jaeger_list*>(nullptr);
+    for (auto* node = list.next; node != nullptr; node = node->next) {
+        EXPECT_EQ(prev, node->prev);
+        prev = node;
+        result.push_back(&reinterpret_cast<const SpanNode*>(node)->value);
+    }
+    EXPECT_EQ(prev, list.prev);
+    return result;
+}
+
+}  // anonymous namespace
+
+TEST(Sort, testSpans)
+{
+    std::mt19937_64 random(42);
+    jaegertracing_protobuf_batch batch;
+    std::memset(&batch, 0, sizeof(batch));
+    // Few traces with 64 and 128-bit IDs, and negative and nearby times.
+    for (auto i = 0u; i < 5000; ++i) {
+        const auto trace = random() % 50;
+        appendSpan(batch.spans,
+                   trace % 2 == 0 ? 0 : trace,
+                   trace * UINT64_C(0x9e3779b97f4a7c15),
+                   static_cast<int64_t>(random() % 100000) - 1000 +
+                       INT64_C(1500000000000000),
+                   i);
+    }
+    appendSpan(batch.spans, 1, 1, INT64_MIN, 5000);
+    appendSpan(batch.spans, 1, 1, INT64_MAX, 5001);
+    appendSpan(batch.spans, 1, 1, -1, 5002);
+
+    auto expected = spans(batch.spans);
+    std::stable_sort(expected.begin(),
+                     expected.end(),
+                     [](const jaegertracing_protobuf_span* lhs,
+                        const jaegertracing_protobuf_span* rhs) {
+                         return key(*lhs) < key(*rhs);
+                     });
+
+    jaeger_list_sorter sorter;
+    std::memset(&sorter, 0, sizeof(sorter));
+    ASSERT_TRUE(jaeger_list_sort(&sorter, &batch.spans, kSpanKeys, 3));
+    ASSERT_EQ(expected, spans(batch.spans));
+
+    // Sorted input stays as is, reusing the scratch space.
+    const auto* scratch = sorter.scratch;
+    ASSERT_TRUE(jaeger_list_sort(&sorter, &batch.spans, kSpanKeys, 3));
+    ASSERT_EQ(expected, spans(batch.spans));
+    ASSERT_EQ(scratch, sorter.scratch);
+
+    jaeger_list_sorter_destroy(&sorter);
+    jaegertracing_protobuf_batch_destroy(&batch);
+}
+
+TEST(Sort, testSmallLists)
+{
+    jaeger_list_sorter sorter;
+    std::memset(&sorter, 0, sizeof(sorter));
+    jaeger_list list;
+    std::memset(&list, 0, sizeof(list));
+    ASSERT_TRUE(jaeger_list_sort(&sorter, &list, kSpanKeys, 3));
+    ASSERT_EQ(nullptr, list.next);
+
+    appendSpan(list, 0, 2, 0, 1);
+    ASSERT_TRUE(jaeger_list_sort(&sorter, &list, kSpanKeys, 3));
+    ASSERT_EQ(1u, spans(list).size());
+
+    // Equal keys keep their order.
+    appendSpan(list, 0, 1, 0, 2);
+    appendSpan(list, 0, 2, 0, 3);
+    ASSERT_TRUE(jaeger_list_sort(&sorter, &list, kSpanKeys, 3));
+    std::vector<uint64_t> ids;
+    for (auto* span : spans(list)) {
+        ids.push_back(span->span_id);
+    }
+    ASSERT_EQ((std::vector<uint64_t>{ 2, 1, 3 }), ids);
+
+    jaeger_list_sorter_destroy(&sorter);
+    while (list.next != nullptr) {
+        auto* node = list.next;
+        list.next = node->next;
+        jaeger_free(node);
+    }
+}
+
+}  // namespace runtime
+}  // namespace jaeger_struct
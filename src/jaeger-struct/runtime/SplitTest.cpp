@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/split.h>
+
+#include <cstring>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <jaeger-struct/runtime/TestUtil.hpp>
+#include <jaeger.h>
+
+namespace jaeger_struct {
+namespace runtime {
+namespace {
+
+void makeBatch(jaegertracing_protobuf_batch& batch, int numSpans)
+{
+    fillBatch(batch, numSpans, [](jaegertracing_protobuf_span& span, int i) {
+        assign(span.operation_name, std::string(i * 37 % 300, 'x'));
+        for (auto j = 0; j < i % 4; ++j) {
+            auto& tag = appendTag(span, "key");
+            tag.value.type = jaegertracing_protobuf_tag_value_double_value_type;
+            tag.value.value.double_value = j;
+        }
+    });
+}
+
+}  // anonymous namespace
+
+TEST(Split, testEncodedSize)
+{
+    jaegertracing_protobuf_batch batch;
+    for (auto numSpans : { 0, 1, 10 }) {
+        makeBatch(batch, numSpans);
+        ASSERT_EQ(encode(batch).size(),
+                  jaegertracing_protobuf_batch_encoded_size(&batch));
+        jaegertracing_protobuf_batch_destroy(&batch);
+    }
+}
+
+TEST(Split, testSplice)
+{
+    jaegertracing_protobuf_batch batch;
+    makeBatch(batch, 3);
+    jaeger_list list{ nullptr, nullptr };
+    jaeger_list_splice(&list, &batch.spans, batch.spans.next);
+    ASSERT_EQ(1u, jaeger_list_size(&list));
+    ASSERT_EQ(2u, jaeger_list_size(&batch.spans));
+    ASSERT_EQ(nullptr, batch.spans.next->prev);
+    jaeger_list_splice(&list, &batch.spans, batch.spans.prev);
+    ASSERT_EQ(3u, jaeger_list_size(&list));
+    ASSERT_TRUE(jaeger_list_empty(&batch.spans));
+    ASSERT_EQ(nullptr, batch.spans.prev);
+    ASSERT_EQ(list.prev, list.next->next->next);
+    batch.spans = list;
+    jaegertracing_protobuf_batch_destroy(&batch);
+}
+
+TEST(Split, testSplit)
+{
+    constexpr auto kMaxSize = 1000u;
+    constexpr auto kSpans = 100;
+    jaegertracing_protobuf_batch batch;
+    makeBatch(batch, kSpans);
+    // Spans that exceed the limit by themselves still go out, alone.
+    auto& big = appendNode<SpanNode>(batch.spans)->value;
+    big.span_id = kSpans + 1;
+    const std::string name(2 * kMaxSize, 'x');
+    ASSERT_TRUE(
+        jaeger_string_assign(&big.operation_name, name.data(), name.size()));
+
+    uint64_t nextSpanID = 1;
+    auto numParts = 0;
+    jaegertracing_protobuf_batch part;
+    while (auto count = jaegertracing_protobuf_batch_split_spans(
+               &batch, kMaxSize, &part)) {
+        ++numParts;
+        ASSERT_EQ(count, jaeger_list_size(&part.spans));
+        const auto size = encode(part).size();
+        if (count > 1) {
+            ASSERT_LE(size, kMaxSize);
+        }
+        ASSERT_EQ(batch.process.service_name.buffer,
+                  part.process.service_name.buffer);
+        const jaeger_list* node;
+        JAEGER_LIST_FOR_EACH(&part.spans, node)
+        {
+            ASSERT_EQ(nextSpanID++,
+                      reinterpret_cast<const SpanNode*>(node)->value.span_id);
+        }
+        jaegertracing_protobuf_batch_split_spans_release(&part);
+        ASSERT_EQ(nullptr, part.process.service_name.buffer);
+    }
+    ASSERT_EQ(kSpans + 2u, nextSpanID);
+    ASSERT_LT(1, numParts);
+    ASSERT_TRUE(jaeger_list_empty(&batch.spans));
+    jaegertracing_protobuf_batch_destroy(&batch);
+}
+
+}  // namespace runtime
+}  // namespace jaeger_struct
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/stats.h>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <jaeger.h>
+
+#ifdef JAEGER_ENABLE_STATS
+
+namespace jaeger_struct {
+namespace runtime {
+namespace {
+
+struct Snapshot {
+    Snapshot()
+    {
+        std::memset(&value, 0, sizeof(value));
+        EXPECT_TRUE(jaeger_stats_snapshot(&value));
+    }
+
+    ~Snapshot() { jaeger_struct_runtime_stats_snapshot_destroy(&value); }
+
+    jaeger_struct_runtime_stats_snapshot value;
+};
+
+void encodeTraceIDs(int count)
+{
+    jaegertracing_protobuf_trace_id traceID{ 1, 2 };
+    jaeger_buffer buffer;
+    std::memset(&buffer, 0, sizeof(buffer));
+    for (auto i = 0; i < count; ++i) {
+        buffer.size = 0;
+        ASSERT_TRUE(jaegertracing_protobuf_trace_id_encode(&traceID, &buffer));
+    }
+    jaeger_buffer_destroy(&buffer);
+}
+
+constexpr auto kExitEncodes = 20000;
+
+pthread_key_t exitKey;
+char firstRound;
+char secondRound;
+std::atomic<bool> exiting(false);
+
+// Encodes from the second round of thread exit destructors, after the
+// stats destructor released the thread's block in the first.
+void encodeAtExit(void* value)
+{
+    if (value == &firstRound) {
+        pthread_setspecific(exitKey, &secondRound);
+        return;
+    }
+    exiting = true;
+    encodeTraceIDs(kExitEncodes);
+}
+
+}  // anonymous namespace
+
+TEST(Stats, testCounters)
+{
+    Snapshot before;
+    jaeger_string str;
+    std::memset(&str, 0, sizeof(str));
+    ASSERT_TRUE(jaeger_string_assign(&str, "abc", 3));
+    jaeger_string_destroy(&str);
+    encodeTraceIDs(10);
+    Snapshot after;
+
+    ASSERT_EQ(before.value.strings_copied + 1, after.value.strings_copied);
+    ASSERT_EQ(before.value.string_bytes_copied + 3,
+              after.value.string_bytes_copied);
+    ASSERT_EQ(before.value.messages_encoded + 10,
+              after.value.messages_encoded);
+    ASSERT_EQ(before.value.encoded_bytes + 40, after.value.encoded_bytes);
+    ASSERT_LE(before.value.allocations + 2, after.value.allocations);
+    ASSERT_LE(before.value.frees + 2, after.value.frees);
+}
+
+TEST(Stats, testThreads)
+{
+    Snapshot before;
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < 4; ++i) {
+        threads.emplace_back([]() { encodeTraceIDs(1000); });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+    Snapshot after;
+    ASSERT_EQ(before.value.messages_encoded + 4000,
+              after.value.messages_encoded);
+
+    // Blocks of exited threads are reused rather than added.
+    threads.clear();
+    for (auto i = 0; i < 4; ++i) {
+        threads.emplace_back([]() { encodeTraceIDs(1); });
+        threads.back().join();
+    }
+    Snapshot last;
+    ASSERT_EQ(after.value.threads, last.value.threads);
+    ASSERT_EQ(after.value.messages_encoded + 4, last.value.messages_encoded);
+}
+
+TEST(Stats, testExitingThread)
+{
+    ASSERT_EQ(0, pthread_key_create(&exitKey, encodeAtExit));
+    Snapshot before;
+    // A thread starting while another exits may take the block released by
+    // the exiting thread, which must not count into it any more.
+    std::thread exitingThread([]() {
+        pthread_setspecific(exitKey, &firstRound);
+        encodeTraceIDs(1);
+    });
+    std::thread startingThread([]() {
+        while (!exiting) {
+            std::this_thread::yield();
+        }
+        encodeTraceIDs(kExitEncodes);
+    });
+    exitingThread.join();
+    startingThread.join();
+    Snapshot after;
+    ASSERT_EQ(before.value.messages_encoded + 2 * kExitEncodes + 1,
+              after.value.messages_encoded);
+    pthread_key_delete(exitKey);
+}
+
+TEST(Stats, testTiming)
+{
+    jaeger_stats_set_timing(true);
+    encodeTraceIDs(100);
+    jaeger_stats_set_timing(false);
+    Snapshot snapshot;
+    ASSERT_LE(100u, snapshot.value.encode_time.count);
+    ASSERT_LT(0u, jaeger_list_size(&snapshot.value.encode_time.buckets));
+
+    // Snapshots are messages themselves, so they can be exported as is.
+    jaeger_buffer buffer;
+    std::memset(&buffer, 0, sizeof(buffer));
+    ASSERT_TRUE(
+        jaeger_struct_runtime_stats_snapshot_encode(&snapshot.value, &buffer));
+    jaeger_struct_runtime_stats_snapshot copy;
+    std::memset(&copy, 0, sizeof(copy));
+    ASSERT_TRUE(jaeger_struct_runtime_stats_snapshot_decode(
+        &copy, buffer.data, buffer.size));
+    ASSERT_EQ(snapshot.value.encode_time.count, copy.encode_time.count);
+    ASSERT_EQ(snapshot.value.messages_encoded, copy.messages_encoded);
+    jaeger_struct_runtime_stats_snapshot_destroy(&copy);
+    jaeger_buffer_destroy(&buffer);
+}
+
+}  // namespace runtime
+}  // namespace jaeger_struct
+
+#endif  // JAEGER_ENABLE_STATS
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_RUNTIME_TESTUTIL_HPP
+#define JAEGER_STRUCT_RUNTIME_TESTUTIL_HPP
+
+#include <cstring>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <jaeger.h>
+
+// Building and encoding the example's messages in tests.
+
+namespace jaeger_struct {
+namespace runtime {
+
+typedef JAEGER_LIST(jaegertracing_protobuf_log) LogNode;
+typedef JAEGER_LIST(jaegertracing_protobuf_span) SpanNode;
+typedef JAEGER_LIST(jaegertracing_protobuf_span_ref) SpanRefNode;
+typedef JAEGER_LIST(jaegertracing_protobuf_tag) TagNode;
+
+// Appends a zeroed node, to be freed with the list's owner.
+template <typename Node>
+Node* appendNode(jaeger_list& list)
+{
+    auto* node = static_cast<Node*>(jaeger_malloc(sizeof(Node)));
+    std::memset(node, 0, sizeof(*node));
+    jaeger_list_append(&list, &node->base);
+    return node;
+}
+
+inline void assign(jaeger_string& str, const std::string& value)
+{
+    ASSERT_TRUE(jaeger_string_assign(&str, value.data(), value.size()));
+}
+
+inline std::string toString(const jaeger_string& str)
+{
+    return std::string(str.buffer, str.len);
+}
+
+inline std::string toString(const jaeger_buffer& buffer)
+{
+    return std::string(reinterpret_cast<const char*>(buffer.data),
+                       buffer.size);
+}
+
+// Appends a tag with key to the tags of span, leaving its value unset.
+inline jaegertracing_protobuf_tag&
+appendTag(jaegertracing_protobuf_span& span, const std::string& key)
+{
+    auto& tag =
+        appendNode<TagNode>(*jaegertracing_protobuf_span_mutable_tags(&span))
+            ->value;
+    assign(tag.key, key);
+    return tag;
+}
+
+// Fills batch with a process and numSpans spans with IDs from 1, calling
+// fillSpan(span, index) to give each its shape.
+template <typename FillSpan>
+void fillBatch(jaegertracing_protobuf_batch& batch,
+               int numSpans,
+               FillSpan fillSpan)
+{
+    std::memset(&batch, 0, sizeof(batch));
+    assign(batch.process.service_name, "frontend");
+    for (auto i = 0; i < numSpans; ++i) {
+        auto& span = appendNode<SpanNode>(batch.spans)->value;
+        span.span_id = i + 1;
+        fillSpan(span, i);
+    }
+}
+
+inline std::string encode(const jaegertracing_protobuf_batch& batch)
+{
+    jaeger_buffer buffer;
+    std::memset(&buffer, 0, sizeof(buffer));
+    EXPECT_TRUE(jaegertracing_protobuf_batch_encode(&batch, &buffer));
+    const auto result = toString(buffer);
+    jaeger_buffer_destroy(&buffer);
+    return result;
+}
+
+}  // namespace runtime
+}  // namespace jaeger_struct
+
+#endif  // JAEGER_STRUCT_RUNTIME_TESTUTIL_HPP
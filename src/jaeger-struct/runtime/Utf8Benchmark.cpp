@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/utf8.h>
+
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+namespace jaeger_struct {
+namespace runtime {
+namespace {
+
+// Tag values of a mix of ASCII, accented Latin, CJK and emoji.
+std::string makeText(size_t size, bool ascii)
+{
+    const std::string words[] = { "http.url=/api/v1/orders ",
+                                  "caf\xc3\xa9 ",
+                                  "\xe6\x9d\xb1\xe4\xba\xac ",
+                                  "\xf0\x9f\x9a\x80 " };
+    std::string text;
+    for (auto i = 0u; text.size() < size; ++i) {
+        text += ascii ? words[0] : words[i % 4];
+    }
+    text.resize(size, ' ');
+    while (!jaeger_utf8_valid(text.data(), text.size())) {
+        text.pop_back();
+    }
+    return text;
+}
+
+void BM_Utf8Valid(benchmark::State& state)
+{
+    const auto text = makeText(state.range(0), state.range(1) != 0);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            jaeger_utf8_valid(text.data(), text.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_Utf8Valid)
+    ->Args({ 12, 1 })
+    ->Args({ 64, 0 })
+    ->Args({ 4096, 1 })
+    ->Args({ 4096, 0 })
+    ->Args({ 65536, 0 });
+
+}  // anonymous namespace
+}  // namespace runtime
+}  // namespace jaeger_struct
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/utf8.h>
+
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace jaeger_struct {
+namespace runtime {
+namespace {
+
+bool valid(const std::string& str)
+{
+    return jaeger_utf8_valid(str.data(), str.size());
+}
+
+// Decodes code points one at a time, as the definition in Unicode 3.9.
+bool referenceValid(const std::string& str)
+{
+    for (auto i = 0u; i < str.size();) {
+        const auto lead = static_cast<unsigned char>(str[i]);
+        unsigned length;
+        std::uint32_t codePoint;
+        if (lead < 0x80) {
+            ++i;
+            continue;
+        }
+        if ((lead & 0xe0) == 0xc0) {
+            length = 2;
+            codePoint = lead & 0x1f;
+        }
+        else if ((lead & 0xf0) == 0xe0) {
+            length = 3;
+            codePoint = lead & 0x0f;
+        }
+        else if ((lead & 0xf8) == 0xf0) {
+            length = 4;
+            codePoint = lead & 0x07;
+        }
+        else {
+            return false;
+        }
+        if (i + length > str.size()) {
+            return false;
+        }
+        for (auto j = 1u; j < length; ++j) {
+            const auto byte = static_cast<unsigned char>(str[i + j]);
+            if ((byte & 0xc0) != 0x80) {
+                return false;
+            }
+            codePoint = (codePoint << 6) | (byte & 0x3f);
+        }
+        const std::uint32_t minimums[] = { 0, 0, 0x80, 0x800, 0x10000 };
+        if (codePoint < minimums[length] || codePoint > 0x10ffff ||
+            (codePoint >= 0xd800 && codePoint <= 0xdfff)) {
+            return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+// Appends the UTF-8 encoding of codePoint.
+void appendCodePoint(std::string& str, std::uint32_t codePoint)
+{
+    if (codePoint < 0x80) {
+        str += static_cast<char>(codePoint);
+    }
+    else if (codePoint < 0x800) {
+        str += static_cast<char>(0xc0 | (codePoint >> 6));
+        str += static_cast<char>(0x80 | (codePoint & 0x3f));
+    }
+    else if (codePoint < 0x10000) {
+        str += static_cast<char>(0xe0 | (codePoint >> 12));
+        str += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+        str += static_cast<char>(0x80 | (codePoint & 0x3f));
+    }
+    else {
+        str += static_cast<char>(0xf0 | (codePoint >> 18));
+        str += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f));
+        str += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+        str += static_cast<char>(0x80 | (codePoint & 0x3f));
+    }
+}
+
+}  // anonymous namespace
+
+TEST(Utf8, testSequences)
+{
+    ASSERT_TRUE(valid(""));
+    ASSERT_TRUE(valid("plain ascii"));
+    ASSERT_TRUE(valid("caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80"));
+    ASSERT_TRUE(valid("\xed\x9f\xbf\xee\x80\x80\xf4\x8f\xbf\xbf"));
+    ASSERT_FALSE(valid("\x80"));
+    ASSERT_FALSE(valid("\xc0\xaf"));
+    ASSERT_FALSE(valid("\xc1\xbf"));
+    ASSERT_FALSE(valid("\xe0\x9f\xbf"));
+    ASSERT_FALSE(valid("\xf0\x8f\xbf\xbf"));
+    ASSERT_FALSE(valid("\xed\xa0\x80"));
+    ASSERT_FALSE(valid("\xf4\x90\x80\x80"));
+    ASSERT_FALSE(valid("\xf5\x80\x80\x80"));
+    ASSERT_FALSE(valid("\xff"));
+    ASSERT_FALSE(valid("\xe2\x82"));
+    ASSERT_FALSE(valid("\xc3\xa9\xa9"));
+}
+
+TEST(Utf8, testBlockBoundaries)
+{
+    // Every sequence at every offset around the 16 and 32 byte blocks, whole
+    // and cut short by the end of the string.
+    const std::string sequences[] = { "\xc3\xa9",
+                                      "\xe2\x82\xac",
+                                      "\xf0\x9f\x98\x80",
+                                      "\xed\xa0\x80",
+                                      "\xc0\xaf" };
+    for (auto&& sequence : sequences) {
+        const auto sequenceValid = referenceValid(sequence);
+        for (auto offset = 0u; offset < 70; ++offset) {
+            const auto str = std::string(offset, 'a') + sequence +
+                             std::string(offset % 7, 'b');
+            ASSERT_EQ(sequenceValid, valid(str)) << offset;
+            for (auto cut = 1u; cut < sequence.size(); ++cut) {
+                const auto prefix =
+                    std::string(offset, 'a') + sequence.substr(0, cut);
+                ASSERT_FALSE(valid(prefix)) << offset << " " << cut;
+                ASSERT_FALSE(valid(prefix + "b")) << offset << " " << cut;
+            }
+        }
+    }
+}
+
+TEST(Utf8, testRandom)
+{
+    std::mt19937 random(42);
+    std::uniform_int_distribution<std::uint32_t> codePoints(0, 0x10ffff);
+    for (auto i = 0; i < 2000; ++i) {
+        std::string str;
+        const auto length = random() % 200;
+        for (auto j = 0u; j < length; ++j) {
+            auto codePoint = random() % 2 == 0 ? random() % 0x80
+                                               : codePoints(random);
+            if (codePoint >= 0xd800 && codePoint <= 0xdfff) {
+                codePoint = 'x';
+            }
+            appendCodePoint(str, codePoint);
+        }
+        ASSERT_TRUE(valid(str));
+        if (str.empty()) {
+            continue;
+        }
+        // Corrupting a byte may or may not invalidate the string.
+        str[random() % str.size()] = static_cast<char>(random());
+        ASSERT_EQ(referenceValid(str), valid(str)) << i;
+    }
+}
+
+}  // namespace runtime
+}  // namespace jaeger_struct
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_RUNTIME_BUDGET_H
+#define JAEGER_STRUCT_RUNTIME_BUDGET_H
+
+#include <jaeger-struct/runtime/common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Memory budget shared by the threads buffering spans. Producers charge the
+ * bytes they are about to hold, e.g. sizeof a list node plus
+ * <type>_memory_usage of its value, and release them once the data is sent
+ * or freed, so that buffered memory stays under a limit whatever the size of
+ * each span. Charges take one atomic addition; a charge that overshoots is
+ * undone, so concurrent charges near the limit may fail although one of them
+ * alone would fit.
+ */
+typedef struct jaeger_budget {
+    /* Private: read and written atomically. */
+    size_t limit;
+    size_t used;
+} jaeger_budget;
+
+#define JAEGER_BUDGET_INIT(limit)                                              \
+    {                                                                          \
+        (limit), 0                                                             \
+    }
+
+/* Changes the limit, failing later charges until usage drops below it. */
+static inline void jaeger_budget_set_limit(jaeger_budget* budget, size_t limit)
+{
+    __atomic_store_n(&budget->limit, limit, __ATOMIC_RELAXED);
+}
+
+/* Takes size bytes from the budget. Returns false if they do not fit. */
+static inline bool jaeger_budget_charge(jaeger_budget* budget, size_t size)
+{
+    const size_t limit = __atomic_load_n(&budget->limit, __ATOMIC_RELAXED);
+    const size_t used =
+        __atomic_add_fetch(&budget->used, size, __ATOMIC_RELAXED);
+    if (used <= limit && used >= size) {
+        return true;
+    }
+    __atomic_sub_fetch(&budget->used, size, __ATOMIC_RELAXED);
+    return false;
+}
+
+/* Returns size bytes charged earlier. */
+static inline void jaeger_budget_release(jaeger_budget* budget, size_t size)
+{
+    __atomic_sub_fetch(&budget->used, size, __ATOMIC_RELAXED);
+}
+
+static inline size_t jaeger_budget_used(const jaeger_budget* budget)
+{
+    return __atomic_load_n(&budget->used, __ATOMIC_RELAXED);
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* JAEGER_STRUCT_RUNTIME_BUDGET_H */
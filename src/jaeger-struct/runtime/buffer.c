@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/buffer.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include <jaeger-struct/runtime/varint.h>
+
+bool jaeger_buffer_reserve(jaeger_buffer* buffer, size_t size)
+{
+    size_t capacity;
+    uint8_t* data;
+    if (size <= buffer->capacity - buffer->size) {
+        return true;
+    }
+    if (size > SIZE_MAX / 2 - buffer->size) {
+        return false;
+    }
+    capacity = buffer->capacity < 64 ? 64 : buffer->capacity;
+    while (capacity - buffer->size < size) {
+        capacity *= 2;
+    }
+    data = (uint8_t*) jaeger_realloc(buffer->data, capacity);
+    if (data == NULL) {
+        return false;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return true;
+}
+
+bool jaeger_buffer_append(jaeger_buffer* buffer, const void* data, size_t size)
+{
+    if (!jaeger_buffer_reserve(buffer, size)) {
+        return false;
+    }
+    if (size > 0) {
+        memcpy(buffer->data + buffer->size, data, size);
+        buffer->size += size;
+    }
+    return true;
+}
+
+bool jaeger_buffer_append_varint(jaeger_buffer* buffer, uint64_t value)
+{
+    if (!jaeger_buffer_reserve(buffer, JAEGER_VARINT_MAX_SIZE)) {
+        return false;
+    }
+    buffer->size =
+        jaeger_varint_write(buffer->data + buffer->size, value) - buffer->data;
+    return true;
+}
+
+void jaeger_buffer_destroy(jaeger_buffer* buffer)
+{
+    jaeger_free(buffer->data);
+    memset(buffer, 0, sizeof(*buffer));
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_RUNTIME_BUFFER_H
+#define JAEGER_STRUCT_RUNTIME_BUFFER_H
+
+#include <jaeger-struct/runtime/common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Growable byte buffer. Zero-initialized buffers are empty. */
+typedef struct jaeger_buffer {
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+} jaeger_buffer;
+
+/* Makes room for at least size more bytes past the end of the buffer. */
+bool jaeger_buffer_reserve(jaeger_buffer* buffer, size_t size);
+
+bool jaeger_buffer_append(jaeger_buffer* buffer, const void* data, size_t size);
+
+bool jaeger_buffer_append_varint(jaeger_buffer* buffer, uint64_t value);
+
+void jaeger_buffer_destroy(jaeger_buffer* buffer);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* JAEGER_STRUCT_RUNTIME_BUFFER_H */
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <jaeger-struct/runtime/clock.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __x86_64__
+#include <cpuid.h>
+#endif
+
+/* Time over which init first measures the counter's scale. */
+#define INIT_CALIBRATION_NS 1000000
+
+static int64_t read_clock(clockid_t id)
+{
+    struct timespec now;
+    clock_gettime(id, &now);
+    return (int64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+/*
+ * Reads both clocks with the ticks halfway through, keeping the quickest of
+ * a few attempts so that an interrupt does not skew the pairing.
+ */
+static void sample(const jaeger_clock* clock,
+                   uint64_t* ticks,
+                   int64_t* monotonic,
+                   int64_t* realtime)
+{
+    uint64_t best = UINT64_MAX;
+    int i;
+    for (i = 0; i < 4; ++i) {
+        const uint64_t before = jaeger_clock_ticks(clock);
+        const int64_t sampled_realtime = read_clock(CLOCK_REALTIME);
+        const int64_t sampled_monotonic = read_clock(CLOCK_MONOTONIC);
+        const uint64_t after = jaeger_clock_ticks(clock);
+        if (after - before < best) {
+            best = after - before;
+            *ticks = before + best / 2;
+            *monotonic = sampled_monotonic;
+            *realtime = sampled_realtime;
+        }
+    }
+}
+
+static bool counter_reliable(void)
+{
+#if defined(JAEGER_CLOCK_HAS_COUNTER) && defined(__x86_64__)
+    unsigned int eax;
+    unsigned int ebx;
+    unsigned int ecx;
+    unsigned int edx;
+    char source[16];
+    FILE* file;
+    bool reliable = true;
+    /* An invariant TSC ticks at a constant rate in every power state. */
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) ||
+        (edx & (1u << 8)) == 0) {
+        return false;
+    }
+    /* Linux stops using a TSC that it finds out of sync between cores. */
+    file = fopen("/sys/devices/system/clocksource/clocksource0/"
+                 "current_clocksource",
+                 "r");
+    if (file != NULL) {
+        reliable = fgets(source, sizeof(source), file) != NULL &&
+                   strncmp(source, "tsc", 3) == 0;
+        fclose(file);
+    }
+    return reliable;
+#elif defined(JAEGER_CLOCK_HAS_COUNTER)
+    /* The AArch64 generic timer has a fixed frequency. */
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool jaeger_clock_init(jaeger_clock* clock, jaeger_clock_source source)
+{
+    int64_t realtime;
+    memset(clock, 0, sizeof(*clock));
+    clock->counter = source != JAEGER_CLOCK_MONOTONIC && counter_reliable();
+    if (source == JAEGER_CLOCK_COUNTER && !clock->counter) {
+        return false;
+    }
+    clock->scale = (uint64_t) 1 << 32;
+    sample(clock, &clock->origin_ticks, &clock->origin_monotonic, &realtime);
+    clock->base_ticks = clock->origin_ticks;
+    clock->base_realtime = realtime;
+    if (clock->counter) {
+        while (read_clock(CLOCK_MONOTONIC) - clock->origin_monotonic <
+               INIT_CALIBRATION_NS) {
+        }
+        jaeger_clock_calibrate(clock);
+    }
+    return true;
+}
+
+void jaeger_clock_calibrate(jaeger_clock* clock)
+{
+    uint32_t sequence = __atomic_load_n(&clock->sequence, __ATOMIC_RELAXED);
+    uint64_t ticks;
+    int64_t monotonic;
+    int64_t realtime;
+    /* Concurrent calibrations would measure the same: one is enough. */
+    if ((sequence & 1) != 0 ||
+        !__atomic_compare_exchange_n(&clock->sequence,
+                                     &sequence,
+                                     sequence + 1,
+                                     false,
+                                     __ATOMIC_ACQUIRE,
+                                     __ATOMIC_RELAXED)) {
+        return;
+    }
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    sample(clock, &ticks, &monotonic, &realtime);
+#ifdef JAEGER_CLOCK_HAS_COUNTER
+    /* The longer the interval measured, the more precise the scale. */
+    if (clock->counter && ticks > clock->origin_ticks &&
+        monotonic > clock->origin_monotonic) {
+        const unsigned __int128 elapsed =
+            (unsigned __int128) (monotonic - clock->origin_monotonic) << 32;
+        __atomic_store_n(
+            &clock->scale,
+            (uint64_t) (elapsed / (ticks - clock->origin_ticks)),
+            __ATOMIC_RELAXED);
+    }
+#endif
+    __atomic_store_n(&clock->base_ticks, ticks, __ATOMIC_RELAXED);
+    __atomic_store_n(&clock->base_realtime, realtime, __ATOMIC_RELAXED);
+    __atomic_store_n(&clock->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_RUNTIME_CLOCK_H
+#define JAEGER_STRUCT_RUNTIME_CLOCK_H
+
+#include <time.h>
+
+#include <jaeger-struct/runtime/common.h>
+
+#if defined(__x86_64__) && defined(__SIZEOF_INT128__)
+#include <x86intrin.h>
+#define JAEGER_CLOCK_HAS_COUNTER
+#elif defined(__aarch64__) && defined(__SIZEOF_INT128__)
+#define JAEGER_CLOCK_HAS_COUNTER
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Clock for span timestamps that reads the CPU's cycle counter (the TSC on
+ * x86-64, the generic timer on AArch64) instead of calling clock_gettime.
+ * Ticks convert to nanoseconds with a scale measured against
+ * CLOCK_MONOTONIC, which the kernel slews but never steps, and to wall
+ * clock time from a base read from CLOCK_REALTIME. Both are recalibrated by
+ * jaeger_clock_calibrate, which should run periodically (e.g. every second
+ * from the thread flushing reporters) to follow NTP adjustments; readers
+ * never block on it. Where the counter is unreliable the clock reads
+ * CLOCK_MONOTONIC instead, which the C library serves from the vDSO.
+ */
+
+typedef enum jaeger_clock_source {
+    /* The cycle counter if invariant and used by the kernel, else monotonic. */
+    JAEGER_CLOCK_AUTO,
+    JAEGER_CLOCK_COUNTER,
+    JAEGER_CLOCK_MONOTONIC
+} jaeger_clock_source;
+
+typedef struct jaeger_clock {
+    /* Private: fixed at init. */
+    bool counter;
+    uint64_t origin_ticks;
+    int64_t origin_monotonic;
+    /*
+     * Private: read and written atomically, under a sequence lock that is
+     * odd while calibrating. Nanoseconds per tick in 32.32 fixed point.
+     */
+    uint32_t sequence;
+    uint64_t scale;
+    uint64_t base_ticks;
+    int64_t base_realtime;
+} jaeger_clock;
+
+/*
+ * Returns false if source is JAEGER_CLOCK_COUNTER and no reliable counter
+ * exists. Measuring the counter's scale takes about a millisecond.
+ */
+bool jaeger_clock_init(jaeger_clock* clock, jaeger_clock_source source);
+
+/* Remeasures the scale over the time since init and rereads the base. */
+void jaeger_clock_calibrate(jaeger_clock* clock);
+
+static inline uint64_t jaeger_clock_ticks(const jaeger_clock* clock)
+{
+    struct timespec now;
+#ifdef JAEGER_CLOCK_HAS_COUNTER
+    if (clock->counter) {
+#ifdef __x86_64__
+        return __rdtsc();
+#else
+        uint64_t value;
+        __asm__ __volatile__("isb; mrs %0, cntvct_el0" : "=r"(value));
+        return value;
+#endif
+    }
+#endif
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000 + (uint64_t) now.tv_nsec;
+}
+
+/* Private. */
+static inline int64_t jaeger_clock_scale_(const jaeger_clock* clock,
+                                          int64_t ticks,
+                                          uint64_t scale)
+{
+#ifdef JAEGER_CLOCK_HAS_COUNTER
+    if (clock->counter) {
+        __extension__ typedef __int128 int128;
+        return (int64_t) (((int128) ticks * (int128) scale) >> 32);
+    }
+#endif
+    (void) clock;
+    (void) scale;
+    return ticks;
+}
+
+/* Nanoseconds elapsed between two readings of jaeger_clock_ticks. */
+static inline int64_t
+jaeger_clock_elapsed(const jaeger_clock* clock, uint64_t start, uint64_t end)
+{
+    return jaeger_clock_scale_(
+        clock,
+        (int64_t) (end - start),
+        __atomic_load_n(&clock->scale, __ATOMIC_RELAXED));
+}
+
+/* Nanoseconds since the epoch at a reading of jaeger_clock_ticks. */
+static inline int64_t jaeger_clock_realtime(const jaeger_clock* clock,
+                                            uint64_t ticks)
+{
+    uint32_t sequence;
+    uint64_t scale;
+    uint64_t base_ticks;
+    int64_t base_realtime;
+    do {
+        sequence = __atomic_load_n(&clock->sequence, __ATOMIC_ACQUIRE);
+        scale = __atomic_load_n(&clock->scale, __ATOMIC_RELAXED);
+        base_ticks = __atomic_load_n(&clock->base_ticks, __ATOMIC_RELAXED);
+        base_realtime =
+            __atomic_load_n(&clock->base_realtime, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((sequence & 1) != 0 ||
+             sequence != __atomic_load_n(&clock->sequence, __ATOMIC_RELAXED));
+    return base_realtime +
+           jaeger_clock_scale_(clock, (int64_t) (ticks - base_ticks), scale);
+}
+
+/* Microseconds since the epoch, the unit of span and log timestamps. */
+static inline int64_t jaeger_clock_now_us(const jaeger_clock* clock)
+{
+    return jaeger_clock_realtime(clock, jaeger_clock_ticks(clock)) / 1000;
+}
+
+/*
+ * Sets the start time of a span and keeps the ticks in its duration until
+ * jaeger_clock_finish_span replaces them with the elapsed microseconds.
+ */
+static inline void jaeger_clock_start_span(const jaeger_clock* clock,
+                                           int64_t* start_time,
+                                           int64_t* duration)
+{
+    const uint64_t ticks = jaeger_clock_ticks(clock);
+    *start_time = jaeger_clock_realtime(clock, ticks) / 1000;
+    *duration = (int64_t) ticks;
+}
+
+static inline void jaeger_clock_finish_span(const jaeger_clock* clock,
+                                            int64_t* duration)
+{
+    *duration = jaeger_clock_elapsed(
+                    clock, (uint64_t) *duration, jaeger_clock_ticks(clock)) /
+                1000;
+}
+
+/* Times a generated span, or any struct with start_time and duration. */
+#define JAEGER_CLOCK_START_SPAN(clock, span)                                   \
+    jaeger_clock_start_span((clock), &(span)->start_time, &(span)->duration)
+#define JAEGER_CLOCK_FINISH_SPAN(clock, span)                                  \
+    jaeger_clock_finish_span((clock), &(span)->duration)
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* JAEGER_STRUCT_RUNTIME_CLOCK_H */
@@ -0,0 +1,1367 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/codec.h>
+
+#include <string.h>
+
+#include <jaeger-struct/runtime/list.h>
+#include <jaeger-struct/runtime/probe.h>
+#include <jaeger-struct/runtime/stats.h>
+#include <jaeger-struct/runtime/string.h>
+#include <jaeger-struct/runtime/utf8.h>
+#include <jaeger-struct/runtime/varint.h>
+
+/* Wire type of a single element, indexed by field type. */
+static const uint8_t element_wire_types[] = {
+    0,
+    JAEGER_WIRE_FIXED64, /* DOUBLE */
+    JAEGER_WIRE_FIXED32, /* FLOAT */
+    JAEGER_WIRE_VARINT,  /* INT64 */
+    JAEGER_WIRE_VARINT,  /* UINT64 */
+    JAEGER_WIRE_VARINT,  /* INT32 */
+    JAEGER_WIRE_FIXED64, /* FIXED64 */
+    JAEGER_WIRE_FIXED32, /* FIXED32 */
+    JAEGER_WIRE_VARINT,  /* BOOL */
+    JAEGER_WIRE_LENGTH,  /* STRING */
+    JAEGER_WIRE_START_GROUP,
+    JAEGER_WIRE_LENGTH,  /* MESSAGE */
+    JAEGER_WIRE_LENGTH,  /* BYTES */
+    JAEGER_WIRE_VARINT,  /* UINT32 */
+    JAEGER_WIRE_VARINT,  /* ENUM */
+    JAEGER_WIRE_FIXED32, /* SFIXED32 */
+    JAEGER_WIRE_FIXED64, /* SFIXED64 */
+    JAEGER_WIRE_VARINT,  /* SINT32 */
+    JAEGER_WIRE_VARINT,  /* SINT64 */
+};
+
+static bool is_scalar(uint8_t type)
+{
+    return type != JAEGER_TYPE_STRING && type != JAEGER_TYPE_BYTES &&
+           type != JAEGER_TYPE_MESSAGE && type != JAEGER_TYPE_ONEOF &&
+           type != JAEGER_TYPE_COLD;
+}
+
+/* Loads a scalar as its wire value: raw bits for fixed types. */
+static uint64_t load_scalar(uint8_t type, const uint8_t* ptr)
+{
+    uint32_t value32;
+    uint64_t value64;
+    switch (type) {
+    case JAEGER_TYPE_BOOL:
+        return *(const bool*) ptr ? 1 : 0;
+    case JAEGER_TYPE_INT32:
+    case JAEGER_TYPE_ENUM:
+        memcpy(&value32, ptr, sizeof(value32));
+        return (uint64_t)(int64_t)(int32_t) value32;
+    case JAEGER_TYPE_SINT32:
+        memcpy(&value32, ptr, sizeof(value32));
+        return jaeger_zigzag_encode((int32_t) value32);
+    case JAEGER_TYPE_UINT32:
+    case JAEGER_TYPE_FIXED32:
+    case JAEGER_TYPE_SFIXED32:
+    case JAEGER_TYPE_FLOAT:
+        memcpy(&value32, ptr, sizeof(value32));
+        return value32;
+    case JAEGER_TYPE_SINT64:
+        memcpy(&value64, ptr, sizeof(value64));
+        return jaeger_zigzag_encode((int64_t) value64);
+    default:
+        memcpy(&value64, ptr, sizeof(value64));
+        return value64;
+    }
+}
+
+static void store_scalar(uint8_t type, uint8_t* ptr, uint64_t value)
+{
+    uint32_t value32;
+    switch (type) {
+    case JAEGER_TYPE_BOOL:
+        *(bool*) ptr = (value != 0);
+        break;
+    case JAEGER_TYPE_SINT32:
+        value32 = (uint32_t) jaeger_zigzag_decode(value);
+        memcpy(ptr, &value32, sizeof(value32));
+        break;
+    case JAEGER_TYPE_SINT64:
+        value = (uint64_t) jaeger_zigzag_decode(value);
+        memcpy(ptr, &value, sizeof(value));
+        break;
+    case JAEGER_TYPE_INT32:
+    case JAEGER_TYPE_ENUM:
+    case JAEGER_TYPE_UINT32:
+    case JAEGER_TYPE_FIXED32:
+    case JAEGER_TYPE_SFIXED32:
+    case JAEGER_TYPE_FLOAT:
+        value32 = (uint32_t) value;
+        memcpy(ptr, &value32, sizeof(value32));
+        break;
+    default:
+        memcpy(ptr, &value, sizeof(value));
+        break;
+    }
+}
+
+static size_t scalar_wire_size(uint8_t type, uint64_t value)
+{
+    switch (element_wire_types[type]) {
+    case JAEGER_WIRE_FIXED32:
+        return 4;
+    case JAEGER_WIRE_FIXED64:
+        return 8;
+    default:
+        return jaeger_varint_size(value);
+    }
+}
+
+static bool put_fixed(jaeger_buffer* out, uint64_t value, size_t size)
+{
+    uint8_t bytes[8];
+    size_t i;
+    for (i = 0; i < size; ++i) {
+        bytes[i] = (uint8_t)(value >> (i * 8));
+    }
+    return jaeger_buffer_append(out, bytes, size);
+}
+
+static uint64_t get_fixed(const uint8_t* pos, size_t size)
+{
+    uint64_t value = 0;
+    size_t i;
+    for (i = 0; i < size; ++i) {
+        value |= (uint64_t) pos[i] << (i * 8);
+    }
+    return value;
+}
+
+static bool put_scalar(jaeger_buffer* out, uint8_t type, uint64_t value)
+{
+    switch (element_wire_types[type]) {
+    case JAEGER_WIRE_FIXED32:
+        return put_fixed(out, value, 4);
+    case JAEGER_WIRE_FIXED64:
+        return put_fixed(out, value, 8);
+    default:
+        return jaeger_buffer_append_varint(out, value);
+    }
+}
+
+/*
+ * Whether data may be the value of a string or bytes field: string fields
+ * must be valid UTF-8 unless validation is skipped for trusted data.
+ */
+static bool valid_string(const jaeger_field_table* field,
+                         const void* data,
+                         size_t len,
+                         bool validate)
+{
+    return !validate || field->type != JAEGER_TYPE_STRING ||
+           jaeger_utf8_valid(data, len);
+}
+
+static bool put_tag(jaeger_buffer* out, uint32_t number, uint8_t wire_type)
+{
+    return jaeger_buffer_append_varint(out,
+                                       ((uint64_t) number << 3) | wire_type);
+}
+
+/* Returns the frozen encoding of message if it is not stale, else NULL. */
+static const jaeger_buffer* frozen_encoding(const jaeger_message_table* table,
+                                            const uint8_t* message)
+{
+    const jaeger_encoded_cache* cache;
+    if (table->encoded_offset == 0) {
+        return NULL;
+    }
+    cache = *(jaeger_encoded_cache* const*) (message + table->encoded_offset);
+    if (cache == NULL || cache->version != cache->frozen_version) {
+        return NULL;
+    }
+    return &cache->bytes;
+}
+
+static bool encode_message(const jaeger_message_table* table,
+                           const uint8_t* message,
+                           jaeger_buffer* out,
+                           int depth,
+                           bool validate);
+
+/*
+ * Writes a length-delimited submessage. The length is assumed to fit in one
+ * byte and the body moved if it does not, so most submessages are written
+ * once. Empty submessages are dropped if skip_empty.
+ */
+static bool encode_submessage(const jaeger_field_table* field,
+                              const uint8_t* message,
+                              jaeger_buffer* out,
+                              bool skip_empty,
+                              int depth,
+                              bool validate)
+{
+    const size_t start = out->size;
+    size_t body;
+    size_t len;
+    size_t len_size;
+    if (!put_tag(out, field->number, JAEGER_WIRE_LENGTH) ||
+        !jaeger_buffer_reserve(out, 1)) {
+        return false;
+    }
+    body = ++out->size;
+    if (!encode_message((const jaeger_message_table*) field->table,
+                        message,
+                        out,
+                        depth + 1,
+                        validate)) {
+        return false;
+    }
+    len = out->size - body;
+    if (len == 0 && skip_empty) {
+        out->size = start;
+        return true;
+    }
+    len_size = jaeger_varint_size(len);
+    if (len_size > 1) {
+        if (!jaeger_buffer_reserve(out, len_size - 1)) {
+            return false;
+        }
+        memmove(out->data + body + len_size - 1, out->data + body, len);
+        out->size += len_size - 1;
+    }
+    jaeger_varint_write(out->data + body - 1, len);
+    return true;
+}
+
+/* Writes one element of field with its tag. */
+static bool encode_element(const jaeger_field_table* field,
+                           const uint8_t* ptr,
+                           jaeger_buffer* out,
+                           int depth,
+                           bool validate)
+{
+    const jaeger_string* str;
+    switch (field->type) {
+    case JAEGER_TYPE_STRING:
+    case JAEGER_TYPE_BYTES:
+        str = (const jaeger_string*) ptr;
+        return valid_string(field, str->buffer, str->len, validate) &&
+               put_tag(out, field->number, JAEGER_WIRE_LENGTH) &&
+               jaeger_buffer_append_varint(out, str->len) &&
+               jaeger_buffer_append(out, str->buffer, str->len);
+    case JAEGER_TYPE_MESSAGE:
+        return encode_submessage(field, ptr, out, false, depth, validate);
+    default:
+        return put_tag(
+                   out, field->number, element_wire_types[field->type]) &&
+               put_scalar(out, field->type, load_scalar(field->type, ptr));
+    }
+}
+
+static bool encode_packed(const jaeger_field_table* field,
+                          const jaeger_list* list,
+                          jaeger_buffer* out)
+{
+    const jaeger_list* node;
+    size_t len = 0;
+    if (jaeger_list_empty(list)) {
+        return true;
+    }
+    JAEGER_LIST_FOR_EACH(list, node) {
+        len += scalar_wire_size(
+            field->type,
+            load_scalar(field->type,
+                        (const uint8_t*) node + field->node_offset));
+    }
+    if (!put_tag(out, field->number, JAEGER_WIRE_LENGTH) ||
+        !jaeger_buffer_append_varint(out, len) ||
+        !jaeger_buffer_reserve(out, len)) {
+        return false;
+    }
+    JAEGER_LIST_FOR_EACH(list, node) {
+        if (!put_scalar(out,
+                        field->type,
+                        load_scalar(field->type,
+                                    (const uint8_t*) node +
+                                        field->node_offset))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool encode_field(const jaeger_field_table* field,
+                         const uint8_t* message,
+                         jaeger_buffer* out,
+                         int depth,
+                         bool validate)
+{
+    const uint8_t* ptr = message + field->offset;
+    const jaeger_list* node;
+    if (field->type == JAEGER_TYPE_COLD) {
+        /* Cold fields follow the others, without a tag of their own. */
+        ptr = *(const uint8_t* const*) ptr;
+        return ptr == NULL ||
+               encode_message((const jaeger_message_table*) field->table,
+                              ptr,
+                              out,
+                              depth,
+                              validate);
+    }
+    if (field->type == JAEGER_TYPE_ONEOF) {
+        /* Oneof members have explicit presence: the tagged one is always
+         * written. */
+        const jaeger_message_table* members =
+            (const jaeger_message_table*) field->table;
+        const uint8_t type = *ptr;
+        if (type >= members->field_count) {
+            return true;
+        }
+        return encode_element(&members->fields[type],
+                              ptr + members->fields[type].offset,
+                              out,
+                              depth,
+                              validate);
+    }
+    if (field->repeated) {
+        const jaeger_list* list = (const jaeger_list*) ptr;
+        if (field->wire_type == JAEGER_WIRE_LENGTH && is_scalar(field->type)) {
+            return encode_packed(field, list, out);
+        }
+        JAEGER_LIST_FOR_EACH(list, node) {
+            if (!encode_element(field,
+                                (const uint8_t*) node + field->node_offset,
+                                out,
+                                depth,
+                                validate)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    switch (field->type) {
+    case JAEGER_TYPE_STRING:
+    case JAEGER_TYPE_BYTES:
+        if (((const jaeger_string*) ptr)->len == 0) {
+            return true;
+        }
+        break;
+    case JAEGER_TYPE_MESSAGE:
+        return encode_submessage(field, ptr, out, true, depth, validate);
+    default:
+        if (load_scalar(field->type, ptr) == 0) {
+            return true;
+        }
+        break;
+    }
+    return encode_element(field, ptr, out, depth, validate);
+}
+
+static bool encode_message(const jaeger_message_table* table,
+                           const uint8_t* message,
+                           jaeger_buffer* out,
+                           int depth,
+                           bool validate)
+{
+    const jaeger_buffer* frozen = frozen_encoding(table, message);
+    size_t i;
+    if (depth > JAEGER_CODEC_MAX_DEPTH) {
+        return false;
+    }
+    if (frozen != NULL) {
+        return frozen->size == 0 ||
+               jaeger_buffer_append(out, frozen->data, frozen->size);
+    }
+    for (i = 0; i < table->field_count; ++i) {
+        if (!encode_field(&table->fields[i], message, out, depth, validate)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool encode(const jaeger_message_table* table,
+                   const void* message,
+                   jaeger_buffer* out,
+                   bool validate)
+{
+    const size_t size = out->size;
+    const uint64_t start = JAEGER_STATS_BEGIN();
+    JAEGER_PROBE2(encode_start, table->name, size);
+    if (!encode_message(table, (const uint8_t*) message, out, 0, validate)) {
+        out->size = size;
+        return false;
+    }
+    JAEGER_PROBE2(encode_end, table->name, out->size - size);
+    JAEGER_STATS_END(JAEGER_STATS_ENCODE_TIME, start);
+    JAEGER_STATS_ADD(JAEGER_STATS_MESSAGES_ENCODED, 1);
+    JAEGER_STATS_ADD(JAEGER_STATS_ENCODED_BYTES, out->size - size);
+    return true;
+}
+
+bool jaeger_encode(const jaeger_message_table* table,
+                   const void* message,
+                   jaeger_buffer* out)
+{
+    return encode(table, message, out, true);
+}
+
+bool jaeger_encode_trusted(const jaeger_message_table* table,
+                           const void* message,
+                           jaeger_buffer* out)
+{
+    return encode(table, message, out, false);
+}
+
+/*
+ * Sizes of the submessages of a message in the order encoding visits them,
+ * recorded by the sizing pass so that scatter-gather encoding can write
+ * length prefixes without sizing every level again.
+ */
+typedef struct size_cache {
+    size_t* sizes;
+    size_t count;
+    size_t capacity;
+    /* Next size to be read back while encoding. */
+    size_t next;
+    bool failed;
+} size_cache;
+
+static size_t fields_size(const jaeger_message_table* table,
+                          const uint8_t* message,
+                          size_t first,
+                          size_t last,
+                          size_cache* cache);
+
+static size_t tag_size(uint32_t number)
+{
+    return jaeger_varint_size((uint64_t) number << 3);
+}
+
+static size_t length_delimited_size(uint32_t number, size_t len)
+{
+    return tag_size(number) + jaeger_varint_size(len) + len;
+}
+
+static size_t message_size(const jaeger_message_table* table,
+                           const uint8_t* message,
+                           size_cache* cache)
+{
+    const jaeger_buffer* frozen = frozen_encoding(table, message);
+    size_t index;
+    size_t capacity;
+    size_t* sizes;
+    size_t size;
+    if (cache == NULL) {
+        return frozen != NULL
+                   ? frozen->size
+                   : fields_size(table, message, 0, table->field_count, NULL);
+    }
+    if (cache->count == cache->capacity) {
+        capacity = cache->capacity < 64 ? 64 : cache->capacity * 2;
+        sizes = (size_t*) jaeger_realloc(cache->sizes,
+                                         capacity * sizeof(*sizes));
+        if (sizes == NULL) {
+            cache->failed = true;
+            return 0;
+        }
+        cache->sizes = sizes;
+        cache->capacity = capacity;
+    }
+    /*
+     * Reserve the slot first: submessages come after their parent, except in
+     * a frozen encoding, which has no sizes to record.
+     */
+    index = cache->count++;
+    size = frozen != NULL
+               ? frozen->size
+               : fields_size(table, message, 0, table->field_count, cache);
+    cache->sizes[index] = size;
+    return size;
+}
+
+/* Mirrors encode_element. */
+static size_t element_size(const jaeger_field_table* field,
+                           const uint8_t* ptr,
+                           size_cache* cache)
+{
+    switch (field->type) {
+    case JAEGER_TYPE_STRING:
+    case JAEGER_TYPE_BYTES:
+        return length_delimited_size(field->number,
+                                     ((const jaeger_string*) ptr)->len);
+    case JAEGER_TYPE_MESSAGE:
+        return length_delimited_size(
+            field->number,
+            message_size(
+                (const jaeger_message_table*) field->table, ptr, cache));
+    default:
+        return tag_size(field->number) +
+               scalar_wire_size(field->type, load_scalar(field->type, ptr));
+    }
+}
+
+/* Mirrors encode_field. */
+static size_t field_size(const jaeger_field_table* field,
+                         const uint8_t* message,
+                         size_cache* cache)
+{
+    const uint8_t* ptr = message + field->offset;
+    const jaeger_list* node;
+    size_t size = 0;
+    size_t len;
+    if (field->type == JAEGER_TYPE_COLD) {
+        const jaeger_message_table* cold =
+            (const jaeger_message_table*) field->table;
+        ptr = *(const uint8_t* const*) ptr;
+        return ptr == NULL
+                   ? 0
+                   : fields_size(cold, ptr, 0, cold->field_count, cache);
+    }
+    if (field->type == JAEGER_TYPE_ONEOF) {
+        const jaeger_message_table* members =
+            (const jaeger_message_table*) field->table;
+        const uint8_t type = *ptr;
+        if (type >= members->field_count) {
+            return 0;
+        }
+        return element_size(&members->fields[type],
+                            ptr + members->fields[type].offset,
+                            cache);
+    }
+    if (field->repeated) {
+        const jaeger_list* list = (const jaeger_list*) ptr;
+        if (field->wire_type == JAEGER_WIRE_LENGTH && is_scalar(field->type)) {
+            if (jaeger_list_empty(list)) {
+                return 0;
+            }
+            JAEGER_LIST_FOR_EACH(list, node) {
+                size += scalar_wire_size(
+                    field->type,
+                    load_scalar(field->type,
+                                (const uint8_t*) node + field->node_offset));
+            }
+            return length_delimited_size(field->number, size);
+        }
+        JAEGER_LIST_FOR_EACH(list, node) {
+            size += element_size(
+                field, (const uint8_t*) node + field->node_offset, cache);
+        }
+        return size;
+    }
+    switch (field->type) {
+    case JAEGER_TYPE_STRING:
+    case JAEGER_TYPE_BYTES:
+        if (((const jaeger_string*) ptr)->len == 0) {
+            return 0;
+        }
+        break;
+    case JAEGER_TYPE_MESSAGE:
+        len = message_size(
+            (const jaeger_message_table*) field->table, ptr, cache);
+        return len == 0 ? 0 : length_delimited_size(field->number, len);
+    default:
+        if (load_scalar(field->type, ptr) == 0) {
+            return 0;
+        }
+        break;
+    }
+    return element_size(field, ptr, cache);
+}
+
+static size_t fields_size(const jaeger_message_table* table,
+                          const uint8_t* message,
+                          size_t first,
+                          size_t last,
+                          size_cache* cache)
+{
+    size_t size = 0;
+    size_t i;
+    for (i = first; i < last; ++i) {
+        size += field_size(&table->fields[i], message, cache);
+    }
+    return size;
+}
+
+size_t jaeger_encoded_size(const jaeger_message_table* table,
+                           const void* message)
+{
+    return message_size(table, (const uint8_t*) message, NULL);
+}
+
+size_t jaeger_encoded_fields_size(const jaeger_message_table* table,
+                                  const void* message,
+                                  size_t first,
+                                  size_t last)
+{
+    return fields_size(table, (const uint8_t*) message, first, last, NULL);
+}
+
+bool jaeger_encode_fields(const jaeger_message_table* table,
+                          const void* message,
+                          size_t first,
+                          size_t last,
+                          jaeger_buffer* out)
+{
+    const size_t size = out->size;
+    size_t i;
+    for (i = first; i < last; ++i) {
+        if (!encode_field(
+                &table->fields[i], (const uint8_t*) message, out, 0, true)) {
+            out->size = size;
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t jaeger_encoded_cache_memory_usage(const jaeger_encoded_cache* cache)
+{
+    return cache != NULL ? sizeof(*cache) + cache->bytes.capacity : 0;
+}
+
+void jaeger_encoded_cache_destroy(jaeger_encoded_cache** cache)
+{
+    if (*cache != NULL) {
+        jaeger_buffer_destroy(&(*cache)->bytes);
+        jaeger_free(*cache);
+        *cache = NULL;
+    }
+}
+
+bool jaeger_freeze(const jaeger_message_table* table, void* message)
+{
+    jaeger_encoded_cache** slot =
+        (jaeger_encoded_cache**) ((uint8_t*) message + table->encoded_offset);
+    jaeger_encoded_cache* cache = *slot;
+    if (cache == NULL) {
+        cache = (jaeger_encoded_cache*) jaeger_malloc(sizeof(*cache));
+        if (cache == NULL) {
+            return false;
+        }
+        memset(cache, 0, sizeof(*cache));
+        *slot = cache;
+    }
+    /* Stale until encoded, so that a failure leaves no partial encoding. */
+    cache->frozen_version = cache->version - 1;
+    cache->bytes.size = 0;
+    if (!jaeger_encode_fields(
+            table, message, 0, table->field_count, &cache->bytes)) {
+        return false;
+    }
+    cache->frozen_version = cache->version;
+    return true;
+}
+
+/*
+ * Scatter-gather encoding. Referenced strings cannot be moved to make room
+ * for a length prefix, so submessage lengths are read back from a size_cache
+ * filled by one sizing pass up front.
+ */
+
+static bool iov_put_tag(jaeger_iov_buffer* out,
+                        uint32_t number,
+                        uint8_t wire_type)
+{
+    return jaeger_iov_buffer_append_varint(
+        out, ((uint64_t) number << 3) | wire_type);
+}
+
+static bool iov_put_scalar(jaeger_iov_buffer* out,
+                           uint8_t type,
+                           uint64_t value)
+{
+    uint8_t bytes[8];
+    size_t size;
+    size_t i;
+    switch (element_wire_types[type]) {
+    case JAEGER_WIRE_FIXED32:
+        size = 4;
+        break;
+    case JAEGER_WIRE_FIXED64:
+        size = 8;
+        break;
+    default:
+        return jaeger_iov_buffer_append_varint(out, value);
+    }
+    for (i = 0; i < size; ++i) {
+        bytes[i] = (uint8_t)(value >> (i * 8));
+    }
+    return jaeger_iov_buffer_copy(out, bytes, size);
+}
+
+static bool iov_encode_message(const jaeger_message_table* table,
+                               const uint8_t* message,
+                               jaeger_iov_buffer* out,
+                               size_cache* cache,
+                               int depth,
+                               bool validate);
+
+static bool iov_encode_submessage(const jaeger_field_table* field,
+                                  const uint8_t* message,
+                                  jaeger_iov_buffer* out,
+                                  size_cache* cache,
+                                  bool skip_empty,
+                                  int depth,
+                                  bool validate)
+{
+    const jaeger_message_table* table =
+        (const jaeger_message_table*) field->table;
+    const size_t len = cache->sizes[cache->next++];
+    if (len == 0 && skip_empty) {
+        return true;
+    }
+    return iov_put_tag(out, field->number, JAEGER_WIRE_LENGTH) &&
+           jaeger_iov_buffer_append_varint(out, len) &&
+           iov_encode_message(table, message, out, cache, depth + 1, validate);
+}
+
+/* Mirrors encode_element. */
+static bool iov_encode_element(const jaeger_field_table* field,
+                               const uint8_t* ptr,
+                               jaeger_iov_buffer* out,
+                               size_cache* cache,
+                               int depth,
+                               bool validate)
+{
+    const jaeger_string* str;
+    switch (field->type) {
+    case JAEGER_TYPE_STRING:
+    case JAEGER_TYPE_BYTES:
+        str = (const jaeger_string*) ptr;
+        return valid_string(field, str->buffer, str->len, validate) &&
+               iov_put_tag(out, field->number, JAEGER_WIRE_LENGTH) &&
+               jaeger_iov_buffer_append_varint(out, str->len) &&
+               jaeger_iov_buffer_append(out, str->buffer, str->len);
+    case JAEGER_TYPE_MESSAGE:
+        return iov_encode_submessage(
+            field, ptr, out, cache, false, depth, validate);
+    default:
+        return iov_put_tag(
+                   out, field->number, element_wire_types[field->type]) &&
+               iov_put_scalar(out, field->type, load_scalar(field->type, ptr));
+    }
+}
+
+/* Mirrors encode_field. */
+static bool iov_encode_field(const jaeger_field_table* field,
+                             const uint8_t* message,
+                             jaeger_iov_buffer* out,
+                             size_cache* cache,
+                             int depth,
+                             bool validate)
+{
+    const uint8_t* ptr = message + field->offset;
+    const jaeger_list* node;
+    size_t len;
+    if (field->type == JAEGER_TYPE_COLD) {
+        ptr = *(const uint8_t* const*) ptr;
+        return ptr == NULL ||
+               iov_encode_message((const jaeger_message_table*) field->table,
+                                  ptr,
+                                  out,
+                                  cache,
+                                  depth,
+                                  validate);
+    }
+    if (field->type == JAEGER_TYPE_ONEOF) {
+        const jaeger_message_table* members =
+            (const jaeger_message_table*) field->table;
+        const uint8_t type = *ptr;
+        if (type >= members->field_count) {
+            return true;
+        }
+        return iov_encode_element(&members->fields[type],
+                                  ptr + members->fields[type].offset,
+                                  out,
+                                  cache,
+                                  depth,
+                                  validate);
+    }
+    if (field->repeated) {
+        const jaeger_list* list = (const jaeger_list*) ptr;
+        if (field->wire_type == JAEGER_WIRE_LENGTH && is_scalar(field->type)) {
+            if (jaeger_list_empty(list)) {
+                return true;
+            }
+            len = 0;
+            JAEGER_LIST_FOR_EACH(list, node) {
+                len += scalar_wire_size(
+                    field->type,
+                    load_scalar(field->type,
+                                (const uint8_t*) node + field->node_offset));
+            }
+            if (!iov_put_tag(out, field->number, JAEGER_WIRE_LENGTH) ||
+                !jaeger_iov_buffer_append_varint(out, len)) {
+                return false;
+            }
+            JAEGER_LIST_FOR_EACH(list, node) {
+                if (!iov_put_scalar(out,
+                                    field->type,
+                                    load_scalar(field->type,
+                                                (const uint8_t*) node +
+                                                    field->node_offset))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        JAEGER_LIST_FOR_EACH(list, node) {
+            if (!iov_encode_element(field,
+                                    (const uint8_t*) node + field->node_offset,
+                                    out,
+                                    cache,
+                                    depth,
+                                    validate)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    switch (field->type) {
+    case JAEGER_TYPE_STRING:
+    case JAEGER_TYPE_BYTES:
+        if (((const jaeger_string*) ptr)->len == 0) {
+            return true;
+        }
+        break;
+    case JAEGER_TYPE_MESSAGE:
+        return iov_encode_submessage(
+            field, ptr, out, cache, true, depth, validate);
+    default:
+        if (load_scalar(field->type, ptr) == 0) {
+            return true;
+        }
+        break;
+    }
+    return iov_encode_element(field, ptr, out, cache, depth, validate);
+}
+
+static bool iov_encode_message(const jaeger_message_table* table,
+                               const uint8_t* message,
+                               jaeger_iov_buffer* out,
+                               size_cache* cache,
+                               int depth,
+                               bool validate)
+{
+    const jaeger_buffer* frozen = frozen_encoding(table, message);
+    size_t i;
+    if (depth > JAEGER_CODEC_MAX_DEPTH) {
+        return false;
+    }
+    if (frozen != NULL) {
+        return frozen->size == 0 ||
+               jaeger_iov_buffer_append(out, frozen->data, frozen->size);
+    }
+    for (i = 0; i < table->field_count; ++i) {
+        if (!iov_encode_field(
+                &table->fields[i], message, out, cache, depth, validate)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool encode_iov(const jaeger_message_table* table,
+                       const void* message,
+                       jaeger_iov_buffer* out,
+                       bool validate)
+{
+    const size_t count = out->count;
+    const size_t size = out->size;
+    const uint64_t start = JAEGER_STATS_BEGIN();
+    size_cache cache;
+    bool success;
+    JAEGER_PROBE2(encode_start, table->name, size);
+    memset(&cache, 0, sizeof(cache));
+    cache.sizes = out->sizes;
+    cache.capacity = out->sizes_capacity;
+    message_size(table, (const uint8_t*) message, &cache);
+    out->sizes = cache.sizes;
+    out->sizes_capacity = cache.capacity;
+    /* The first size is that of message itself. */
+    cache.next = 1;
+    success = !cache.failed && iov_encode_message(table,
+                                                  (const uint8_t*) message,
+                                                  out,
+                                                  &cache,
+                                                  0,
+                                                  validate);
+    if (!success) {
+        jaeger_iov_buffer_truncate(out, count, size);
+        return false;
+    }
+    JAEGER_PROBE2(encode_end, table->name, out->size - size);
+    JAEGER_STATS_END(JAEGER_STATS_ENCODE_TIME, start);
+    JAEGER_STATS_ADD(JAEGER_STATS_MESSAGES_ENCODED, 1);
+    JAEGER_STATS_ADD(JAEGER_STATS_ENCODED_BYTES, out->size - size);
+    return true;
+}
+
+bool jaeger_encode_iov(const jaeger_message_table* table,
+                       const void* message,
+                       jaeger_iov_buffer* out)
+{
+    return encode_iov(table, message, out, true);
+}
+
+bool jaeger_encode_iov_trusted(const jaeger_message_table* table,
+                               const void* message,
+                               jaeger_iov_buffer* out)
+{
+    return encode_iov(table, message, out, false);
+}
+
+static void destroy_message(const jaeger_message_table* table,
+                            uint8_t* message);
+
+static void destroy_element(const jaeger_field_table* field, uint8_t* ptr)
+{
+    switch (field->type) {
+    case JAEGER_TYPE_STRING:
+    case JAEGER_TYPE_BYTES:
+        jaeger_string_destroy((jaeger_string*) ptr);
+        break;
+    case JAEGER_TYPE_MESSAGE:
+        destroy_message((const jaeger_message_table*) field->table, ptr);
+        break;
+    default:
+        break;
+    }
+}
+
+static void destroy_field(const jaeger_field_table* field, uint8_t* message)
+{
+    uint8_t* ptr = message + field->offset;
+    if (field->type == JAEGER_TYPE_COLD) {
+        uint8_t** cold = (uint8_t**) ptr;
+        if (*cold != NULL) {
+            destroy_message((const jaeger_message_table*) field->table, *cold);
+            jaeger_free(*cold);
+            *cold = NULL;
+        }
+        return;
+    }
+    if (field->type == JAEGER_TYPE_ONEOF) {
+        const jaeger_message_table* members =
+            (const jaeger_message_table*) field->table;
+        if (*ptr < members->field_count) {
+            destroy_element(&members->fields[*ptr],
+                            ptr + members->fields[*ptr].offset);
+        }
+        return;
+    }
+    if (field->repeated) {
+        jaeger_list* list = (jaeger_list*) ptr;
+        uint8_t* storage = message + field->inline_offset;
+        size_t i;
+        while (list->next != NULL) {
+            jaeger_list* node = list->next;
+            list->next = node->next;
+            if (field->inline_capacity != 0 &&
+                jaeger_list_inline_owns(
+                    storage, field->node_size, field->inline_capacity, node)) {
+                continue;
+            }
+            destroy_element(field, (uint8_t*) node + field->node_offset);
+            jaeger_free(node);
+        }
+        list->prev = NULL;
+        if (field->inline_capacity == 0) {
+            return;
+        }
+        /* Unused inline nodes may still hold buffers from earlier uses. */
+        for (i = 0; i < field->inline_capacity; ++i) {
+            uint8_t* node = storage + i * field->node_size;
+            destroy_element(field, node + field->node_offset);
+        }
+        *jaeger_list_inline_size(
+            storage, field->node_size, field->inline_capacity) = 0;
+        return;
+    }
+    destroy_element(field, ptr);
+}
+
+static void destroy_message(const jaeger_message_table* table,
+                            uint8_t* message)
+{
+    size_t i;
+    for (i = 0; i < table->field_count; ++i) {
+        destroy_field(&table->fields[i], message);
+    }
+    if (table->encoded_offset != 0) {
+        jaeger_encoded_cache_destroy(
+            (jaeger_encoded_cache**) (message + table->encoded_offset));
+    }
+}
+
+/*
+ * Finds the field numbered number, either in table or among the members of
+ * one of its oneofs or of its cold fields, whose table field is then
+ * returned in *container. Fields usually arrive in order, so the search
+ * starts past the previous match.
+ */
+static const jaeger_field_table*
+find_field(const jaeger_message_table* table,
+           uint32_t number,
+           size_t* hint,
+           const jaeger_field_table** container)
+{
+    size_t i;
+    size_t j;
+    *container = NULL;
+    for (i = *hint; i < table->field_count; ++i) {
+        if (table->fields[i].number == number) {
+            *hint = i + 1;
+            return &table->fields[i];
+        }
+    }
+    for (i = 0; i < *hint && i < table->field_count; ++i) {
+        if (table->fields[i].number == number) {
+            *hint = i + 1;
+            return &table->fields[i];
+        }
+    }
+    for (i = 0; i < table->field_count; ++i) {
+        const jaeger_message_table* members;
+        if (table->fields[i].type != JAEGER_TYPE_ONEOF &&
+            table->fields[i].type != JAEGER_TYPE_COLD) {
+            continue;
+        }
+        members = (const jaeger_message_table*) table->fields[i].table;
+        for (j = 0; j < members->field_count; ++j) {
+            if (members->fields[j].number == number) {
+                *container = &table->fields[i];
+                return &members->fields[j];
+            }
+        }
+    }
+    return NULL;
+}
+
+static bool read_length(const uint8_t** pos, const uint8_t* end, size_t* len)
+{
+    uint64_t value;
+    if (!jaeger_varint_read(pos, end, &value) ||
+        value > (uint64_t)(end - *pos)) {
+        return false;
+    }
+    *len = (size_t) value;
+    return true;
+}
+
+static bool read_scalar(const uint8_t** pos,
+                        const uint8_t* end,
+                        uint8_t type,
+                        uint64_t* value)
+{
+    size_t size;
+    switch (element_wire_types[type]) {
+    case JAEGER_WIRE_FIXED32:
+        size = 4;
+        break;
+    case JAEGER_WIRE_FIXED64:
+        size = 8;
+        break;
+    default:
+        return jaeger_varint_read(pos, end, value);
+    }
+    if ((size_t)(end - *pos) < size) {
+        return false;
+    }
+    *value = get_fixed(*pos, size);
+    *pos += size;
+    return true;
+}
+
+static bool skip_field(const uint8_t** pos, const uint8_t* end, uint8_t wire)
+{
+    uint64_t value;
+    size_t len;
+    switch (wire) {
+    case JAEGER_WIRE_VARINT:
+        return jaeger_varint_read(pos, end, &value);
+    case JAEGER_WIRE_FIXED64:
+        len = 8;
+        break;
+    case JAEGER_WIRE_FIXED32:
+        len = 4;
+        break;
+    case JAEGER_WIRE_LENGTH:
+        if (!read_length(pos, end, &len)) {
+            return false;
+        }
+        break;
+    default:
+        /* Groups are not supported. */
+        return false;
+    }
+    if ((size_t)(end - *pos) < len) {
+        return false;
+    }
+    *pos += len;
+    return true;
+}
+
+static bool decode_message(const jaeger_message_table* table,
+                           uint8_t* message,
+                           const uint8_t* pos,
+                           const uint8_t* end,
+                           int depth,
+                           bool validate);
+
+static bool decode_element(const jaeger_field_table* field,
+                           uint8_t* ptr,
+                           const uint8_t** pos,
+                           const uint8_t* end,
+                           int depth,
+                           bool validate)
+{
+    uint64_t value;
+    size_t len;
+    switch (field->type) {
+    case JAEGER_TYPE_STRING:
+    case JAEGER_TYPE_BYTES:
+        if (!read_length(pos, end, &len) ||
+            !valid_string(field, *pos, len, validate) ||
+            !jaeger_string_assign(
+                (jaeger_string*) ptr, (const char*) *pos, len)) {
+            return false;
+        }
+        *pos += len;
+        return true;
+    case JAEGER_TYPE_MESSAGE:
+        if (!read_length(pos, end, &len) ||
+            !decode_message((const jaeger_message_table*) field->table,
+                            ptr,
+                            *pos,
+                            *pos + len,
+                            depth + 1,
+                            validate)) {
+            return false;
+        }
+        *pos += len;
+        return true;
+    default:
+        if (!read_scalar(pos, end, field->type, &value)) {
+            return false;
+        }
+        store_scalar(field->type, ptr, value);
+        return true;
+    }
+}
+
+/*
+ * Appends a node to the list of a repeated field, an unused inline node if
+ * any is left, else a zeroed one.
+ */
+static uint8_t* append_node(const jaeger_field_table* field, uint8_t* message)
+{
+    jaeger_list* node = NULL;
+    if (field->inline_capacity != 0) {
+        node = jaeger_list_inline_take(message + field->inline_offset,
+                                       field->node_size,
+                                       field->inline_capacity);
+    }
+    if (node == NULL) {
+        node = (jaeger_list*) jaeger_malloc(field->node_size);
+        if (node == NULL) {
+            return NULL;
+        }
+        memset(node, 0, field->node_size);
+    }
+    jaeger_list_append((jaeger_list*) (message + field->offset), node);
+    return (uint8_t*) node + field->node_offset;
+}
+
+/*
+ * Returns the struct that field, a member of container, is relative to: the
+ * union, switched to field if another member was set, or the cold fields,
+ * allocated if there were none. Returns NULL if allocation fails.
+ */
+static uint8_t* container_base(const jaeger_field_table* container,
+                               const jaeger_field_table* field,
+                               uint8_t* message)
+{
+    const jaeger_message_table* members =
+        (const jaeger_message_table*) container->table;
+    uint8_t* base = message + container->offset;
+    uint8_t type;
+    if (container->type == JAEGER_TYPE_COLD) {
+        uint8_t** cold = (uint8_t**) base;
+        if (*cold == NULL) {
+            *cold = (uint8_t*) jaeger_malloc(members->size);
+            if (*cold != NULL) {
+                memset(*cold, 0, members->size);
+            }
+        }
+        return *cold;
+    }
+    type = (uint8_t)(field - members->fields);
+    if (*base != type) {
+        const size_t value = members->fields[0].offset;
+        destroy_field(container, message);
+        memset(base + value, 0, members->size - value);
+        *base = type;
+    }
+    return base;
+}
+
+static bool decode_repeated(const jaeger_field_table* field,
+                            uint8_t* message,
+                            uint8_t wire,
+                            const uint8_t** pos,
+                            const uint8_t* end,
+                            int depth,
+                            bool validate)
+{
+    uint8_t* ptr;
+    if (wire == JAEGER_WIRE_LENGTH && is_scalar(field->type)) {
+        size_t len;
+        const uint8_t* packed_end;
+        if (!read_length(pos, end, &len)) {
+            return false;
+        }
+        packed_end = *pos + len;
+        while (*pos < packed_end) {
+            uint64_t value;
+            if (!read_scalar(pos, packed_end, field->type, &value)) {
+                return false;
+            }
+            ptr = append_node(field, message);
+            if (ptr == NULL) {
+                return false;
+            }
+            store_scalar(field->type, ptr, value);
+        }
+        return true;
+    }
+    ptr = append_node(field, message);
+    return ptr != NULL &&
+           decode_element(field, ptr, pos, end, depth, validate);
+}
+
+static bool decode_message(const jaeger_message_table* table,
+                           uint8_t* message,
+                           const uint8_t* pos,
+                           const uint8_t* end,
+                           int depth,
+                           bool validate)
+{
+    size_t hint = 0;
+    if (depth > JAEGER_CODEC_MAX_DEPTH) {
+        return false;
+    }
+    if (table->encoded_offset != 0) {
+        jaeger_encoded_cache_touch(
+            *(jaeger_encoded_cache**) (message + table->encoded_offset));
+    }
+    while (pos < end) {
+        const jaeger_field_table* field;
+        const jaeger_field_table* container;
+        uint64_t key;
+        uint8_t wire;
+        uint8_t* base = message;
+        if (!jaeger_varint_read(&pos, end, &key) || (key >> 3) == 0 ||
+            (key >> 3) > UINT32_MAX) {
+            return false;
+        }
+        wire = (uint8_t)(key & 7);
+        field = find_field(table, (uint32_t)(key >> 3), &hint, &container);
+        if (field == NULL ||
+            (wire != element_wire_types[field->type] &&
+             !(field->repeated && wire == JAEGER_WIRE_LENGTH &&
+               is_scalar(field->type)))) {
+            if (!skip_field(&pos, end, wire)) {
+                return false;
+            }
+            continue;
+        }
+        if (container != NULL) {
+            base = container_base(container, field, message);
+            if (base == NULL) {
+                return false;
+            }
+        }
+        if (field->repeated) {
+            if (!decode_repeated(
+                    field, base, wire, &pos, end, depth, validate)) {
+                return false;
+            }
+            continue;
+        }
+        if (!decode_element(field,
+                            base + field->offset,
+                            &pos,
+                            end,
+                            depth,
+                            validate)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool decode(const jaeger_message_table* table,
+                   void* message,
+                   const void* data,
+                   size_t size,
+                   bool validate)
+{
+    const uint8_t* pos = (const uint8_t*) data;
+    const uint64_t start = JAEGER_STATS_BEGIN();
+    if (!decode_message(
+            table, (uint8_t*) message, pos, pos + size, 0, validate)) {
+        return false;
+    }
+    JAEGER_STATS_END(JAEGER_STATS_DECODE_TIME, start);
+    JAEGER_STATS_ADD(JAEGER_STATS_MESSAGES_DECODED, 1);
+    JAEGER_STATS_ADD(JAEGER_STATS_DECODED_BYTES, size);
+    return true;
+}
+
+bool jaeger_decode(const jaeger_message_table* table,
+                   void* message,
+                   const void* data,
+                   size_t size)
+{
+    return decode(table, message, data, size, true);
+}
+
+bool jaeger_decode_trusted(const jaeger_message_table* table,
+                           void* message,
+                           const void* data,
+                           size_t size)
+{
+    return decode(table, message, data, size, false);
+}
+
+bool jaeger_enum_table_contains(const jaeger_enum_table* table, int32_t value)
+{
+    size_t low = 0;
+    size_t high = table->value_count;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (table->values[mid] < value) {
+            low = mid + 1;
+        }
+        else if (table->values[mid] > value) {
+            high = mid;
+        }
+        else {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_RUNTIME_CODEC_H
+#define JAEGER_STRUCT_RUNTIME_CODEC_H
+
+#include <jaeger-struct/runtime/buffer.h>
+#include <jaeger-struct/runtime/common.h>
+#include <jaeger-struct/runtime/iov.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Table-driven protobuf codec. With the codec=table option the generator
+ * emits a const table per message, oneof and enum instead of per-message
+ * code, and this engine walks the tables to encode and decode.
+ */
+
+enum {
+    JAEGER_WIRE_VARINT = 0,
+    JAEGER_WIRE_FIXED64 = 1,
+    JAEGER_WIRE_LENGTH = 2,
+    JAEGER_WIRE_START_GROUP = 3,
+    JAEGER_WIRE_END_GROUP = 4,
+    JAEGER_WIRE_FIXED32 = 5
+};
+
+/* Field types, numbered as in descriptor.proto. */
+enum {
+    JAEGER_TYPE_DOUBLE = 1,
+    JAEGER_TYPE_FLOAT = 2,
+    JAEGER_TYPE_INT64 = 3,
+    JAEGER_TYPE_UINT64 = 4,
+    JAEGER_TYPE_INT32 = 5,
+    JAEGER_TYPE_FIXED64 = 6,
+    JAEGER_TYPE_FIXED32 = 7,
+    JAEGER_TYPE_BOOL = 8,
+    JAEGER_TYPE_STRING = 9,
+    JAEGER_TYPE_GROUP = 10,
+    JAEGER_TYPE_MESSAGE = 11,
+    JAEGER_TYPE_BYTES = 12,
+    JAEGER_TYPE_UINT32 = 13,
+    JAEGER_TYPE_ENUM = 14,
+    JAEGER_TYPE_SFIXED32 = 15,
+    JAEGER_TYPE_SFIXED64 = 16,
+    JAEGER_TYPE_SINT32 = 17,
+    JAEGER_TYPE_SINT64 = 18,
+    /* A oneof member of the struct. Its table lists the union's fields. */
+    JAEGER_TYPE_ONEOF = 19,
+    /*
+     * The pointer to the cold fields of the struct. Its table lists them
+     * relative to the companion struct, allocated when decoding one of them.
+     */
+    JAEGER_TYPE_COLD = 20
+};
+
+enum { JAEGER_CODEC_MAX_DEPTH = 64 };
+
+typedef struct jaeger_field_table {
+    /* Zero for JAEGER_TYPE_ONEOF and JAEGER_TYPE_COLD. */
+    uint32_t number;
+    uint32_t offset;
+    /* Size of a JAEGER_LIST node and offset of its value if repeated. */
+    uint32_t node_size;
+    uint32_t node_offset;
+    /*
+     * Offset and capacity of the JAEGER_LIST_INLINE storage of a repeated
+     * field marked (jaeger_struct.inline_capacity), zero otherwise.
+     */
+    uint32_t inline_offset;
+    uint32_t inline_capacity;
+    /* JAEGER_WIRE_LENGTH for packed repeated scalars. */
+    uint8_t wire_type;
+    uint8_t type;
+    bool repeated;
+    /*
+     * jaeger_message_table for messages, oneofs and cold fields,
+     * jaeger_enum_table for enums, NULL otherwise.
+     */
+    const void* table;
+} jaeger_field_table;
+
+/*
+ * Fields of a message in field number order, followed by its oneofs and its
+ * cold fields. For a oneof, fields are its members relative to the union
+ * struct, and the index of a member is its type tag.
+ */
+typedef struct jaeger_message_table {
+    const char* name;
+    size_t size;
+    const jaeger_field_table* fields;
+    size_t field_count;
+    /*
+     * Offset of the jaeger_encoded_cache pointer of a struct marked
+     * (jaeger_struct.cached), zero otherwise.
+     */
+    size_t encoded_offset;
+} jaeger_message_table;
+
+/* Enumerator values in ascending order. Enums are stored as int. */
+typedef struct jaeger_enum_table {
+    const char* name;
+    const int32_t* values;
+    size_t value_count;
+} jaeger_enum_table;
+
+bool jaeger_enum_table_contains(const jaeger_enum_table* table, int32_t value);
+
+/*
+ * Appends the wire format encoding of message to out. Fails if a string
+ * field is not valid UTF-8, as proto3 requires; bytes fields are not checked.
+ */
+bool jaeger_encode(const jaeger_message_table* table,
+                   const void* message,
+                   jaeger_buffer* out);
+
+/*
+ * Like jaeger_encode without validating UTF-8, for messages whose strings
+ * are known to be valid, such as those decoded with validation.
+ */
+bool jaeger_encode_trusted(const jaeger_message_table* table,
+                           const void* message,
+                           jaeger_buffer* out);
+
+/*
+ * Appends the encoding of the fields of message from table->fields[first] up
+ * to but excluding table->fields[last], so that callers can encode a field
+ * themselves. Unlike jaeger_encode, not counted in stats.
+ */
+bool jaeger_encode_fields(const jaeger_message_table* table,
+                          const void* message,
+                          size_t first,
+                          size_t last,
+                          jaeger_buffer* out);
+
+/*
+ * Appends the encoding of message to out like jaeger_encode, referencing
+ * strings and bytes of at least out->threshold bytes in place instead of
+ * copying them. The message must outlive the output.
+ */
+bool jaeger_encode_iov(const jaeger_message_table* table,
+                       const void* message,
+                       jaeger_iov_buffer* out);
+
+bool jaeger_encode_iov_trusted(const jaeger_message_table* table,
+                               const void* message,
+                               jaeger_iov_buffer* out);
+
+/* Returns the number of bytes jaeger_encode would append for message. */
+size_t jaeger_encoded_size(const jaeger_message_table* table,
+                           const void* message);
+
+/* Returns the number of bytes jaeger_encode_fields would append. */
+size_t jaeger_encoded_fields_size(const jaeger_message_table* table,
+                                  const void* message,
+                                  size_t first,
+                                  size_t last);
+
+/*
+ * Encoding of a message frozen by jaeger_freeze. While version equals
+ * frozen_version the codec copies bytes instead of encoding the message,
+ * wherever it appears. Generated functions writing a cached struct bump
+ * version, making the frozen encoding stale until the next freeze.
+ */
+typedef struct jaeger_encoded_cache {
+    jaeger_buffer bytes;
+    uint64_t version;
+    uint64_t frozen_version;
+} jaeger_encoded_cache;
+
+static inline void jaeger_encoded_cache_touch(jaeger_encoded_cache* cache)
+{
+    if (cache != NULL) {
+        ++cache->version;
+    }
+}
+
+/* Bytes allocated for cache, which may be NULL. */
+size_t jaeger_encoded_cache_memory_usage(const jaeger_encoded_cache* cache);
+
+/* Frees *cache and sets it to NULL. */
+void jaeger_encoded_cache_destroy(jaeger_encoded_cache** cache);
+
+/*
+ * Encodes message, whose table must have an encoded_offset, into its
+ * encoded cache, allocating the cache on first use. Later encodings of the
+ * message splice these bytes in until it is written again.
+ */
+bool jaeger_freeze(const jaeger_message_table* table, void* message);
+
+/*
+ * Merges the encoded message in data into message, which must be initialized
+ * (zeroed or previously decoded). Fails on string fields that are not valid
+ * UTF-8. On failure message holds a partial result that must still be
+ * destroyed.
+ */
+bool jaeger_decode(const jaeger_message_table* table,
+                   void* message,
+                   const void* data,
+                   size_t size);
+
+/* Like jaeger_decode without validating UTF-8, for data from trusted peers. */
+bool jaeger_decode_trusted(const jaeger_message_table* table,
+                           void* message,
+                           const void* data,
+                           size_t size);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* JAEGER_STRUCT_RUNTIME_CODEC_H */
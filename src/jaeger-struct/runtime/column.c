@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/column.h>
+
+#include <stdint.h>
+#include <string.h>
+
+void* jaeger_column_resize(void* data, size_t elem_size, size_t capacity)
+{
+    if (elem_size != 0 && capacity > SIZE_MAX / elem_size) {
+        return NULL;
+    }
+    return jaeger_realloc(data, elem_size * capacity);
+}
+
+bool jaeger_string_column_reserve(jaeger_string_column* column,
+                                  size_t capacity)
+{
+    const bool empty = (column->offsets == NULL);
+    size_t* offsets = (size_t*) jaeger_column_resize(
+        column->offsets, sizeof(*offsets), capacity + 1);
+    if (offsets == NULL) {
+        return false;
+    }
+    if (empty) {
+        offsets[0] = 0;
+    }
+    column->offsets = offsets;
+    return true;
+}
+
+bool jaeger_string_column_append(jaeger_string_column* column,
+                                 size_t row,
+                                 const jaeger_string* str)
+{
+    const size_t start = column->offsets[row];
+    if (str->len > column->blob_capacity - start) {
+        size_t capacity = jaeger_column_grow(column->blob_capacity);
+        char* blob;
+        while (capacity - start < str->len) {
+            capacity *= 2;
+        }
+        blob = (char*) jaeger_realloc(column->blob, capacity);
+        if (blob == NULL) {
+            return false;
+        }
+        column->blob = blob;
+        column->blob_capacity = capacity;
+    }
+    if (str->len > 0) {
+        memcpy(column->blob + start, str->buffer, str->len);
+    }
+    column->offsets[row + 1] = start + str->len;
+    return true;
+}
+
+bool jaeger_string_column_copy(const jaeger_string_column* column,
+                               size_t row,
+                               jaeger_string* str)
+{
+    const jaeger_string view = jaeger_string_column_get(column, row);
+    return jaeger_string_assign(str, view.buffer, view.len);
+}
+
+void jaeger_string_column_destroy(jaeger_string_column* column)
+{
+    jaeger_free(column->offsets);
+    jaeger_free(column->blob);
+    memset(column, 0, sizeof(*column));
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_RUNTIME_COLUMN_H
+#define JAEGER_STRUCT_RUNTIME_COLUMN_H
+
+#include <jaeger-struct/runtime/common.h>
+#include <jaeger-struct/runtime/stats.h>
+#include <jaeger-struct/runtime/string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Building blocks for the columnar (struct-of-arrays) companion types emitted
+ * by the generator. A column table owns one array per scalar field, all sized
+ * to the table capacity.
+ */
+
+/* Returns the capacity to grow to once capacity is exhausted. */
+static inline size_t jaeger_column_grow(size_t capacity)
+{
+    return capacity < 16 ? 16 : capacity * 2;
+}
+
+/*
+ * Resizes an array of capacity elements of elem_size bytes. Returns the new
+ * array, or NULL on failure, in which case data is left untouched.
+ */
+void* jaeger_column_resize(void* data, size_t elem_size, size_t capacity);
+
+/*
+ * Strings stored as one contiguous blob. Row i spans
+ * blob[offsets[i], offsets[i + 1]).
+ */
+typedef struct jaeger_string_column {
+    size_t* offsets;
+    char* blob;
+    size_t blob_capacity;
+} jaeger_string_column;
+
+/* Makes room for capacity rows. */
+bool jaeger_string_column_reserve(jaeger_string_column* column,
+                                  size_t capacity);
+
+/* Stores str at row, which must be the row following the last one stored. */
+bool jaeger_string_column_append(jaeger_string_column* column,
+                                 size_t row,
+                                 const jaeger_string* str);
+
+/*
+ * Returns a borrowed view of row, valid until the column is modified. The
+ * view does not own its buffer: it must not be cleared, assigned or
+ * destroyed, nor stored in a message that will be.
+ */
+static inline jaeger_string jaeger_string_column_get(
+    const jaeger_string_column* column, size_t row)
+{
+    jaeger_string str;
+    JAEGER_STATS_ADD(JAEGER_STATS_STRINGS_BORROWED, 1);
+    str.len = column->offsets[row + 1] - column->offsets[row];
+    str.buffer = column->blob + column->offsets[row];
+    str.capacity = 0;
+    return str;
+}
+
+/* Copies row into str, replacing its contents. */
+bool jaeger_string_column_copy(const jaeger_string_column* column,
+                               size_t row,
+                               jaeger_string* str);
+
+void jaeger_string_column_destroy(jaeger_string_column* column);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* JAEGER_STRUCT_RUNTIME_COLUMN_H */
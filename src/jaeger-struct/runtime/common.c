@@ -15,3 +15,29 @@
  */
 
 #include <jaeger-struct/runtime/common.h>
+
+#include <stdlib.h>
+
+#include <jaeger-struct/runtime/stats.h>
+
+void* jaeger_malloc(size_t size)
+{
+    JAEGER_STATS_ADD(JAEGER_STATS_ALLOCATIONS, 1);
+    JAEGER_STATS_ADD(JAEGER_STATS_ALLOCATED_BYTES, size);
+    return malloc(size);
+}
+
+void* jaeger_realloc(void* ptr, size_t size)
+{
+    JAEGER_STATS_ADD(JAEGER_STATS_ALLOCATIONS, 1);
+    JAEGER_STATS_ADD(JAEGER_STATS_ALLOCATED_BYTES, size);
+    return realloc(ptr, size);
+}
+
+void jaeger_free(void* ptr)
+{
+    if (ptr != NULL) {
+        JAEGER_STATS_ADD(JAEGER_STATS_FREES, 1);
+    }
+    free(ptr);
+}
@@ -21,4 +21,17 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* All runtime and generated code allocates through these functions. */
+void* jaeger_malloc(size_t size);
+void* jaeger_realloc(void* ptr, size_t size);
+void jaeger_free(void* ptr);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
 #endif /* JAEGER_STRUCT_RUNTIME_COMMON_H */
@@ -0,0 +1,629 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/compress.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include <jaeger-struct/runtime/lz.h>
+#include <jaeger-struct/runtime/varint.h>
+
+enum { CODEC_PLAIN, CODEC_DELTA, CODEC_DELTA2, CODEC_FIXED };
+
+enum { STRINGS_PLAIN, STRINGS_DICTIONARY };
+
+static void widen(const void* values,
+                  size_t elem_size,
+                  bool is_signed,
+                  size_t count,
+                  uint64_t* result)
+{
+    size_t i;
+#define WIDEN(signed_type, unsigned_type)                                      \
+    do {                                                                       \
+        const unsigned_type* typed = (const unsigned_type*) values;            \
+        if (is_signed) {                                                       \
+            for (i = 0; i < count; ++i) {                                      \
+                result[i] = (uint64_t)(int64_t)(signed_type) typed[i];         \
+            }                                                                  \
+        }                                                                      \
+        else {                                                                 \
+            for (i = 0; i < count; ++i) {                                      \
+                result[i] = typed[i];                                          \
+            }                                                                  \
+        }                                                                      \
+    } while (0)
+
+    switch (elem_size) {
+    case 1:
+        WIDEN(int8_t, uint8_t);
+        break;
+    case 2:
+        WIDEN(int16_t, uint16_t);
+        break;
+    case 4:
+        WIDEN(int32_t, uint32_t);
+        break;
+    default:
+        memcpy(result, values, count * sizeof(*result));
+        break;
+    }
+
+#undef WIDEN
+}
+
+static void
+narrow(const uint64_t* values, size_t elem_size, size_t count, void* result)
+{
+    size_t i;
+#define NARROW(type)                                                           \
+    for (i = 0; i < count; ++i) {                                              \
+        ((type*) result)[i] = (type) values[i];                                \
+    }
+
+    switch (elem_size) {
+    case 1:
+        NARROW(uint8_t);
+        break;
+    case 2:
+        NARROW(uint16_t);
+        break;
+    case 4:
+        NARROW(uint32_t);
+        break;
+    default:
+        memcpy(result, values, count * sizeof(*values));
+        break;
+    }
+
+#undef NARROW
+}
+
+/* Computes the encoded size of values under each varint codec in one pass. */
+static void
+estimate(const uint64_t* values, size_t count, bool zigzag, size_t* sizes)
+{
+    uint64_t previous = 0;
+    uint64_t previous_delta = 0;
+    size_t plain = 0;
+    size_t delta = 0;
+    size_t delta2 = 0;
+    size_t i;
+    for (i = 0; i < count; ++i) {
+        const uint64_t value = values[i];
+        const uint64_t d = value - previous;
+        plain += jaeger_varint_size(
+            zigzag ? jaeger_zigzag_encode((int64_t) value) : value);
+        delta += jaeger_varint_size(jaeger_zigzag_encode((int64_t) d));
+        delta2 += jaeger_varint_size(
+            jaeger_zigzag_encode((int64_t)(d - previous_delta)));
+        previous = value;
+        previous_delta = d;
+    }
+    sizes[CODEC_PLAIN] = plain;
+    sizes[CODEC_DELTA] = delta;
+    sizes[CODEC_DELTA2] = delta2;
+}
+
+/* Applies a varint codec in place. */
+static void transform(uint64_t* values, size_t count, int codec, bool zigzag)
+{
+    uint64_t previous = 0;
+    uint64_t previous_delta = 0;
+    size_t i;
+    switch (codec) {
+    case CODEC_PLAIN:
+        if (zigzag) {
+            for (i = 0; i < count; ++i) {
+                values[i] = jaeger_zigzag_encode((int64_t) values[i]);
+            }
+        }
+        break;
+    case CODEC_DELTA:
+        for (i = 0; i < count; ++i) {
+            const uint64_t value = values[i];
+            values[i] = jaeger_zigzag_encode((int64_t)(value - previous));
+            previous = value;
+        }
+        break;
+    default:
+        for (i = 0; i < count; ++i) {
+            const uint64_t value = values[i];
+            const uint64_t delta = value - previous;
+            values[i] =
+                jaeger_zigzag_encode((int64_t)(delta - previous_delta));
+            previous = value;
+            previous_delta = delta;
+        }
+        break;
+    }
+}
+
+static void untransform(uint64_t* values, size_t count, int codec, bool zigzag)
+{
+    uint64_t previous = 0;
+    uint64_t previous_delta = 0;
+    size_t i;
+    for (i = 0; i < count; ++i) {
+        uint64_t value = values[i];
+        if (codec != CODEC_PLAIN || zigzag) {
+            value = (uint64_t) jaeger_zigzag_decode(value);
+        }
+        if (codec == CODEC_DELTA2) {
+            previous_delta += value;
+            value = previous_delta;
+        }
+        if (codec != CODEC_PLAIN) {
+            previous += value;
+            value = previous;
+        }
+        values[i] = value;
+    }
+}
+
+bool jaeger_block_put_size(jaeger_buffer* block, size_t size)
+{
+    return jaeger_buffer_append_varint(block, size);
+}
+
+bool jaeger_block_get_size(jaeger_block_reader* reader, size_t* size)
+{
+    uint64_t value;
+    if (!jaeger_varint_read(&reader->pos, reader->end, &value) ||
+        value > SIZE_MAX) {
+        return false;
+    }
+    *size = (size_t) value;
+    return true;
+}
+
+bool jaeger_block_put_ints(jaeger_buffer* block,
+                           const void* values,
+                           size_t elem_size,
+                           bool is_signed,
+                           size_t count)
+{
+    uint64_t* scratch;
+    size_t sizes[CODEC_FIXED];
+    size_t best_size;
+    int best_codec = CODEC_FIXED;
+    int codec;
+    size_t i;
+    uint8_t* pos;
+
+    if (count == 0) {
+        return true;
+    }
+    scratch =
+        (uint64_t*) jaeger_column_resize(NULL, sizeof(*scratch), count);
+    if (scratch == NULL) {
+        return false;
+    }
+
+    widen(values, elem_size, is_signed, count, scratch);
+    estimate(scratch, count, is_signed, sizes);
+    best_size = count * elem_size;
+    for (codec = CODEC_PLAIN; codec <= CODEC_DELTA2; ++codec) {
+        if (sizes[codec] < best_size) {
+            best_size = sizes[codec];
+            best_codec = codec;
+        }
+    }
+
+    if (!jaeger_buffer_reserve(block, 1 + best_size)) {
+        jaeger_free(scratch);
+        return false;
+    }
+    pos = block->data + block->size;
+    *pos++ = (uint8_t) best_codec;
+    if (best_codec == CODEC_FIXED) {
+        for (i = 0; i < count; ++i) {
+            size_t byte;
+            for (byte = 0; byte < elem_size; ++byte) {
+                *pos++ = (uint8_t)(scratch[i] >> (8 * byte));
+            }
+        }
+    }
+    else {
+        transform(scratch, count, best_codec, is_signed);
+        for (i = 0; i < count; ++i) {
+            pos = jaeger_varint_write(pos, scratch[i]);
+        }
+    }
+    block->size = pos - block->data;
+    jaeger_free(scratch);
+    return true;
+}
+
+bool jaeger_block_get_ints(jaeger_block_reader* reader,
+                           void* values,
+                           size_t elem_size,
+                           bool is_signed,
+                           size_t count)
+{
+    uint64_t* scratch;
+    uint8_t codec;
+    size_t i;
+
+    if (count == 0) {
+        return true;
+    }
+    if (reader->pos == reader->end) {
+        return false;
+    }
+    codec = *reader->pos++;
+    if (codec > CODEC_FIXED) {
+        return false;
+    }
+    scratch =
+        (uint64_t*) jaeger_column_resize(NULL, sizeof(*scratch), count);
+    if (scratch == NULL) {
+        return false;
+    }
+    if (codec == CODEC_FIXED) {
+        if ((size_t)(reader->end - reader->pos) / elem_size < count) {
+            jaeger_free(scratch);
+            return false;
+        }
+        for (i = 0; i < count; ++i) {
+            size_t byte;
+            scratch[i] = 0;
+            for (byte = 0; byte < elem_size; ++byte) {
+                scratch[i] |= (uint64_t) *reader->pos++ << (8 * byte);
+            }
+        }
+    }
+    else {
+        for (i = 0; i < count; ++i) {
+            if (!jaeger_varint_read(&reader->pos, reader->end, &scratch[i])) {
+                jaeger_free(scratch);
+                return false;
+            }
+        }
+        untransform(scratch, count, codec, is_signed);
+    }
+    narrow(scratch, elem_size, count, values);
+    jaeger_free(scratch);
+    return true;
+}
+
+bool jaeger_block_put_raw(jaeger_buffer* block, const void* data, size_t size)
+{
+    return jaeger_buffer_append(block, data, size);
+}
+
+bool jaeger_block_get_raw(jaeger_block_reader* reader, void* data, size_t size)
+{
+    if ((size_t)(reader->end - reader->pos) < size) {
+        return false;
+    }
+    if (size > 0) {
+        memcpy(data, reader->pos, size);
+        reader->pos += size;
+    }
+    return true;
+}
+
+static uint64_t hash_bytes(const char* data, size_t size)
+{
+    uint64_t hash = 14695981039346656037u;
+    size_t i;
+    for (i = 0; i < size; ++i) {
+        hash = (hash ^ (uint8_t) data[i]) * 1099511628211u;
+    }
+    return hash;
+}
+
+/*
+ * Assigns each row the index of its value in order of first appearance.
+ * Returns the number of distinct values, or 0 if there are more than limit or
+ * memory is exhausted.
+ */
+static size_t build_dictionary(const jaeger_string_column* column,
+                               size_t count,
+                               size_t limit,
+                               uint32_t* indices,
+                               size_t* first_rows)
+{
+    size_t table_size = 16;
+    size_t* table;
+    size_t unique = 0;
+    size_t row;
+
+    while (table_size < 2 * limit) {
+        table_size *= 2;
+    }
+    table = (size_t*) jaeger_column_resize(NULL, sizeof(*table), table_size);
+    if (table == NULL) {
+        return 0;
+    }
+    memset(table, 0xff, table_size * sizeof(*table));
+
+    for (row = 0; row < count; ++row) {
+        const jaeger_string value = jaeger_string_column_get(column, row);
+        size_t slot = hash_bytes(value.buffer, value.len) & (table_size - 1);
+        for (;;) {
+            const size_t index = table[slot];
+            jaeger_string existing;
+            if (index == SIZE_MAX) {
+                if (unique == limit) {
+                    jaeger_free(table);
+                    return 0;
+                }
+                table[slot] = unique;
+                first_rows[unique] = row;
+                indices[row] = (uint32_t) unique++;
+                break;
+            }
+            existing = jaeger_string_column_get(column, first_rows[index]);
+            /* Empty views may carry a null buffer, so skip memcmp. */
+            if (existing.len == value.len &&
+                (value.len == 0 ||
+                 memcmp(existing.buffer, value.buffer, value.len) == 0)) {
+                indices[row] = (uint32_t) index;
+                break;
+            }
+            slot = (slot + 1) & (table_size - 1);
+        }
+    }
+    jaeger_free(table);
+    return unique;
+}
+
+static bool put_lengths(jaeger_buffer* block,
+                        const jaeger_string_column* column,
+                        const size_t* rows,
+                        size_t count)
+{
+    size_t* lengths;
+    size_t i;
+    bool result;
+    lengths = (size_t*) jaeger_column_resize(NULL, sizeof(*lengths), count);
+    if (lengths == NULL) {
+        return false;
+    }
+    for (i = 0; i < count; ++i) {
+        const size_t row = (rows == NULL) ? i : rows[i];
+        lengths[i] = column->offsets[row + 1] - column->offsets[row];
+    }
+    result = jaeger_block_put_ints(
+        block, lengths, sizeof(*lengths), false, count);
+    jaeger_free(lengths);
+    return result;
+}
+
+bool jaeger_block_put_strings(jaeger_buffer* block,
+                              const jaeger_string_column* column,
+                              size_t count)
+{
+    uint32_t* indices;
+    size_t* first_rows;
+    size_t unique = 0;
+    bool result = false;
+    size_t i;
+
+    if (count == 0) {
+        return true;
+    }
+    indices = (uint32_t*) jaeger_column_resize(NULL, sizeof(*indices), count);
+    first_rows =
+        (size_t*) jaeger_column_resize(NULL, sizeof(*first_rows), count);
+    if (indices != NULL && first_rows != NULL && count <= UINT32_MAX) {
+        unique =
+            build_dictionary(column, count, count / 2, indices, first_rows);
+    }
+
+    if (unique == 0) {
+        result = jaeger_buffer_append_varint(block, STRINGS_PLAIN) &&
+                 put_lengths(block, column, NULL, count) &&
+                 jaeger_block_put_raw(
+                     block, column->blob, column->offsets[count]);
+    }
+    else if (jaeger_buffer_append_varint(block, STRINGS_DICTIONARY) &&
+             jaeger_block_put_size(block, unique) &&
+             put_lengths(block, column, first_rows, unique)) {
+        result = true;
+        for (i = 0; i < unique && result; ++i) {
+            const jaeger_string value =
+                jaeger_string_column_get(column, first_rows[i]);
+            result = jaeger_block_put_raw(block, value.buffer, value.len);
+        }
+        result = result && jaeger_block_put_ints(
+                               block, indices, sizeof(*indices), false, count);
+    }
+
+    jaeger_free(indices);
+    jaeger_free(first_rows);
+    return result;
+}
+
+/* Turns lengths[1..count] into offsets, checking they fit in limit bytes. */
+static bool lengths_to_offsets(size_t* offsets, size_t count, size_t limit)
+{
+    size_t i;
+    offsets[0] = 0;
+    for (i = 0; i < count; ++i) {
+        if (offsets[i + 1] > limit - offsets[i]) {
+            return false;
+        }
+        offsets[i + 1] += offsets[i];
+    }
+    return true;
+}
+
+static bool reserve_blob(jaeger_string_column* column, size_t size)
+{
+    char* blob;
+    if (size <= column->blob_capacity) {
+        return true;
+    }
+    blob = (char*) jaeger_realloc(column->blob, size);
+    if (blob == NULL) {
+        return false;
+    }
+    column->blob = blob;
+    column->blob_capacity = size;
+    return true;
+}
+
+static bool get_dictionary_strings(jaeger_block_reader* reader,
+                                   jaeger_string_column* column,
+                                   size_t count)
+{
+    size_t unique;
+    size_t* dictionary = NULL;
+    uint32_t* indices = NULL;
+    const char* blob;
+    bool result = false;
+    size_t i;
+
+    if (!jaeger_block_get_size(reader, &unique) || unique == 0 ||
+        unique > count) {
+        return false;
+    }
+    dictionary =
+        (size_t*) jaeger_column_resize(NULL, sizeof(*dictionary), unique + 1);
+    indices = (uint32_t*) jaeger_column_resize(NULL, sizeof(*indices), count);
+    if (dictionary == NULL || indices == NULL ||
+        !jaeger_block_get_ints(
+            reader, dictionary + 1, sizeof(*dictionary), false, unique) ||
+        !lengths_to_offsets(
+            dictionary, unique, (size_t)(reader->end - reader->pos))) {
+        goto cleanup;
+    }
+    blob = (const char*) reader->pos;
+    reader->pos += dictionary[unique];
+    if (!jaeger_block_get_ints(
+            reader, indices, sizeof(*indices), false, count)) {
+        goto cleanup;
+    }
+
+    column->offsets[0] = 0;
+    for (i = 0; i < count; ++i) {
+        const size_t index = indices[i];
+        size_t length;
+        if (index >= unique) {
+            goto cleanup;
+        }
+        length = dictionary[index + 1] - dictionary[index];
+        if (length > SIZE_MAX - column->offsets[i]) {
+            goto cleanup;
+        }
+        column->offsets[i + 1] = column->offsets[i] + length;
+    }
+    if (!reserve_blob(column, column->offsets[count])) {
+        goto cleanup;
+    }
+    for (i = 0; i < count; ++i) {
+        const size_t index = indices[i];
+        memcpy(column->blob + column->offsets[i],
+               blob + dictionary[index],
+               dictionary[index + 1] - dictionary[index]);
+    }
+    result = true;
+
+cleanup:
+    jaeger_free(dictionary);
+    jaeger_free(indices);
+    return result;
+}
+
+bool jaeger_block_get_strings(jaeger_block_reader* reader,
+                              jaeger_string_column* column,
+                              size_t count)
+{
+    uint64_t mode;
+
+    if (count == 0) {
+        return true;
+    }
+    if (!jaeger_varint_read(&reader->pos, reader->end, &mode)) {
+        return false;
+    }
+    if (mode == STRINGS_DICTIONARY) {
+        return get_dictionary_strings(reader, column, count);
+    }
+    if (mode != STRINGS_PLAIN ||
+        !jaeger_block_get_ints(reader,
+                               column->offsets + 1,
+                               sizeof(*column->offsets),
+                               false,
+                               count) ||
+        !lengths_to_offsets(column->offsets,
+                            count,
+                            (size_t)(reader->end - reader->pos)) ||
+        !reserve_blob(column, column->offsets[count])) {
+        return false;
+    }
+    return jaeger_block_get_raw(reader, column->blob, column->offsets[count]);
+}
+
+bool jaeger_block_check_offsets(const size_t* offsets, size_t rows)
+{
+    size_t i;
+    if (offsets[0] != 0) {
+        return false;
+    }
+    for (i = 0; i < rows; ++i) {
+        if (offsets[i + 1] < offsets[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool jaeger_block_compress(const jaeger_buffer* block, jaeger_buffer* out)
+{
+    const size_t bound = jaeger_lz_bound(block->size);
+    size_t size;
+    if (!jaeger_buffer_append_varint(out, block->size) ||
+        !jaeger_buffer_reserve(out, bound)) {
+        return false;
+    }
+    size = jaeger_lz_compress(
+        block->data, block->size, out->data + out->size, bound);
+    if (size == 0) {
+        return false;
+    }
+    out->size += size;
+    return true;
+}
+
+bool jaeger_block_decompress(const void* data,
+                             size_t size,
+                             jaeger_buffer* block)
+{
+    jaeger_block_reader reader;
+    size_t raw_size;
+    reader.pos = (const uint8_t*) data;
+    reader.end = reader.pos + size;
+    if (!jaeger_block_get_size(&reader, &raw_size)) {
+        return false;
+    }
+    size = (size_t)(reader.end - reader.pos);
+    /* Each compressed byte expands to at most 255 bytes. */
+    if (raw_size / 255 > size) {
+        return false;
+    }
+    block->size = 0;
+    if (!jaeger_buffer_reserve(block, raw_size) ||
+        !jaeger_lz_decompress(reader.pos, size, block->data, raw_size)) {
+        return false;
+    }
+    block->size = raw_size;
+    return true;
+}
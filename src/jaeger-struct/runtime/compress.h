@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_RUNTIME_COMPRESS_H
+#define JAEGER_STRUCT_RUNTIME_COMPRESS_H
+
+#include <jaeger-struct/runtime/buffer.h>
+#include <jaeger-struct/runtime/column.h>
+#include <jaeger-struct/runtime/common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Column-aware compression for columnar batches. Columns are first written
+ * to a block with codecs exploiting their redundancy, then the whole block is
+ * compressed with the LZ codec.
+ *
+ * Integer columns pick the smallest of plain varints, delta or
+ * delta-of-delta varints (monotonic timestamps, offsets, sequential IDs) and
+ * fixed width (random IDs). String columns use a per-block dictionary when
+ * values repeat.
+ */
+
+typedef struct jaeger_block_reader {
+    const uint8_t* pos;
+    const uint8_t* end;
+} jaeger_block_reader;
+
+bool jaeger_block_put_size(jaeger_buffer* block, size_t size);
+
+bool jaeger_block_get_size(jaeger_block_reader* reader, size_t* size);
+
+/*
+ * Writes count integers of elem_size bytes each (1, 2, 4 or 8), sign extended
+ * if is_signed.
+ */
+bool jaeger_block_put_ints(jaeger_buffer* block,
+                           const void* values,
+                           size_t elem_size,
+                           bool is_signed,
+                           size_t count);
+
+bool jaeger_block_get_ints(jaeger_block_reader* reader,
+                           void* values,
+                           size_t elem_size,
+                           bool is_signed,
+                           size_t count);
+
+bool jaeger_block_put_raw(jaeger_buffer* block, const void* data, size_t size);
+
+bool jaeger_block_get_raw(jaeger_block_reader* reader, void* data, size_t size);
+
+/* Writes the first count rows of column. */
+bool jaeger_block_put_strings(jaeger_buffer* block,
+                              const jaeger_string_column* column,
+                              size_t count);
+
+/* Reads count rows into column, which must have room for count rows. */
+bool jaeger_block_get_strings(jaeger_block_reader* reader,
+                              jaeger_string_column* column,
+                              size_t count);
+
+/* Checks offsets[0..rows] starts at zero and never decreases. */
+bool jaeger_block_check_offsets(const size_t* offsets, size_t rows);
+
+/* Appends the LZ-compressed block to out. */
+bool jaeger_block_compress(const jaeger_buffer* block, jaeger_buffer* out);
+
+/* Replaces the contents of block with the decompressed data. */
+bool jaeger_block_decompress(const void* data,
+                             size_t size,
+                             jaeger_buffer* block);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* JAEGER_STRUCT_RUNTIME_COMPRESS_H */
@@ -0,0 +1,339 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <jaeger-struct/runtime/encoder.h>
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <jaeger-struct/runtime/varint.h>
+
+#define CACHE_LINE_SIZE 64
+
+/*
+ * The unclaimed elements of a worker, with the first index in the low half
+ * and the end in the high half, so that the owner taking from the front and
+ * thieves taking from the back agree with a single compare and swap.
+ */
+typedef _Atomic uint64_t element_range;
+
+struct jaeger_encoder_worker {
+    _Alignas(CACHE_LINE_SIZE) element_range range;
+    jaeger_encoder* encoder;
+    size_t index;
+    pthread_t thread;
+    jaeger_buffer buffer;
+    bool failed;
+};
+
+typedef struct jaeger_encoder_worker worker;
+
+static uint64_t make_range(uint32_t first, uint32_t end)
+{
+    return ((uint64_t) end << 32) | first;
+}
+
+static bool take(worker* self, uint32_t* index)
+{
+    uint64_t range = atomic_load_explicit(&self->range, memory_order_relaxed);
+    for (;;) {
+        const uint32_t first = (uint32_t) range;
+        const uint32_t end = (uint32_t) (range >> 32);
+        if (first >= end) {
+            return false;
+        }
+        if (atomic_compare_exchange_weak_explicit(&self->range,
+                                                  &range,
+                                                  make_range(first + 1, end),
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+            *index = first;
+            return true;
+        }
+    }
+}
+
+/* Moves the back half of the range of some other worker to self. */
+static bool steal(worker* self)
+{
+    jaeger_encoder* encoder = self->encoder;
+    size_t i;
+    for (i = 1; i < encoder->num_threads; ++i) {
+        worker* victim =
+            &encoder->workers[(self->index + i) % encoder->num_threads];
+        uint64_t range =
+            atomic_load_explicit(&victim->range, memory_order_relaxed);
+        for (;;) {
+            const uint32_t first = (uint32_t) range;
+            const uint32_t end = (uint32_t) (range >> 32);
+            const uint32_t half = (end - first + 1) / 2;
+            if (first >= end) {
+                break;
+            }
+            if (atomic_compare_exchange_weak_explicit(
+                    &victim->range,
+                    &range,
+                    make_range(first, end - half),
+                    memory_order_relaxed,
+                    memory_order_relaxed)) {
+                atomic_store_explicit(&self->range,
+                                      make_range(end - half, end),
+                                      memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static void run(worker* self)
+{
+    jaeger_encoder* encoder = self->encoder;
+    const jaeger_field_table* field = encoder->field;
+    uint32_t index;
+    do {
+        while (take(self, &index)) {
+            jaeger_encoder_result* result = &encoder->results[index];
+            result->worker = self->index;
+            result->offset = self->buffer.size;
+            if (!jaeger_encode(
+                    (const jaeger_message_table*) field->table,
+                    (const uint8_t*) encoder->elements[index] +
+                        field->node_offset,
+                    &self->buffer)) {
+                self->failed = true;
+            }
+            result->size = self->buffer.size - result->offset;
+        }
+    } while (steal(self));
+}
+
+static void* worker_main(void* arg)
+{
+    worker* self = (worker*) arg;
+    jaeger_encoder* encoder = self->encoder;
+    uint64_t generation = 0;
+    pthread_mutex_lock(&encoder->mutex);
+    for (;;) {
+        while (!encoder->stopping && encoder->generation == generation) {
+            pthread_cond_wait(&encoder->start, &encoder->mutex);
+        }
+        if (encoder->stopping) {
+            break;
+        }
+        generation = encoder->generation;
+        pthread_mutex_unlock(&encoder->mutex);
+        run(self);
+        pthread_mutex_lock(&encoder->mutex);
+        if (--encoder->running == 0) {
+            pthread_cond_signal(&encoder->done);
+        }
+    }
+    pthread_mutex_unlock(&encoder->mutex);
+    return NULL;
+}
+
+bool jaeger_encoder_init(jaeger_encoder* encoder, size_t num_threads)
+{
+    size_t i;
+    memset(encoder, 0, sizeof(*encoder));
+    if (num_threads == 0) {
+        return false;
+    }
+    /* Not jaeger_malloc, which does not align to cache lines. */
+    encoder->workers =
+        (worker*) aligned_alloc(CACHE_LINE_SIZE, num_threads * sizeof(worker));
+    if (encoder->workers == NULL) {
+        return false;
+    }
+    memset(encoder->workers, 0, num_threads * sizeof(worker));
+    encoder->num_threads = num_threads;
+    pthread_mutex_init(&encoder->mutex, NULL);
+    pthread_cond_init(&encoder->start, NULL);
+    pthread_cond_init(&encoder->done, NULL);
+    for (i = 0; i < num_threads; ++i) {
+        encoder->workers[i].encoder = encoder;
+        encoder->workers[i].index = i;
+    }
+    for (i = 1; i < num_threads; ++i) {
+        if (pthread_create(&encoder->workers[i].thread,
+                           NULL,
+                           worker_main,
+                           &encoder->workers[i]) != 0) {
+            jaeger_encoder_destroy(encoder);
+            return false;
+        }
+        encoder->num_started = i;
+    }
+    return true;
+}
+
+static bool reserve_elements(jaeger_encoder* encoder, size_t count)
+{
+    const jaeger_list** elements;
+    jaeger_encoder_result* results;
+    if (count <= encoder->element_capacity) {
+        return true;
+    }
+    elements = (const jaeger_list**) jaeger_realloc(
+        (void*) encoder->elements, count * sizeof(*elements));
+    if (elements == NULL) {
+        return false;
+    }
+    encoder->elements = elements;
+    results = (jaeger_encoder_result*) jaeger_realloc(
+        encoder->results, count * sizeof(*results));
+    if (results == NULL) {
+        return false;
+    }
+    encoder->results = results;
+    encoder->element_capacity = count;
+    return true;
+}
+
+/* Encodes the elements of list in parallel and appends them to out. */
+static bool encode_elements(jaeger_encoder* encoder,
+                            const jaeger_field_table* field,
+                            const jaeger_list* list,
+                            size_t count,
+                            jaeger_buffer* out)
+{
+    const uint64_t tag = ((uint64_t) field->number << 3) | JAEGER_WIRE_LENGTH;
+    const jaeger_list* node;
+    size_t i = 0;
+    size_t total = 0;
+    bool failed = false;
+    if (!reserve_elements(encoder, count)) {
+        return false;
+    }
+    JAEGER_LIST_FOR_EACH(list, node) {
+        encoder->elements[i++] = node;
+    }
+    for (i = 0; i < encoder->num_threads; ++i) {
+        worker* w = &encoder->workers[i];
+        w->buffer.size = 0;
+        w->failed = false;
+        atomic_store_explicit(
+            &w->range,
+            make_range((uint32_t) (count * i / encoder->num_threads),
+                       (uint32_t) (count * (i + 1) / encoder->num_threads)),
+            memory_order_relaxed);
+    }
+
+    pthread_mutex_lock(&encoder->mutex);
+    encoder->field = field;
+    encoder->running = encoder->num_threads - 1;
+    ++encoder->generation;
+    pthread_cond_broadcast(&encoder->start);
+    pthread_mutex_unlock(&encoder->mutex);
+    run(&encoder->workers[0]);
+    pthread_mutex_lock(&encoder->mutex);
+    while (encoder->running > 0) {
+        pthread_cond_wait(&encoder->done, &encoder->mutex);
+    }
+    pthread_mutex_unlock(&encoder->mutex);
+
+    for (i = 0; i < encoder->num_threads; ++i) {
+        failed = failed || encoder->workers[i].failed;
+    }
+    if (failed) {
+        return false;
+    }
+    for (i = 0; i < count; ++i) {
+        total += jaeger_varint_size(tag) +
+                 jaeger_varint_size(encoder->results[i].size) +
+                 encoder->results[i].size;
+    }
+    if (!jaeger_buffer_reserve(out, total)) {
+        return false;
+    }
+    for (i = 0; i < count; ++i) {
+        const jaeger_encoder_result* result = &encoder->results[i];
+        if (!jaeger_buffer_append_varint(out, tag) ||
+            !jaeger_buffer_append_varint(out, result->size) ||
+            !jaeger_buffer_append(
+                out,
+                encoder->workers[result->worker].buffer.data + result->offset,
+                result->size)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool jaeger_encoder_encode(jaeger_encoder* encoder,
+                           const jaeger_message_table* table,
+                           const void* message,
+                           uint32_t field_number,
+                           jaeger_buffer* out)
+{
+    const size_t size = out->size;
+    const jaeger_field_table* field = NULL;
+    const jaeger_list* list;
+    size_t count;
+    size_t i;
+    for (i = 0; i < table->field_count; ++i) {
+        if (table->fields[i].number == field_number) {
+            field = &table->fields[i];
+            break;
+        }
+    }
+    if (field == NULL || !field->repeated ||
+        field->type != JAEGER_TYPE_MESSAGE) {
+        return false;
+    }
+    list = (const jaeger_list*) ((const uint8_t*) message + field->offset);
+    count = jaeger_list_size(list);
+    if (encoder->num_threads == 1 ||
+        count < JAEGER_ENCODER_MIN_PARALLEL_ELEMENTS || count > UINT32_MAX) {
+        return jaeger_encode(table, message, out);
+    }
+    if (!jaeger_encode_fields(table, message, 0, i, out) ||
+        !encode_elements(encoder, field, list, count, out) ||
+        !jaeger_encode_fields(table, message, i + 1, table->field_count, out)) {
+        out->size = size;
+        return false;
+    }
+    return true;
+}
+
+void jaeger_encoder_destroy(jaeger_encoder* encoder)
+{
+    size_t i;
+    if (encoder->workers == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&encoder->mutex);
+    encoder->stopping = true;
+    pthread_cond_broadcast(&encoder->start);
+    pthread_mutex_unlock(&encoder->mutex);
+    for (i = 1; i <= encoder->num_started; ++i) {
+        pthread_join(encoder->workers[i].thread, NULL);
+    }
+    for (i = 0; i < encoder->num_threads; ++i) {
+        jaeger_buffer_destroy(&encoder->workers[i].buffer);
+    }
+    pthread_mutex_destroy(&encoder->mutex);
+    pthread_cond_destroy(&encoder->start);
+    pthread_cond_destroy(&encoder->done);
+    free(encoder->workers);
+    jaeger_free((void*) encoder->elements);
+    jaeger_free(encoder->results);
+    memset(encoder, 0, sizeof(*encoder));
+}
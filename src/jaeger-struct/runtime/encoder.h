@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_RUNTIME_ENCODER_H
+#define JAEGER_STRUCT_RUNTIME_ENCODER_H
+
+#include <pthread.h>
+
+#include <jaeger-struct/runtime/codec.h>
+#include <jaeger-struct/runtime/list.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Parallel encoder for messages dominated by one repeated message field, like
+ * the spans of a Batch. The elements are dealt out to num_threads workers,
+ * the calling thread being the first, as contiguous index ranges. A worker
+ * that runs out steals half of the remaining range of another, so uneven
+ * elements still keep every worker busy. Each worker encodes into its own
+ * buffer, and the caller then copies the elements into the output in order
+ * with their tags and length prefixes. The output is byte for byte what
+ * jaeger_encode produces.
+ *
+ * An encoder serves one encode call at a time.
+ */
+
+/* Messages with fewer elements are encoded by the caller alone. */
+enum { JAEGER_ENCODER_MIN_PARALLEL_ELEMENTS = 64 };
+
+struct jaeger_encoder_worker;
+
+typedef struct jaeger_encoder_result {
+    size_t worker;
+    size_t offset;
+    size_t size;
+} jaeger_encoder_result;
+
+typedef struct jaeger_encoder {
+    size_t num_threads;
+    /* Private. */
+    struct jaeger_encoder_worker* workers;
+    size_t num_started;
+    pthread_mutex_t mutex;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    uint64_t generation;
+    size_t running;
+    bool stopping;
+    const jaeger_field_table* field;
+    const jaeger_list** elements;
+    jaeger_encoder_result* results;
+    size_t element_capacity;
+} jaeger_encoder;
+
+/* Starts num_threads - 1 worker threads. */
+bool jaeger_encoder_init(jaeger_encoder* encoder, size_t num_threads);
+
+/*
+ * Appends the encoding of message to out like jaeger_encode, encoding the
+ * elements of its repeated message field field_number in parallel.
+ */
+bool jaeger_encoder_encode(jaeger_encoder* encoder,
+                           const jaeger_message_table* table,
+                           const void* message,
+                           uint32_t field_number,
+                           jaeger_buffer* out);
+
+/* Stops the worker threads. */
+void jaeger_encoder_destroy(jaeger_encoder* encoder);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* JAEGER_STRUCT_RUNTIME_ENCODER_H */
@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _GNU_SOURCE
+
+#include <jaeger-struct/runtime/iov.h>
+
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <jaeger-struct/runtime/varint.h>
+
+#define CHUNK_SIZE 4096
+
+/* iovecs passed to one writev call. */
+#define WRITE_BATCH 256
+
+struct jaeger_iov_chunk {
+    struct jaeger_iov_chunk* next;
+    size_t size;
+    size_t capacity;
+    uint8_t* data;
+};
+
+typedef struct jaeger_iov_chunk chunk;
+
+void jaeger_iov_buffer_init(jaeger_iov_buffer* buffer, size_t threshold)
+{
+    memset(buffer, 0, sizeof(*buffer));
+    buffer->threshold = threshold;
+}
+
+static bool push(jaeger_iov_buffer* buffer, const void* data, size_t size)
+{
+    struct iovec* iov;
+    size_t capacity;
+    if (buffer->count == buffer->capacity) {
+        capacity = buffer->capacity < 16 ? 16 : buffer->capacity * 2;
+        iov = (struct iovec*) jaeger_realloc(buffer->iov,
+                                             capacity * sizeof(*iov));
+        if (iov == NULL) {
+            return false;
+        }
+        buffer->iov = iov;
+        buffer->capacity = capacity;
+    }
+    iov = &buffer->iov[buffer->count++];
+    iov->iov_base = (void*) data;
+    iov->iov_len = size;
+    buffer->size += size;
+    return true;
+}
+
+/*
+ * Returns size bytes of scratch space in the current chunk, moving on to the
+ * next chunk or allocating one if it is full.
+ */
+static uint8_t* scratch(jaeger_iov_buffer* buffer, size_t size)
+{
+    chunk* current = buffer->chunk;
+    chunk* next;
+    size_t capacity;
+    if (current != NULL && size <= current->capacity - current->size) {
+        return current->data + current->size;
+    }
+    next = (current == NULL) ? buffer->chunks : current->next;
+    if (next == NULL || next->capacity < size) {
+        capacity = size < CHUNK_SIZE ? CHUNK_SIZE : size;
+        next = (chunk*) jaeger_malloc(sizeof(chunk) + capacity);
+        if (next == NULL) {
+            return NULL;
+        }
+        next->capacity = capacity;
+        next->data = (uint8_t*) (next + 1);
+        if (current == NULL) {
+            next->next = buffer->chunks;
+            buffer->chunks = next;
+        }
+        else {
+            next->next = current->next;
+            current->next = next;
+        }
+    }
+    next->size = 0;
+    buffer->chunk = next;
+    return next->data;
+}
+
+/* Records size bytes just written to scratch as output. */
+static bool commit(jaeger_iov_buffer* buffer, uint8_t* data, size_t size)
+{
+    struct iovec* last;
+    buffer->chunk->size += size;
+    if (buffer->count > 0) {
+        last = &buffer->iov[buffer->count - 1];
+        if ((uint8_t*) last->iov_base + last->iov_len == data) {
+            last->iov_len += size;
+            buffer->size += size;
+            return true;
+        }
+    }
+    return push(buffer, data, size);
+}
+
+bool jaeger_iov_buffer_append(jaeger_iov_buffer* buffer,
+                              const void* data,
+                              size_t size)
+{
+    if (size >= buffer->threshold && size > 0) {
+        return push(buffer, data, size);
+    }
+    return jaeger_iov_buffer_copy(buffer, data, size);
+}
+
+bool jaeger_iov_buffer_copy(jaeger_iov_buffer* buffer,
+                            const void* data,
+                            size_t size)
+{
+    uint8_t* dest;
+    if (size == 0) {
+        return true;
+    }
+    dest = scratch(buffer, size);
+    if (dest == NULL) {
+        return false;
+    }
+    memcpy(dest, data, size);
+    return commit(buffer, dest, size);
+}
+
+bool jaeger_iov_buffer_append_varint(jaeger_iov_buffer* buffer,
+                                     uint64_t value)
+{
+    uint8_t* dest = scratch(buffer, JAEGER_VARINT_MAX_SIZE);
+    if (dest == NULL) {
+        return false;
+    }
+    return commit(buffer, dest, jaeger_varint_write(dest, value) - dest);
+}
+
+void jaeger_iov_buffer_reset(jaeger_iov_buffer* buffer)
+{
+    buffer->count = 0;
+    buffer->size = 0;
+    buffer->chunk = buffer->chunks;
+    if (buffer->chunk != NULL) {
+        buffer->chunk->size = 0;
+    }
+}
+
+void jaeger_iov_buffer_truncate(jaeger_iov_buffer* buffer,
+                                size_t count,
+                                size_t size)
+{
+    size_t total = 0;
+    size_t i;
+    /* The scratch space of the dropped bytes stays used until reset. */
+    buffer->count = count;
+    buffer->size = size;
+    for (i = 0; i < count; ++i) {
+        total += buffer->iov[i].iov_len;
+    }
+    /* Undo copies coalesced into the last iovec kept. */
+    if (total > size) {
+        buffer->iov[count - 1].iov_len -= total - size;
+    }
+}
+
+bool jaeger_iov_buffer_write(const jaeger_iov_buffer* buffer, int fd)
+{
+    struct iovec batch[WRITE_BATCH];
+    size_t index = 0;
+    size_t offset = 0;
+    while (index < buffer->count) {
+        size_t count = buffer->count - index;
+        ssize_t result;
+        if (count > WRITE_BATCH) {
+            count = WRITE_BATCH;
+        }
+        memcpy(batch, buffer->iov + index, count * sizeof(*batch));
+        batch[0].iov_base = (uint8_t*) batch[0].iov_base + offset;
+        batch[0].iov_len -= offset;
+        result = writev(fd, batch, (int) count);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        offset += (size_t) result;
+        while (index < buffer->count &&
+               offset >= buffer->iov[index].iov_len) {
+            offset -= buffer->iov[index].iov_len;
+            ++index;
+        }
+    }
+    return true;
+}
+
+bool jaeger_iov_buffer_send(const jaeger_iov_buffer* buffer,
+                            int fd,
+                            int flags)
+{
+    struct msghdr message;
+    ssize_t result;
+    if (buffer->count > IOV_MAX) {
+        return false;
+    }
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = buffer->iov;
+    message.msg_iovlen = buffer->count;
+    do {
+        result = sendmsg(fd, &message, flags);
+    } while (result < 0 && errno == EINTR);
+    return result >= 0 && (size_t) result == buffer->size;
+}
+
+void jaeger_iov_buffer_destroy(jaeger_iov_buffer* buffer)
+{
+    chunk* next;
+    while (buffer->chunks != NULL) {
+        next = buffer->chunks->next;
+        jaeger_free(buffer->chunks);
+        buffer->chunks = next;
+    }
+    jaeger_free(buffer->iov);
+    jaeger_free(buffer->sizes);
+    memset(buffer, 0, sizeof(*buffer));
+}
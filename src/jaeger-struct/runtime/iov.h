@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_RUNTIME_IOV_H
+#define JAEGER_STRUCT_RUNTIME_IOV_H
+
+#include <sys/uio.h>
+
+#include <jaeger-struct/runtime/common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Scatter-gather output as an iovec list. Small pieces are copied into
+ * scratch chunks, with consecutive copies coalesced into one iovec, while
+ * pieces of at least threshold bytes are referenced in place and must
+ * outlive the iovecs. Scratch chunks never move once allocated, and are kept
+ * by reset for the next message.
+ */
+
+enum { JAEGER_IOV_DEFAULT_THRESHOLD = 512 };
+
+struct jaeger_iov_chunk;
+
+typedef struct jaeger_iov_buffer {
+    struct iovec* iov;
+    size_t count;
+    /* Total bytes referenced by iov. */
+    size_t size;
+    size_t threshold;
+    /* Private. */
+    size_t capacity;
+    struct jaeger_iov_chunk* chunks;
+    struct jaeger_iov_chunk* chunk;
+    /* Submessage sizes recorded by jaeger_encode_iov. */
+    size_t* sizes;
+    size_t sizes_capacity;
+} jaeger_iov_buffer;
+
+void jaeger_iov_buffer_init(jaeger_iov_buffer* buffer, size_t threshold);
+
+/* Copies data, or references it if size is at least the threshold. */
+bool jaeger_iov_buffer_append(jaeger_iov_buffer* buffer,
+                              const void* data,
+                              size_t size);
+
+/* Copies data whatever its size. */
+bool jaeger_iov_buffer_copy(jaeger_iov_buffer* buffer,
+                            const void* data,
+                            size_t size);
+
+bool jaeger_iov_buffer_append_varint(jaeger_iov_buffer* buffer,
+                                     uint64_t value);
+
+/* Drops the output and keeps the scratch chunks. */
+void jaeger_iov_buffer_reset(jaeger_iov_buffer* buffer);
+
+/*
+ * Truncates the output to its first count iovecs holding size bytes, as
+ * recorded before a failed append.
+ */
+void jaeger_iov_buffer_truncate(jaeger_iov_buffer* buffer,
+                                size_t count,
+                                size_t size);
+
+/* Writes the whole output to fd with writev, resuming short writes. */
+bool jaeger_iov_buffer_write(const jaeger_iov_buffer* buffer, int fd);
+
+/*
+ * Sends the output as one message with sendmsg, for example a datagram on a
+ * connected socket. Fails if it is not sent whole.
+ */
+bool jaeger_iov_buffer_send(const jaeger_iov_buffer* buffer,
+                            int fd,
+                            int flags);
+
+void jaeger_iov_buffer_destroy(jaeger_iov_buffer* buffer);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* JAEGER_STRUCT_RUNTIME_IOV_H */
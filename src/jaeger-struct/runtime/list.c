@@ -15,3 +15,71 @@
  */
 
 #include <jaeger-struct/runtime/list.h>
+
+#include <jaeger-struct/runtime/stats.h>
+
+void jaeger_list_append(jaeger_list* list, jaeger_list* node)
+{
+    JAEGER_STATS_ADD(JAEGER_STATS_LIST_NODES, 1);
+    node->next = NULL;
+    node->prev = list->prev;
+    if (list->prev == NULL) {
+        list->next = node;
+    }
+    else {
+        list->prev->next = node;
+    }
+    list->prev = node;
+}
+
+void jaeger_list_splice(jaeger_list* list, jaeger_list* from, jaeger_list* last)
+{
+    jaeger_list* first = from->next;
+    jaeger_list* rest = last->next;
+    from->next = rest;
+    if (rest == NULL) {
+        from->prev = NULL;
+    }
+    else {
+        rest->prev = NULL;
+    }
+    first->prev = list->prev;
+    if (list->prev == NULL) {
+        list->next = first;
+    }
+    else {
+        list->prev->next = first;
+    }
+    last->next = NULL;
+    list->prev = last;
+}
+
+size_t jaeger_list_size(const jaeger_list* list)
+{
+    size_t size = 0;
+    const jaeger_list* node;
+    JAEGER_LIST_FOR_EACH(list, node) {
+        ++size;
+    }
+    return size;
+}
+
+jaeger_list*
+jaeger_list_inline_take(void* storage, size_t node_size, size_t capacity)
+{
+    size_t* size = jaeger_list_inline_size(storage, node_size, capacity);
+    if (*size == capacity) {
+        return NULL;
+    }
+    return (jaeger_list*) ((char*) storage + node_size * (*size)++);
+}
+
+bool jaeger_list_inline_owns(const void* storage,
+                             size_t node_size,
+                             size_t capacity,
+                             const jaeger_list* node)
+{
+    const char* begin = (const char*) storage;
+    const char* ptr = (const char*) node;
+    return ptr >= begin && ptr < begin + node_size * capacity;
+}
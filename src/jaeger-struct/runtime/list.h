@@ -23,6 +23,11 @@
 extern "C" {
 #endif /* __cplusplus */
 
+/*
+ * Intrusive doubly linked list. A list head is zero-initializable: next points
+ * to the first node and prev to the last, both NULL when the list is empty.
+ * Nodes are NULL-terminated in both directions.
+ */
 typedef struct jaeger_list {
     struct jaeger_list* next;
     struct jaeger_list* prev;
@@ -34,6 +39,60 @@ typedef struct jaeger_list {
         type value;                                                            \
     }
 
+#define JAEGER_LIST_NODE_VALUE(type, node) (&((JAEGER_LIST(type)*) (node))->value)
+
+#define JAEGER_LIST_FOR_EACH(list, node)                                       \
+    for ((node) = (list)->next; (node) != NULL; (node) = (node)->next)
+
+/*
+ * Storage for the first capacity nodes of a list inside the struct holding
+ * the list, so that short lists allocate nothing, followed by the number of
+ * them in use, always the first ones. Zero-initializable. Inline nodes are
+ * linked like any other, so iterating the list is unchanged.
+ */
+#define JAEGER_LIST_INLINE(type, capacity)                                     \
+    struct {                                                                   \
+        JAEGER_LIST(type) nodes[capacity];                                     \
+        size_t size;                                                           \
+    }
+
+/* The size of storage, a JAEGER_LIST_INLINE of capacity nodes. */
+static inline size_t*
+jaeger_list_inline_size(void* storage, size_t node_size, size_t capacity)
+{
+    return (size_t*) ((char*) storage + node_size * capacity);
+}
+
+static inline bool jaeger_list_empty(const jaeger_list* list)
+{
+    return list->next == NULL;
+}
+
+void jaeger_list_append(jaeger_list* list, jaeger_list* node);
+
+/*
+ * Moves the nodes of from up to and including last, which must be one of
+ * them, to the end of list in constant time.
+ */
+void jaeger_list_splice(jaeger_list* list, jaeger_list* from, jaeger_list* last);
+
+size_t jaeger_list_size(const jaeger_list* list);
+
+/*
+ * Takes the next unused node of storage, a JAEGER_LIST_INLINE of capacity
+ * nodes of node_size bytes, or returns NULL if all are in use. The value of
+ * the node is left zeroed or as cleared after its previous use, keeping its
+ * buffers. The node still has to be appended to the list.
+ */
+jaeger_list*
+jaeger_list_inline_take(void* storage, size_t node_size, size_t capacity);
+
+/* Returns whether node is one of the nodes of storage. */
+bool jaeger_list_inline_owns(const void* storage,
+                             size_t node_size,
+                             size_t capacity,
+                             const jaeger_list* node);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
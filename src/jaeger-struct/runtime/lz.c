@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/lz.h>
+
+#include <string.h>
+
+enum {
+    HASH_LOG = 12,
+    MIN_MATCH = 4,
+    /* The last match must start at least this far from the end. */
+    MATCH_FIND_LIMIT = 12,
+    /* The last bytes of a block are always literals. */
+    LAST_LITERALS = 5,
+    MAX_OFFSET = 65535,
+    /* Skip ahead faster through incompressible data. */
+    SKIP_TRIGGER = 6
+};
+
+static inline uint32_t read32(const uint8_t* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline uint32_t hash32(uint32_t value)
+{
+    return (value * 2654435761u) >> (32 - HASH_LOG);
+}
+
+static uint8_t* write_length(uint8_t* op, const uint8_t* oend, size_t length)
+{
+    while (length >= 255) {
+        if (op == oend) {
+            return NULL;
+        }
+        *op++ = 255;
+        length -= 255;
+    }
+    if (op == oend) {
+        return NULL;
+    }
+    *op++ = (uint8_t) length;
+    return op;
+}
+
+static uint8_t* write_sequence(uint8_t* op,
+                               const uint8_t* oend,
+                               const uint8_t* literals,
+                               size_t literal_length,
+                               size_t offset,
+                               size_t match_length)
+{
+    uint8_t* token = op++;
+    if (token >= oend) {
+        return NULL;
+    }
+    *token = (uint8_t)((literal_length < 15 ? literal_length : 15) << 4);
+    if (literal_length >= 15) {
+        op = write_length(op, oend, literal_length - 15);
+        if (op == NULL) {
+            return NULL;
+        }
+    }
+    if ((size_t)(oend - op) < literal_length) {
+        return NULL;
+    }
+    memcpy(op, literals, literal_length);
+    op += literal_length;
+    if (match_length == 0) {
+        return op;
+    }
+    if (oend - op < 2) {
+        return NULL;
+    }
+    *op++ = (uint8_t) offset;
+    *op++ = (uint8_t)(offset >> 8);
+    match_length -= MIN_MATCH;
+    *token |= (uint8_t)(match_length < 15 ? match_length : 15);
+    if (match_length >= 15) {
+        op = write_length(op, oend, match_length - 15);
+    }
+    return op;
+}
+
+size_t jaeger_lz_compress(const void* src,
+                          size_t size,
+                          void* dst,
+                          size_t dst_capacity)
+{
+    uint32_t table[1 << HASH_LOG];
+    const uint8_t* const base = (const uint8_t*) src;
+    const uint8_t* const iend = base + size;
+    const uint8_t* ip = base;
+    const uint8_t* anchor = base;
+    uint8_t* op = (uint8_t*) dst;
+    uint8_t* const oend = op + dst_capacity;
+
+    if (size > MATCH_FIND_LIMIT) {
+        const uint8_t* const mflimit = iend - MATCH_FIND_LIMIT;
+        const uint8_t* const matchlimit = iend - LAST_LITERALS;
+        unsigned attempts = 1 << SKIP_TRIGGER;
+        memset(table, 0, sizeof(table));
+        ++ip;
+        while (ip < mflimit) {
+            const uint32_t h = hash32(read32(ip));
+            const uint8_t* ref = base + table[h];
+            const uint8_t* match_end;
+            table[h] = (uint32_t)(ip - base);
+            if (ref >= ip || ip - ref > MAX_OFFSET ||
+                read32(ref) != read32(ip)) {
+                ip += attempts++ >> SKIP_TRIGGER;
+                continue;
+            }
+            attempts = 1 << SKIP_TRIGGER;
+            while (ip > anchor && ref > base && ip[-1] == ref[-1]) {
+                --ip;
+                --ref;
+            }
+            match_end = ip + MIN_MATCH;
+            ref += MIN_MATCH;
+            while (match_end < matchlimit && *match_end == *ref) {
+                ++match_end;
+                ++ref;
+            }
+            op = write_sequence(op,
+                                oend,
+                                anchor,
+                                (size_t)(ip - anchor),
+                                (size_t)(match_end - ref),
+                                (size_t)(match_end - ip));
+            if (op == NULL) {
+                return 0;
+            }
+            ip = match_end;
+            anchor = ip;
+            if (ip < mflimit) {
+                table[hash32(read32(ip - 2))] = (uint32_t)(ip - 2 - base);
+            }
+        }
+    }
+
+    op = write_sequence(op, oend, anchor, (size_t)(iend - anchor), 0, 0);
+    if (op == NULL) {
+        return 0;
+    }
+    return (size_t)(op - (uint8_t*) dst);
+}
+
+static bool read_length(const uint8_t** ip, const uint8_t* iend, size_t* length)
+{
+    uint8_t byte;
+    do {
+        if (*ip == iend) {
+            return false;
+        }
+        byte = *(*ip)++;
+        *length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+bool jaeger_lz_decompress(const void* src,
+                          size_t size,
+                          void* dst,
+                          size_t dst_size)
+{
+    const uint8_t* ip = (const uint8_t*) src;
+    const uint8_t* const iend = ip + size;
+    uint8_t* op = (uint8_t*) dst;
+    uint8_t* const oend = op + dst_size;
+
+    while (ip < iend) {
+        const uint8_t token = *ip++;
+        size_t length = token >> 4;
+        size_t offset;
+        const uint8_t* ref;
+
+        if (length == 15 && !read_length(&ip, iend, &length)) {
+            return false;
+        }
+        if ((size_t)(iend - ip) < length || (size_t)(oend - op) < length) {
+            return false;
+        }
+        memcpy(op, ip, length);
+        ip += length;
+        op += length;
+        if (ip == iend) {
+            break;
+        }
+
+        if (iend - ip < 2) {
+            return false;
+        }
+        offset = (size_t) ip[0] | ((size_t) ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - (uint8_t*) dst)) {
+            return false;
+        }
+        length = token & 15;
+        if (length == 15 && !read_length(&ip, iend, &length)) {
+            return false;
+        }
+        length += MIN_MATCH;
+        if ((size_t)(oend - op) < length) {
+            return false;
+        }
+        ref = op - offset;
+        if (offset >= length) {
+            memcpy(op, ref, length);
+            op += length;
+        }
+        else {
+            while (length-- > 0) {
+                *op++ = *ref++;
+            }
+        }
+    }
+    return op == oend;
+}
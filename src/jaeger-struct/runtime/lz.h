@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_RUNTIME_LZ_H
+#define JAEGER_STRUCT_RUNTIME_LZ_H
+
+#include <jaeger-struct/runtime/common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Fast LZ77 block codec using the LZ4 block format: sequences of literals
+ * followed by a 16-bit back reference, with a greedy single-probe matcher.
+ */
+
+/* Worst case compressed size of size bytes. */
+static inline size_t jaeger_lz_bound(size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+/*
+ * Compresses size bytes of src into dst. Returns the compressed size, or 0 if
+ * dst_capacity is too small.
+ */
+size_t jaeger_lz_compress(const void* src,
+                          size_t size,
+                          void* dst,
+                          size_t dst_capacity);
+
+/*
+ * Decompresses a block of size bytes into exactly dst_size bytes at dst.
+ * Returns false if the block is malformed or does not expand to dst_size.
+ */
+bool jaeger_lz_decompress(const void* src,
+                          size_t size,
+                          void* dst,
+                          size_t dst_size);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* JAEGER_STRUCT_RUNTIME_LZ_H */
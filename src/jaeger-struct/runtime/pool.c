@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <jaeger-struct/runtime/pool.h>
+
+#include <string.h>
+
+#include <jaeger-struct/runtime/probe.h>
+#include <jaeger-struct/runtime/stats.h>
+
+typedef struct free_object {
+    struct free_object* next;
+} free_object;
+
+typedef struct pool_cache {
+    free_object* head;
+    size_t count;
+} pool_cache;
+
+static pthread_mutex_t registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+static jaeger_pool* pools[JAEGER_POOL_MAX_POOLS];
+static int pool_count;
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t key;
+static _Thread_local pool_cache caches[JAEGER_POOL_MAX_POOLS];
+static _Thread_local bool flush_scheduled;
+
+static void free_chain(const jaeger_pool* pool, free_object* head)
+{
+    while (head != NULL) {
+        free_object* next = head->next;
+        if (pool->destroy != NULL) {
+            head->next = NULL;
+            pool->destroy(head);
+        }
+        jaeger_free(head);
+        head = next;
+    }
+}
+
+/* Detaches the first JAEGER_POOL_BATCH objects of cache. */
+static free_object* take_batch(pool_cache* cache)
+{
+    free_object* batch = cache->head;
+    free_object* tail = batch;
+    size_t i;
+    for (i = 1; i < JAEGER_POOL_BATCH; ++i) {
+        tail = tail->next;
+    }
+    cache->head = tail->next;
+    cache->count -= JAEGER_POOL_BATCH;
+    tail->next = NULL;
+    return batch;
+}
+
+static void deposit(jaeger_pool* pool, free_object* batch)
+{
+    bool kept = false;
+    pthread_mutex_lock(&pool->mutex);
+    if (pool->batch_count < JAEGER_POOL_MAX_BATCHES) {
+        pool->batches[pool->batch_count++] = batch;
+        kept = true;
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    if (!kept) {
+        free_chain(pool, batch);
+    }
+}
+
+static free_object* withdraw(jaeger_pool* pool)
+{
+    free_object* batch = NULL;
+    pthread_mutex_lock(&pool->mutex);
+    if (pool->batch_count > 0) {
+        batch = (free_object*) pool->batches[--pool->batch_count];
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return batch;
+}
+
+/* Gives the objects cached by an exiting thread back to their pools. */
+static void flush_caches(void* arg)
+{
+    int count;
+    int i;
+    (void) arg;
+    flush_scheduled = false;
+    pthread_mutex_lock(&registry_mutex);
+    count = pool_count;
+    pthread_mutex_unlock(&registry_mutex);
+    for (i = 0; i < count; ++i) {
+        pool_cache* cache = &caches[i];
+        while (cache->count >= JAEGER_POOL_BATCH) {
+            deposit(pools[i], take_batch(cache));
+        }
+        free_chain(pools[i], cache->head);
+        cache->head = NULL;
+        cache->count = 0;
+    }
+}
+
+static void create_key(void)
+{
+    pthread_key_create(&key, flush_caches);
+}
+
+static int register_pool(jaeger_pool* pool)
+{
+    int id;
+    pthread_mutex_lock(&registry_mutex);
+    id = pool->id;
+    if (id == 0) {
+        if (pool_count < JAEGER_POOL_MAX_POOLS) {
+            pools[pool_count++] = pool;
+            id = pool_count;
+        }
+        else {
+            id = -1;
+        }
+        __atomic_store_n(&pool->id, id, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&registry_mutex);
+    return id;
+}
+
+static pool_cache* local_cache(jaeger_pool* pool)
+{
+    int id = __atomic_load_n(&pool->id, __ATOMIC_ACQUIRE);
+    if (id == 0) {
+        id = register_pool(pool);
+    }
+    if (id < 0) {
+        return NULL;
+    }
+    if (!flush_scheduled) {
+        /* Any non-NULL value makes the key run its destructor. */
+        pthread_once(&key_once, create_key);
+        pthread_setspecific(key, &flush_scheduled);
+        flush_scheduled = true;
+    }
+    return &caches[id - 1];
+}
+
+void* jaeger_pool_acquire(jaeger_pool* pool)
+{
+    pool_cache* cache = local_cache(pool);
+    free_object* object = NULL;
+    JAEGER_STATS_ADD(JAEGER_STATS_POOL_ACQUIRES, 1);
+    if (cache != NULL) {
+        if (cache->head == NULL) {
+            cache->head = withdraw(pool);
+            cache->count = cache->head != NULL ? JAEGER_POOL_BATCH : 0;
+        }
+        object = cache->head;
+        if (object != NULL) {
+            cache->head = object->next;
+            --cache->count;
+        }
+    }
+    if (object == NULL) {
+        JAEGER_STATS_ADD(JAEGER_STATS_POOL_MISSES, 1);
+        JAEGER_PROBE1(pool_miss, pool->object_size);
+        object = (free_object*) jaeger_malloc(pool->object_size);
+        if (object == NULL) {
+            return NULL;
+        }
+    }
+    else if (pool->destroy != NULL) {
+        object->next = NULL;
+        return object;
+    }
+    memset(object, 0, pool->object_size);
+    return object;
+}
+
+void jaeger_pool_release(jaeger_pool* pool, void* object)
+{
+    pool_cache* cache;
+    free_object* node = (free_object*) object;
+    if (object == NULL) {
+        return;
+    }
+    cache = local_cache(pool);
+    if (cache == NULL) {
+        node->next = NULL;
+        free_chain(pool, node);
+        return;
+    }
+    node->next = cache->head;
+    cache->head = node;
+    if (++cache->count == 2 * JAEGER_POOL_BATCH) {
+        deposit(pool, take_batch(cache));
+    }
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_RUNTIME_POOL_H
+#define JAEGER_STRUCT_RUNTIME_POOL_H
+
+#include <pthread.h>
+
+#include <jaeger-struct/runtime/common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Pool of free objects of one size. Each thread keeps a free list per pool
+ * and trades whole batches of JAEGER_POOL_BATCH objects with a shared depot,
+ * so the lock is taken once per batch at most. Depots hold up to
+ * JAEGER_POOL_MAX_BATCHES batches and free the rest.
+ *
+ * Objects are ordinary jaeger_malloc blocks, so code that frees them with
+ * jaeger_free, like the codec and the columns conversions do for list nodes,
+ * stays correct. Pools must have static storage duration, since threads return
+ * their cached objects to them on exit.
+ *
+ * Pools with a destroy function keep objects as released, so cleared messages
+ * retain their buffers, and only reset the first pointer-sized word, which
+ * links free objects and must be zero in released objects. destroy runs before
+ * a pooled object is freed.
+ */
+
+enum {
+    JAEGER_POOL_BATCH = 32,
+    JAEGER_POOL_MAX_BATCHES = 64,
+    /* Pools past this many do not cache and fall back to jaeger_malloc. */
+    JAEGER_POOL_MAX_POOLS = 256
+};
+
+typedef struct jaeger_pool {
+    /* At least a pointer, which links free objects. */
+    size_t object_size;
+    void (*destroy)(void* object);
+    /*
+     * Private: index in thread caches plus one, zero until first use and -1
+     * if all caches are taken.
+     */
+    int id;
+    pthread_mutex_t mutex;
+    void* batches[JAEGER_POOL_MAX_BATCHES];
+    size_t batch_count;
+} jaeger_pool;
+
+#define JAEGER_POOL_INIT(size, destroy)                                        \
+    {                                                                          \
+        (size) < sizeof(void*) ? sizeof(void*) : (size), (destroy), 0,         \
+            PTHREAD_MUTEX_INITIALIZER, { NULL }, 0                             \
+    }
+
+/*
+ * Returns a zeroed object, or a released one if the pool has a destroy
+ * function, or NULL if out of memory.
+ */
+void* jaeger_pool_acquire(jaeger_pool* pool);
+
+/*
+ * Returns object, which must come from a pool of the same size or from
+ * jaeger_malloc of at least pool->object_size bytes, to the pool.
+ */
+void jaeger_pool_release(jaeger_pool* pool, void* object);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* JAEGER_STRUCT_RUNTIME_POOL_H */
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_RUNTIME_PROBE_H
+#define JAEGER_STRUCT_RUNTIME_PROBE_H
+
+#include <jaeger-struct/runtime/common.h>
+
+/*
+ * USDT (user-level statically defined tracing) probes of provider
+ * jaeger_struct, for perf, bpftrace and SystemTap:
+ *
+ *   sample(trace_id_low, sampled)    a sampler decision
+ *   encode_start(table_name, size)   an encode appending to size bytes
+ *   encode_end(table_name, bytes)    bytes appended by a successful encode
+ *   flush(packets, sent)             a reporter sending its datagrams
+ *   drop(size)                       a reporter dropping a span
+ *   pool_miss(object_size)           a pool allocating a new object
+ *
+ * for example bpftrace -e 'usdt:libfoo.so:jaeger_struct:drop { ... }'. A
+ * probe is a nop and an ELF note describing where its arguments live, so an
+ * unattached probe costs nothing but keeping the arguments available.
+ *
+ * Without JAEGER_ENABLE_PROBES (the ENABLE_PROBES build option) the macros
+ * compile to nothing. They use <sys/sdt.h> when it is available, and
+ * otherwise write the same notes themselves on x86-64.
+ */
+
+#ifdef JAEGER_ENABLE_PROBES
+#if defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define JAEGER_PROBE1(name, a) DTRACE_PROBE1(jaeger_struct, name, a)
+#define JAEGER_PROBE2(name, a, b) DTRACE_PROBE2(jaeger_struct, name, a, b)
+#endif
+#endif
+
+#if !defined(JAEGER_PROBE1) && defined(__x86_64__) && defined(__GNUC__)
+/* The stapsdt note of <sys/sdt.h>, with every argument passed as 64 bits. */
+#define JAEGER_PROBE_(name, args, ...)                                        \
+    __asm__ __volatile__(                                                      \
+        "990: nop\n"                                                           \
+        ".pushsection .note.stapsdt,\"\",\"note\"\n"                           \
+        ".balign 4\n"                                                          \
+        ".4byte 992f-991f, 994f-993f, 3\n"                                     \
+        "991: .asciz \"stapsdt\"\n"                                            \
+        "992: .balign 4\n"                                                     \
+        "993: .8byte 990b\n"                                                   \
+        ".8byte _.stapsdt.base\n"                                              \
+        ".8byte 0\n"                                                           \
+        ".asciz \"jaeger_struct\"\n"                                           \
+        ".asciz \"" #name "\"\n"                                               \
+        ".asciz \"" args "\"\n"                                                \
+        "994: .balign 4\n"                                                     \
+        ".popsection\n"                                                        \
+        ".ifndef _.stapsdt.base\n"                                             \
+        ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,"        \
+        "comdat\n"                                                             \
+        ".weak _.stapsdt.base\n"                                               \
+        ".hidden _.stapsdt.base\n"                                             \
+        "_.stapsdt.base: .space 1\n"                                           \
+        ".size _.stapsdt.base, 1\n"                                            \
+        ".popsection\n"                                                        \
+        ".endif\n"                                                             \
+        :                                                                      \
+        : __VA_ARGS__)
+#define JAEGER_PROBE1(name, a)                                                 \
+    JAEGER_PROBE_(name, "8@%0", "nor"((uint64_t) (a)))
+#define JAEGER_PROBE2(name, a, b)                                              \
+    JAEGER_PROBE_(                                                             \
+        name, "8@%0 8@%1", "nor"((uint64_t) (a)), "nor"((uint64_t) (b)))
+#endif
+#endif /* JAEGER_ENABLE_PROBES */
+
+#ifndef JAEGER_PROBE1
+#define JAEGER_PROBE1(name, a) ((void) 0)
+#define JAEGER_PROBE2(name, a, b) ((void) 0)
+#endif
+
+#endif /* JAEGER_STRUCT_RUNTIME_PROBE_H */
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/propagation.h>
+
+#include <string.h>
+
+#if defined(__SSE2__) && defined(__x86_64__)
+#define JAEGER_PROPAGATION_SSE2
+#include <emmintrin.h>
+#endif /* defined(__SSE2__) && defined(__x86_64__) */
+
+/*
+ * Converts 16 hex digits to a value, most significant first, or fails if
+ * any is not a digit, or not lowercase with lowercase_only.
+ */
+#ifdef JAEGER_PROPAGATION_SSE2
+
+static bool decode_hex16(const char* digits, bool lowercase_only, uint64_t* out)
+{
+    const __m128i chars = _mm_loadu_si128((const __m128i*) digits);
+    const __m128i letters =
+        lowercase_only ? chars : _mm_or_si128(chars, _mm_set1_epi8(0x20));
+    /* Subtracting the first of a range turns it into unsigned 0..n. */
+    const __m128i decimal = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    const __m128i alpha = _mm_sub_epi8(letters, _mm_set1_epi8('a'));
+    const __m128i is_decimal =
+        _mm_cmpeq_epi8(_mm_min_epu8(decimal, _mm_set1_epi8(9)), decimal);
+    const __m128i is_alpha =
+        _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+    const __m128i nibbles = _mm_or_si128(
+        _mm_and_si128(is_decimal, decimal),
+        _mm_and_si128(is_alpha, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+    /* Each 16-bit lane holds a digit pair, the first in its low byte. */
+    const __m128i pairs =
+        _mm_or_si128(_mm_and_si128(_mm_slli_epi16(nibbles, 4),
+                                   _mm_set1_epi16(0xff)),
+                     _mm_srli_epi16(nibbles, 8));
+    const uint64_t bytes =
+        (uint64_t) _mm_cvtsi128_si64(_mm_packus_epi16(pairs, pairs));
+    *out = __builtin_bswap64(bytes);
+    return _mm_movemask_epi8(_mm_or_si128(is_decimal, is_alpha)) == 0xffff;
+}
+
+/* Writes the 16 lowercase hex digits of value. */
+static void encode_hex16(uint64_t value, char* out)
+{
+    const __m128i bytes =
+        _mm_cvtsi64_si128((long long) __builtin_bswap64(value));
+    const __m128i low_mask = _mm_set1_epi8(0x0f);
+    const __m128i nibbles = _mm_unpacklo_epi8(
+        _mm_and_si128(_mm_srli_epi16(bytes, 4), low_mask),
+        _mm_and_si128(bytes, low_mask));
+    const __m128i is_letter = _mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9));
+    const __m128i letters =
+        _mm_and_si128(is_letter, _mm_set1_epi8('a' - '0' - 10));
+    _mm_storeu_si128(
+        (__m128i*) out,
+        _mm_add_epi8(nibbles, _mm_add_epi8(letters, _mm_set1_epi8('0'))));
+}
+
+#else
+
+static bool decode_hex16(const char* digits, bool lowercase_only, uint64_t* out)
+{
+    const uint8_t case_bit = lowercase_only ? 0 : 0x20;
+    uint64_t value = 0;
+    bool valid = true;
+    int i;
+    for (i = 0; i < 16; ++i) {
+        const uint8_t decimal = (uint8_t) (digits[i] - '0');
+        const uint8_t alpha = (uint8_t) ((digits[i] | case_bit) - 'a');
+        const bool is_decimal = decimal <= 9;
+        const bool is_alpha = alpha <= 5;
+        valid &= is_decimal | is_alpha;
+        value = (value << 4) |
+                ((is_decimal ? decimal : (uint8_t) (alpha + 10)) & 0x0f);
+    }
+    *out = value;
+    return valid;
+}
+
+static void encode_hex16(uint64_t value, char* out)
+{
+    static const char digits[] = "0123456789abcdef";
+    int i;
+    for (i = 15; i >= 0; --i) {
+        out[i] = digits[value & 0x0f];
+        value >>= 4;
+    }
+}
+
+#endif /* JAEGER_PROPAGATION_SSE2 */
+
+/* Converts 1 to 16 hex digits in either case, padding them with zeros. */
+static bool decode_hex(const char* digits, size_t len, uint64_t* out)
+{
+    char padded[16];
+    if (len == 16) {
+        return decode_hex16(digits, false, out);
+    }
+    if (len == 0 || len > 16) {
+        return false;
+    }
+    memset(padded, '0', sizeof(padded));
+    memcpy(padded + sizeof(padded) - len, digits, len);
+    return decode_hex16(padded, false, out);
+}
+
+bool jaeger_uber_trace_id_parse(jaeger_trace_context* context,
+                                const char* value,
+                                size_t len)
+{
+    const char* end = value + len;
+    const char* fields[4];
+    size_t lens[4];
+    uint64_t flags;
+    bool valid;
+    int i;
+    if (len > JAEGER_UBER_TRACE_ID_MAX_LEN) {
+        return false;
+    }
+    for (i = 0; i < 4; ++i) {
+        const char* colon = (const char*) memchr(value, ':', end - value);
+        if ((colon == NULL) != (i == 3)) {
+            return false;
+        }
+        if (colon == NULL) {
+            colon = end;
+        }
+        fields[i] = value;
+        lens[i] = colon - value;
+        value = colon + 1;
+    }
+    if (lens[0] > 16) {
+        valid = decode_hex(fields[0], lens[0] - 16, &context->trace_id_high) &
+                decode_hex16(fields[0] + lens[0] - 16,
+                             false,
+                             &context->trace_id_low);
+    }
+    else {
+        context->trace_id_high = 0;
+        valid = decode_hex(fields[0], lens[0], &context->trace_id_low);
+    }
+    valid &= decode_hex(fields[1], lens[1], &context->span_id) &
+             decode_hex(fields[2], lens[2], &context->parent_span_id) &
+             decode_hex(fields[3], lens[3], &flags) & (lens[3] <= 2);
+    context->flags = (uint8_t) flags;
+    return valid && (context->trace_id_high | context->trace_id_low) != 0;
+}
+
+size_t jaeger_uber_trace_id_format(const jaeger_trace_context* context,
+                                   char* out)
+{
+    static const char digits[] = "0123456789abcdef";
+    char* start = out;
+    if (context->trace_id_high != 0) {
+        encode_hex16(context->trace_id_high, out);
+        out += 16;
+    }
+    encode_hex16(context->trace_id_low, out);
+    out[16] = ':';
+    encode_hex16(context->span_id, out + 17);
+    out[33] = ':';
+    encode_hex16(context->parent_span_id, out + 34);
+    out[50] = ':';
+    out += 51;
+    if (context->flags >= 0x10) {
+        *out++ = digits[context->flags >> 4];
+    }
+    *out++ = digits[context->flags & 0x0f];
+    return out - start;
+}
+
+bool jaeger_traceparent_parse(jaeger_trace_context* context,
+                              const char* value,
+                              size_t len)
+{
+    uint64_t version;
+    uint64_t flags;
+    char padded[16];
+    bool valid;
+    if (len < JAEGER_TRACEPARENT_LEN) {
+        return false;
+    }
+    /* The version and flags go through the vector path padded too. */
+    memset(padded, '0', sizeof(padded));
+    memcpy(padded + 12, value, 2);
+    memcpy(padded + 14, value + 53, 2);
+    valid = decode_hex16(padded, true, &flags) &
+            decode_hex16(value + 3, true, &context->trace_id_high) &
+            decode_hex16(value + 19, true, &context->trace_id_low) &
+            decode_hex16(value + 36, true, &context->span_id) &
+            (value[2] == '-') & (value[35] == '-') & (value[52] == '-');
+    version = flags >> 8;
+    if (!valid || version == 0xff ||
+        (version == 0 ? len != JAEGER_TRACEPARENT_LEN
+                      : len > JAEGER_TRACEPARENT_LEN &&
+                            value[JAEGER_TRACEPARENT_LEN] != '-')) {
+        return false;
+    }
+    context->parent_span_id = 0;
+    context->flags = (uint8_t) (flags & JAEGER_TRACE_FLAG_SAMPLED);
+    return (context->trace_id_high | context->trace_id_low) != 0 &&
+           context->span_id != 0;
+}
+
+void jaeger_traceparent_format(const jaeger_trace_context* context, char* out)
+{
+    memcpy(out, "00-", 3);
+    encode_hex16(context->trace_id_high, out + 3);
+    encode_hex16(context->trace_id_low, out + 19);
+    out[35] = '-';
+    encode_hex16(context->span_id, out + 36);
+    out[52] = '-';
+    out[53] = '0';
+    out[54] = (context->flags & JAEGER_TRACE_FLAG_SAMPLED) != 0 ? '1' : '0';
+}
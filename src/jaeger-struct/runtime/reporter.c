@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _GNU_SOURCE
+
+#include <jaeger-struct/runtime/reporter.h>
+
+#include <errno.h>
+#include <netdb.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <jaeger-struct/runtime/probe.h>
+
+bool jaeger_udp_reporter_open(jaeger_udp_reporter* reporter,
+                              const char* host,
+                              const char* port,
+                              size_t max_packet_size,
+                              const void* header,
+                              size_t header_size)
+{
+    struct addrinfo hints;
+    struct addrinfo* addresses;
+    struct addrinfo* address;
+
+    memset(reporter, 0, sizeof(*reporter));
+    reporter->fd = -1;
+    reporter->max_packet_size = max_packet_size;
+    reporter->header_size = header_size;
+    if (header_size >= max_packet_size ||
+        !jaeger_buffer_append(&reporter->data, header, header_size)) {
+        jaeger_udp_reporter_close(reporter);
+        return false;
+    }
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo(host, port, &hints, &addresses) != 0) {
+        jaeger_udp_reporter_close(reporter);
+        return false;
+    }
+    for (address = addresses; address != NULL; address = address->ai_next) {
+        reporter->fd = socket(address->ai_family,
+                              address->ai_socktype | SOCK_CLOEXEC,
+                              address->ai_protocol);
+        if (reporter->fd < 0) {
+            continue;
+        }
+        if (connect(reporter->fd, address->ai_addr, address->ai_addrlen) ==
+            0) {
+            break;
+        }
+        close(reporter->fd);
+        reporter->fd = -1;
+    }
+    freeaddrinfo(addresses);
+    if (reporter->fd < 0) {
+        jaeger_udp_reporter_close(reporter);
+        return false;
+    }
+    return true;
+}
+
+static size_t packet_start(const jaeger_udp_reporter* reporter, size_t packet)
+{
+    return (packet == 0) ? reporter->header_size
+                         : reporter->packet_ends[packet - 1];
+}
+
+/* Counts a dropped span of size bytes, releasing the charge taken for it. */
+static bool
+drop_span(jaeger_udp_reporter* reporter, size_t size, size_t charge)
+{
+    if (charge != 0) {
+        jaeger_budget_release(reporter->budget, charge);
+    }
+    ++reporter->stats.drops;
+    JAEGER_PROBE1(drop, size);
+    return false;
+}
+
+/* Charges size bytes to the budget, flushing to make room if needed. */
+static bool charge_span(jaeger_udp_reporter* reporter, size_t size)
+{
+    if (reporter->budget == NULL ||
+        jaeger_budget_charge(reporter->budget, size)) {
+        return true;
+    }
+    if (reporter->num_packets == 0) {
+        return false;
+    }
+    jaeger_udp_reporter_flush(reporter);
+    return jaeger_budget_charge(reporter->budget, size);
+}
+
+bool jaeger_udp_reporter_append(jaeger_udp_reporter* reporter,
+                                const void* span,
+                                size_t size)
+{
+    size_t last;
+    size_t charge;
+    if (size > reporter->max_packet_size - reporter->header_size ||
+        !charge_span(reporter, size)) {
+        return drop_span(reporter, size, 0);
+    }
+    charge = (reporter->budget != NULL) ? size : 0;
+    last = reporter->num_packets - 1;
+    if (reporter->num_packets == 0 ||
+        size > reporter->max_packet_size + packet_start(reporter, last) -
+                   reporter->packet_ends[last]) {
+        if (reporter->num_packets == JAEGER_UDP_REPORTER_MAX_PACKETS) {
+            jaeger_udp_reporter_flush(reporter);
+        }
+        /* Reserve first, since the header is copied from the same buffer. */
+        if (!jaeger_buffer_reserve(&reporter->data,
+                                   reporter->header_size + size)) {
+            return drop_span(reporter, size, charge);
+        }
+        if (reporter->header_size > 0) {
+            memcpy(reporter->data.data + reporter->data.size,
+                   reporter->data.data,
+                   reporter->header_size);
+        }
+        reporter->data.size += reporter->header_size;
+        last = reporter->num_packets++;
+        reporter->packet_ends[last] = reporter->data.size;
+        reporter->packet_spans[last] = 0;
+    }
+    if (!jaeger_buffer_append(&reporter->data, span, size)) {
+        return drop_span(reporter, size, charge);
+    }
+    reporter->packet_ends[last] = reporter->data.size;
+    ++reporter->packet_spans[last];
+    reporter->charged += charge;
+    return true;
+}
+
+/* Sends count datagrams described by iov. Returns how many were sent. */
+static size_t send_packets(jaeger_udp_reporter* reporter,
+                           struct iovec* iov,
+                           size_t count)
+{
+    size_t sent = 0;
+#ifdef __linux__
+    struct mmsghdr messages[JAEGER_UDP_REPORTER_MAX_PACKETS];
+    size_t i;
+    memset(messages, 0, count * sizeof(*messages));
+    for (i = 0; i < count; ++i) {
+        messages[i].msg_hdr.msg_iov = &iov[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+    while (sent < count) {
+        const int result =
+            sendmmsg(reporter->fd, messages + sent, count - sent, 0);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for (i = sent; i < sent + (size_t) result; ++i) {
+            reporter->stats.bytes += messages[i].msg_len;
+        }
+        sent += (size_t) result;
+    }
+#else
+    while (sent < count) {
+        const ssize_t result =
+            send(reporter->fd, iov[sent].iov_base, iov[sent].iov_len, 0);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        reporter->stats.bytes += (size_t) result;
+        ++sent;
+    }
+#endif /* __linux__ */
+    reporter->stats.packets += sent;
+    return sent;
+}
+
+static void release_charge(jaeger_udp_reporter* reporter)
+{
+    if (reporter->budget != NULL) {
+        jaeger_budget_release(reporter->budget, reporter->charged);
+    }
+    reporter->charged = 0;
+}
+
+bool jaeger_udp_reporter_flush(jaeger_udp_reporter* reporter)
+{
+    struct iovec iov[JAEGER_UDP_REPORTER_MAX_PACKETS];
+    const size_t count = reporter->num_packets;
+    size_t sent;
+    size_t i;
+    for (i = 0; i < count; ++i) {
+        const size_t start = packet_start(reporter, i);
+        iov[i].iov_base = reporter->data.data + start;
+        iov[i].iov_len = reporter->packet_ends[i] - start;
+    }
+    sent = (count == 0) ? 0 : send_packets(reporter, iov, count);
+    JAEGER_PROBE2(flush, count, sent);
+    for (i = sent; i < count; ++i) {
+        reporter->stats.drops += reporter->packet_spans[i];
+    }
+    reporter->data.size = reporter->header_size;
+    reporter->num_packets = 0;
+    release_charge(reporter);
+    return sent == count;
+}
+
+void jaeger_udp_reporter_close(jaeger_udp_reporter* reporter)
+{
+    if (reporter->fd >= 0) {
+        close(reporter->fd);
+    }
+    reporter->fd = -1;
+    jaeger_buffer_destroy(&reporter->data);
+    reporter->num_packets = 0;
+    release_charge(reporter);
+}
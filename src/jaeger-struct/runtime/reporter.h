@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_RUNTIME_REPORTER_H
+#define JAEGER_STRUCT_RUNTIME_REPORTER_H
+
+#include <jaeger-struct/runtime/budget.h>
+#include <jaeger-struct/runtime/buffer.h>
+#include <jaeger-struct/runtime/common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * UDP reporter that packs encoded spans into datagrams of at most
+ * max_packet_size bytes. Every datagram starts with a copy of the header
+ * given at open time, followed by as many whole spans as fit. Pending
+ * datagrams are sent together with sendmmsg, either by an explicit flush or
+ * automatically once JAEGER_UDP_REPORTER_MAX_PACKETS are waiting.
+ *
+ * If budget is set after opening, queued spans are charged to it until they
+ * are sent. A span over budget first flushes the pending datagrams, freeing
+ * their bytes, and is dropped if it still does not fit.
+ */
+
+#define JAEGER_UDP_REPORTER_MAX_PACKETS 64
+
+typedef struct jaeger_udp_reporter_stats {
+    uint64_t bytes;
+    uint64_t packets;
+    /* Spans that did not fit in a datagram or failed to send. */
+    uint64_t drops;
+} jaeger_udp_reporter_stats;
+
+typedef struct jaeger_udp_reporter {
+    int fd;
+    size_t max_packet_size;
+    size_t header_size;
+    /* Pending datagrams, back to back. The first holds only the header. */
+    jaeger_buffer data;
+    size_t packet_ends[JAEGER_UDP_REPORTER_MAX_PACKETS];
+    size_t packet_spans[JAEGER_UDP_REPORTER_MAX_PACKETS];
+    size_t num_packets;
+    jaeger_udp_reporter_stats stats;
+    jaeger_budget* budget;
+    /* Private: bytes charged to budget for the pending spans. */
+    size_t charged;
+} jaeger_udp_reporter;
+
+/* Connects to host:port, for example "localhost" and "6831". */
+bool jaeger_udp_reporter_open(jaeger_udp_reporter* reporter,
+                              const char* host,
+                              const char* port,
+                              size_t max_packet_size,
+                              const void* header,
+                              size_t header_size);
+
+/*
+ * Queues an encoded span of size bytes. Spans that can never fit in a
+ * datagram are counted as drops. Returns false if the span was dropped.
+ */
+bool jaeger_udp_reporter_append(jaeger_udp_reporter* reporter,
+                                const void* span,
+                                size_t size);
+
+/* Sends all pending datagrams. Returns false if any were dropped. */
+bool jaeger_udp_reporter_flush(jaeger_udp_reporter* reporter);
+
+/* Closes the socket without flushing, releasing the pending spans' charge. */
+void jaeger_udp_reporter_close(jaeger_udp_reporter* reporter);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* JAEGER_STRUCT_RUNTIME_REPORTER_H */
@@ -0,0 +1,287 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/sampler.h>
+
+#include <string.h>
+
+#include <jaeger-struct/runtime/probe.h>
+
+/* Longest interval or tolerance, about 146 years, so that sums cannot wrap. */
+#define MAX_NANOSECONDS ((uint64_t) 1 << 62)
+
+static uint64_t to_nanoseconds(double seconds)
+{
+    if (!(seconds > 0)) {
+        return 0;
+    }
+    if (seconds * 1e9 >= (double) MAX_NANOSECONDS) {
+        return MAX_NANOSECONDS;
+    }
+    return (uint64_t) (seconds * 1e9);
+}
+
+void jaeger_probabilistic_sampler_set_rate(
+    jaeger_probabilistic_sampler* sampler, double rate)
+{
+    uint64_t boundary;
+    if (!(rate > 0)) {
+        boundary = 0;
+    }
+    else if (rate >= 1) {
+        boundary = (uint64_t) 1 << 63;
+    }
+    else {
+        boundary = (uint64_t) (rate * 9223372036854775808.0);
+    }
+    __atomic_store_n(&sampler->boundary, boundary, __ATOMIC_RELAXED);
+}
+
+void jaeger_rate_limiter_set_rate(jaeger_rate_limiter* limiter,
+                                  double credits_per_second,
+                                  double max_balance)
+{
+    uint64_t interval = 0;
+    uint64_t tolerance = 0;
+    if (credits_per_second > 0) {
+        interval = to_nanoseconds(1 / credits_per_second);
+        if (interval == 0) {
+            interval = 1;
+        }
+        if (max_balance > 1) {
+            tolerance = to_nanoseconds((max_balance - 1) / credits_per_second);
+        }
+    }
+    __atomic_store_n(&limiter->tolerance, tolerance, __ATOMIC_RELAXED);
+    __atomic_store_n(&limiter->interval, interval, __ATOMIC_RELAXED);
+}
+
+bool jaeger_rate_limiter_check(jaeger_rate_limiter* limiter, uint64_t now)
+{
+    const uint64_t interval =
+        __atomic_load_n(&limiter->interval, __ATOMIC_RELAXED);
+    const uint64_t tolerance =
+        __atomic_load_n(&limiter->tolerance, __ATOMIC_RELAXED);
+    uint64_t arrival = __atomic_load_n(&limiter->arrival, __ATOMIC_RELAXED);
+    uint64_t previous;
+    if (interval == 0) {
+        return false;
+    }
+    /*
+     * An arrival time in the past means a full bucket. Move it to now, once:
+     * if another thread changed it meanwhile, it moved it too.
+     */
+    if ((int64_t) (arrival - now) < 0) {
+        __atomic_compare_exchange_n(&limiter->arrival,
+                                    &arrival,
+                                    now,
+                                    false,
+                                    __ATOMIC_RELAXED,
+                                    __ATOMIC_RELAXED);
+    }
+    previous =
+        __atomic_fetch_add(&limiter->arrival, interval, __ATOMIC_RELAXED);
+    if ((int64_t) (previous - now) <= (int64_t) tolerance) {
+        return true;
+    }
+    /* Gives the credit back, so rejected decisions cost nothing. */
+    __atomic_fetch_sub(&limiter->arrival, interval, __ATOMIC_RELAXED);
+    return false;
+}
+
+bool jaeger_operation_sampler_sample(jaeger_operation_sampler* sampler,
+                                     uint64_t trace_id_low,
+                                     uint64_t now)
+{
+    bool sampled;
+    if (jaeger_probabilistic_sampler_sample(&sampler->probabilistic,
+                                            trace_id_low)) {
+        /* Counts toward the lower bound, which only makes up the rest. */
+        jaeger_rate_limiter_check(&sampler->lower_bound, now);
+        sampled = true;
+    }
+    else {
+        sampled = jaeger_rate_limiter_check(&sampler->lower_bound, now);
+    }
+    JAEGER_PROBE2(sample, trace_id_low, sampled);
+    return sampled;
+}
+
+bool jaeger_adaptive_sampler_init(jaeger_adaptive_sampler* sampler,
+                                  size_t max_operations,
+                                  size_t max_name_len,
+                                  double default_rate,
+                                  double default_lower_bound)
+{
+    size_t slots_size;
+    size_t operations_size;
+    uint8_t* block;
+    memset(sampler, 0, sizeof(*sampler));
+    jaeger_probabilistic_sampler_set_rate(&sampler->default_sampler,
+                                          default_rate);
+    sampler->default_lower_bound = default_lower_bound;
+    sampler->max_operations = max_operations;
+    sampler->max_name_len = max_name_len;
+    if (max_operations == 0) {
+        return true;
+    }
+    /* At most half full, so that probe sequences stay short. */
+    sampler->slot_count = 1;
+    while (sampler->slot_count < 2 * max_operations) {
+        sampler->slot_count *= 2;
+    }
+    /* One block: the slots, then the operations, then their names. */
+    slots_size = sampler->slot_count * sizeof(*sampler->slots);
+    operations_size = max_operations * sizeof(*sampler->operations);
+    block = (uint8_t*) jaeger_malloc(slots_size + operations_size +
+                                     max_operations * max_name_len);
+    if (block == NULL) {
+        return false;
+    }
+    memset(block, 0, slots_size);
+    sampler->slots = (jaeger_operation_sampler**) block;
+    sampler->operations = (jaeger_operation_sampler*) (block + slots_size);
+    sampler->names = (char*) (block + slots_size + operations_size);
+    return true;
+}
+
+/* FNV-1a, fast for the short names of operations. */
+static uint64_t hash_name(const char* name, size_t len)
+{
+    uint64_t hash = UINT64_C(14695981039346656037);
+    size_t i;
+    for (i = 0; i < len; ++i) {
+        hash ^= (uint8_t) name[i];
+        hash *= UINT64_C(1099511628211);
+    }
+    return hash;
+}
+
+/*
+ * Claims the next unused operation and sets it up for name, which no other
+ * thread sees until it is published in a slot.
+ */
+static jaeger_operation_sampler* claim_operation(
+    jaeger_adaptive_sampler* sampler, const char* name, size_t len,
+    uint64_t hash)
+{
+    jaeger_operation_sampler* operation;
+    char* storage;
+    const size_t index =
+        __atomic_fetch_add(&sampler->operation_count, 1, __ATOMIC_RELAXED);
+    if (index >= sampler->max_operations) {
+        __atomic_fetch_sub(&sampler->operation_count, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    operation = &sampler->operations[index];
+    storage = sampler->names + index * sampler->max_name_len;
+    memset(operation, 0, sizeof(*operation));
+    memcpy(storage, name, len);
+    operation->name = storage;
+    operation->name_len = len;
+    operation->probabilistic.boundary = __atomic_load_n(
+        &sampler->default_sampler.boundary, __ATOMIC_RELAXED);
+    jaeger_rate_limiter_set_rate(&operation->lower_bound,
+                                 sampler->default_lower_bound,
+                                 sampler->default_lower_bound > 1
+                                     ? sampler->default_lower_bound
+                                     : 1);
+    operation->hash = hash;
+    return operation;
+}
+
+/*
+ * Gives back an operation claimed but not published, which is possible only
+ * while no other thread has claimed one after it.
+ */
+static void release_operation(jaeger_adaptive_sampler* sampler,
+                              jaeger_operation_sampler* operation)
+{
+    if (operation != NULL) {
+        size_t count = (size_t) (operation - sampler->operations) + 1;
+        __atomic_compare_exchange_n(&sampler->operation_count,
+                                    &count,
+                                    count - 1,
+                                    false,
+                                    __ATOMIC_RELAXED,
+                                    __ATOMIC_RELAXED);
+    }
+}
+
+jaeger_operation_sampler*
+jaeger_adaptive_sampler_operation(jaeger_adaptive_sampler* sampler,
+                                  const char* name,
+                                  size_t len)
+{
+    const uint64_t hash = hash_name(name, len);
+    jaeger_operation_sampler* claimed = NULL;
+    size_t i;
+    if (len > sampler->max_name_len) {
+        return NULL;
+    }
+    for (i = 0; i < sampler->slot_count; ++i) {
+        jaeger_operation_sampler** slot =
+            &sampler->slots[(hash + i) & (sampler->slot_count - 1)];
+        jaeger_operation_sampler* operation =
+            __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+        if (operation == NULL) {
+            if (claimed == NULL) {
+                claimed = claim_operation(sampler, name, len, hash);
+                if (claimed == NULL) {
+                    return NULL;
+                }
+            }
+            if (__atomic_compare_exchange_n(slot,
+                                            &operation,
+                                            claimed,
+                                            false,
+                                            __ATOMIC_ACQ_REL,
+                                            __ATOMIC_ACQUIRE)) {
+                return claimed;
+            }
+            /* Another thread filled the slot, maybe with the same name. */
+        }
+        if (operation->hash == hash && operation->name_len == len &&
+            memcmp(operation->name, name, len) == 0) {
+            release_operation(sampler, claimed);
+            return operation;
+        }
+    }
+    release_operation(sampler, claimed);
+    return NULL;
+}
+
+bool jaeger_adaptive_sampler_sample(jaeger_adaptive_sampler* sampler,
+                                    const jaeger_string* operation_name,
+                                    uint64_t trace_id_low,
+                                    uint64_t now)
+{
+    jaeger_operation_sampler* operation = jaeger_adaptive_sampler_operation(
+        sampler, operation_name->buffer, operation_name->len);
+    if (operation == NULL) {
+        const bool sampled = jaeger_probabilistic_sampler_sample(
+            &sampler->default_sampler, trace_id_low);
+        JAEGER_PROBE2(sample, trace_id_low, sampled);
+        return sampled;
+    }
+    return jaeger_operation_sampler_sample(operation, trace_id_low, now);
+}
+
+void jaeger_adaptive_sampler_destroy(jaeger_adaptive_sampler* sampler)
+{
+    jaeger_free(sampler->slots);
+    memset(sampler, 0, sizeof(*sampler));
+}
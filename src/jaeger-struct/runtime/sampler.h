@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_RUNTIME_SAMPLER_H
+#define JAEGER_STRUCT_RUNTIME_SAMPLER_H
+
+#include <jaeger-struct/runtime/common.h>
+#include <jaeger-struct/runtime/string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Sampling decisions for new traces. Decisions are wait-free: a few atomic
+ * operations and no locks, so that they stay cheap under contention. Rates
+ * may be changed while other threads decide.
+ *
+ * Samplers take the low 64 bits of the trace ID, the low member of a
+ * generated TraceID, which is random, so it needs no hashing. Times are
+ * monotonic nanoseconds, e.g. from clock_gettime(CLOCK_MONOTONIC).
+ */
+
+/*
+ * Samples the trace IDs whose low 63 bits are below a boundary, like the
+ * Jaeger clients do, so that every service sampling at the same rate makes
+ * the same decision for a trace.
+ */
+typedef struct jaeger_probabilistic_sampler {
+    /* Private: read and written atomically. */
+    uint64_t boundary;
+} jaeger_probabilistic_sampler;
+
+/* Sets the fraction of traces sampled, clamped to [0, 1]. */
+void jaeger_probabilistic_sampler_set_rate(
+    jaeger_probabilistic_sampler* sampler, double rate);
+
+static inline bool
+jaeger_probabilistic_sampler_sample(const jaeger_probabilistic_sampler* sampler,
+                                    uint64_t trace_id_low)
+{
+    return (trace_id_low & INT64_MAX) <
+           __atomic_load_n(&sampler->boundary, __ATOMIC_RELAXED);
+}
+
+/*
+ * Token bucket admitting credits_per_second decisions on average and bursts
+ * of up to max_balance, as the generic cell rate algorithm: a single atomic
+ * theoretical arrival time advances by one interval per admitted decision,
+ * and decisions arriving too far before it are rejected. Under contention
+ * the limiter may reject a decision it could have admitted; after an idle
+ * period, threads racing to refill the bucket may each admit one decision
+ * too many. Starts with a full bucket.
+ */
+typedef struct jaeger_rate_limiter {
+    /* Private: read and written atomically. */
+    uint64_t interval;
+    uint64_t tolerance;
+    uint64_t arrival;
+} jaeger_rate_limiter;
+
+/* Sets the rate, keeping the balance. */
+void jaeger_rate_limiter_set_rate(jaeger_rate_limiter* limiter,
+                                  double credits_per_second,
+                                  double max_balance);
+
+/* Takes a credit if one is available at time now. */
+bool jaeger_rate_limiter_check(jaeger_rate_limiter* limiter, uint64_t now);
+
+/*
+ * Sampling of an operation: its probabilistic sampler, with a lower bound of
+ * traces per second sampled regardless of their ID.
+ */
+typedef struct jaeger_operation_sampler {
+    /* Interned copy of the operation name. */
+    const char* name;
+    size_t name_len;
+    jaeger_probabilistic_sampler probabilistic;
+    jaeger_rate_limiter lower_bound;
+    /* Private. */
+    uint64_t hash;
+} jaeger_operation_sampler;
+
+bool jaeger_operation_sampler_sample(jaeger_operation_sampler* sampler,
+                                     uint64_t trace_id_low,
+                                     uint64_t now);
+
+/*
+ * Per-operation sampling as in Jaeger's adaptive sampling strategies. The
+ * first decision for an operation name interns it in a table of at most
+ * max_operations operations with the default rate and lower bound, each
+ * then adjustable through its jaeger_operation_sampler. Operations and
+ * their names are allocated up front and claimed with an atomic increment,
+ * then found by hashing their names in an open addressing table whose slots
+ * are filled once with a compare-and-swap, so decisions never allocate,
+ * lookups take a bounded number of steps and operations stay at the same
+ * address until the sampler is destroyed. Operations past max_operations,
+ * and names longer than max_name_len, use the default sampler. A thread
+ * losing a race to add the same name as another may use up an operation.
+ */
+typedef struct jaeger_adaptive_sampler {
+    jaeger_probabilistic_sampler default_sampler;
+    double default_lower_bound;
+    size_t max_operations;
+    size_t max_name_len;
+    /* Private. */
+    jaeger_operation_sampler** slots;
+    size_t slot_count;
+    jaeger_operation_sampler* operations;
+    char* names;
+    size_t operation_count;
+} jaeger_adaptive_sampler;
+
+bool jaeger_adaptive_sampler_init(jaeger_adaptive_sampler* sampler,
+                                  size_t max_operations,
+                                  size_t max_name_len,
+                                  double default_rate,
+                                  double default_lower_bound);
+
+/*
+ * Returns the sampler of the operation named by the len bytes at name,
+ * adding it if needed, or NULL if the table is full or the name too long.
+ * Callers may keep it to skip the lookup of later decisions.
+ */
+jaeger_operation_sampler*
+jaeger_adaptive_sampler_operation(jaeger_adaptive_sampler* sampler,
+                                  const char* name,
+                                  size_t len);
+
+/* Decides for a trace starting with a span of operation_name. */
+bool jaeger_adaptive_sampler_sample(jaeger_adaptive_sampler* sampler,
+                                    const jaeger_string* operation_name,
+                                    uint64_t trace_id_low,
+                                    uint64_t now);
+
+/* Frees the operations, which no thread may use any more. */
+void jaeger_adaptive_sampler_destroy(jaeger_adaptive_sampler* sampler);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* JAEGER_STRUCT_RUNTIME_SAMPLER_H */
@@ -0,0 +1,391 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <jaeger-struct/runtime/segment.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <jaeger-struct/runtime/crc32c.h>
+
+#define RECORD_HEADER_SIZE 8
+#define INDEX_ENTRY_SIZE 24
+#define INDEX_BATCH 16
+
+static const uint8_t magic[JAEGER_SEGMENT_HEADER_SIZE] = {
+    'J', 'S', 'E', 'G', 1, 0, 0, 0
+};
+
+static void put_u32(uint8_t* data, uint32_t value)
+{
+    size_t i;
+    for (i = 0; i < 4; ++i) {
+        data[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static void put_u64(uint8_t* data, uint64_t value)
+{
+    size_t i;
+    for (i = 0; i < 8; ++i) {
+        data[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint32_t get_u32(const uint8_t* data)
+{
+    return (uint32_t) data[0] | (uint32_t) data[1] << 8 |
+           (uint32_t) data[2] << 16 | (uint32_t) data[3] << 24;
+}
+
+static uint64_t get_u64(const uint8_t* data)
+{
+    return (uint64_t) get_u32(data) | (uint64_t) get_u32(data + 4) << 32;
+}
+
+static char* index_path(const char* path)
+{
+    const size_t len = strlen(path);
+    char* result = (char*) jaeger_malloc(len + sizeof(".idx"));
+    if (result != NULL) {
+        memcpy(result, path, len);
+        memcpy(result + len, ".idx", sizeof(".idx"));
+    }
+    return result;
+}
+
+/* Writes all of iov, retrying short writes and interrupts. */
+static bool write_all(int fd, struct iovec* iov, int count)
+{
+    while (count > 0) {
+        ssize_t written = writev(fd, iov, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        while (count > 0 && (size_t) written >= iov->iov_len) {
+            written -= iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if (count > 0) {
+            iov->iov_base = (uint8_t*) iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+    return true;
+}
+
+bool jaeger_segment_writer_open(jaeger_segment_writer* writer,
+                                const char* path)
+{
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC;
+    char* idx = index_path(path);
+    struct iovec iov;
+    if (idx == NULL) {
+        return false;
+    }
+    writer->fd = open(path, flags, 0644);
+    writer->index_fd = (writer->fd < 0) ? -1 : open(idx, flags, 0644);
+    writer->offset = JAEGER_SEGMENT_HEADER_SIZE;
+    writer->index_offset = 0;
+    jaeger_free(idx);
+    iov.iov_base = (void*) magic;
+    iov.iov_len = sizeof(magic);
+    if (writer->index_fd < 0 || !write_all(writer->fd, &iov, 1)) {
+        jaeger_segment_writer_close(writer);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Truncates fd to length, dropping a torn write, or closes the writer if
+ * that fails so that nothing is appended after the torn bytes.
+ */
+static void roll_back(jaeger_segment_writer* writer, int fd, uint64_t length)
+{
+    int result;
+    do {
+        result = ftruncate(fd, (off_t) length);
+    } while (result != 0 && errno == EINTR);
+    if (result != 0) {
+        jaeger_segment_writer_close(writer);
+    }
+}
+
+bool jaeger_segment_writer_append(jaeger_segment_writer* writer,
+                                  const void* data,
+                                  size_t size,
+                                  const jaeger_segment_trace_id* trace_ids,
+                                  size_t num_trace_ids)
+{
+    uint8_t header[RECORD_HEADER_SIZE];
+    uint8_t entries[INDEX_BATCH * INDEX_ENTRY_SIZE];
+    struct iovec iov[2];
+    uint64_t offset;
+    size_t i;
+
+    if (size > UINT32_MAX) {
+        return false;
+    }
+    put_u32(header, (uint32_t) size);
+    put_u32(header + 4, jaeger_crc32c(jaeger_crc32c(0, header, 4), data, size));
+    iov[0].iov_base = header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = (void*) data;
+    iov[1].iov_len = size;
+    if (!write_all(writer->fd, iov, 2)) {
+        roll_back(writer, writer->fd, writer->offset);
+        return false;
+    }
+    offset = writer->offset;
+    writer->offset += RECORD_HEADER_SIZE + size;
+
+    for (i = 0; i < num_trace_ids; i += INDEX_BATCH) {
+        const size_t batch = (num_trace_ids - i < INDEX_BATCH)
+                                 ? num_trace_ids - i
+                                 : INDEX_BATCH;
+        size_t j;
+        for (j = 0; j < batch; ++j) {
+            uint8_t* entry = entries + j * INDEX_ENTRY_SIZE;
+            put_u64(entry, trace_ids[i + j].high);
+            put_u64(entry + 8, trace_ids[i + j].low);
+            put_u64(entry + 16, offset);
+        }
+        iov[0].iov_base = entries;
+        iov[0].iov_len = batch * INDEX_ENTRY_SIZE;
+        if (!write_all(writer->index_fd, iov, 1)) {
+            roll_back(writer, writer->index_fd, writer->index_offset);
+            return false;
+        }
+    }
+    writer->index_offset += num_trace_ids * INDEX_ENTRY_SIZE;
+    return true;
+}
+
+bool jaeger_segment_writer_sync(jaeger_segment_writer* writer)
+{
+    return fdatasync(writer->fd) == 0 && fdatasync(writer->index_fd) == 0;
+}
+
+void jaeger_segment_writer_close(jaeger_segment_writer* writer)
+{
+    if (writer->fd >= 0) {
+        close(writer->fd);
+    }
+    if (writer->index_fd >= 0) {
+        close(writer->index_fd);
+    }
+    writer->fd = -1;
+    writer->index_fd = -1;
+}
+
+/* Maps path read-only. Sets *data to NULL for an empty file. */
+static bool map_file(const char* path, const uint8_t** data, size_t* size)
+{
+    struct stat st;
+    void* mapping;
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    *data = NULL;
+    *size = (size_t) st.st_size;
+    if (*size > 0) {
+        mapping = mmap(NULL, *size, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        *data = (const uint8_t*) mapping;
+    }
+    close(fd);
+    return true;
+}
+
+static int compare_entries(const void* lhs, const void* rhs)
+{
+    const jaeger_segment_index_entry* a =
+        (const jaeger_segment_index_entry*) lhs;
+    const jaeger_segment_index_entry* b =
+        (const jaeger_segment_index_entry*) rhs;
+    if (a->trace_id.high != b->trace_id.high) {
+        return a->trace_id.high < b->trace_id.high ? -1 : 1;
+    }
+    if (a->trace_id.low != b->trace_id.low) {
+        return a->trace_id.low < b->trace_id.low ? -1 : 1;
+    }
+    if (a->offset != b->offset) {
+        return a->offset < b->offset ? -1 : 1;
+    }
+    return 0;
+}
+
+/* Checks that a whole record starts at offset, without verifying it. */
+static bool record_fits(const jaeger_segment_reader* reader, uint64_t offset)
+{
+    return offset >= JAEGER_SEGMENT_HEADER_SIZE && offset <= reader->size &&
+           reader->size - offset >= RECORD_HEADER_SIZE &&
+           reader->size - offset - RECORD_HEADER_SIZE >=
+               get_u32(reader->data + offset);
+}
+
+/* Loads the index, dropping entries for records torn off the segment. */
+static bool load_index(jaeger_segment_reader* reader, const char* path)
+{
+    const uint8_t* data;
+    size_t size;
+    size_t count;
+    size_t i;
+    bool mapped;
+    bool missing;
+    char* idx = index_path(path);
+    if (idx == NULL) {
+        return false;
+    }
+    mapped = map_file(idx, &data, &size);
+    missing = !mapped && errno == ENOENT;
+    jaeger_free(idx);
+    if (!mapped) {
+        return missing;
+    }
+
+    count = size / INDEX_ENTRY_SIZE;
+    if (count > 0) {
+        reader->index = (jaeger_segment_index_entry*) jaeger_malloc(
+            count * sizeof(*reader->index));
+        if (reader->index == NULL) {
+            munmap((void*) data, size);
+            return false;
+        }
+    }
+    for (i = 0; i < count; ++i) {
+        const uint8_t* entry = data + i * INDEX_ENTRY_SIZE;
+        jaeger_segment_index_entry* out = &reader->index[reader->index_size];
+        out->trace_id.high = get_u64(entry);
+        out->trace_id.low = get_u64(entry + 8);
+        out->offset = get_u64(entry + 16);
+        if (record_fits(reader, out->offset)) {
+            ++reader->index_size;
+        }
+    }
+    if (data != NULL) {
+        munmap((void*) data, size);
+    }
+    qsort(reader->index,
+          reader->index_size,
+          sizeof(*reader->index),
+          compare_entries);
+    return true;
+}
+
+bool jaeger_segment_reader_open(jaeger_segment_reader* reader,
+                                const char* path)
+{
+    memset(reader, 0, sizeof(*reader));
+    if (!map_file(path, &reader->data, &reader->size)) {
+        return false;
+    }
+    if (reader->size < JAEGER_SEGMENT_HEADER_SIZE ||
+        memcmp(reader->data, magic, sizeof(magic)) != 0) {
+        jaeger_segment_reader_close(reader);
+        return false;
+    }
+    posix_madvise(
+        (void*) reader->data, reader->size, POSIX_MADV_SEQUENTIAL);
+    if (!load_index(reader, path)) {
+        jaeger_segment_reader_close(reader);
+        return false;
+    }
+    return true;
+}
+
+bool jaeger_segment_reader_read(const jaeger_segment_reader* reader,
+                                uint64_t* offset,
+                                jaeger_segment_record* record)
+{
+    const uint8_t* header;
+    uint32_t size;
+    if (*offset > reader->size ||
+        reader->size - *offset < RECORD_HEADER_SIZE) {
+        return false;
+    }
+    header = reader->data + *offset;
+    size = get_u32(header);
+    if (reader->size - *offset - RECORD_HEADER_SIZE < size ||
+        jaeger_crc32c(jaeger_crc32c(0, header, 4),
+                      header + RECORD_HEADER_SIZE,
+                      size) != get_u32(header + 4)) {
+        return false;
+    }
+    record->data = header + RECORD_HEADER_SIZE;
+    record->size = size;
+    *offset += RECORD_HEADER_SIZE + size;
+    return true;
+}
+
+size_t jaeger_segment_reader_find(const jaeger_segment_reader* reader,
+                                  const jaeger_segment_trace_id* trace_id,
+                                  const jaeger_segment_index_entry** entries)
+{
+    jaeger_segment_index_entry key;
+    size_t first = 0;
+    size_t last = reader->index_size;
+    size_t end;
+    key.trace_id = *trace_id;
+    key.offset = 0;
+    while (first < last) {
+        const size_t middle = first + (last - first) / 2;
+        if (compare_entries(&reader->index[middle], &key) < 0) {
+            first = middle + 1;
+        }
+        else {
+            last = middle;
+        }
+    }
+    for (end = first; end < reader->index_size &&
+                      reader->index[end].trace_id.high == trace_id->high &&
+                      reader->index[end].trace_id.low == trace_id->low;
+         ++end) {
+    }
+    *entries = reader->index + first;
+    return end - first;
+}
+
+void jaeger_segment_reader_close(jaeger_segment_reader* reader)
+{
+    if (reader->data != NULL) {
+        munmap((void*) reader->data, reader->size);
+    }
+    jaeger_free(reader->index);
+    memset(reader, 0, sizeof(*reader));
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_RUNTIME_SEGMENT_H
+#define JAEGER_STRUCT_RUNTIME_SEGMENT_H
+
+#include <jaeger-struct/runtime/common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Append-only segment files for spilling encoded spans or batches to disk.
+ *
+ * A segment starts with an 8 byte header, followed by records of the form
+ * (uint32 size, uint32 CRC-32C, size bytes of payload), little-endian. A
+ * sidecar file at "<path>.idx" holds fixed-size entries mapping trace IDs to
+ * record offsets. Both files are only ever appended to, except to drop what
+ * a failed append left, so a crash leaves at most a torn final record, which
+ * readers detect and stop at.
+ */
+
+/* Offset of the first record in a segment. */
+#define JAEGER_SEGMENT_HEADER_SIZE 8
+
+typedef struct jaeger_segment_trace_id {
+    uint64_t high;
+    uint64_t low;
+} jaeger_segment_trace_id;
+
+typedef struct jaeger_segment_writer {
+    int fd;
+    int index_fd;
+    /* Private: the lengths of the files, up to the last complete append. */
+    uint64_t offset;
+    uint64_t index_offset;
+} jaeger_segment_writer;
+
+/* Creates a new segment at path, truncating any existing one. */
+bool jaeger_segment_writer_open(jaeger_segment_writer* writer,
+                                const char* path);
+
+/*
+ * Appends a record holding size bytes of data, and indexes it under each of
+ * the num_trace_ids trace IDs. Costs one write to the segment and one to
+ * the index per 16 trace IDs, regardless of how much has been written
+ * before. On failure, truncates the files back to whole records and index
+ * entries: a record written without its index entries stays readable by
+ * iteration only. If truncating fails too, the writer is closed and later
+ * appends fail.
+ */
+bool jaeger_segment_writer_append(jaeger_segment_writer* writer,
+                                  const void* data,
+                                  size_t size,
+                                  const jaeger_segment_trace_id* trace_ids,
+                                  size_t num_trace_ids);
+
+/* Flushes both files to stable storage. */
+bool jaeger_segment_writer_sync(jaeger_segment_writer* writer);
+
+void jaeger_segment_writer_close(jaeger_segment_writer* writer);
+
+typedef struct jaeger_segment_index_entry {
+    jaeger_segment_trace_id trace_id;
+    uint64_t offset;
+} jaeger_segment_index_entry;
+
+/* A record payload, pointing into the mapped segment. */
+typedef struct jaeger_segment_record {
+    const void* data;
+    size_t size;
+} jaeger_segment_record;
+
+typedef struct jaeger_segment_reader {
+    const uint8_t* data;
+    size_t size;
+    jaeger_segment_index_entry* index;
+    size_t index_size;
+} jaeger_segment_reader;
+
+/*
+ * Maps the segment at path and loads its index, sorted by trace ID then
+ * offset. A missing index is treated as empty.
+ */
+bool jaeger_segment_reader_open(jaeger_segment_reader* reader,
+                                const char* path);
+
+/*
+ * Reads the record at *offset and advances *offset to the next one. Start
+ * iteration at JAEGER_SEGMENT_HEADER_SIZE. Returns false at the end of the
+ * segment or at a truncated or corrupt record.
+ */
+bool jaeger_segment_reader_read(const jaeger_segment_reader* reader,
+                                uint64_t* offset,
+                                jaeger_segment_record* record);
+
+/*
+ * Points *entries at the index entries for trace_id, in offset order, and
+ * returns how many there are.
+ */
+size_t jaeger_segment_reader_find(const jaeger_segment_reader* reader,
+                                  const jaeger_segment_trace_id* trace_id,
+                                  const jaeger_segment_index_entry** entries);
+
+void jaeger_segment_reader_close(jaeger_segment_reader* reader);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* JAEGER_STRUCT_RUNTIME_SEGMENT_H */
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/sort.h>
+
+#include <string.h>
+
+enum { RADIX_BITS = 8, RADIX = 1 << RADIX_BITS, DIGITS = 64 / RADIX_BITS };
+
+/* A node's key being sorted on and the node's index in the list. */
+typedef struct entry {
+    uint64_t key;
+    uint32_t index;
+} entry;
+
+static uint64_t read_key(const jaeger_list* node, const jaeger_sort_key* key)
+{
+    uint64_t value;
+    memcpy(&value, (const char*) node + key->offset, sizeof(value));
+    /* Flipping the sign bit orders two's complement values as unsigned. */
+    return key->is_signed ? value ^ ((uint64_t) 1 << 63) : value;
+}
+
+static bool reserve(jaeger_list_sorter* sorter, size_t size)
+{
+    void* scratch;
+    if (size <= sorter->scratch_size) {
+        return true;
+    }
+    scratch = jaeger_malloc(size);
+    if (scratch == NULL) {
+        return false;
+    }
+    jaeger_free(sorter->scratch);
+    sorter->scratch = scratch;
+    sorter->scratch_size = size;
+    return true;
+}
+
+/*
+ * Orders the entries at src, whose keys are set, by key into dst and
+ * returns the array holding the result, src or dst.
+ */
+static entry* sort_entries(entry* src,
+                           entry* dst,
+                           size_t count,
+                           uint32_t counts[DIGITS][RADIX])
+{
+    size_t digit;
+    for (digit = 0; digit < DIGITS; ++digit) {
+        const unsigned shift = (unsigned) (digit * RADIX_BITS);
+        size_t offsets[RADIX];
+        size_t offset = 0;
+        size_t i;
+        entry* swap;
+        if (counts[digit][(src[0].key >> shift) & (RADIX - 1)] == count) {
+            continue;
+        }
+        for (i = 0; i < RADIX; ++i) {
+            offsets[i] = offset;
+            offset += counts[digit][i];
+        }
+        for (i = 0; i < count; ++i) {
+            dst[offsets[(src[i].key >> shift) & (RADIX - 1)]++] = src[i];
+        }
+        swap = src;
+        src = dst;
+        dst = swap;
+    }
+    return src;
+}
+
+bool jaeger_list_sort(jaeger_list_sorter* sorter,
+                      jaeger_list* list,
+                      const jaeger_sort_key* keys,
+                      size_t num_keys)
+{
+    const size_t count = jaeger_list_size(list);
+    uint32_t counts[DIGITS][RADIX];
+    entry* entries;
+    entry* spare;
+    uint64_t* values;
+    jaeger_list** nodes;
+    jaeger_list* node;
+    jaeger_list* prev;
+    size_t i;
+    size_t k;
+
+    if (count < 2 || num_keys == 0) {
+        return true;
+    }
+    if (count > UINT32_MAX ||
+        !reserve(sorter,
+                 count * (2 * sizeof(entry) + num_keys * sizeof(uint64_t) +
+                          sizeof(jaeger_list*)))) {
+        return false;
+    }
+    entries = (entry*) sorter->scratch;
+    spare = entries + count;
+    values = (uint64_t*) (spare + count);
+    nodes = (jaeger_list**) (values + count * num_keys);
+
+    i = 0;
+    JAEGER_LIST_FOR_EACH(list, node)
+    {
+        nodes[i] = node;
+        for (k = 0; k < num_keys; ++k) {
+            values[i * num_keys + k] = read_key(node, &keys[k]);
+        }
+        entries[i].index = (uint32_t) i;
+        ++i;
+    }
+
+    /*
+     * Sorting by each key in turn, least significant first, is stable, so
+     * ties keep the order of the less significant keys.
+     */
+    for (k = num_keys; k-- > 0;) {
+        memset(counts, 0, sizeof(counts));
+        for (i = 0; i < count; ++i) {
+            const uint64_t key = values[entries[i].index * num_keys + k];
+            size_t digit;
+            entries[i].key = key;
+            for (digit = 0; digit < DIGITS; ++digit) {
+                ++counts[digit][(key >> (digit * RADIX_BITS)) & (RADIX - 1)];
+            }
+        }
+        if (sort_entries(entries, spare, count, counts) == spare) {
+            entry* swap = entries;
+            entries = spare;
+            spare = swap;
+        }
+    }
+
+    prev = NULL;
+    for (i = 0; i < count; ++i) {
+        node = nodes[entries[i].index];
+        node->prev = prev;
+        if (prev == NULL) {
+            list->next = node;
+        }
+        else {
+            prev->next = node;
+        }
+        prev = node;
+    }
+    prev->next = NULL;
+    list->prev = prev;
+    return true;
+}
+
+void jaeger_list_sorter_destroy(jaeger_list_sorter* sorter)
+{
+    jaeger_free(sorter->scratch);
+    memset(sorter, 0, sizeof(*sorter));
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_RUNTIME_SORT_H
+#define JAEGER_STRUCT_RUNTIME_SORT_H
+
+#include <jaeger-struct/runtime/list.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Stable sort of list nodes by 64-bit integer keys, e.g. the spans of a
+ * Batch by trace ID and start time, so that spans of a trace are adjacent
+ * for compression and trace assembly. The keys of every node are copied out
+ * once, then the nodes are ordered by a least significant digit radix sort,
+ * a byte per pass, and relinked. Passes over bytes that are the same in
+ * every node, like the high bytes of nearby timestamps, are skipped, so a
+ * sort takes linear time and no comparisons.
+ */
+
+/* A 64-bit integer member of the nodes, at offset bytes from their start. */
+typedef struct jaeger_sort_key {
+    size_t offset;
+    bool is_signed;
+} jaeger_sort_key;
+
+/* Scratch space reused by successive sorts. Zero-initializable. */
+typedef struct jaeger_list_sorter {
+    /* Private. */
+    void* scratch;
+    size_t scratch_size;
+} jaeger_list_sorter;
+
+/*
+ * Sorts the nodes of list by keys, the first key most significant. Returns
+ * false, leaving the list as is, if scratch space cannot be allocated.
+ */
+bool jaeger_list_sort(jaeger_list_sorter* sorter,
+                      jaeger_list* list,
+                      const jaeger_sort_key* keys,
+                      size_t num_keys);
+
+void jaeger_list_sorter_destroy(jaeger_list_sorter* sorter);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* JAEGER_STRUCT_RUNTIME_SORT_H */
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/split.h>
+
+#include <string.h>
+
+#include <jaeger-struct/runtime/list.h>
+#include <jaeger-struct/runtime/varint.h>
+
+size_t jaeger_split(const jaeger_message_table* table,
+                    void* message,
+                    uint32_t field_number,
+                    size_t max_size,
+                    void* part)
+{
+    const jaeger_field_table* field = NULL;
+    jaeger_list* list;
+    jaeger_list* part_list;
+    jaeger_list* node;
+    jaeger_list* last = NULL;
+    size_t tag_size;
+    size_t size;
+    size_t count = 0;
+    size_t i;
+    for (i = 0; i < table->field_count; ++i) {
+        if (table->fields[i].number == field_number) {
+            field = &table->fields[i];
+            break;
+        }
+    }
+    if (field == NULL || !field->repeated ||
+        field->type != JAEGER_TYPE_MESSAGE) {
+        return 0;
+    }
+    list = (jaeger_list*) ((uint8_t*) message + field->offset);
+    if (jaeger_list_empty(list)) {
+        return 0;
+    }
+
+    tag_size = jaeger_varint_size((uint64_t) field_number << 3);
+    size = jaeger_encoded_fields_size(table, message, 0, i) +
+           jaeger_encoded_fields_size(
+               table, message, i + 1, table->field_count);
+    JAEGER_LIST_FOR_EACH(list, node) {
+        const size_t len = jaeger_encoded_size(
+            (const jaeger_message_table*) field->table,
+            (const uint8_t*) node + field->node_offset);
+        const size_t element = tag_size + jaeger_varint_size(len) + len;
+        if (count > 0 && size + element > max_size) {
+            break;
+        }
+        size += element;
+        last = node;
+        ++count;
+    }
+
+    memcpy(part, message, table->size);
+    part_list = (jaeger_list*) ((uint8_t*) part + field->offset);
+    part_list->next = NULL;
+    part_list->prev = NULL;
+    jaeger_list_splice(part_list, list, last);
+    if (table->encoded_offset != 0) {
+        /* Neither holds the elements encoded when message was frozen. */
+        jaeger_encoded_cache** cache =
+            (jaeger_encoded_cache**) ((uint8_t*) message +
+                                      table->encoded_offset);
+        jaeger_encoded_cache_touch(*cache);
+        *(jaeger_encoded_cache**) ((uint8_t*) part + table->encoded_offset) =
+            NULL;
+    }
+    return count;
+}
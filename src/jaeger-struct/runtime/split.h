@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_RUNTIME_SPLIT_H
+#define JAEGER_STRUCT_RUNTIME_SPLIT_H
+
+#include <jaeger-struct/runtime/codec.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Splits message into parts that encode to at most max_size bytes each, one
+ * part per call, for receivers that limit message sizes. Moves elements from
+ * the front of the repeated message field field_number of message to the
+ * same field of part, as many as fit along with the other fields of message,
+ * by splicing list nodes. The other fields of part are shallow copies of
+ * those of message, so that a Batch split this way repeats its Process in
+ * every part without copying it. If message is a cached struct, splitting
+ * makes its frozen encoding stale and part has none. A part exceeds
+ * max_size only if it holds a single element that does by itself. The field
+ * must not have inline storage (jaeger_struct.inline_capacity), whose nodes
+ * cannot move.
+ *
+ * Returns the number of elements moved, zero once none are left. part is
+ * overwritten and must be released by destroying the elements of its field
+ * field_number only, as the generated <type>_split_<field>_release
+ * functions do, never with <type>_destroy.
+ */
+size_t jaeger_split(const jaeger_message_table* table,
+                    void* message,
+                    uint32_t field_number,
+                    size_t max_size,
+                    void* part);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* JAEGER_STRUCT_RUNTIME_SPLIT_H */
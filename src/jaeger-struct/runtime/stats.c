@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <jaeger-struct/runtime/stats.h>
+
+#ifdef JAEGER_ENABLE_STATS
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define CACHE_LINE_SIZE 64
+
+typedef struct stats_block {
+    _Atomic uint64_t counters[JAEGER_STATS_COUNTER_COUNT];
+    _Atomic uint64_t sums[JAEGER_STATS_HISTOGRAM_COUNT];
+    _Atomic uint64_t buckets[JAEGER_STATS_HISTOGRAM_COUNT]
+                            [JAEGER_STATS_BUCKETS];
+    atomic_bool in_use;
+    /* Immutable once the block is published. */
+    struct stats_block* next;
+} stats_block;
+
+static _Atomic(stats_block*) blocks;
+static atomic_bool timing;
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t key;
+static _Thread_local stats_block* local_block;
+
+/*
+ * Runs at thread exit. Destructors running after it in the same thread
+ * acquire a block again, which the next round of destructors releases.
+ */
+static void release_block(void* block)
+{
+    local_block = NULL;
+    atomic_store_explicit(
+        &((stats_block*) block)->in_use, false, memory_order_release);
+}
+
+static void create_key(void)
+{
+    pthread_key_create(&key, release_block);
+}
+
+/*
+ * Adopts the block of an exited thread or publishes a new one. Blocks are
+ * never freed, so snapshots can walk the list without synchronization.
+ */
+static stats_block* acquire_block(void)
+{
+    stats_block* block;
+    stats_block* head;
+    size_t size;
+    pthread_once(&key_once, create_key);
+    for (block = atomic_load_explicit(&blocks, memory_order_acquire);
+         block != NULL;
+         block = block->next) {
+        bool expected = false;
+        if (atomic_compare_exchange_strong(&block->in_use, &expected, true)) {
+            break;
+        }
+    }
+    if (block == NULL) {
+        /* Not jaeger_malloc, which counts itself. */
+        size = (sizeof(stats_block) + CACHE_LINE_SIZE - 1) /
+               CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+        block = (stats_block*) aligned_alloc(CACHE_LINE_SIZE, size);
+        if (block == NULL) {
+            return NULL;
+        }
+        memset(block, 0, size);
+        atomic_store_explicit(&block->in_use, true, memory_order_relaxed);
+        head = atomic_load_explicit(&blocks, memory_order_relaxed);
+        do {
+            block->next = head;
+        } while (!atomic_compare_exchange_weak_explicit(&blocks,
+                                                        &head,
+                                                        block,
+                                                        memory_order_release,
+                                                        memory_order_relaxed));
+    }
+    pthread_setspecific(key, block);
+    local_block = block;
+    return block;
+}
+
+static stats_block* current_block(void)
+{
+    stats_block* block = local_block;
+    if (block == NULL) {
+        block = acquire_block();
+    }
+    return block;
+}
+
+/* Only the owning thread writes, so a plain load and store suffice. */
+static void increment(_Atomic uint64_t* counter, uint64_t value)
+{
+    atomic_store_explicit(
+        counter,
+        atomic_load_explicit(counter, memory_order_relaxed) + value,
+        memory_order_relaxed);
+}
+
+static uint64_t read_clock(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t value;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(value));
+    return value;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000 + (uint64_t) now.tv_nsec;
+#endif
+}
+
+void jaeger_stats_add(jaeger_stats_counter counter, uint64_t value)
+{
+    stats_block* block = current_block();
+    if (block != NULL) {
+        increment(&block->counters[counter], value);
+    }
+}
+
+void jaeger_stats_set_timing(bool enabled)
+{
+    atomic_store_explicit(&timing, enabled, memory_order_relaxed);
+}
+
+uint64_t jaeger_stats_begin(void)
+{
+    if (!atomic_load_explicit(&timing, memory_order_relaxed)) {
+        return 0;
+    }
+    return read_clock() | 1;
+}
+
+void jaeger_stats_end(jaeger_stats_histogram histogram, uint64_t start)
+{
+    stats_block* block;
+    uint64_t elapsed;
+    size_t bucket = 0;
+    if (start == 0 || (block = current_block()) == NULL) {
+        return;
+    }
+    elapsed = read_clock() - (start & ~(uint64_t) 1);
+    while (bucket < 64 && (elapsed >> bucket) != 0) {
+        ++bucket;
+    }
+    increment(&block->sums[histogram], elapsed);
+    increment(&block->buckets[histogram][bucket], 1);
+}
+
+static bool snapshot_histogram(const uint64_t* buckets,
+                               uint64_t sum,
+                               jaeger_struct_runtime_histogram* histogram)
+{
+    typedef JAEGER_LIST(uint64_t) node_type;
+    size_t used = JAEGER_STATS_BUCKETS;
+    size_t i;
+    while (used > 0 && buckets[used - 1] == 0) {
+        --used;
+    }
+    histogram->sum = sum;
+    for (i = 0; i < used; ++i) {
+        node_type* node = (node_type*) jaeger_malloc(sizeof(node_type));
+        if (node == NULL) {
+            return false;
+        }
+        node->value = buckets[i];
+        jaeger_list_append(&histogram->buckets, &node->base);
+        histogram->count += buckets[i];
+    }
+    return true;
+}
+
+bool jaeger_stats_snapshot(jaeger_struct_runtime_stats_snapshot* snapshot)
+{
+    uint64_t counters[JAEGER_STATS_COUNTER_COUNT] = { 0 };
+    uint64_t sums[JAEGER_STATS_HISTOGRAM_COUNT] = { 0 };
+    uint64_t buckets[JAEGER_STATS_HISTOGRAM_COUNT][JAEGER_STATS_BUCKETS];
+    const stats_block* block;
+    size_t i;
+    size_t j;
+    memset(buckets, 0, sizeof(buckets));
+    for (block = atomic_load_explicit(&blocks, memory_order_acquire);
+         block != NULL;
+         block = block->next) {
+        if (atomic_load_explicit(&block->in_use, memory_order_relaxed)) {
+            ++snapshot->threads;
+        }
+        for (i = 0; i < JAEGER_STATS_COUNTER_COUNT; ++i) {
+            counters[i] += atomic_load_explicit(&block->counters[i],
+                                                memory_order_relaxed);
+        }
+        for (i = 0; i < JAEGER_STATS_HISTOGRAM_COUNT; ++i) {
+            sums[i] +=
+                atomic_load_explicit(&block->sums[i], memory_order_relaxed);
+            for (j = 0; j < JAEGER_STATS_BUCKETS; ++j) {
+                buckets[i][j] += atomic_load_explicit(&block->buckets[i][j],
+                                                      memory_order_relaxed);
+            }
+        }
+    }
+    snapshot->allocations = counters[JAEGER_STATS_ALLOCATIONS];
+    snapshot->allocated_bytes = counters[JAEGER_STATS_ALLOCATED_BYTES];
+    snapshot->frees = counters[JAEGER_STATS_FREES];
+    snapshot->list_nodes = counters[JAEGER_STATS_LIST_NODES];
+    snapshot->strings_copied = counters[JAEGER_STATS_STRINGS_COPIED];
+    snapshot->string_bytes_copied =
+        counters[JAEGER_STATS_STRING_BYTES_COPIED];
+    snapshot->strings_borrowed = counters[JAEGER_STATS_STRINGS_BORROWED];
+    snapshot->messages_encoded = counters[JAEGER_STATS_MESSAGES_ENCODED];
+    snapshot->encoded_bytes = counters[JAEGER_STATS_ENCODED_BYTES];
+    snapshot->messages_decoded = counters[JAEGER_STATS_MESSAGES_DECODED];
+    snapshot->decoded_bytes = counters[JAEGER_STATS_DECODED_BYTES];
+    snapshot->pool_acquires = counters[JAEGER_STATS_POOL_ACQUIRES];
+    snapshot->pool_misses = counters[JAEGER_STATS_POOL_MISSES];
+    return snapshot_histogram(buckets[JAEGER_STATS_ENCODE_TIME],
+                              sums[JAEGER_STATS_ENCODE_TIME],
+                              &snapshot->encode_time) &&
+           snapshot_histogram(buckets[JAEGER_STATS_DECODE_TIME],
+                              sums[JAEGER_STATS_DECODE_TIME],
+                              &snapshot->decode_time);
+}
+
+#else
+
+void jaeger_stats_add(jaeger_stats_counter counter, uint64_t value)
+{
+    (void) counter;
+    (void) value;
+}
+
+void jaeger_stats_set_timing(bool enabled)
+{
+    (void) enabled;
+}
+
+uint64_t jaeger_stats_begin(void)
+{
+    return 0;
+}
+
+void jaeger_stats_end(jaeger_stats_histogram histogram, uint64_t start)
+{
+    (void) histogram;
+    (void) start;
+}
+
+bool jaeger_stats_snapshot(jaeger_struct_runtime_stats_snapshot* snapshot)
+{
+    (void) snapshot;
+    return true;
+}
+
+#endif /* JAEGER_ENABLE_STATS */
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_RUNTIME_STATS_H
+#define JAEGER_STRUCT_RUNTIME_STATS_H
+
+#include <jaeger-struct/runtime/common.h>
+#include <jaeger-struct/runtime/stats_snapshot.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Runtime instrumentation. Each thread updates its own cache-line aligned
+ * block of counters without atomic read-modify-writes, and snapshots sum all
+ * blocks. Blocks of exited threads are reused by new ones, so totals never go
+ * backwards.
+ *
+ * Without JAEGER_ENABLE_STATS (the ENABLE_STATS build option) the macros
+ * below compile to nothing and snapshots are all zero.
+ */
+
+typedef enum jaeger_stats_counter {
+    JAEGER_STATS_ALLOCATIONS,
+    JAEGER_STATS_ALLOCATED_BYTES,
+    JAEGER_STATS_FREES,
+    JAEGER_STATS_LIST_NODES,
+    JAEGER_STATS_STRINGS_COPIED,
+    JAEGER_STATS_STRING_BYTES_COPIED,
+    JAEGER_STATS_STRINGS_BORROWED,
+    JAEGER_STATS_MESSAGES_ENCODED,
+    JAEGER_STATS_ENCODED_BYTES,
+    JAEGER_STATS_MESSAGES_DECODED,
+    JAEGER_STATS_DECODED_BYTES,
+    JAEGER_STATS_POOL_ACQUIRES,
+    JAEGER_STATS_POOL_MISSES,
+    JAEGER_STATS_COUNTER_COUNT
+} jaeger_stats_counter;
+
+typedef enum jaeger_stats_histogram {
+    JAEGER_STATS_ENCODE_TIME,
+    JAEGER_STATS_DECODE_TIME,
+    JAEGER_STATS_HISTOGRAM_COUNT
+} jaeger_stats_histogram;
+
+enum { JAEGER_STATS_BUCKETS = 65 };
+
+void jaeger_stats_add(jaeger_stats_counter counter, uint64_t value);
+
+/* Timing costs a cycle counter read per operation, so it is off by default. */
+void jaeger_stats_set_timing(bool enabled);
+
+/* Returns the start time of a timed operation, or zero if timing is off. */
+uint64_t jaeger_stats_begin(void);
+
+/* Records the time elapsed since start unless start is zero. */
+void jaeger_stats_end(jaeger_stats_histogram histogram, uint64_t start);
+
+/*
+ * Stores the totals of all threads in snapshot, which must be zeroed and
+ * released with jaeger_struct_runtime_stats_snapshot_destroy.
+ */
+bool jaeger_stats_snapshot(jaeger_struct_runtime_stats_snapshot* snapshot);
+
+#ifdef JAEGER_ENABLE_STATS
+#define JAEGER_STATS_ADD(counter, value) jaeger_stats_add((counter), (value))
+#define JAEGER_STATS_BEGIN() jaeger_stats_begin()
+#define JAEGER_STATS_END(histogram, start) jaeger_stats_end((histogram), (start))
+#else
+#define JAEGER_STATS_ADD(counter, value) ((void) 0)
+#define JAEGER_STATS_BEGIN() ((uint64_t) 0)
+#define JAEGER_STATS_END(histogram, start) ((void) (start))
+#endif /* JAEGER_ENABLE_STATS */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* JAEGER_STRUCT_RUNTIME_STATS_H */
@@ -15,3 +15,66 @@
  */
 
 #include <jaeger-struct/runtime/string.h>
+
+#include <string.h>
+
+#include <jaeger-struct/runtime/stats.h>
+
+bool jaeger_string_assign(jaeger_string* str, const char* buffer, size_t len)
+{
+    char* copy = NULL;
+    JAEGER_STATS_ADD(JAEGER_STATS_STRINGS_COPIED, 1);
+    JAEGER_STATS_ADD(JAEGER_STATS_STRING_BYTES_COPIED, len);
+    if (len <= str->capacity && str->capacity > 0) {
+        /* buffer may point into str itself. */
+        memmove(str->buffer, buffer, len);
+        str->len = len;
+        return true;
+    }
+    if (len > 0) {
+        copy = (char*) jaeger_malloc(len);
+        if (copy == NULL) {
+            return false;
+        }
+        memcpy(copy, buffer, len);
+    }
+    jaeger_free(str->buffer);
+    str->buffer = copy;
+    str->len = len;
+    str->capacity = len;
+    return true;
+}
+
+void jaeger_string_clear(jaeger_string* str)
+{
+    if (str->capacity == 0) {
+        jaeger_string_destroy(str);
+        return;
+    }
+    str->len = 0;
+}
+
+void jaeger_string_shrink(jaeger_string* str)
+{
+    char* buffer;
+    if (str->len == 0) {
+        jaeger_string_destroy(str);
+        return;
+    }
+    if (str->capacity <= str->len) {
+        return;
+    }
+    buffer = (char*) jaeger_realloc(str->buffer, str->len);
+    if (buffer != NULL) {
+        str->buffer = buffer;
+        str->capacity = str->len;
+    }
+}
+
+void jaeger_string_destroy(jaeger_string* str)
+{
+    jaeger_free(str->buffer);
+    str->buffer = NULL;
+    str->len = 0;
+    str->capacity = 0;
+}
@@ -26,8 +26,37 @@ extern "C" {
 typedef struct jaeger_string {
     size_t len;
     char* buffer;
+    /*
+     * Bytes allocated at buffer, or zero if unknown, as for strings filled
+     * in by hand. buffer is always owned: clearing, shrinking, assigning and
+     * destroying may free it whatever the capacity.
+     */
+    size_t capacity;
 } jaeger_string;
 
+/*
+ * Replaces the contents of str with a copy of len bytes from buffer, reusing
+ * the buffer of str if its capacity suffices.
+ */
+bool jaeger_string_assign(jaeger_string* str, const char* buffer, size_t len);
+
+/* Empties str, keeping its buffer for reuse if the capacity is known. */
+void jaeger_string_clear(jaeger_string* str);
+
+/* Releases the capacity of str beyond its length. */
+void jaeger_string_shrink(jaeger_string* str);
+
+void jaeger_string_destroy(jaeger_string* str);
+
+/* Bytes allocated for str, its length if the capacity is unknown. */
+static inline size_t jaeger_string_memory_usage(const jaeger_string* str)
+{
+    if (str->capacity != 0) {
+        return str->capacity;
+    }
+    return str->buffer != NULL ? str->len : 0;
+}
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
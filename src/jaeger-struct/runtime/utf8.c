@@ -0,0 +1,328 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <jaeger-struct/runtime/utf8.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define JAEGER_UTF8_SIMD
+#include <immintrin.h>
+#endif /* defined(__GNUC__) && defined(__x86_64__) */
+
+static bool is_continuation(uint8_t byte)
+{
+    return (byte & 0xc0) == 0x80;
+}
+
+static bool utf8_valid_sw(const uint8_t* data, size_t len)
+{
+    const uint8_t* const end = data + len;
+    while (data < end) {
+        const size_t left = (size_t) (end - data);
+        const uint8_t lead = *data;
+        if (left >= 8) {
+            uint64_t word;
+            memcpy(&word, data, sizeof(word));
+            if ((word & UINT64_C(0x8080808080808080)) == 0) {
+                data += 8;
+                continue;
+            }
+        }
+        if (lead < 0x80) {
+            ++data;
+        }
+        else if (lead < 0xc2) {
+            /* A continuation byte, or an overlong two-byte form. */
+            return false;
+        }
+        else if (lead < 0xe0) {
+            if (left < 2 || !is_continuation(data[1])) {
+                return false;
+            }
+            data += 2;
+        }
+        else if (lead < 0xf0) {
+            if (left < 3 || !is_continuation(data[1]) ||
+                !is_continuation(data[2]) ||
+                (lead == 0xe0 && data[1] < 0xa0) ||
+                (lead == 0xed && data[1] > 0x9f)) {
+                return false;
+            }
+            data += 3;
+        }
+        else if (lead < 0xf5) {
+            if (left < 4 || !is_continuation(data[1]) ||
+                !is_continuation(data[2]) || !is_continuation(data[3]) ||
+                (lead == 0xf0 && data[1] < 0x90) ||
+                (lead == 0xf4 && data[1] > 0x8f)) {
+                return false;
+            }
+            data += 4;
+        }
+        else {
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifdef JAEGER_UTF8_SIMD
+
+/*
+ * The lookup algorithm of Keiser and Lemire, "Validating UTF-8 In Less Than
+ * One Instruction Per Byte" (2021). Each byte is checked against the byte
+ * before it: three 16-entry tables, indexed by the high and low nibbles of
+ * the previous byte and the high nibble of the byte, map them to the errors
+ * the pair may belong to, and the AND of the three is nonzero exactly for
+ * invalid pairs. Only the third and fourth bytes of a sequence need to look
+ * further back, which a saturating subtraction handles.
+ */
+#define TOO_SHORT (1 << 0)
+#define TOO_LONG (1 << 1)
+#define OVERLONG_3 (1 << 2)
+#define TOO_LARGE (1 << 3)
+#define SURROGATE (1 << 4)
+#define OVERLONG_2 (1 << 5)
+#define TOO_LARGE_1000 (1 << 6)
+#define OVERLONG_4 (1 << 6)
+#define TWO_CONTS (1 << 7)
+#define CARRY (TOO_SHORT | TOO_LONG | TWO_CONTS)
+
+static const uint8_t byte_1_high[16] = {
+    /* 0xxx: ASCII. */
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+    /* 10xx: continuation. */
+    TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+    /* 1100 and 1101: two-byte lead. */
+    TOO_SHORT | OVERLONG_2,
+    TOO_SHORT,
+    /* 1110: three-byte lead. */
+    TOO_SHORT | OVERLONG_3 | SURROGATE,
+    /* 1111: four-byte lead. */
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4
+};
+
+static const uint8_t byte_1_low[16] = {
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+    CARRY | OVERLONG_2,
+    CARRY,
+    CARRY,
+    CARRY | TOO_LARGE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000
+};
+
+static const uint8_t byte_2_high[16] = {
+    /* 0xxx: ASCII. */
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    /* 1000, 1001 and 101x: continuation. */
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 |
+        OVERLONG_4,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    /* 11xx: lead. */
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT
+};
+
+/*
+ * Bytes that a block may end with without a sequence being cut short: less
+ * than a lead byte in the last three positions.
+ */
+static const uint8_t block_end_max[32] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xef, 0xdf, 0xbf
+};
+
+/*
+ * State of a validation: the previous block, the bytes of it that start a
+ * sequence the block cuts short, and the errors found so far.
+ */
+typedef struct sse_state {
+    __m128i prev;
+    __m128i incomplete;
+    __m128i error;
+} sse_state;
+
+__attribute__((target("sse4.1"))) static void
+sse_check(sse_state* state, __m128i input)
+{
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    __m128i prev1;
+    __m128i special;
+    __m128i must23;
+    if (_mm_movemask_epi8(input) == 0) {
+        /* ASCII, which only an incomplete previous block can make invalid. */
+        state->error = _mm_or_si128(state->error, state->incomplete);
+        state->incomplete = _mm_setzero_si128();
+        state->prev = input;
+        return;
+    }
+    prev1 = _mm_alignr_epi8(input, state->prev, 15);
+    special = _mm_and_si128(
+        _mm_and_si128(
+            _mm_shuffle_epi8(
+                _mm_loadu_si128((const __m128i*) byte_1_high),
+                _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+            _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) byte_1_low),
+                             _mm_and_si128(prev1, nibble))),
+        _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) byte_2_high),
+                         _mm_and_si128(_mm_srli_epi16(input, 4), nibble)));
+    /* Bytes two or three after a three- or four-byte lead. */
+    must23 = _mm_and_si128(
+        _mm_or_si128(
+            _mm_subs_epu8(_mm_alignr_epi8(input, state->prev, 14),
+                          _mm_set1_epi8((char) (0xe0 - 0x80))),
+            _mm_subs_epu8(_mm_alignr_epi8(input, state->prev, 13),
+                          _mm_set1_epi8((char) (0xf0 - 0x80)))),
+        _mm_set1_epi8((char) 0x80));
+    state->error =
+        _mm_or_si128(state->error, _mm_xor_si128(must23, special));
+    state->incomplete = _mm_subs_epu8(
+        input, _mm_loadu_si128((const __m128i*) (block_end_max + 16)));
+    state->prev = input;
+}
+
+__attribute__((target("sse4.1"))) static bool
+utf8_valid_sse(const uint8_t* data, size_t len)
+{
+    sse_state state;
+    uint8_t tail[16];
+    size_t i;
+    state.prev = _mm_setzero_si128();
+    state.incomplete = _mm_setzero_si128();
+    state.error = _mm_setzero_si128();
+    for (i = 0; i + 16 <= len; i += 16) {
+        sse_check(&state, _mm_loadu_si128((const __m128i*) (data + i)));
+    }
+    if (i < len) {
+        /* Padded with ASCII, which ends every sequence. */
+        memset(tail, 0, sizeof(tail));
+        memcpy(tail, data + i, len - i);
+        sse_check(&state, _mm_loadu_si128((const __m128i*) tail));
+    }
+    state.error = _mm_or_si128(state.error, state.incomplete);
+    return _mm_testz_si128(state.error, state.error);
+}
+
+typedef struct avx2_state {
+    __m256i prev;
+    __m256i incomplete;
+    __m256i error;
+} avx2_state;
+
+/* Shifts the bytes of prev before input into input by n bytes. */
+#define AVX2_PREV(input, prev, n)                                              \
+    _mm256_alignr_epi8(                                                        \
+        (input), _mm256_permute2x128_si256((prev), (input), 0x21), 16 - (n))
+
+__attribute__((target("avx2"))) static void
+avx2_check(avx2_state* state, __m256i input)
+{
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    __m256i prev1;
+    __m256i special;
+    __m256i must23;
+    if (_mm256_movemask_epi8(input) == 0) {
+        state->error = _mm256_or_si256(state->error, state->incomplete);
+        state->incomplete = _mm256_setzero_si256();
+        state->prev = input;
+        return;
+    }
+    prev1 = AVX2_PREV(input, state->prev, 1);
+    special = _mm256_and_si256(
+        _mm256_and_si256(
+            _mm256_shuffle_epi8(
+                _mm256_broadcastsi128_si256(
+                    _mm_loadu_si128((const __m128i*) byte_1_high)),
+                _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+            _mm256_shuffle_epi8(
+                _mm256_broadcastsi128_si256(
+                    _mm_loadu_si128((const __m128i*) byte_1_low)),
+                _mm256_and_si256(prev1, nibble))),
+        _mm256_shuffle_epi8(
+            _mm256_broadcastsi128_si256(
+                _mm_loadu_si128((const __m128i*) byte_2_high)),
+            _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble)));
+    must23 = _mm256_and_si256(
+        _mm256_or_si256(
+            _mm256_subs_epu8(AVX2_PREV(input, state->prev, 2),
+                             _mm256_set1_epi8((char) (0xe0 - 0x80))),
+            _mm256_subs_epu8(AVX2_PREV(input, state->prev, 3),
+                             _mm256_set1_epi8((char) (0xf0 - 0x80)))),
+        _mm256_set1_epi8((char) 0x80));
+    state->error =
+        _mm256_or_si256(state->error, _mm256_xor_si256(must23, special));
+    state->incomplete = _mm256_subs_epu8(
+        input, _mm256_loadu_si256((const __m256i*) block_end_max));
+    state->prev = input;
+}
+
+__attribute__((target("avx2"))) static bool
+utf8_valid_avx2(const uint8_t* data, size_t len)
+{
+    avx2_state state;
+    uint8_t tail[32];
+    size_t i;
+    state.prev = _mm256_setzero_si256();
+    state.incomplete = _mm256_setzero_si256();
+    state.error = _mm256_setzero_si256();
+    for (i = 0; i + 32 <= len; i += 32) {
+        avx2_check(&state, _mm256_loadu_si256((const __m256i*) (data + i)));
+    }
+    if (i < len) {
+        memset(tail, 0, sizeof(tail));
+        memcpy(tail, data + i, len - i);
+        avx2_check(&state, _mm256_loadu_si256((const __m256i*) tail));
+    }
+    state.error = _mm256_or_si256(state.error, state.incomplete);
+    return _mm256_testz_si256(state.error, state.error);
+}
+
+#endif /* JAEGER_UTF8_SIMD */
+
+/* Shorter strings, such as most tag keys, are checked faster without SIMD. */
+enum { SIMD_MIN_LEN = 16 };
+
+bool jaeger_utf8_valid(const void* data, size_t len)
+{
+#ifdef JAEGER_UTF8_SIMD
+    if (len >= SIMD_MIN_LEN) {
+        if (__builtin_cpu_supports("avx2")) {
+            return utf8_valid_avx2((const uint8_t*) data, len);
+        }
+        if (__builtin_cpu_supports("sse4.1")) {
+            return utf8_valid_sse((const uint8_t*) data, len);
+        }
+    }
+#endif /* JAEGER_UTF8_SIMD */
+    return utf8_valid_sw((const uint8_t*) data, len);
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_RUNTIME_UTF8_H
+#define JAEGER_STRUCT_RUNTIME_UTF8_H
+
+#include <jaeger-struct/runtime/common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Returns whether the len bytes at data are valid UTF-8, without overlong
+ * forms, surrogates or code points past U+10FFFF, as proto3 requires of
+ * string fields. Checks 32 or 16 bytes at a time with AVX2 or SSE4.1 when
+ * the CPU supports them, and short strings and other CPUs with a scalar loop
+ * skipping ASCII eight bytes at a time.
+ */
+bool jaeger_utf8_valid(const void* data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* JAEGER_STRUCT_RUNTIME_UTF8_H */
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_RUNTIME_VARINT_H
+#define JAEGER_STRUCT_RUNTIME_VARINT_H
+
+#include <jaeger-struct/runtime/common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Protobuf base 128 varints and zigzag encoding. */
+
+enum { JAEGER_VARINT_MAX_SIZE = 10 };
+
+static inline size_t jaeger_varint_size(uint64_t value)
+{
+#if defined(__GNUC__)
+    /* Seven bits per byte: ceil(bits / 7) computed as (bits * 9 + 64) / 64. */
+    const size_t bits = 64 - (size_t) __builtin_clzll(value | 1);
+    return (bits * 9 + 64) / 64;
+#else
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+#endif /* defined(__GNUC__) */
+}
+
+/* Writes value at buffer and returns the position past the last byte. */
+static inline uint8_t* jaeger_varint_write(uint8_t* buffer, uint64_t value)
+{
+    while (value >= 0x80) {
+        *buffer++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *buffer++ = (uint8_t) value;
+    return buffer;
+}
+
+/*
+ * Reads a varint from [*buffer, end), advancing *buffer past it. Returns false
+ * if the input is truncated or the varint is longer than ten bytes.
+ */
+static inline bool
+jaeger_varint_read(const uint8_t** buffer, const uint8_t* end, uint64_t* value)
+{
+    const uint8_t* pos = *buffer;
+    uint64_t result = 0;
+    unsigned shift;
+    for (shift = 0; shift < 64; shift += 7) {
+        uint8_t byte;
+        if (pos == end) {
+            return false;
+        }
+        byte = *pos++;
+        result |= (uint64_t)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            *buffer = pos;
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static inline uint64_t jaeger_zigzag_encode(int64_t value)
+{
+    return ((uint64_t) value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline int64_t jaeger_zigzag_decode(uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* JAEGER_STRUCT_RUNTIME_VARINT_H */
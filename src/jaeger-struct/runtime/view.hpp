@@ -0,0 +1,302 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGER_STRUCT_RUNTIME_VIEW_HPP
+#define JAEGER_STRUCT_RUNTIME_VIEW_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+#include <jaeger-struct/runtime/list.h>
+#include <jaeger-struct/runtime/string.h>
+
+// C++ wrappers over generated structs. Generated headers specialize View and
+// Traits for each message and oneof; everything here is inline and holds at
+// most one pointer, so it compiles down to direct struct access.
+
+namespace jaeger_struct {
+
+struct FieldInfo {
+    const char* _name;
+    std::size_t _offset;
+    bool _repeated;
+};
+
+#if __cplusplus >= 201703L
+using StringView = std::string_view;
+#else
+// Minimal stand-in for std::string_view before C++17.
+class StringView {
+  public:
+    using const_iterator = const char*;
+
+    constexpr StringView() noexcept
+        : _data(nullptr)
+        , _size(0)
+    {
+    }
+
+    constexpr StringView(const char* data, std::size_t size) noexcept
+        : _data(data)
+        , _size(size)
+    {
+    }
+
+    StringView(const char* str) noexcept
+        : _data(str)
+        , _size(std::strlen(str))
+    {
+    }
+
+    StringView(const std::string& str) noexcept
+        : _data(str.data())
+        , _size(str.size())
+    {
+    }
+
+    constexpr const char* data() const noexcept { return _data; }
+
+    constexpr std::size_t size() const noexcept { return _size; }
+
+    constexpr bool empty() const noexcept { return _size == 0; }
+
+    constexpr const_iterator begin() const noexcept { return _data; }
+
+    constexpr const_iterator end() const noexcept { return _data + _size; }
+
+    explicit operator std::string() const { return std::string(_data, _size); }
+
+    friend bool operator==(StringView lhs, StringView rhs) noexcept
+    {
+        return lhs._size == rhs._size &&
+               (lhs._size == 0 ||
+                std::memcmp(lhs._data, rhs._data, lhs._size) == 0);
+    }
+
+    friend bool operator!=(StringView lhs, StringView rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+  private:
+    const char* _data;
+    std::size_t _size;
+};
+#endif
+
+// Specialized by generated code with name(), fields(), relocatable() and
+// destroy().
+template <typename T>
+struct Traits {
+};
+
+// Non-owning typed accessor for a generated struct.
+template <typename T>
+class View;
+
+constexpr StringView toStringView(const jaeger_string& str) noexcept
+{
+    return StringView(str.buffer, str.len);
+}
+
+template <typename...>
+struct Void {
+    using type = void;
+};
+
+// Maps list element types to what iterating over them yields: views for
+// generated types, StringView for strings and values otherwise.
+template <typename T, typename = void>
+struct ElementView {
+    using type = T;
+
+    static constexpr type make(const T& value) noexcept { return value; }
+};
+
+template <>
+struct ElementView<jaeger_string> {
+    using type = StringView;
+
+    static constexpr type make(const jaeger_string& value) noexcept
+    {
+        return toStringView(value);
+    }
+};
+
+template <typename T>
+struct ElementView<T,
+                   typename Void<decltype(Traits<T>::fields())>::type> {
+    using type = View<T>;
+
+    static constexpr type make(const T& value) noexcept
+    {
+        return View<T>(value);
+    }
+};
+
+// Typed view over a jaeger_list whose nodes are JAEGER_LIST(T).
+template <typename T>
+class ListView {
+    struct Node {
+        jaeger_list _base;
+        T _value;
+    };
+
+  public:
+    class iterator {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename ElementView<T>::type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = value_type;
+
+        constexpr iterator() noexcept
+            : _node(nullptr)
+        {
+        }
+
+        constexpr explicit iterator(const jaeger_list* node) noexcept
+            : _node(node)
+        {
+        }
+
+        reference operator*() const noexcept
+        {
+            return ElementView<T>::make(
+                reinterpret_cast<const Node*>(_node)->_value);
+        }
+
+        iterator& operator++() noexcept
+        {
+            _node = _node->next;
+            return *this;
+        }
+
+        iterator operator++(int) noexcept
+        {
+            iterator result(*this);
+            ++*this;
+            return result;
+        }
+
+        friend bool operator==(const iterator& lhs, const iterator& rhs)
+        {
+            return lhs._node == rhs._node;
+        }
+
+        friend bool operator!=(const iterator& lhs, const iterator& rhs)
+        {
+            return lhs._node != rhs._node;
+        }
+
+      private:
+        const jaeger_list* _node;
+    };
+
+    constexpr explicit ListView(const jaeger_list& list) noexcept
+        : _list(&list)
+    {
+    }
+
+    iterator begin() const noexcept { return iterator(_list->next); }
+
+    iterator end() const noexcept { return iterator(); }
+
+    bool empty() const noexcept { return _list->next == nullptr; }
+
+    std::size_t size() const noexcept { return jaeger_list_size(_list); }
+
+  private:
+    const jaeger_list* _list;
+};
+
+// Move-only owner of a generated struct, destroying it when done. Moves
+// copy the struct, so it must not hold inline list nodes.
+template <typename T>
+class Owner {
+    static_assert(Traits<T>::relocatable(),
+                  "structs with inline list nodes cannot be moved");
+
+  public:
+    constexpr Owner() noexcept
+        : _value()
+    {
+    }
+
+    // Takes over the memory referenced by value.
+    constexpr explicit Owner(const T& value) noexcept
+        : _value(value)
+    {
+    }
+
+    Owner(Owner&& other) noexcept
+        : _value(other.release())
+    {
+    }
+
+    Owner& operator=(Owner&& other) noexcept
+    {
+        if (this != &other) {
+            reset(other.release());
+        }
+        return *this;
+    }
+
+    Owner(const Owner&) = delete;
+
+    Owner& operator=(const Owner&) = delete;
+
+    ~Owner() { Traits<T>::destroy(&_value); }
+
+    T* get() noexcept { return &_value; }
+
+    const T* get() const noexcept { return &_value; }
+
+    T* operator->() noexcept { return &_value; }
+
+    const T* operator->() const noexcept { return &_value; }
+
+    View<T> view() const noexcept { return View<T>(_value); }
+
+    // Gives up ownership, leaving this empty.
+    T release() noexcept
+    {
+        const T value = _value;
+        _value = T();
+        return value;
+    }
+
+    void reset(const T& value = T()) noexcept
+    {
+        Traits<T>::destroy(&_value);
+        _value = value;
+    }
+
+  private:
+    T _value;
+};
+
+}  // namespace jaeger_struct
+
+#endif  // JAEGER_STRUCT_RUNTIME_VIEW_HPP